@@ -31,6 +31,7 @@
 #include <nidas/core/FileSet.h>
 #include <nidas/core/Socket.h>
 #include <nidas/core/IOChannel.h>
+#include <nidas/core/SampleBusChannel.h>
 #include <nidas/dynld/RawSampleInputStream.h>
 #include <nidas/core/Project.h>
 #include <nidas/core/XMLParser.h>
@@ -44,13 +45,14 @@
 #include <nidas/util/auto_ptr.h>
 #include <nidas/util/EndianConverter.h>
 #include <nidas/core/NidasApp.h>
+#include <nidas/core/SampleIdMap.h>
+#include <nidas/util/FormatBuffer.h>
 
 #include <set>
 #include <map>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
-#include <sys/stat.h>
 
 #include <unistd.h>
 #include <getopt.h>
@@ -73,7 +75,10 @@ public:
 
     virtual ~DumpClient() {}
 
-    void flush() throw() {}
+    /**
+     * Write the formatted samples to the output stream.
+     */
+    void flush() throw();
 
     bool receive(const Sample* samp) throw();
 
@@ -87,8 +92,26 @@ public:
         warntime = w;
     }
 
+    /**
+     * Number of significant digits of floating point values.
+     * If 0, the fewest digits that give back the exact binary value.
+     * If negative, the default, 5 for floats and 10 for doubles.
+     */
+    void
+    setPrecision(int val)
+    {
+        _precision = val;
+    }
+
 private:
 
+    /**
+     * Append the DSM and sensor+sample ids of a sample to the line.
+     */
+    void appendId(dsm_sample_id_t sampid);
+
+    void appendFloat(double val, bool isDouble);
+
     SampleMatcher _samples;
 
     format_t format;
@@ -99,6 +122,25 @@ private:
 
     float warntime;
 
+    int _precision;
+
+    /**
+     * Samples are formatted into this buffer, which is written to
+     * ostr when it is full, or has not been written for a while.
+     */
+    n_u::FormatBuffer _buf;
+
+    /**
+     * Raw samples and processed samples are received from
+     * different threads.
+     */
+    n_u::Mutex _bufLock;
+
+    /**
+     * Formatted DSM and sensor+sample ids.
+     */
+    SampleIdMap<string> _idStrings;
+
     DumpClient(const DumpClient&);
     DumpClient& operator=(const DumpClient&);
 };
@@ -110,8 +152,40 @@ DumpClient::DumpClient(const SampleMatcher& matcher,
     _samples(matcher),
     format(fmt), ostr(outstr),
     fromLittle(n_u::EndianConverter::getConverter(n_u::EndianConverter::EC_LITTLE_ENDIAN)),
-    warntime(0.0)
+    warntime(0.0), _precision(-1), _buf(), _bufLock(), _idStrings()
 {
+    _buf.setTimeFormat("%Y %m %d %H:%M:%S.%4f ");
+}
+
+void DumpClient::flush() throw()
+{
+    n_u::Synchronized autolock(_bufLock);
+    _buf.write(ostr);
+}
+
+void DumpClient::appendId(dsm_sample_id_t sampid)
+{
+    SampleIdMap<string>::iterator si = _idStrings.find(sampid);
+    if (si == _idStrings.end()) {
+        ostringstream ost;
+        ost << setw(2) << setfill(' ') << GET_DSM_ID(sampid) << ',';
+        NidasApp* app = NidasApp::getApplicationInstance();
+        app->formatSampleId(ost, sampid);
+        _idStrings[sampid] = ost.str();
+        si = _idStrings.find(sampid);
+    }
+    _buf.append(si->second);
+}
+
+void DumpClient::appendFloat(double val, bool isDouble)
+{
+    if (_precision > 0)
+        _buf.appendGeneral(val, _precision, 10);
+    else if (_precision == 0) {
+        if (isDouble) _buf.appendShortest(val, 10);
+        else _buf.appendShortest((float)val, 10);
+    }
+    else _buf.appendGeneral(val, isDouble ? 10 : 5, 10);
 }
 
 void DumpClient::printHeader()
@@ -163,16 +237,11 @@ bool DumpClient::receive(const Sample* samp) throw()
     static dsm_time_t prev_tt = 0;
     dsm_sample_id_t sampid = samp->getId();
 
-    // Format the line leader into a separate string before handling the
-    // chosen output format, in case the output format is naked.
-    ostringstream leader;
-
-    leader << n_u::UTime(tt).format(true,"%Y %m %d %H:%M:%S.%4f") << ' ';
+    n_u::Synchronized autolock(_bufLock);
 
-    leader << setprecision(4) << setfill(' ');
+    double tdiff = 0.0;
     if (prev_tt != 0) {
-        double tdiff = (tt - prev_tt) / (double)(USECS_PER_SEC);
-        leader << setw(7) << tdiff << ' ';
+        tdiff = (tt - prev_tt) / (double)(USECS_PER_SEC);
         if ((warntime < 0 && tdiff < warntime) ||
             (warntime > 0 && tdiff > warntime))
         {
@@ -180,25 +249,11 @@ bool DumpClient::receive(const Sample* samp) throw()
                  << tdiff << " seconds." << endl;
         }
     }
-    else
-    {
-        leader << setw(7) << 0 << ' ';
-    }
-
-    if (!_samples.exclusiveMatch())
-    {
-        leader << setw(2) << setfill(' ') << GET_DSM_ID(sampid) << ',';
-        NidasApp* app = NidasApp::getApplicationInstance();
-        app->formatSampleId(leader, sampid);
-    }
-
-    leader << setw(7) << setfill(' ') << samp->getDataByteLength() << ' ';
-    prev_tt = tt;
 
     format_t sample_format = format;
 
     // Naked format trumps everything, otherwise force floating point
-    // samples to be printed in FLOAT format.
+    // samples to be printed in FLOAT format, and write the line leader.
     if (format != NAKED) {
         if (samp->getType() == FLOAT_ST) sample_format = FLOAT;
         else if (samp->getType() == DOUBLE_ST) sample_format = FLOAT;
@@ -206,8 +261,28 @@ bool DumpClient::receive(const Sample* samp) throw()
         {
             sample_format = typeToFormat(samp->getType());
         }
-        ostr << leader.str();
+
+        _buf.appendTime(tt);
+
+        if (prev_tt != 0) {
+            _buf.appendGeneral(tdiff, 4, 7);
+            _buf.append(' ');
+        }
+        else
+        {
+            _buf.appendInt(0, 7);
+            _buf.append(' ');
+        }
+
+        if (!_samples.exclusiveMatch())
+        {
+            appendId(sampid);
+        }
+
+        _buf.appendInt(samp->getDataByteLength(), 7);
+        _buf.append(' ');
     }
+    prev_tt = tt;
 
     switch(sample_format) {
     case ASCII:
@@ -220,52 +295,56 @@ bool DumpClient::receive(const Sample* samp) throw()
             char cp7[l];
             char* xp;
             for (xp=cp7; *cp; ) *xp++ = *cp++ & 0x7f;
-            ostr << n_u::addBackslashSequences(string(cp7,l)) << endl;
+            _buf.append(n_u::addBackslashSequences(string(cp7,l)));
         }
         else {
-            ostr << n_u::addBackslashSequences(string(cp,l)) << endl;
+            _buf.append(n_u::addBackslashSequences(string(cp,l)));
         }
+        _buf.append('\n');
         }
         break;
     case HEX_FMT:
         {
 	const unsigned char* cp =
 		(const unsigned char*) samp->getConstVoidDataPtr();
-	ostr << setfill('0');
-	for (unsigned int i = 0; i < samp->getDataByteLength(); i++)
-	    ostr << hex << setw(2) << (unsigned int)cp[i] << dec << ' ';
-	ostr << endl;
+	for (unsigned int i = 0; i < samp->getDataByteLength(); i++) {
+	    _buf.appendHex(cp[i], 2);
+	    _buf.append(' ');
+        }
+	_buf.append('\n');
 	}
         break;
     case SIGNED_SHORT:
 	{
 	const short* sp =
 		(const short*) samp->getConstVoidDataPtr();
-	ostr << setfill(' ');
-	for (unsigned int i = 0; i < samp->getDataByteLength()/sizeof(short); i++)
-	    ostr << setw(6) << sp[i] << ' ';
-	ostr << endl;
+	for (unsigned int i = 0; i < samp->getDataByteLength()/sizeof(short); i++) {
+	    _buf.appendInt(sp[i], 6);
+	    _buf.append(' ');
+        }
+	_buf.append('\n');
 	}
         break;
     case UNSIGNED_SHORT:
 	{
 	const unsigned short* sp =
 		(const unsigned short*) samp->getConstVoidDataPtr();
-	ostr << setfill(' ');
-	for (unsigned int i = 0; i < samp->getDataByteLength()/sizeof(short); i++)
-	    ostr << setw(6) << sp[i] << ' ';
-	ostr << endl;
+	for (unsigned int i = 0; i < samp->getDataByteLength()/sizeof(short); i++) {
+	    _buf.appendInt(sp[i], 6);
+	    _buf.append(' ');
+        }
+	_buf.append('\n');
 	}
         break;
     case FLOAT:
-         if (samp->getType() == DOUBLE_ST) ostr << setprecision(10);
-         else ostr << setprecision(5);
-
-         ostr << setfill(' ');
-
-        for (unsigned int i = 0; i < samp->getDataLength(); i++)
-            ostr << setw(10) << samp->getDataValue(i) << ' ';
-        ostr << endl;
+        {
+        bool isDouble = samp->getType() == DOUBLE_ST;
+        for (unsigned int i = 0; i < samp->getDataLength(); i++) {
+            appendFloat(samp->getDataValue(i), isDouble);
+            _buf.append(' ');
+        }
+        _buf.append('\n');
+        }
         break;
     case IRIG:
 	{
@@ -274,6 +353,7 @@ bool DumpClient::receive(const Sample* samp) throw()
 	struct timeval32 tv;
 	char timestr[128];
 	struct tm tm;
+        ostringstream ost;
 
         // IRIG time
         time_t irig_sec = fromLittle->int32Value(dp);
@@ -283,7 +363,7 @@ bool DumpClient::receive(const Sample* samp) throw()
 
 	gmtime_r(&irig_sec,&tm);
 	strftime(timestr,sizeof(timestr)-1,"%H:%M:%S",&tm);
-	ostr << "irig: " << timestr << '.' << setw(6) << setfill('0') << irig_usec << ", ";
+	ost << "irig: " << timestr << '.' << setw(6) << setfill('0') << irig_usec << ", ";
 
         if (nbytes >= 2 * sizeof(struct timeval32) + 1) {
 
@@ -296,34 +376,36 @@ bool DumpClient::receive(const Sample* samp) throw()
 
             gmtime_r(&unix_sec,&tm);
             strftime(timestr,sizeof(timestr)-1,"%H:%M:%S",&tm);
-            ostr << "unix: " << timestr << '.' << setw(6) << setfill('0') << unix_usec << ", ";
-            ostr << "i-u: " << setfill(' ') << setw(4) << ((irig_sec - unix_sec) * USECS_PER_SEC +
+            ost << "unix: " << timestr << '.' << setw(6) << setfill('0') << unix_usec << ", ";
+            ost << "i-u: " << setfill(' ') << setw(4) << ((irig_sec - unix_sec) * USECS_PER_SEC +
                 (irig_usec - unix_usec)) << " us, ";
         }
 
 	unsigned char status = *dp++;
 
-        ostr << "status: " << setw(2) << setfill('0') << hex << (int)status << dec <<
+        ost << "status: " << setw(2) << setfill('0') << hex << (int)status << dec <<
 		'(' << IRIGSensor::shortStatusString(status) << ')';
         if (nbytes >= 2 * sizeof(struct timeval32) + 2)
-            ostr << ", seq: " << (int)*dp++;
+            ost << ", seq: " << (int)*dp++;
         if (nbytes >= 2 * sizeof(struct timeval32) + 3)
-            ostr << ", synctgls: " << (int)*dp++;
+            ost << ", synctgls: " << (int)*dp++;
         if (nbytes >= 2 * sizeof(struct timeval32) + 4)
-            ostr << ", clksteps: " << (int)*dp++;
+            ost << ", clksteps: " << (int)*dp++;
         if (nbytes >= 2 * sizeof(struct timeval32) + 5)
-            ostr << ", maxbacklog: " << (int)*dp++;
-	ostr << endl;
+            ost << ", maxbacklog: " << (int)*dp++;
+	ost << '\n';
+        _buf.append(ost.str());
 	}
         break;
     case INT32:
 	{
 	const int* lp =
 		(const int*) samp->getConstVoidDataPtr();
-	ostr << setfill(' ');
-	for (unsigned int i = 0; i < samp->getDataByteLength()/sizeof(int); i++)
-	    ostr << setw(8) << lp[i] << ' ';
-	ostr << endl;
+	for (unsigned int i = 0; i < samp->getDataByteLength()/sizeof(int); i++) {
+	    _buf.appendInt(lp[i], 8);
+	    _buf.append(' ');
+        }
+	_buf.append('\n');
 	}
         break;
     case NAKED:
@@ -339,11 +421,12 @@ bool DumpClient::receive(const Sample* samp) throw()
         const char* ptr = (const char*) samp->getConstVoidDataPtr(); 
         if (n > 1 && ptr[n-1] == '\0' && 
                 (ptr[n-2] == '\r' || ptr[n-2] == '\n')) n--;
-        ostr.write(ptr,n);
+        _buf.append(ptr,n);
         }
     case DEFAULT:
         break;
     }
+    if (_buf.writeDue()) _buf.write(ostr);
     return true;
 }
 
@@ -371,8 +454,11 @@ private:
 
     float warntime;
 
+    int precision;
+
     NidasApp app;
     NidasAppArg WarnTime;
+    NidasAppArg Precision;
 };
 
 
@@ -380,11 +466,17 @@ DataDump::DataDump():
     xmlFileName(),
     format(DumpClient::DEFAULT),
     warntime(0.0),
+    precision(-1),
     app("data_dump"),
     WarnTime("-w,--warntime", "<seconds>",
              "Warn when sample time succeeds the previous more than <seconds>.\n"
              "If <seconds> is negative, then warn when the succeeding time skips\n"
-             "backwards.\n", "0")
+             "backwards.\n", "0"),
+    Precision("--precision", "<digits>",
+              "Number of significant digits of floating point values.\n"
+              "If 0, use the fewest digits which give back the exact\n"
+              "binary value. The default is 5 for floats and 10 for doubles.",
+              "-1")
 {
     app.setApplicationInstance();
     app.setupSignals();
@@ -397,7 +489,7 @@ int DataDump::parseRunstring(int argc, char** argv)
                         app.FormatHexId | app.FormatSampleId |
                         app.SampleRanges | app.StartTime | app.EndTime |
                         app.Version | app.InputFiles | app.ProcessData |
-                        app.Help | app.Version | WarnTime);
+                        app.Help | app.Version | WarnTime | Precision);
 
     app.InputFiles.allowFiles = true;
     app.InputFiles.allowSockets = true;
@@ -411,6 +503,7 @@ int DataDump::parseRunstring(int argc, char** argv)
         return usage(argv[0]);
     }
     warntime = WarnTime.asFloat();
+    precision = Precision.asInt();
 
     NidasAppArgv left(argv[0], args);
     int opt_char;     /* option character */
@@ -543,6 +636,9 @@ int DataDump::run() throw()
                 nidas::core::FileSet::getFileSet(app.dataFileNames());
             iochan = fset->connect();
 	}
+	else if (app.sampleBusName().length() > 0) {
+	    iochan = new SampleBusChannel(app.sampleBusName());
+	}
 	else {
             // We know a default socket address was provided, so it's safe
             // to dereference it.
@@ -565,12 +661,15 @@ int DataDump::run() throw()
 	    xmlFileName = header.getConfigName();
 	xmlFileName = n_u::Process::expandEnvVars(xmlFileName);
 
-	struct stat statbuf;
-	if (::stat(xmlFileName.c_str(),&statbuf) == 0 || app.processData())
+	// The sensors are only needed to process samples, and then
+	// only those with samples selected by the -i options.
+	if (app.processData())
         {
             n_u::auto_ptr<xercesc::DOMDocument>
                 doc(parseXMLConfigFile(xmlFileName));
 
+            if (app.sampleMatcher().numRanges() > 0)
+                Project::getInstance()->setSampleMatcher(&app.sampleMatcher());
 	    Project::getInstance()->fromDOMElement(doc->getDocumentElement());
 
 	    DSMConfigIterator di = Project::getInstance()->getDSMConfigIterator();
@@ -603,6 +702,7 @@ int DataDump::run() throw()
 
         DumpClient dumper(app.sampleMatcher(), format, cout);
         dumper.setWarningTime(warntime);
+        dumper.setPrecision(precision);
 
 	if (app.processData()) {
             // 2. connect the pipeline to the SampleInputStream.
@@ -621,6 +721,9 @@ int DataDump::run() throw()
         try {
             for (;;) {
                 sis.readSamples();
+                // write what has been formatted, so that samples from
+                // a socket are seen as they arrive
+                dumper.flush();
                 if (app.interrupted()) break;
             }
         }
@@ -637,6 +740,7 @@ int DataDump::run() throw()
             pipeline.interrupt();
             pipeline.join();
             sis.close();
+            dumper.flush();
             throw(e);
         }
 	if (app.processData()) {
@@ -648,6 +752,7 @@ int DataDump::run() throw()
         else {
             sis.removeSampleClient(&dumper);
         }
+        dumper.flush();
         sis.close();
         pipeline.interrupt();
         pipeline.join();
@@ -30,6 +30,7 @@
 
 #include <nidas/core/FileSet.h>
 #include <nidas/core/Socket.h>
+#include <nidas/core/SampleBusChannel.h>
 #include <nidas/dynld/RawSampleInputStream.h>
 #include <nidas/core/Project.h>
 #include <nidas/core/XMLParser.h>
@@ -865,6 +866,11 @@ int DataStats::run() throw()
                 nidas::core::FileSet::getFileSet(app.dataFileNames());
             iochan = fset->connect();
 	}
+	else if (app.sampleBusName().length() > 0)
+        {
+	    iochan = new SampleBusChannel(app.sampleBusName());
+            _realtime = true;
+	}
 	else
         {
 	    n_u::Socket* sock = new n_u::Socket(*app.socketAddress());
@@ -896,6 +902,9 @@ int DataStats::run() throw()
             n_u::auto_ptr<xercesc::DOMDocument>
                 doc(parseXMLConfigFile(xmlFileName));
 
+            // Only create the sensors with samples selected by -i.
+            if (app.sampleMatcher().numRanges() > 0)
+                Project::getInstance()->setSampleMatcher(&app.sampleMatcher());
 	    Project::getInstance()->fromDOMElement(doc->getDocumentElement());
 
             DSMConfigIterator di = Project::getInstance()->getDSMConfigIterator();
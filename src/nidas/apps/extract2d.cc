@@ -475,11 +475,14 @@ size_t ExtractFast2D::computeDiodeCount(Probe * probe, const unsigned char * rec
 
       for (size_t i = 0; i < nBytes; ++i)
       {
-        for (size_t j = 0; j < 8; ++j) // 8 bits.
-          if (((slice[i] << j) & 0x80) == 0x00) {
-            probe->diodeCount[i*nBytes + j]++;
-            diodeCnt[i*nBytes + j]++;
-          }
+        // Shadowed diodes are 0 bits. Visit just those, most significant first.
+        unsigned int bits = (unsigned char)~slice[i];
+        while (bits) {
+          size_t j = __builtin_clz(bits) - 24;
+          probe->diodeCount[i*nBytes + j]++;
+          diodeCnt[i*nBytes + j]++;
+          bits &= ~(0x80u >> j);
+        }
       }
     }
 
@@ -502,14 +505,15 @@ size_t ExtractFast2D::countParticles(Probe * probe, const unsigned char * record
     const P2d_rec *rec = (const P2d_rec *)record;
     const unsigned char *p = rec->data;
 
-    if (probe->nDiodes == 32)
-        for (size_t i = 0; i < 4095; ++i, ++p) {
-            if (*p == 0x55) {
-                ++totalCnt;
-                if ((i % 4) != 0)
-                    ++missCnt;
-            }
+    if (probe->nDiodes == 32) {
+        const unsigned char *eod = p + 4095;
+        while ((p = (const unsigned char *)::memchr(p, 0x55, eod - p))) {
+            ++totalCnt;
+            if (((p - rec->data) % 4) != 0)
+                ++missCnt;
+            ++p;
         }
+    }
 
     if (probe->nDiodes == 64) {
         unsigned char dof_flag_mask = 0x01;
@@ -82,6 +82,8 @@ private:
 
     bool doAscii;
 
+    int nthreads;
+
 };
 
 int main(int argc, char** argv)
@@ -96,6 +98,9 @@ int PacketDecode::usage(const char* argv0)
 Usage: " << argv0 << " -x xml_file [packet_file] ...\n\
     -a : (optional) output ASCII samples \n\
     -h : print this help\n\
+    -j nthreads: number of threads to decode packets, default=1.\n\
+       With more than one, samples are only sorted by time within\n\
+       batches of 4096 packets\n\
     -l log_level: 7=debug,6=info,5=notice,4=warn,3=err, default=6\n" <<
 #ifdef HAVE_LIBNC_SERVER_RPC
     "\
@@ -122,7 +127,8 @@ int PacketDecode::main(int argc, char** argv) throw()
 }
 
 PacketDecode::PacketDecode():
-    packetFileNames(),xmlFileName(),netcdfServer(), doAscii(false)
+    packetFileNames(),xmlFileName(),netcdfServer(), doAscii(false),
+    nthreads(1)
 {
 }
 
@@ -132,13 +138,17 @@ int PacketDecode::parseRunstring(int argc, char** argv) throw()
     extern int optind;       /* "  "     "     */
     int opt_char;     /* option character */
 
-    while ((opt_char = getopt(argc, argv, "ahl:N:x:")) != -1) {
+    while ((opt_char = getopt(argc, argv, "ahj:l:N:x:")) != -1) {
 	switch (opt_char) {
 	case 'a':
 	    doAscii = true;
 	    break;
 	case 'h':
 	    return usage(argv[0]);
+	case 'j':
+	    nthreads = atoi(optarg);
+	    if (nthreads < 1) return usage(argv[0]);
+	    break;
 	case 'l':
             {
                 n_u::LogConfig lc;
@@ -199,6 +209,7 @@ int PacketDecode::run() throw()
 	// PacketInputStream owns the fset ptr.
 	PacketInputStream input(fset);
 
+	input.setNumThreads(nthreads);
 	input.init();
 
 	SampleArchiver arch;
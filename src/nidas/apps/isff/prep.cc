@@ -50,6 +50,7 @@
 #include <nidas/util/UTime.h>
 #include <nidas/util/Process.h>
 #include <nidas/util/auto_ptr.h>
+#include <nidas/util/FormatBuffer.h>
 
 #include <set>
 #include <map>
@@ -77,7 +78,8 @@ public:
 
     void flush() throw()
     {
-        _ostr.flush();
+        n_u::Synchronized autolock(_bufLock);
+        _buf.write(_ostr);
     }
 
     bool receive(const Sample* samp) throw();
@@ -122,8 +124,25 @@ private:
 
     bool _dosOut;
 
+    /**
+     * Number of significant digits in ASCII output. If 0, the fewest
+     * digits which give back the binary value.
+     */
     int _asciiPrecision;
 
+    /**
+     * ASCII output is formatted into this buffer, and written to _ostr
+     * when it is full, or has not been written for a while.
+     */
+    n_u::FormatBuffer _buf;
+
+    n_u::Mutex _bufLock;
+
+    /** No copying. */
+    DumpClient(const DumpClient&);
+
+    /** No assignment. */
+    DumpClient& operator=(const DumpClient&);
 };
 
 
@@ -297,8 +316,9 @@ const char* DataPrep::_isfsDatasetsXML = "$ISFS/projects/$PROJECT/ISFS/config/da
 DumpClient::DumpClient(format_t fmt,ostream &outstr,int precision):
 	_format(fmt),_ostr(outstr),_startTime((time_t)0),_endTime((time_t)0),
         _checkStart(false),_checkEnd(false),_dosOut(false),
-        _asciiPrecision(precision)
+        _asciiPrecision(precision),_buf(),_bufLock()
 {
+    _buf.setTimeFormat("%Y %m %d %H:%M:%S.%4f");
 }
 
 Dataset DataPrep::getDataset() throw(n_u::InvalidParameterException, XMLException)
@@ -359,14 +379,21 @@ bool DumpClient::receive(const Sample* samp) throw()
     switch(_format) {
     case ASCII:
 	{
-	n_u::UTime ut(tt);
-	_ostr << ut.format(true,"%Y %m %d %H:%M:%S.%4f");
-
-	_ostr << setprecision(_asciiPrecision) << setfill(' ');
-	for (unsigned int i = 0; i < samp->getDataLength(); i++)
-	    _ostr << ' ' << setw(10) << samp->getDataValue(i);
-        if (_dosOut) cout << '\r';
-	_ostr << endl;
+        n_u::Synchronized autolock(_bufLock);
+	_buf.appendTime(tt);
+
+	for (unsigned int i = 0; i < samp->getDataLength(); i++) {
+            _buf.append(' ');
+            if (_asciiPrecision > 0)
+                _buf.appendGeneral(samp->getDataValue(i), _asciiPrecision, 10);
+            else if (samp->getType() == DOUBLE_ST)
+                _buf.appendShortest(samp->getDataValue(i), 10);
+            else
+                _buf.appendShortest((float)samp->getDataValue(i), 10);
+        }
+        if (_dosOut) _buf.append('\r');
+        _buf.append('\n');
+        if (_buf.writeDue()) _buf.write(_ostr);
 	}
         break;
     case BINARY1:
@@ -541,7 +568,7 @@ int DataPrep::parseRunstring(int argc, char** argv)
             {
                 istringstream ist(optarg);
                 ist >> _asciiPrecision;
-                if (ist.fail() || _asciiPrecision < 1) {
+                if (ist.fail() || _asciiPrecision < 0) {
                     cerr << "Invalid precision: " << optarg << endl;
                     return usage(argv[0]);
                 }
@@ -678,7 +705,8 @@ Usage: " << argv0 << " [-A] [-C] [-r rate] [-d dsmname] -D var[,var,...] [-B tim
             Default: " << defaultNCInterval <<
 #endif
         "\n\
-    -p precision: number of digits in ASCII output values, default is 5\n\
+    -p precision: number of digits in ASCII output values, default is 5.\n\
+       0 for the fewest digits which give back the exact binary values\n\
     -r rate: optional resample rate, in Hz for successive variables.\n\
        Output timetags will be in middle of periods.\n\
        When writing to NetCDF files, it can be useful for prep to generate\n\
@@ -1195,6 +1223,7 @@ int DataPrep::run() throw()
                 }
                 pipeline.disconnect(&sis);
                 sis.close();
+                dumper.flush();
                 throw e;
             }
             pipeline.disconnect(&sis);
@@ -1203,6 +1232,7 @@ int DataPrep::run() throw()
             for (ri = _resamplers.begin() ; ri != _resamplers.end(); ++ri) {
                 (*ri)->removeSampleClient(&dumper);
             }
+            dumper.flush();
         }
 #ifdef HAVE_LIBNC_SERVER_RPC
         else {
@@ -30,6 +30,8 @@
 #include <nidas/core/SortedSampleSet.h>
 #include <nidas/util/UTime.h>
 #include <nidas/util/EOFException.h>
+#include <nidas/util/Thread.h>
+#include <nidas/util/ThreadSupport.h>
 
 #include <unistd.h>
 #include <getopt.h>
@@ -38,6 +40,8 @@
 #include <climits>
 
 #include <iomanip>
+#include <map>
+#include <algorithm>
 
 // hack for arm-linux-gcc from Arcom which doesn't define LLONG_MAX
 #ifndef LLONG_MAX
@@ -51,6 +55,268 @@ using namespace std;
 
 namespace n_u = nidas::util;
 
+namespace {
+
+/**
+ * Hash of the time tag, id and data of a sample.
+ */
+inline unsigned long long mix64(unsigned long long h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+unsigned long long hashSample(const Sample* samp)
+{
+    unsigned long long h = mix64(samp->getTimeTag() ^
+        ((unsigned long long)samp->getRawId() << 32 | samp->getDataByteLength()));
+
+    const char* cp = (const char*) samp->getConstVoidDataPtr();
+    const char* ep = cp + samp->getDataByteLength();
+    unsigned long long word;
+    for ( ; ep - cp >= (int)sizeof(word); cp += sizeof(word)) {
+        ::memcpy(&word,cp,sizeof(word));
+        h = mix64(h ^ word);
+    }
+    if (cp < ep) {
+        word = 0;
+        ::memcpy(&word,cp,ep - cp);
+        h = mix64(h ^ word);
+    }
+    return h;
+}
+
+/**
+ * Digest of the samples with one id in an interval: their number
+ * and the sum of their hashes, which doesn't depend on the order
+ * in which they were read.
+ */
+struct SampleDigest
+{
+    SampleDigest(): count(0),sum(0) {}
+
+    void add(unsigned long long h)
+    {
+        count++;
+        sum += h;
+    }
+
+    SampleDigest& operator += (const SampleDigest& x)
+    {
+        count += x.count;
+        sum += x.sum;
+        return *this;
+    }
+
+    bool operator == (const SampleDigest& x) const
+    {
+        return count == x.count && sum == x.sum;
+    }
+
+    size_t count;
+
+    unsigned long long sum;
+};
+
+typedef map<dsm_sample_id_t,SampleDigest> IdDigests;
+
+/**
+ * Digests by interval number, tt / interval.
+ */
+typedef map<long long,IdDigests> IntervalDigests;
+
+/**
+ * State shared by the DigestReaders and the verifying thread.
+ */
+struct DigestSync
+{
+    DigestSync(): cond(),verified(LLONG_MIN) {}
+
+    /**
+     * Protects the completed digests of the readers and verified,
+     * and is signaled when either changes.
+     */
+    n_u::Cond cond;
+
+    /**
+     * Intervals before this one have been compared.
+     */
+    long long verified;
+
+private:
+    // No copying
+    DigestSync(const DigestSync&);
+
+    // No assignment
+    DigestSync& operator=(const DigestSync&);
+};
+
+/**
+ * Thread which reads a SampleInputStream to its end, accumulating
+ * the digests of its samples by interval. An interval is complete,
+ * and is moved to the completed digests, once a sample is read whose
+ * time is more than the slack past the end of the interval.
+ */
+class DigestReader: public n_u::Thread
+{
+public:
+    DigestReader(SampleInputStream* input,DigestSync& sync,
+        dsm_time_t interval, dsm_time_t slack,
+        dsm_time_t tstart, dsm_time_t tend):
+        n_u::Thread(input->getName()),_input(input),_sync(sync),
+        _interval(interval),_slack(slack),_tstart(tstart),_tend(tend),
+        _tmax(LLONG_MIN),_pending(),_completed(),_done(LLONG_MIN),
+        _nsamps(0),_nback(0)
+    {
+    }
+
+    /**
+     * Intervals before this one are complete. LLONG_MAX after EOF.
+     * Call with the DigestSync::cond locked.
+     */
+    long long getDone() const
+    {
+        return _done;
+    }
+
+    /**
+     * Completed digests. Call with the DigestSync::cond locked.
+     */
+    IntervalDigests& getCompleted()
+    {
+        return _completed;
+    }
+
+    size_t getNumSamples() const
+    {
+        return _nsamps;
+    }
+
+    size_t getNumBackward() const
+    {
+        return _nback;
+    }
+
+    int run() throw(n_u::Exception);
+
+private:
+
+    void publish(long long done);
+
+    SampleInputStream* _input;
+
+    DigestSync& _sync;
+
+    dsm_time_t _interval;
+
+    dsm_time_t _slack;
+
+    dsm_time_t _tstart;
+
+    dsm_time_t _tend;
+
+    dsm_time_t _tmax;
+
+    /**
+     * Digests of incomplete intervals, only accessed by this thread.
+     */
+    IntervalDigests _pending;
+
+    IntervalDigests _completed;
+
+    long long _done;
+
+    size_t _nsamps;
+
+    size_t _nback;
+
+    /**
+     * How many intervals a reader may complete ahead of the
+     * verification, which bounds the memory used by the digests
+     * of a fast reader.
+     */
+    static const long long MAX_AHEAD = 100;
+
+    // No copying
+    DigestReader(const DigestReader&);
+
+    // No assignment
+    DigestReader& operator=(const DigestReader&);
+};
+
+void DigestReader::publish(long long done)
+{
+    _sync.cond.lock();
+    IntervalDigests::iterator end = _pending.lower_bound(done);
+    _completed.insert(_pending.begin(),end);
+    _pending.erase(_pending.begin(),end);
+    _done = done;
+    _sync.cond.broadcast();
+    while (!isInterrupted() && _done != LLONG_MAX &&
+        _sync.verified != LLONG_MIN && _done > _sync.verified + MAX_AHEAD)
+        _sync.cond.wait();
+    _sync.cond.unlock();
+}
+
+int DigestReader::run() throw(n_u::Exception)
+{
+    try {
+        while (!isInterrupted()) {
+            Sample* samp = _input->readSample();
+            dsm_time_t tt = samp->getTimeTag();
+            if (tt < _tstart || tt >= _tend) {
+                samp->freeReference();
+                continue;
+            }
+            long long iv = tt / _interval;
+            if (iv < _done) {
+                // interval has been published, it may have been compared
+                if (!(_nback++ % 100)) {
+                    n_u::UTime ut(tt);
+                    _sync.cond.lock();
+                    cerr << "Backward sample (#" << _nback << "), in=" <<
+                        _input->getName() << ": " <<
+                        ut.format(true,"%Y %m %d %H:%M:%S.%6f") <<
+                        ", id=" << GET_DSM_ID(samp->getId()) << ',' <<
+                        GET_SHORT_ID(samp->getId()) <<
+                        ", len=" << samp->getDataByteLength() << endl;
+                    _sync.cond.unlock();
+                }
+                samp->freeReference();
+                continue;
+            }
+            _pending[iv][samp->getId()].add(hashSample(samp));
+            _nsamps++;
+            samp->freeReference();
+
+            if (tt > _tmax) {
+                _tmax = tt;
+                long long done = (_tmax - _slack) / _interval;
+                if (done > _done) publish(done);
+            }
+        }
+    }
+    catch (const n_u::EOFException& e) {
+        _sync.cond.lock();
+        cerr << _input->getName() << ": " << e.what() << endl;
+        _sync.cond.unlock();
+    }
+    catch (const n_u::IOException& e) {
+        // digests of the rest of the input will be reported as mismatches
+        _sync.cond.lock();
+        cerr << e.what() << endl;
+        _sync.cond.unlock();
+    }
+    publish(LLONG_MAX);
+    return RUN_OK;
+}
+
+}
+
 class MergeVerifier
 {
 public:
@@ -82,6 +348,14 @@ public:
 
     void reportDuplicate(unsigned ndup, SampleInputStream* merge, Sample* samp);
 
+    /**
+     * Read the inputs and the merge in parallel, and compare
+     * the digests of their samples by interval and id, rather than
+     * matching each sample.
+     */
+    int verifyDigests(vector<SampleInputStream*>& inputs,
+        SampleInputStream* merge);
+
 private:
 
     static bool interrupted;
@@ -92,12 +366,19 @@ private:
 
     long readAheadUsecs;
 
+    /**
+     * If non-zero, the interval of the digests compared by verifyDigests().
+     */
+    long long digestUsecs;
+
     n_u::UTime startTime;
  
     n_u::UTime endTime;
 
     size_t nmissing;
 
+    size_t nmismatch;
+
 };
 
 int main(int argc, char** argv)
@@ -152,13 +433,18 @@ int MergeVerifier::usage(const char* argv0)
     cerr << "\
 Usage: " << argv0 << " -i input ...  [-i input ... ] ...\n\
 	[-s start_time] [-e end_time]\n\
-	-o output [-r read_ahead_secs]\n\n\
+	-o output [-r read_ahead_secs] [-d digest_secs]\n\n\
     -i input ...: one or more input file name or file name formats\n\
     -s start_time\n\
     -e end_time: time period to merge\n\
     -m merge: merge file name or file name format\n\
     -r read_ahead_secs: how much time to read ahead and sort the input samples\n\
-    	before verifying\n\n\
+    	before verifying\n\
+    -d digest_secs: instead of matching each sample, read the inputs and\n\
+        merge in parallel and compare digests of the samples of each id over\n\
+        intervals of digest_secs. Input samples more than read_ahead_secs\n\
+        out of time order are reported as backward and not verified.\n\
+        Samples which are in more than one input are reported as mismatches\n\n\
 Example (from ISFF/TREX): \n" << argv0 << " \
 -i /data1/isff_%Y%m%d_%H%M%S.dat \n\
 	-i /data2/central_%Y%m%d_%H%M%S.dat\n\
@@ -187,9 +473,9 @@ int MergeVerifier::main(int argc, char** argv) throw()
 
 MergeVerifier::MergeVerifier():
     inputFileNames(),mergeFileNames(),
-    readAheadUsecs(30*USECS_PER_SEC),
+    readAheadUsecs(30*USECS_PER_SEC),digestUsecs(0),
     startTime(LONG_LONG_MIN),endTime(LONG_LONG_MIN),
-    nmissing(0)
+    nmissing(0),nmismatch(0)
 {
 }
 
@@ -199,8 +485,12 @@ int MergeVerifier::parseRunstring(int argc, char** argv) throw()
     extern int optind;       /* "  "     "     */
     int opt_char;     /* option character */
 
-    while ((opt_char = getopt(argc, argv, "-e:i:m:s:r:")) != -1) {
+    while ((opt_char = getopt(argc, argv, "-d:e:i:m:s:r:")) != -1) {
 	switch (opt_char) {
+	case 'd':
+	    digestUsecs = atoi(optarg) * (long long)USECS_PER_SEC;
+	    if (digestUsecs <= 0) return usage(argv[0]);
+	    break;
 	case 'e':
 	    try {
 		endTime = n_u::UTime::parse(true,optarg);
@@ -292,6 +582,132 @@ void MergeVerifier::reportDuplicate(unsigned ndup, SampleInputStream* merge, Sam
         ", len=" << samp->getDataByteLength() << endl;
 }
 
+int MergeVerifier::verifyDigests(vector<SampleInputStream*>& inputs,
+    SampleInputStream* merge)
+{
+    DigestSync sync;
+
+    dsm_time_t tstart = startTime.toUsecs();
+    dsm_time_t tend = endTime.toUsecs();
+    if (tend == LONG_LONG_MIN) tend = LONG_LONG_MAX;
+
+    // The merge reader is last. Its samples are sorted, and so
+    // it needs no slack.
+    vector<DigestReader*> readers;
+    for (unsigned int ii = 0; ii < inputs.size(); ii++)
+        readers.push_back(new DigestReader(inputs[ii],sync,
+            digestUsecs,readAheadUsecs,tstart,tend));
+    readers.push_back(new DigestReader(merge,sync,digestUsecs,0,tstart,tend));
+    DigestReader* mreader = readers.back();
+
+    for (unsigned int ii = 0; ii < readers.size(); ii++)
+        readers[ii]->start();
+
+    size_t nmerge = 0;
+    size_t ninput = 0;
+
+    sync.cond.lock();
+    for (;;) {
+        long long done = LLONG_MAX;
+        for (unsigned int ii = 0; ii < readers.size(); ii++)
+            done = std::min(done,readers[ii]->getDone());
+
+        // compare the intervals which all readers have completed
+        for (;;) {
+            long long iv = LLONG_MAX;
+            for (unsigned int ii = 0; ii < readers.size(); ii++) {
+                IntervalDigests& comp = readers[ii]->getCompleted();
+                if (!comp.empty()) iv = std::min(iv,comp.begin()->first);
+            }
+            if (iv >= done) break;
+
+            IdDigests idigests;
+            IdDigests mdigests;
+            for (unsigned int ii = 0; ii < readers.size(); ii++) {
+                IntervalDigests& comp = readers[ii]->getCompleted();
+                IntervalDigests::iterator ci = comp.find(iv);
+                if (ci == comp.end()) continue;
+                IdDigests& dst = (readers[ii] == mreader ? mdigests : idigests);
+                IdDigests::const_iterator di = ci->second.begin();
+                for ( ; di != ci->second.end(); ++di) dst[di->first] += di->second;
+                comp.erase(ci);
+            }
+            n_u::UTime t1(iv * digestUsecs);
+            n_u::UTime t2((iv + 1) * digestUsecs);
+
+            // step through the union of the ids of both sides
+            size_t nm = 0, ni = 0, nbadids = 0;
+            IdDigests::const_iterator mdi = mdigests.begin();
+            IdDigests::const_iterator idi = idigests.begin();
+            while (mdi != mdigests.end() || idi != idigests.end()) {
+                dsm_sample_id_t id;
+                SampleDigest md, ind;
+                if (idi == idigests.end() ||
+                    (mdi != mdigests.end() && mdi->first < idi->first)) {
+                    id = mdi->first;
+                    md = (mdi++)->second;
+                }
+                else if (mdi == mdigests.end() || idi->first < mdi->first) {
+                    id = idi->first;
+                    ind = (idi++)->second;
+                }
+                else {
+                    id = mdi->first;
+                    md = (mdi++)->second;
+                    ind = (idi++)->second;
+                }
+                nm += md.count;
+                ni += ind.count;
+                if (!(md == ind)) {
+                    cerr << "Mismatch, " <<
+                        t1.format(true,"%Y %m %d %H:%M:%S.%6f") << " - " <<
+                        t2.format(true,"%H:%M:%S.%6f") <<
+                        ", id=" << GET_DSM_ID(id) << ',' << GET_SHORT_ID(id) <<
+                        ", merge samps=" << md.count <<
+                        ", input samps=" << ind.count << endl;
+                    nbadids++;
+                }
+            }
+            cout << t1.format(true,"%Y %m %d %H:%M:%S.%6f") << " - " <<
+                t2.format(true,"%H:%M:%S.%6f") <<
+                ", merge samps=" << nm << ", input samps=" << ni <<
+                ", mismatched ids=" << nbadids << endl;
+            nmerge += nm;
+            ninput += ni;
+            nmismatch += nbadids;
+        }
+        sync.verified = done;
+        sync.cond.broadcast();
+        if (done == LLONG_MAX || interrupted) break;
+        sync.cond.wait();
+    }
+    sync.cond.unlock();
+
+    for (unsigned int ii = 0; ii < readers.size(); ii++) {
+        DigestReader* reader = readers[ii];
+        if (interrupted) {
+            reader->interrupt();
+            // wake a reader waiting for the verification
+            sync.cond.lock();
+            sync.cond.broadcast();
+            sync.cond.unlock();
+        }
+        try {
+            reader->join();
+        }
+        catch (const n_u::Exception& e) {
+            cerr << reader->getName() << ": " << e.what() << endl;
+        }
+        if (reader->getNumBackward() > 0)
+            cerr << reader->getName() << ": " << reader->getNumBackward() <<
+                " backward samples, not verified" << endl;
+        delete reader;
+    }
+    cout << "merge samps=" << nmerge << ", input samps=" << ninput <<
+        ", mismatched intervals and ids=" << nmismatch << endl;
+    return 0;
+}
+
 int MergeVerifier::run() throw()
 {
 
@@ -324,10 +740,15 @@ int MergeVerifier::run() throw()
 	    // SampleInputStream owns the iochan ptr.
 	    SampleInputStream* input = new SampleInputStream(fset);
             input->setMaxSampleLength(32768);
-            n_u::UTime filter1(startTime - USECS_PER_DAY);
-            n_u::UTime filter2(endTime + USECS_PER_DAY);
-            input->setMinSampleTime(filter1);
-            input->setMaxSampleTime(filter2);
+            // leave the filters at their defaults for an unset time
+            if (startTime.toUsecs() != LONG_LONG_MIN) {
+                n_u::UTime filter1(startTime - USECS_PER_DAY);
+                input->setMinSampleTime(filter1);
+            }
+            if (endTime.toUsecs() != LONG_LONG_MIN) {
+                n_u::UTime filter2(endTime + USECS_PER_DAY);
+                input->setMaxSampleTime(filter2);
+            }
 	    inputs.push_back(input);
 
 	    // input->init();
@@ -386,6 +807,20 @@ int MergeVerifier::run() throw()
             eof = true;
         }
 
+        if (digestUsecs > 0) {
+            int res = 0;
+            if (!eof) {
+                vector<SampleInputStream*> dinputs;
+                for (unsigned int ii = 0; ii < inputs.size(); ii++)
+                    if (!ieof[ii]) dinputs.push_back(inputs[ii]);
+                res = verifyDigests(dinputs,merge);
+            }
+            delete merge;
+            for (unsigned int ii = 0; ii < inputs.size(); ii++)
+                delete inputs[ii];
+            return res;
+        }
+
         Sample* msamp = 0;
         vector<Sample*> isamps(inputs.size(),0);
 	unsigned int neof = 0;
@@ -32,6 +32,8 @@
 #include <nidas/core/HeaderSource.h>
 #include <nidas/util/UTime.h>
 #include <nidas/util/EOFException.h>
+#include <nidas/util/ThreadPool.h>
+#include <nidas/util/auto_ptr.h>
 #include <nidas/core/NidasApp.h>
 
 #include <unistd.h>
@@ -48,6 +50,114 @@ using namespace std;
 
 namespace n_u = nidas::util;
 
+/**
+ * Reads the samples of an input up to a time, as a Task of a ThreadPool,
+ * so that the inputs are read and uncompressed in parallel. The samples
+ * are then sorted by the main thread, in the order of the inputs, so
+ * the result is the same as reading the inputs one after the other.
+ */
+class ReadAhead: public n_u::Task
+{
+public:
+    ReadAhead(SampleInputStream* input, NidasApp& app):
+        _input(input),_app(app),_samples(),_endTime(0),_lastTime(0),
+        _eof(false),_message(),_error(0)
+    {
+    }
+
+    ~ReadAhead()
+    {
+        for (unsigned int i = 0; i < _samples.size(); i++)
+            _samples[i]->freeReference();
+        delete _error;
+    }
+
+    /**
+     * Read samples until one at or after endTime.
+     */
+    void setEndTime(dsm_time_t endTime, dsm_time_t lastTime)
+    {
+        _endTime = endTime;
+        _lastTime = lastTime;
+    }
+
+    void execute() throw(n_u::Exception)
+    {
+        try {
+            while (!_app.interrupted() && _lastTime < _endTime) {
+                Sample* samp = _input->readSample();
+                _lastTime = samp->getTimeTag();
+                _samples.push_back(samp);
+            }
+        }
+        catch (const n_u::EOFException& e) {
+            _eof = true;
+            _message = e.what();
+        }
+        catch (const n_u::IOException& e) {
+            if (e.getErrno() == ENOENT) {
+                _eof = true;
+                _message = e.what();
+            }
+            else _error = new n_u::IOException(e);
+        }
+    }
+
+    vector<Sample*>& getSamples()
+    {
+        return _samples;
+    }
+
+    dsm_time_t getLastTime() const
+    {
+        return _lastTime;
+    }
+
+    /**
+     * Was the end of the input reached, or is a file missing.
+     */
+    bool isEOF() const
+    {
+        return _eof;
+    }
+
+    const string& getMessage() const
+    {
+        return _message;
+    }
+
+    /**
+     * IOException, other than a missing file, which stopped the read.
+     */
+    const n_u::IOException* getError() const
+    {
+        return _error;
+    }
+
+private:
+    SampleInputStream* _input;
+
+    NidasApp& _app;
+
+    vector<Sample*> _samples;
+
+    dsm_time_t _endTime;
+
+    dsm_time_t _lastTime;
+
+    bool _eof;
+
+    string _message;
+
+    n_u::IOException* _error;
+
+    /** No copying */
+    ReadAhead(const ReadAhead&);
+
+    /** No assignment */
+    ReadAhead& operator=(const ReadAhead&);
+};
+
 class NidsMerge: public HeaderSource
 {
 public:
@@ -97,6 +207,17 @@ private:
 
     list<unsigned int> allowed_dsms; /* DSMs to require.  If empty*/
 
+    /**
+     * Number of threads reading the inputs. If 1, they are read
+     * by the main thread.
+     */
+    unsigned int _nthreads;
+
+    /**
+     * Sample encoding of the output.
+     */
+    string _encoding;
+
     NidasApp _app;
 };
 
@@ -111,7 +232,8 @@ int NidsMerge::usage(const char* argv0)
     cerr << "Usage: " << argv0 << " [-x config] -i input ...  [-i input ... ] ..." << endl;
     cerr << "    [-s start_time] [-e end_time]" << endl;
     cerr << endl;
-    cerr << "    -o output [-l output_file_length] [-r read_ahead_secs]" << endl;
+    cerr << "    -o output [-l output_file_length] [-r read_ahead_secs] [-j threads]" << endl;
+    cerr << "    [-E encoding]" << endl;
     cerr << "    -c config: Legacy flag for -x." << endl;
     cerr << "    -x config: Update the configuration name in the output header. Legacy -c" << endl;
     cerr << "         example: -x $ISFF/projects/AHATS/ISFF/config/ahats.xml" << endl;
@@ -119,6 +241,11 @@ int NidsMerge::usage(const char* argv0)
     cerr << "         between start and end time, assume sample header is corrupt" << endl;
     cerr << "         and scan ahead for a good header. Use only on corrupt data files." << endl;
     cerr << "    -i input ...: one or more input file name or file name formats" << endl;
+    cerr << "    -j threads: number of threads reading the inputs in parallel," << endl;
+    cerr << "         default 1. Helps when uncompressing several .bz2 inputs." << endl;
+    cerr << "    -E encoding: sample encoding of the output, full (default) or compact." << endl;
+    cerr << "         compact replaces the 16 byte header of each sample with a few bytes," << endl;
+    cerr << "         which can be read by versions of NIDAS which support it." << endl;
     cerr << "    -d dsm ...: one or more DSM IDs to require input data tagged with. If this"  << endl;
     cerr << "         option is ommited (default), then any input data will be passed"  << endl;
     cerr << "         blindly to the output.  If any dsms are defined here, only input"  << endl;
@@ -161,8 +288,8 @@ NidsMerge::NidsMerge():
     inputFileNames(),outputFileName(),lastTimes(),
     readAheadUsecs(30*USECS_PER_SEC),startTime(LONG_LONG_MIN),
     endTime(LONG_LONG_MAX), outputFileLength(0),header(),
-    configName(),_filterTimes(false), allowed_dsms(),
-    _app("nidsmerge")
+    configName(),_filterTimes(false), allowed_dsms(),_nthreads(1),
+    _encoding(),_app("nidsmerge")
 {
 }
 
@@ -192,7 +319,7 @@ int NidsMerge::parseRunstring(int argc, char** argv) throw()
     NidasAppArgv left(argv[0], args);
     int opt_char;     /* option character */
 
-    while ((opt_char = getopt(left.argc, left.argv, "-c:x:fil:r:d:")) != -1) {
+    while ((opt_char = getopt(left.argc, left.argv, "-c:x:fij:l:r:d:E:")) != -1) {
     switch (opt_char) {
     case 'x':
     case 'c':
@@ -201,6 +328,11 @@ int NidsMerge::parseRunstring(int argc, char** argv) throw()
     case 'f':
         _filterTimes = true;
         break;
+    case 'E':
+        _encoding = optarg;
+        if (_encoding != "full" && _encoding != CompactHeaderEncoder::ENCODING)
+            return usage(argv[0]);
+        break;
     case 'i':
         {
         list<string> fileNames;
@@ -210,6 +342,10 @@ int NidsMerge::parseRunstring(int argc, char** argv) throw()
         inputFileNames.push_back(fileNames);
         }
         break;
+    case 'j':
+        _nthreads = atoi(optarg);
+        if (_nthreads < 1) return usage(argv[0]);
+        break;
     case 'l':
         outputFileLength = atoi(optarg);
         break;
@@ -305,6 +441,7 @@ int NidsMerge::run() throw()
 
         SampleOutputStream outStream(outSet);
         outStream.setHeaderSource(this);
+        outStream.setSampleEncoding(_encoding);
 
         vector<SampleInputStream*> inputs;
 
@@ -401,14 +538,64 @@ int NidsMerge::run() throw()
 
         unsigned int neof = 0;
 
+        n_u::auto_ptr<n_u::ThreadPool> pool;
+        vector<ReadAhead*> readers;
+        if (_nthreads > 1) {
+            pool.reset(new n_u::ThreadPool("nidsmerge",
+                std::min(_nthreads,(unsigned int)inputs.size())));
+            pool->start();
+            for (unsigned int ii = 0; ii < inputs.size(); ii++)
+                readers.push_back(new ReadAhead(inputs[ii],_app));
+        }
+
         dsm_time_t tcur;
         for (tcur = startTime.toUsecs(); neof < inputs.size() && tcur < endTime.toUsecs();
              tcur += readAheadUsecs) {
+
+            // Until startTime is known from the first sample, the inputs
+            // are read in order.
+            vector<bool> submitted(readers.size(),false);
+            if (pool.get() && startTime.toUsecs() != LONG_LONG_MIN) {
+                for (unsigned int ii = 0; ii < readers.size(); ii++) {
+                    if (lastTimes[ii] >= tcur + readAheadUsecs) continue;
+                    readers[ii]->setEndTime(tcur + readAheadUsecs,lastTimes[ii]);
+                    pool->submit(readers[ii],ii);
+                    submitted[ii] = true;
+                }
+            }
+
             for (unsigned int ii = 0; ii < inputs.size(); ii++) {
                 SampleInputStream* input = inputs[ii];
                 size_t nread = 0;
                 size_t nunique = 0;
 
+                if (pool.get() && startTime.toUsecs() != LONG_LONG_MIN) {
+                    if (submitted[ii]) {
+                        ReadAhead* reader = readers[ii];
+                        reader->wait();
+                        vector<Sample*>& samps = reader->getSamples();
+                        for (unsigned int i = 0; i < samps.size(); i++) {
+                            Sample* samp = samps[i];
+                            if (samp->getTimeTag() < startTime.toUsecs() ||
+                                !sorter.insert(samp).second)
+                                samp->freeReference();
+                            else nunique++;
+                        }
+                        nread = samps.size();
+                        samps.clear();
+                        lastTimes[ii] = reader->getLastTime();
+                        if (reader->getError()) throw *reader->getError();
+                        if (reader->isEOF()) {
+                            cerr << reader->getMessage() << endl;
+                            lastTimes[ii] = LONG_LONG_MAX;
+                            neof++;
+                        }
+                    }
+                    samplesRead[ii] = nread;
+                    samplesUnique[ii] = nunique;
+                    continue;
+                }
+
 #ifdef ADDITIONAL_TIME_FILTERS
                 /* this won't really work, since the next sample from input
                  * may legitimately be a day or more ahead as the result
@@ -512,6 +699,9 @@ int NidsMerge::run() throw()
         }
         outStream.flush();
         outStream.close();
+        if (pool.get()) pool->join();
+        for (unsigned int ii = 0; ii < readers.size(); ii++)
+            delete readers[ii];
         for (unsigned int ii = 0; ii < inputs.size(); ii++) {
             SampleInputStream* input = inputs[ii];
             delete input;
@@ -53,16 +53,51 @@
 //    
 #define _LARGEFILE64_SOURCE
 #include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <map>
 
-#define CHUNK SSIZE_MAX/512
+// SSIZE_MAX/512 on 32 bit systems. On 64 bit systems that
+// is far too large for a static buffer.
+#define CHUNK (4 * 1024 * 1024)
 
 using namespace std;
 
 char lineBuf[CHUNK];
 
+/*
+ * Copy the rest of the input file to the output with copy_file_range,
+ * in the kernel, without reading the data into user space.
+ * Return 1 if copied, 0 if copy_file_range is not supported
+ * for these files and nothing was copied, -1 on error.
+ */
+int copyRange(int ifPtr, int ofPtr)
+{
+#ifdef SYS_copy_file_range
+  bool copied = false;
+  for (;;) {
+    ssize_t n = syscall(SYS_copy_file_range, ifPtr, NULL, ofPtr, NULL,
+                        (size_t)CHUNK, 0);
+    if (n == 0) return 1;
+    if (n < 0) {
+      if (!copied && (errno == ENOSYS || errno == EXDEV ||
+                      errno == EINVAL || errno == EOPNOTSUPP))
+        return 0;
+      fprintf (stderr, "error while copying: %s\n", strerror(errno));
+      return -1;
+    }
+    copied = true;
+  }
+#else
+  return 0;
+#endif
+}
+
 int main(int argc, char** argv)
 {
   if (argc < 3) {
@@ -92,7 +127,7 @@ int main(int argc, char** argv)
     return -errno;
   }
 
-  char linePtr;
+  int  linePtr;
   int  nRead, nWrite;
 
   map<string,string> systemMap;
@@ -175,6 +210,8 @@ int main(int argc, char** argv)
 
 //printf("\ncopying raw data...\n");
 
+  if (copyRange(ifPtr, ofPtr) != 0) goto exit;
+
   do {
     nRead = read(ifPtr, lineBuf, CHUNK);
 
@@ -39,6 +39,7 @@
 #include <nidas/util/UTime.h>
 #include <nidas/util/EOFException.h>
 #include <nidas/util/auto_ptr.h>
+#include <nidas/util/EndianConverter.h>
 
 #include <csignal>
 #include <climits>
@@ -81,6 +82,20 @@ public:
      */
     void printHeader();
 
+    /**
+     * Should a sample with the given id be copied?
+     * @param newid Returns the id of the copy.
+     */
+    bool match(dsm_sample_id_t id, dsm_sample_id_t& newid);
+
+    /**
+     * Copy samples without decoding them: scan the sample headers
+     * in each block read from the input, patch ids in place,
+     * and write runs of matching samples to the output.
+     */
+    bool copyRaw(SampleInputStream& input, SampleOutputStream& outStream)
+        throw(n_u::IOException);
+
 private:
 
     static bool interrupted;
@@ -93,6 +108,8 @@ private:
 
     int outputFileLength;
 
+    bool rawCopy;
+
     SampleInputHeader header;
 
     set<dsm_sample_id_t> includeIds;
@@ -164,7 +181,7 @@ int SensorExtract::usage(const char* argv0)
 {
     cerr << "\
 Usage: " << argv0 << " [-s dsmids,sensorids[,newdsmid,newsensorid]] [-s ...]\n\
-	[-x dsmid,sensorid] [-x ...] [-l output_file_length] output input ... \n\n\
+	[-x dsmid,sensorid] [-x ...] [-l output_file_length] [-r] output input ... \n\n\
     -s dsmids,sensorids[,newdsmid,newsensorid]:\n\
             Copy samples with ids matching the specified ids.\n\
             dsmids: a non-negative dsm id, or range of ids separated by a dash\n\
@@ -181,6 +198,8 @@ Usage: " << argv0 << " [-s dsmids,sensorids[,newdsmid,newsensorid]] [-s ...]\n\
                 -1 for all sensors of a dsm. If sensorids is missing the default is -1.\n\
             More than one -x option can be specified\n\
     -l output_file_length: length of output files, in seconds\n\
+    -r: copy the samples as they are in the input, without decoding\n\
+        each sample. Much faster on large archives\n\
     output: output file name or file name format\n\
     input ...: one or more input file name or file name formats, or\n\
         sock:[hostname:port]  to connect to a socket on hostname, or\n\
@@ -212,7 +231,7 @@ int SensorExtract::main(int argc, char** argv) throw()
 
 SensorExtract::SensorExtract():
     inputFileNames(),sockAddr(),outputFileName(),
-    outputFileLength(0),header(),
+    outputFileLength(0),rawCopy(false),header(),
     includeIds(),includeDSMIds(),
     excludeIds(),excludeDSMIds(),
     newIds(),newDSMIds()
@@ -225,11 +244,14 @@ int SensorExtract::parseRunstring(int argc, char** argv) throw()
     extern int optind;       /* "  "     "     */
     int opt_char;     /* option character */
 
-    while ((opt_char = getopt(argc, argv, "l:s:x:")) != -1) {
+    while ((opt_char = getopt(argc, argv, "l:rs:x:")) != -1) {
 	switch (opt_char) {
 	case 'l':
 	    outputFileLength = atoi(optarg);
 	    break;
+	case 'r':
+	    rawCopy = true;
+	    break;
 	case 's':
             {
                 const char* cp1 = optarg;
@@ -448,6 +470,79 @@ void SensorExtract::printHeader()
     cerr << "ConfigVersion:" << header.getConfigVersion() << endl;
 }
 
+bool SensorExtract::match(dsm_sample_id_t id, dsm_sample_id_t& newid)
+{
+    if (!includeIds.empty() || !includeDSMIds.empty()) {
+        if (includeIds.find(id) != includeIds.end()) {
+            newid = newIds[id];
+            return true;
+        }
+        int dsm = GET_DSM_ID(id);
+        if (includeDSMIds.find(dsm) != includeDSMIds.end()) {
+            newid = SET_DSM_ID(id,newDSMIds[dsm]);
+            return true;
+        }
+        return false;
+    }
+    newid = id;
+    return excludeIds.find(id) == excludeIds.end() &&
+        excludeDSMIds.find(GET_DSM_ID(id)) == excludeDSMIds.end();
+}
+
+bool SensorExtract::copyRaw(SampleInputStream& input,
+        SampleOutputStream& outStream) throw(n_u::IOException)
+{
+    // sample headers are little-endian: time tag, length, id
+    const n_u::EndianConverter* cvt =
+        n_u::EndianConverter::getConverter(
+                n_u::EndianConverter::EC_LITTLE_ENDIAN);
+    const size_t hlen = SampleHeader::getSizeOf();
+    dsm_time_t screenTime = n_u::UTime(true,2001,1,1,0,0,0).toUsecs();
+
+    for (;;) {
+        size_t len;
+        char* bp = input.readRawBlock(len);
+        if (interrupted) break;
+        char* eb = bp + len;
+
+        // start of the current run of samples to be written
+        char* run = 0;
+        dsm_time_t tfirst = 0;
+        dsm_time_t tlast = 0;
+
+        for (char* cp = bp; cp < eb; ) {
+            dsm_time_t tt = cvt->int64Value(cp);
+            size_t slen = hlen + cvt->uint32Value(cp + 8);
+            dsm_sample_id_t rawid = cvt->uint32Value(cp + 12);
+            dsm_sample_id_t id = GET_FULL_ID(rawid);
+            dsm_sample_id_t newid;
+
+            bool copy = tt >= screenTime && match(id,newid);
+
+            // A sample past the end of the output file ends a run,
+            // so that the output starts a new file with it.
+            if (run && (!copy || tt >= outStream.getNextFileTime())) {
+                if (!outStream.receiveBlock(run,cp - run,tfirst,tlast))
+                    return false;
+                run = 0;
+            }
+            if (copy) {
+                if (newid != id)
+                    cvt->uint32Copy(SET_FULL_ID(rawid,newid),cp + 12);
+                if (!run) {
+                    run = cp;
+                    tfirst = tt;
+                }
+                tlast = tt;
+            }
+            cp += slen;
+        }
+        if (run && !outStream.receiveBlock(run,eb - run,tfirst,tlast))
+            return false;
+    }
+    return true;
+}
+
 int SensorExtract::run() throw()
 {
     bool outOK = true;
@@ -502,39 +597,24 @@ int SensorExtract::run() throw()
         // save header for later writing to output
         header = input.getInputHeader();
 
-        n_u::UTime screenTime(true,2001,1,1,0,0,0);
-
         try {
-            for (;;) {
+            if (rawCopy) outOK = copyRaw(input,outStream);
+            else {
+                n_u::UTime screenTime(true,2001,1,1,0,0,0);
+                for (;;) {
 
-                Sample* samp = input.readSample();
-                if (interrupted) break;
+                    Sample* samp = input.readSample();
+                    if (interrupted) break;
 
-                if (samp->getTimeTag() < screenTime.toUsecs()) continue;
+                    if (samp->getTimeTag() < screenTime.toUsecs()) continue;
 
-                dsm_sample_id_t id = samp->getId();
-
-		if (!includeIds.empty() || !includeDSMIds.empty()) {
-		    if (includeIds.find(id) != includeIds.end()) {
-			dsm_sample_id_t newid = newIds[id];
-			samp->setId(newid);
-			if (!(outOK = outStream.receive(samp))) break;
-		    }
-                    else if (includeDSMIds.find(GET_DSM_ID(id)) != includeDSMIds.end()) {
-                        int dsm = GET_DSM_ID(id);
-			int newdsm = newDSMIds[dsm];
-                        id = SET_DSM_ID(id,newdsm);
-			samp->setId(id);
-			if (!(outOK = outStream.receive(samp))) break;
-		    }
-                }
-		else {
-                    int dsmid = GET_DSM_ID(id);
-                    if (excludeIds.find(id) == excludeIds.end() &&
-                                excludeDSMIds.find(dsmid) == excludeDSMIds.end()) 
-			if (!(outOK = outStream.receive(samp))) break;
+                    dsm_sample_id_t newid;
+                    if (match(samp->getId(),newid)) {
+                        samp->setId(newid);
+                        if (!(outOK = outStream.receive(samp))) break;
+                    }
+                    samp->freeReference();
                 }
-                samp->freeReference();
             }
         }
         catch (n_u::EOFException& ioe) {
@@ -92,6 +92,8 @@ int main(int argc, char** argv)
     // These constructors register methods with the XMLRPC server
     GetClocks getclocks(xmlrpc_server, &lstn);
     GetStatus getstatus(xmlrpc_server, &lstn);
+    GetLatency getlatency(xmlrpc_server, &lstn);
+    GetSorter getsorter(xmlrpc_server, &lstn);
 
     // DEBUG - set verbosity of the xmlrpc server HIGH...
     //   XmlRpc::setVerbosity(5);
@@ -69,7 +69,7 @@ bool AdaptiveDespiker::staticInit()
 AdaptiveDespiker::AdaptiveDespiker():
 	_prob(1.e-5),_levelMultiplier(2.5),_maxMissingFreq(2.0),
     _u1(0.0), _mean1(0.0), _mean2(0.0), _var1(0.0), _var2(0.0), _corr(0.0),
-    _initLevel(0.0), _level(0.0), _missfreq(0.0), _msize(0), _npts(0)
+    _sqrtVar12(0.0), _initLevel(0.0), _level(0.0), _missfreq(0.0), _msize(0), _npts(0)
 {
     setDiscLevelMultiplier(2.5);
     setOutlierProbability(1.e-5);
@@ -278,7 +278,8 @@ void AdaptiveDespiker::incrementStatistics(float u)
 	if (_var1 < 0) _var1 = 0.;
 	if (_var2 < 0) _var2 = 0.;
 
-	_corr = (_corr / _npts - _mean2 * _mean1) / sqrt(_var1 * _var2);
+	_sqrtVar12 = sqrt(_var1 * _var2);
+	_corr = (_corr / _npts - _mean2 * _mean1) / _sqrtVar12;
 
 	if ( _corr >  0.99) _corr =  0.99;
 	else if ( _corr < -0.99) _corr = -0.99;
@@ -300,7 +301,7 @@ void AdaptiveDespiker::updateStatistics(float u)
     _missfreq *= 0.9;
 
     /* Convert correlation back to un-normalized covariance */
-    _corr *= sqrt(_var1 * _var2);
+    _corr *= _sqrtVar12;
 
     double mx = (_msize - 1.) / _msize;
     _mean1 = _mean2;
@@ -310,7 +311,8 @@ void AdaptiveDespiker::updateStatistics(float u)
     _var2 = _var2 * mx + (u - _mean2) * (u - _mean2) / _msize;
     if (_var2 < 0.) _var2 = 0.;
     double v1v2 = _var1*_var2;
-    _corr = (v1v2 == 0.0) ? 1.0 : _corr/sqrt(v1v2);
+    _sqrtVar12 = sqrt(v1v2);
+    _corr = (v1v2 == 0.0) ? 1.0 : _corr/_sqrtVar12;
 
     /*
      * Due to the running means approximation:
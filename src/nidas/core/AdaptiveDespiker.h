@@ -170,6 +170,13 @@ private:
     /** Correlation */
     double _corr;
 
+    /**
+     * sqrt(_var1 * _var2), saved from the normalization of _corr,
+     * for converting it back to a covariance in the next
+     * updateStatistics(), without another sqrt.
+     */
+    double _sqrtVar12;
+
     /** Discrimination level */
     double _initLevel;
 
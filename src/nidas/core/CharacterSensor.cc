@@ -357,12 +357,20 @@ scanSample(AsciiSscanf* sscanf, const char* inputstr, float* data_ptr)
 
 bool CharacterSensor::process(const Sample* samp,list<const Sample*>& results)
 	throw()
+{
+    SampleT<float>* outs = parseSample(samp);
+    if (!outs) return false;
+    results.push_back(outs);
+    return true;
+}
+
+SampleT<float>* CharacterSensor::parseSample(const Sample* samp) throw()
 {
     // Note: sscanfers can be empty here, if a CharacterSensor was configured
     // with no samples, and hence no scanf strings.  For example,
     // a differential GPS, where nidas is supposed to take the
     // data for later use, but doesn't (currently) parse it.
-    if (_sscanfers.empty()) return false;
+    if (_sscanfers.empty()) return 0;
 
     assert(samp->getType() == CHAR_ST);
 
@@ -378,9 +386,9 @@ bool CharacterSensor::process(const Sample* samp,list<const Sample*>& results)
         ::memcpy(newstr,inputstr,slen);
         newstr[slen] = '\0';
 
-        bool res =  CharacterSensor::process(newsamp,results);
+        SampleT<float>* outs = parseSample(newsamp);
         newsamp->freeReference();
-        return res;
+        return outs;
     }
 
     SampleT<float>* outs = getSample<float>(_maxScanfFields);
@@ -424,7 +432,7 @@ bool CharacterSensor::process(const Sample* samp,list<const Sample*>& results)
     if (!nparsed) {
         _scanfFailures++;
         outs->freeReference();  // remember!
-        return false;           // no sample
+        return 0;               // no sample
     }
 
     // If requested, reduce latency jitter in the time tags.
@@ -440,7 +448,6 @@ bool CharacterSensor::process(const Sample* samp,list<const Sample*>& results)
     trimUnparsed(stag, outs, nparsed);
     applyConversions(stag, outs);
 
-    results.push_back(outs);
-    return true;
+    return outs;
 }
 
@@ -282,6 +282,16 @@ protected:
     virtual int scanSample(AsciiSscanf* sscanf, const char* inputstr, 
 			   float* data_ptr);
 
+    /**
+     * Do the work of CharacterSensor::process(): sscanf the character
+     * string contents of a raw sample into a new floating point sample,
+     * with time tag adjustments and variable conversions applied.
+     * @return The new sample, or NULL if the string could not be parsed.
+     * Sensors which override DSMSensor::processInto() can call this
+     * rather than CharacterSensor::process(), to avoid the result list.
+     */
+    SampleT<float>* parseSample(const Sample* samp) throw();
+
     std::map<const SampleTag*, TimetagAdjuster*> _ttadjusters;
 
 private:
@@ -0,0 +1,186 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#include "CompactSampleHeader.h"
+
+using namespace nidas::core;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+const char* const CompactHeaderEncoder::ENCODING = "compact";
+
+namespace {
+
+    inline char* putVarint(char* cp, unsigned long long val)
+    {
+        while (val >= 0x80) {
+            *cp++ = (char)(val | 0x80);
+            val >>= 7;
+        }
+        *cp++ = (char)val;
+        return cp;
+    }
+
+    /**
+     * Get a varint of at most maxlen bytes.
+     * @return false if the buffer ends first.
+     */
+    inline bool getVarint(const char*& cp, const char* eb, unsigned int maxlen,
+        unsigned long long& val) throw(n_u::ParseException)
+    {
+        val = 0;
+        for (unsigned int i = 0; i < maxlen; i++) {
+            if (cp == eb) return false;
+            unsigned char c = *cp++;
+            val |= (unsigned long long)(c & 0x7f) << (7 * i);
+            if (!(c & 0x80)) return true;
+        }
+        throw n_u::ParseException("compact sample header: varint too long");
+    }
+
+    inline unsigned long long zigzag(dsm_time_t tt, dsm_time_t base)
+    {
+        unsigned long long d = (unsigned long long)tt - (unsigned long long)base;
+        return (d << 1) ^ (unsigned long long)((long long)d >> 63);
+    }
+
+    /*
+     * Return 0, for a header which is not complete in len bytes,
+     * unless len is the maximum length of a header. The varints
+     * are not checked for the shortest encoding, so a corrupt
+     * header can be longer, and a caller assembling a header in a
+     * buffer of MAX_LENGTH must not be asked for more.
+     */
+    inline size_t incomplete(size_t len) throw(n_u::ParseException)
+    {
+        if (len >= CompactHeaderEncoder::MAX_LENGTH)
+            throw n_u::ParseException("compact sample header: too long");
+        return 0;
+    }
+
+    inline dsm_time_t unzigzag(unsigned long long z, dsm_time_t base)
+    {
+        unsigned long long d = (z >> 1) ^ (0ULL - (z & 1));
+        return (dsm_time_t)((unsigned long long)base + d);
+    }
+}
+
+CompactHeaderEncoder::CompactHeaderEncoder():
+    _codes(),_entries(),_code(0),_rawId(0),_tt(0)
+{
+}
+
+void CompactHeaderEncoder::reset()
+{
+    _codes.clear();
+    _entries.clear();
+}
+
+size_t CompactHeaderEncoder::encode(dsm_time_t tt, dsm_sample_id_t rawId,
+    unsigned int len, char* buf)
+{
+    _code = 0;
+    _rawId = rawId;
+    _tt = tt;
+
+    SampleIdMap<unsigned int>::const_iterator ci = _codes.find(GET_FULL_ID(rawId));
+    // A sample of an id whose type has changed is sent with its id.
+    if (ci != _codes.end() && _entries[ci->second].rawId == rawId)
+        _code = ci->second + 1;
+
+    char* cp = putVarint(buf,_code);
+    if (_code) cp = putVarint(cp,zigzag(tt,_entries[_code-1].lastTime));
+    else {
+        cp = putVarint(cp,rawId);
+        cp = putVarint(cp,zigzag(tt,0));
+    }
+    cp = putVarint(cp,len);
+    return cp - buf;
+}
+
+void CompactHeaderEncoder::accept()
+{
+    if (_code) _entries[_code-1].lastTime = _tt;
+    else if (_entries.size() < MAX_IDS) {
+        _codes[GET_FULL_ID(_rawId)] = _entries.size();
+        _entries.push_back(Entry(_rawId,_tt));
+    }
+}
+
+CompactHeaderDecoder::CompactHeaderDecoder():
+    _entries(),_code(0),_rawId(0),_tt(0)
+{
+}
+
+void CompactHeaderDecoder::reset()
+{
+    _entries.clear();
+}
+
+size_t CompactHeaderDecoder::decode(const char* buf, size_t len,
+    SampleHeader& header) throw(n_u::ParseException)
+{
+    const char* cp = buf;
+    const char* eb = buf + len;
+    unsigned long long val;
+
+    if (!getVarint(cp,eb,3,val)) return incomplete(len);
+    if (val > _entries.size())
+        throw n_u::ParseException("compact sample header: unknown id code");
+    _code = val;
+
+    dsm_time_t base = 0;
+    if (_code) {
+        _rawId = _entries[_code-1].rawId;
+        base = _entries[_code-1].lastTime;
+    }
+    else {
+        if (!getVarint(cp,eb,5,val)) return incomplete(len);
+        if (val > 0xffffffffULL)
+            throw n_u::ParseException("compact sample header: bad id");
+        _rawId = val;
+    }
+
+    if (!getVarint(cp,eb,10,val)) return incomplete(len);
+    _tt = unzigzag(val,base);
+
+    if (!getVarint(cp,eb,5,val)) return incomplete(len);
+    if (val > SampleHeader::getMaxDataLength())
+        throw n_u::ParseException("compact sample header: bad length");
+
+    header.setTimeTag(_tt);
+    header.setRawId(_rawId);
+    header.setDataByteLength(val);
+    return cp - buf;
+}
+
+void CompactHeaderDecoder::accept()
+{
+    if (_code) _entries[_code-1].lastTime = _tt;
+    else if (_entries.size() < CompactHeaderEncoder::MAX_IDS)
+        _entries.push_back(Entry(_rawId,_tt));
+}
@@ -0,0 +1,183 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#ifndef NIDAS_CORE_COMPACTSAMPLEHEADER_H
+#define NIDAS_CORE_COMPACTSAMPLEHEADER_H
+
+#include "Sample.h"
+#include "SampleIdMap.h"
+#include <nidas/util/ParseException.h>
+
+#include <vector>
+
+namespace nidas { namespace core {
+
+/**
+ * Encoder of the compact sample headers of a stream or archive whose
+ * SampleInputHeader has a "sample encoding: compact" field. The
+ * compact header replaces the 16 byte SampleHeader in front of the
+ * data of each sample. It is a sequence of unsigned LEB128 varints:
+ *
+ *   code            0 for an id which follows, or n for the id of
+ *                   entry n-1 in the dictionary of ids.
+ *   id              only if code is 0: the raw id, with the type.
+ *                   It is added to the dictionary, if there is room.
+ *   time delta      zig-zag encoded difference of the time tag from
+ *                   that of the previous sample of the id, or from 0
+ *                   if the code is 0.
+ *   length          byte length of the data.
+ *
+ * A few bytes for the header of a sample in a sorted archive,
+ * rather than 16. The dictionary and times are started over for
+ * each file or connection, after its SampleInputHeader, so that
+ * each can be read on its own. A stream can't be resynchronized
+ * after a corrupt byte though, as one with full SampleHeaders
+ * can, and its samples must be decoded in order.
+ */
+class CompactHeaderEncoder
+{
+public:
+
+    /**
+     * Value of the sample encoding in a SampleInputHeader.
+     */
+    static const char* const ENCODING;
+
+    enum {
+        /**
+         * Maximum length in bytes of an encoded header.
+         */
+        MAX_LENGTH = 21,
+
+        /**
+         * Maximum number of ids in the dictionary.
+         */
+        MAX_IDS = 65535
+    };
+
+    CompactHeaderEncoder();
+
+    /**
+     * Start over, at the beginning of a file or connection.
+     */
+    void reset();
+
+    /**
+     * Encode the header of a sample into buf, which must have
+     * room for MAX_LENGTH bytes. The state is not changed until
+     * accept(), so that a sample which is not written, because
+     * of a jammed output, can be left out.
+     * @return Length of the encoded header.
+     */
+    size_t encode(dsm_time_t tt, dsm_sample_id_t rawId, unsigned int len,
+        char* buf);
+
+    /**
+     * Update the state with the sample of the last encode(),
+     * after it has been written.
+     */
+    void accept();
+
+private:
+
+    struct Entry
+    {
+        Entry(dsm_sample_id_t id, dsm_time_t tt): rawId(id),lastTime(tt) {}
+
+        dsm_sample_id_t rawId;
+
+        dsm_time_t lastTime;
+    };
+
+    /**
+     * Index of each id in _entries.
+     */
+    SampleIdMap<unsigned int> _codes;
+
+    std::vector<Entry> _entries;
+
+    unsigned int _code;
+
+    dsm_sample_id_t _rawId;
+
+    dsm_time_t _tt;
+};
+
+/**
+ * Decoder of the compact sample headers written by CompactHeaderEncoder.
+ */
+class CompactHeaderDecoder
+{
+public:
+
+    CompactHeaderDecoder();
+
+    /**
+     * Start over, after the SampleInputHeader of a file or connection.
+     */
+    void reset();
+
+    /**
+     * Decode a compact header from the beginning of buf. As with
+     * the encoder, the state is not changed until accept(), so that
+     * a caller can decode the header again when it has more data.
+     * @return Length of the header, or 0 if it is not complete in
+     *      the len bytes of buf.
+     * @throw ParseException if the header is corrupt, including one
+     *      which is not complete in CompactHeaderEncoder::MAX_LENGTH
+     *      bytes.
+     */
+    size_t decode(const char* buf, size_t len, SampleHeader& header)
+        throw(nidas::util::ParseException);
+
+    /**
+     * Update the state with the header of the last decode().
+     */
+    void accept();
+
+private:
+
+    struct Entry
+    {
+        Entry(dsm_sample_id_t id, dsm_time_t tt): rawId(id),lastTime(tt) {}
+
+        dsm_sample_id_t rawId;
+
+        dsm_time_t lastTime;
+    };
+
+    std::vector<Entry> _entries;
+
+    unsigned int _code;
+
+    dsm_sample_id_t _rawId;
+
+    dsm_time_t _tt;
+};
+
+}}	// namespace nidas namespace core
+
+#endif
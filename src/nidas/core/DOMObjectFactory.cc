@@ -26,10 +26,12 @@
 
 
 #include <nidas/util/Logger.h>
+#include <nidas/util/ThreadSupport.h>
 #include "DOMObjectFactory.h"
 #include "DynamicLoader.h"
 
 #include <vector>
+#include <list>
 #include <sstream>
 
 using std::vector;
@@ -54,6 +56,88 @@ string replace_util(const string& str,const string& s1, const string& s2) {
 	    res.replace(bi,s1.length(),s2);
     return res;
 }
+
+/*
+ * Hash table of the creator functions registered by the
+ * NIDAS_CREATOR_FUNCTION macros, keyed by the function name.
+ */
+class CreatorTable
+{
+public:
+    typedef DOMObjectFactory::dom_object_ctor_t ctor_t;
+
+    CreatorTable(): _buckets(NBUCKETS),_size(0),_mutex() {}
+
+    void add(const char* name, ctor_t* ctor)
+    {
+        n_u::Synchronized autosync(_mutex);
+        bucket_t& bucket = _buckets[hash(name)];
+        for (bucket_t::iterator bi = bucket.begin(); bi != bucket.end(); ++bi)
+            if (bi->first == name) return;
+        bucket.push_back(make_pair(string(name),ctor));
+        _size++;
+    }
+
+    ctor_t* find(const string& name)
+    {
+        n_u::Synchronized autosync(_mutex);
+        bucket_t& bucket = _buckets[hash(name.c_str())];
+        for (bucket_t::iterator bi = bucket.begin(); bi != bucket.end(); ++bi)
+            if (bi->first == name) return bi->second;
+        return 0;
+    }
+
+    unsigned int size()
+    {
+        n_u::Synchronized autosync(_mutex);
+        return _size;
+    }
+
+private:
+    typedef list<pair<string,ctor_t*> > bucket_t;
+
+    // FNV-1a
+    static unsigned int hash(const char* name)
+    {
+        unsigned int h = 2166136261u;
+        for ( ; *name; name++) h = (h ^ (unsigned char)*name) * 16777619u;
+        return h % NBUCKETS;
+    }
+
+    static const unsigned int NBUCKETS = 512;
+
+    vector<bucket_t> _buckets;
+
+    unsigned int _size;
+
+    n_u::Mutex _mutex;
+};
+
+/*
+ * The table is created on first use, since the macros register
+ * their functions during static initialization, possibly before
+ * the statics of this file are constructed.
+ */
+CreatorTable& creatorTable()
+{
+    static CreatorTable table;
+    return table;
+}
+}
+
+bool
+DOMObjectFactory::
+registerCreator(const char* entryname, dom_object_ctor_t* ctor)
+{
+    creatorTable().add(entryname,ctor);
+    return true;
+}
+
+unsigned int
+DOMObjectFactory::
+getNumRegistered()
+{
+    return creatorTable().size();
 }
 
 DOMable* 
@@ -70,9 +154,19 @@ createObject(const string& classname) throw(n_u::Exception)
     qclassname = replace_util(qclassname,"::","_");
     string entryname = "create_" + qclassname;
 
+    // Creator functions linked into the program, or in libraries that
+    // have already been loaded.
+    ctor = creatorTable().find(entryname);
+    if (ctor) {
+        VLOG(("creating registered: %s", classname.c_str()));
+        return ctor();
+    }
+
     ostringstream errors;
 
-    // Look for symbol in program, and currently loaded libraries.
+    // Look for symbol in program, and currently loaded libraries,
+    // which were not registered, for example if they were not
+    // built with the current NIDAS_CREATOR_FUNCTION macros.
     try {
         DLOG(("looking for %s in program", entryname.c_str()));
         ctor = (dom_object_ctor_t*) 
@@ -98,6 +98,11 @@ public:
      * The extern "C" function can be either statically linked in the
      * program, or in a shareable library.  createObject() attempts to 
      * resolve the extern "C" function symbol via the following search:
+     * -# Look up the creator function in the table of functions added
+     *    by registerCreator(). The NIDAS_CREATOR_FUNCTION macros register
+     *    their functions when the program or library containing them is
+     *    loaded, so the classes in libnidas_dynld, and in any plugin
+     *    library already opened, are found here without a symbol search.
      * -# Lookup the symbol within the program and the currently loaded
      *    dynamic libraries, by calling
      *    DynamicLoader::lookup(const std::string& name).
@@ -127,6 +132,25 @@ public:
      */
     typedef DOMable* dom_object_ctor_t();
 
+    /**
+     * Add a creator function to the table searched by createObject().
+     * Called during static initialization by the NIDAS_CREATOR_FUNCTION
+     * macros, so that createObject() does not need a dlsym() for the
+     * classes that are linked into the program. The functions are never
+     * removed: DynamicLoader opens libraries with RTLD_NODELETE, so that
+     * a library is not unmapped while its functions are in the table.
+     * @param entryname Name of the extern "C" creator function,
+     *      such as @c create_nidas_dynld_isff_CSAT3_Sonic.
+     * @return true, so that the result can initialize a static variable.
+     */
+    static bool registerCreator(const char* entryname,
+        dom_object_ctor_t* ctor);
+
+    /**
+     * Number of creator functions added by registerCreator().
+     */
+    static unsigned int getNumRegistered();
+
     /**
      * When searching for libraries based on the class name,
      * add this suffix to the name. Typically something like ".so.1".
@@ -133,6 +133,10 @@ private:
  * nidas::dynld::MyClass* classobj =
  *   	dynamic_cast<nidas::dynld::MyClass*>(newobj);
  *
+ * The macro also registers the function with
+ * DOMObjectFactory::registerCreator() when the program or library
+ * is loaded.
+ *
  * DOMObjectFactory::createObject does the name mangling by
  * prepending "create_nidas_dynld_" to the string argument,
  * converting all "::" to '_' in the class name string
@@ -154,6 +158,11 @@ extern "C" {\
     {\
 	return new nidas::dynld::CLASSNAME();\
     }\
+}\
+namespace {\
+    bool nidas_dynld_##CLASSNAME##_registered =\
+        nidas::core::DOMObjectFactory::registerCreator(\
+            "create_nidas_dynld_" #CLASSNAME,create_nidas_dynld_##CLASSNAME);\
 }
 
 /**
@@ -168,6 +177,12 @@ extern "C" {\
     {\
 	return new nidas::dynld::NS::CLASSNAME();\
     }\
+}\
+namespace {\
+    bool nidas_dynld_##NS##_##CLASSNAME##_registered =\
+        nidas::core::DOMObjectFactory::registerCreator(\
+            "create_nidas_dynld_" #NS "_" #CLASSNAME,\
+            create_nidas_dynld_##NS##_##CLASSNAME);\
 }
 
 #endif
@@ -51,10 +51,14 @@ DSMConfig::DSMConfig():
     _remoteSerialSocketPort(0),
     _rawSorterLength(0.0), _procSorterLength(0.0),
     _rawHeapMax(5000000), _procHeapMax(5000000),
+    _rawSorterLengthMin(0.0), _rawSorterLengthMax(0.0),
+    _procSorterLengthMin(0.0), _procSorterLengthMax(0.0),
+    _rawHeapMin(1000000), _procHeapMin(1000000),
     _rawLateSampleCacheSize(0), _procLateSampleCacheSize(0),
     _derivedDataSocketAddr(new n_u::Inet4SocketAddress()),
     _processors(),
-    _statusSocketAddr(new n_u::Inet4SocketAddress())
+    _statusSocketAddr(new n_u::Inet4SocketAddress()),
+    _realTimeProfile()
 {
 }
 
@@ -316,7 +320,25 @@ void DSMConfig::fromDOMElement(const xercesc::DOMElement* node)
                 if (aname[0] == 'r') setRawSorterLength(val);
                 else setProcSorterLength(val);
 	    }
-            else if (aname == "rawHeapMax" || aname == "procHeapMax") {
+            else if (aname == "rawSorterLengthMin" || aname == "rawSorterLengthMax" ||
+                aname == "procSorterLengthMin" || aname == "procSorterLengthMax") {
+		float val;
+		istringstream ist(aval);
+		ist >> val;
+		if (ist.fail() || val < 0.0) throw n_u::InvalidParameterException(
+		    string("dsm") + ": " + getName(), aname,aval);
+                bool isMax = aname.substr(aname.length()-3) == "Max";
+                if (aname[0] == 'r') {
+                    if (isMax) setRawSorterLengthBounds(getRawSorterLengthMin(),val);
+                    else setRawSorterLengthBounds(val,getRawSorterLengthMax());
+                }
+                else {
+                    if (isMax) setProcSorterLengthBounds(getProcSorterLengthMin(),val);
+                    else setProcSorterLengthBounds(val,getProcSorterLengthMax());
+                }
+	    }
+            else if (aname == "rawHeapMax" || aname == "procHeapMax" ||
+                aname == "rawHeapMin" || aname == "procHeapMin") {
 		int val;
 		istringstream ist(aval);
 		ist >> val;
@@ -330,8 +352,15 @@ void DSMConfig::fromDOMElement(const xercesc::DOMElement* node)
                     else if (smult[0] == 'M') mult = 1000000;
                     else if (smult[0] == 'G') mult = 1000000000;
                 }
-                if (aname[0] == 'r') setRawHeapMax((size_t)val*mult);
-                else setProcHeapMax((size_t)val*mult);
+                bool isMax = aname.substr(aname.length()-3) == "Max";
+                if (aname[0] == 'r') {
+                    if (isMax) setRawHeapMax((size_t)val*mult);
+                    else setRawHeapMin((size_t)val*mult);
+                }
+                else {
+                    if (isMax) setProcHeapMax((size_t)val*mult);
+                    else setProcHeapMin((size_t)val*mult);
+                }
 	    }
             else if (aname == "rawLateSampleCacheSize" || aname == "procLateSampleCacheSize") {
 		unsigned int val;
@@ -365,6 +394,11 @@ void DSMConfig::fromDOMElement(const xercesc::DOMElement* node)
             elname == "lamsSensor" ||   // obsolete, no longer in nidas schema
             elname == "socketSensor") { // obsolete, no longer in nidas schema
 
+            // Skip sensors whose samples are not wanted.
+            if (!project->selectSensor(getId(),(xercesc::DOMElement*)child,
+                    getSensors()))
+                continue;
+
             if (elname == "irigSensor") WLOG(("%s: <irigSensor> element is obsolete. Use a <sensor> element instead",getName().c_str()));
             else if (elname == "lamsSensor") WLOG(("%s: <lamsSensor> element is obsolete. Use a <sensor> element instead",getName().c_str()));
             else if (elname == "socketSensor") WLOG(("%s: <socketSensor> element is obsolete. Use a <sensor> element instead",getName().c_str()));
@@ -436,6 +470,9 @@ void DSMConfig::fromDOMElement(const xercesc::DOMElement* node)
             processor->fromDOMElement((xercesc::DOMElement*)child);
 	    addProcessor(processor);
         }
+        else if (elname == "realtime") {
+            _realTimeProfile.fromDOMElement((xercesc::DOMElement*)child);
+        }
 	else throw n_u::InvalidParameterException(
 		string("dsm") + ": " + getName(),
 		    "unrecognized element",elname);
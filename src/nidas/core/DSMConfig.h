@@ -31,6 +31,7 @@
 #include "DOMable.h"
 #include "NidsIterators.h"
 #include "Dictionary.h"
+#include "RealTimeProfile.h"
 
 #include <nidas/util/SocketAddress.h>
 #include <nidas/util/IOException.h>
@@ -174,6 +175,53 @@ public:
         _procHeapMax = val;
     }
 
+    /**
+     * Set the bounds of the length of the raw SampleSorter, in seconds.
+     * If maxSecs is greater than zero the sorter adapts its length,
+     * starting at getRawSorterLength(), and its heap size limit,
+     * between getRawHeapMin() and getRawHeapMax(), to the data.
+     * See SamplePipeline::setRawSorterLengthBounds().
+     */
+    void setRawSorterLengthBounds(float minSecs, float maxSecs)
+    {
+        _rawSorterLengthMin = minSecs;
+        _rawSorterLengthMax = maxSecs;
+    }
+
+    float getRawSorterLengthMin() const { return _rawSorterLengthMin; }
+
+    float getRawSorterLengthMax() const { return _rawSorterLengthMax; }
+
+    /**
+     * Set the bounds of the length of the processed SampleSorter,
+     * in seconds. See setRawSorterLengthBounds().
+     */
+    void setProcSorterLengthBounds(float minSecs, float maxSecs)
+    {
+        _procSorterLengthMin = minSecs;
+        _procSorterLengthMax = maxSecs;
+    }
+
+    float getProcSorterLengthMin() const { return _procSorterLengthMin; }
+
+    float getProcSorterLengthMax() const { return _procSorterLengthMax; }
+
+    /**
+     * Lower bound of the heap size limit of an adaptive raw sorter,
+     * in bytes.
+     */
+    void setRawHeapMin(size_t val) { _rawHeapMin = val; }
+
+    size_t getRawHeapMin() const { return _rawHeapMin; }
+
+    /**
+     * Lower bound of the heap size limit of an adaptive processed sorter,
+     * in bytes.
+     */
+    void setProcHeapMin(size_t val) { _procHeapMin = val; }
+
+    size_t getProcHeapMin() const { return _procHeapMin; }
+
     /**
      * Get the size of the late sample cache in the raw sample sorter.
      * See SampleSorter::getLateSampleCacheSize(). Default: 0.
@@ -212,6 +260,16 @@ public:
         _procLateSampleCacheSize = val;
     }
 
+    /**
+     * Real-time settings from the \<realtime\> element of this dsm.
+     * Only the values set by the element are copied by
+     * RealTimeProfile::update().
+     */
+    const RealTimeProfile& getRealTimeProfile() const
+    {
+        return _realTimeProfile;
+    }
+
     /**
      * Parse a DOMElement for a DSMSensor, returning a pointer to
      * the DSMSensor. The pointer may be for a new instance of a DSMSensor,
@@ -367,6 +425,18 @@ private:
 
     size_t _procHeapMax;
 
+    float _rawSorterLengthMin;
+
+    float _rawSorterLengthMax;
+
+    float _procSorterLengthMin;
+
+    float _procSorterLengthMax;
+
+    size_t _rawHeapMin;
+
+    size_t _procHeapMin;
+
     unsigned int _rawLateSampleCacheSize;
 
     unsigned int _procLateSampleCacheSize;
@@ -377,6 +447,8 @@ private:
 
     nidas::util::SocketAddress* _statusSocketAddr;
 
+    RealTimeProfile _realTimeProfile;
+
 private:
     // no copying
     DSMConfig(const DSMConfig& x);
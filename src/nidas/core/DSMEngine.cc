@@ -47,11 +47,14 @@
 #include "SampleIOProcessor.h"
 #include "NidsIterators.h"
 #include "SampleOutputRequestThread.h"
+#include "RealTimeProfile.h"
+#include "SampleBus.h"
 #include <nidas/util/Process.h>
 #include <nidas/util/FileSet.h>
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <limits>
 #include <sys/resource.h>
 #include <sys/mman.h>
@@ -83,7 +86,7 @@ DSMEngine::DSMEngine():
     _statusThread(0),_xmlrpcThread(0),
     _outputSet(),_outputMutex(),
     _logLevel(defaultLogLevel),_signalMask(),_myThreadId(::pthread_self()),
-    _app("dsm")
+    _app("dsm"),_realTimeSpec(),_sampleBusSpec()
 {
     try {
 	_configSockAddr = n_u::Inet4SocketAddress(
@@ -104,6 +107,8 @@ DSMEngine::~DSMEngine()
     delete _project;
     _project = 0;
     SamplePools::deleteInstance();
+    RealTimeProfile::deleteInstance();
+    SampleBusWriter::deleteInstance();
 }
 
 namespace {
@@ -194,9 +199,28 @@ int DSMEngine::parseRunstring(int argc, char** argv) throw()
         ("-r,--remote", "",
          "Start XML RPC thread to enable to remote commands.");
 
+    NidasAppArg RealTime
+        ("--realtime", "spec",
+         "Real-time profile, overriding the <realtime> element of the dsm.\n"
+         "Settings separated by semicolons:\n"
+         "  role=priority@cpus  role is sensors, rawsorter, procsorter,\n"
+         "                      looper or status, priority is RT_FIFO:n,\n"
+         "                      RT_RR:n or NONRT, cpus is a list like 0-1,3.\n"
+         "                      Either priority or @cpus may be omitted.\n"
+         "  prefault=MB         prefault MB of heap and sample pool memory\n"
+         "  lock                mlockall() the process memory\n"
+         "Example: \"sensors=RT_FIFO:60@1;rawsorter=@1;prefault=16;lock\"");
+
+    NidasAppArg SampleBus
+        ("--samplebus", "name[:MB]",
+         "Publish the raw samples to a shared memory sample bus of MB\n"
+         "megabytes, default 16, which local programs can read as\n"
+         "input shm:name, without a socket to this process.");
+
     _app.enableArguments(_app.loggingArgs() | _app.Version | _app.Help |
                          _app.Username | _app.Hostname |
-                         _app.DebugDaemon | ExternalControl);
+                         _app.DebugDaemon | ExternalControl | RealTime |
+                         SampleBus);
 
     ArgVector args = _app.parseArgs(argc, argv);
     if (_app.helpRequested())
@@ -205,6 +229,35 @@ int DSMEngine::parseRunstring(int argc, char** argv) throw()
         return 1;
     }
     _externalControl = ExternalControl.asBool();
+
+    if (RealTime.specified())
+    {
+        _realTimeSpec = RealTime.getValue();
+        try {
+            RealTimeProfile check;
+            check.parse(_realTimeSpec);
+        }
+        catch (const n_u::InvalidParameterException& e) {
+            cerr << e.what() << endl;
+            usage();
+            return 1;
+        }
+    }
+
+    if (SampleBus.specified())
+    {
+        _sampleBusSpec = SampleBus.getValue();
+        try {
+            string name;
+            unsigned int mbytes;
+            SampleBusWriter::parseSpec(_sampleBusSpec,name,mbytes);
+        }
+        catch (const n_u::InvalidParameterException& e) {
+            cerr << e.what() << endl;
+            usage();
+            return 1;
+        }
+    }
     
     if (args.size() == 1)
     {
@@ -397,6 +450,13 @@ int DSMEngine::run() throw()
         // start the status Thread
         if (_dsmConfig->getStatusSocketAddr().getPort() != 0) {
             _statusThread = new DSMEngineStat("DSMEngineStat",_dsmConfig->getStatusSocketAddr());
+            try {
+                RealTimeProfile::getInstance()->apply(
+                    RealTimeProfile::STATUS,_statusThread);
+            }
+            catch (const n_u::Exception& e) {
+                WLOG(("%s: %s",_statusThread->getName().c_str(),e.what()));
+            }
             _statusThread->start();
 	}
         _runState = DSM_RUNNING;
@@ -413,6 +473,11 @@ int DSMEngine::run() throw()
 
     joinDataThreads();
 
+    // If latencies are being measured, log what has accumulated since
+    // the last status report, which for a dsm without a status address,
+    // such as in a benchmark, is the whole run.
+    if (PipelineLatency::enabled()) logLatency();
+
     disconnectProcessors();
 
     closeOutputs();
@@ -519,6 +584,10 @@ void DSMEngine::deleteDataThreads() throw()
         DerivedDataReader::deleteInstance();
     }
 
+    if (_pipeline && SampleBusWriter::getInstance())
+        _pipeline->getRawSampleSource()->removeSampleClient(
+            SampleBusWriter::getInstance());
+
     delete _pipeline;
     _pipeline = 0;
 }
@@ -663,10 +732,28 @@ void DSMEngine::initialize(xercesc::DOMDocument* projectDoc)
 
 void DSMEngine::openSensors() throw(n_u::IOException)
 {
+    // The profile is rebuilt from the configuration on each restart.
+    RealTimeProfile::deleteInstance();
+    RealTimeProfile* rtprofile = RealTimeProfile::getInstance();
+    rtprofile->update(_dsmConfig->getRealTimeProfile());
+    try {
+        rtprofile->parse(_realTimeSpec);
+    }
+    catch (const n_u::InvalidParameterException& e) {
+        throw n_u::IOException("dsm","--realtime",e.what());
+    }
+    rtprofile->log();
+    rtprofile->prefault();
+
     _selector = new SensorHandler(_dsmConfig->getRemoteSerialSocketPort());
 
     n_u::Logger::getInstance()->log(LOG_INFO,"DSMEngine: setting RT priority");
-    _selector->setRealTimeFIFOPriority(50);
+    try {
+        rtprofile->apply(RealTimeProfile::SENSORS,_selector);
+    }
+    catch (const n_u::Exception& e) {
+        throw n_u::IOException(_selector->getName(),"realtime",e.what());
+    }
 
     _pipeline = new SamplePipeline();
     _pipeline->setRealTime(true);
@@ -674,6 +761,12 @@ void DSMEngine::openSensors() throw(n_u::IOException)
     _pipeline->setProcSorterLength(_dsmConfig->getProcSorterLength());
     _pipeline->setRawHeapMax(_dsmConfig->getRawHeapMax());
     _pipeline->setProcHeapMax(_dsmConfig->getProcHeapMax());
+    _pipeline->setRawSorterLengthBounds(_dsmConfig->getRawSorterLengthMin(),
+        _dsmConfig->getRawSorterLengthMax());
+    _pipeline->setProcSorterLengthBounds(_dsmConfig->getProcSorterLengthMin(),
+        _dsmConfig->getProcSorterLengthMax());
+    _pipeline->setRawHeapMin(_dsmConfig->getRawHeapMin());
+    _pipeline->setProcHeapMin(_dsmConfig->getProcHeapMin());
     _pipeline->setRawLateSampleCacheSize(_dsmConfig->getRawLateSampleCacheSize());
     _pipeline->setProcLateSampleCacheSize(_dsmConfig->getProcLateSampleCacheSize());
 
@@ -686,6 +779,18 @@ void DSMEngine::openSensors() throw(n_u::IOException)
 	DSMSensor* sensor = *si;
         _pipeline->connect(sensor);
     }
+
+    if (!_sampleBusSpec.empty()) {
+        SampleBusWriter* bus;
+        try {
+            bus = SampleBusWriter::createInstance(_sampleBusSpec);
+        }
+        catch (const n_u::InvalidParameterException& e) {
+            throw n_u::IOException(_sampleBusSpec,"samplebus",e.what());
+        }
+        bus->setHeader();
+        _pipeline->getRawSampleSource()->addSampleClient(bus);
+    }
     _selector->start();
     _dsmConfig->openSensors(_selector);
 }
@@ -708,6 +813,44 @@ void DSMEngine::connectOutputs() throw(n_u::IOException)
     }
 }
 
+void DSMEngine::printLatency(std::ostream& ostr)
+{
+    if (_selector) {
+        list<DSMSensor*> sensors = _selector->getAllSensors();
+        list<DSMSensor*>::const_iterator si = sensors.begin();
+        for ( ; si != sensors.end(); ++si) {
+            DSMSensor* sensor = *si;
+            sensor->printLatency(ostr);
+        }
+    }
+
+    if (_pipeline) _pipeline->printLatency(ostr);
+
+    n_u::Autolock alock(_outputMutex);
+    set<SampleOutput*>::const_iterator oi = _outputSet.begin();
+    for ( ; oi != _outputSet.end(); ++oi) {
+        SampleOutput* output = *oi;
+        PipelineLatency::printAndReset(ostr,output->getName(),
+            PipelineLatency::OUTPUT,output->getWriteLatencyHistogram());
+    }
+}
+
+void DSMEngine::printSorterStatus(std::ostream& ostr)
+{
+    if (_pipeline) _pipeline->printSorterStatus(ostr);
+}
+
+void DSMEngine::logLatency()
+{
+    ostringstream ost;
+    printLatency(ost);
+
+    istringstream ist(ost.str());
+    string line;
+    while (getline(ist,line))
+        ILOG(("latency: ") << line);
+}
+
 /* implementation of SampleConnectionRequester::connect(SampleOutput*) */
 void DSMEngine::connect(SampleOutput* output) throw()
 {
@@ -123,6 +123,19 @@ public:
 
     const SensorHandler* getSensorHandler() const { return _selector; }
 
+    /**
+     * Write the latency summaries of the sensors, sorters and outputs
+     * of this DSMEngine, one line for each stage with counts, and reset
+     * the histograms. See PipelineLatency.
+     */
+    void printLatency(std::ostream& ostr);
+
+    /**
+     * Write the state of the raw and processed sorters, one line each.
+     * See SamplePipeline::printSorterStatus().
+     */
+    void printSorterStatus(std::ostream& ostr);
+
     /**
      * Sensors register with the DSMEngineIntf XmlRpcThread if they have a
      * executeXmlRpc() method which can be invoked with a "SensorAction"
@@ -186,6 +199,11 @@ private:
 
     void joinDataThreads() throw();
 
+    /**
+     * Log the output of printLatency() at LOG_INFO level.
+     */
+    void logLatency();
+
     /**
      * Implementation of SampleConnectionRequester connect methods.
      * This is how DSMEngine is notified of remote connections.
@@ -255,6 +273,17 @@ private:
 
     NidasApp _app;
 
+    /**
+     * Real-time profile from the command line, which
+     * overrides the \<realtime\> element of the dsm.
+     */
+    std::string _realTimeSpec;
+
+    /**
+     * Name and size of the shared memory sample bus, if any.
+     */
+    std::string _sampleBusSpec;
+
     /** No copy */
     DSMEngine(const DSMEngine&);
 
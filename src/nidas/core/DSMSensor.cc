@@ -33,12 +33,14 @@
 #include "Parameter.h"
 #include "SensorCatalog.h"
 #include "Looper.h"
+#include "RealTimeProfile.h"
 #include "Variable.h"
 
 #include "SamplePool.h"
 #include "CalFile.h"
 
 #include <nidas/util/Logger.h>
+#include <nidas/util/UTime.h>
 
 #include <cmath>
 #include <iostream>
@@ -73,7 +75,8 @@ DSMSensor::DSMSensor() :
     _duplicateIdOK(false),
     _applyVariableConversions(),
     _driverTimeTagUsecs(USECS_PER_TMSEC),
-    _nTimeouts(0),_lag(0),_station(-1)
+    _nTimeouts(0),_lag(0),_station(-1),
+    _pipelineLatency(),_processResults()
 {
 }
 
@@ -357,6 +360,8 @@ void DSMSensor::init() throw(n_u::InvalidParameterException)
 
 bool DSMSensor::readSamples() throw(nidas::util::IOException)
 {
+    if (PipelineLatency::enabled()) return readSamplesTimed();
+
     bool exhausted = readBuffer();
 
     // process all data in buffer, pass samples onto clients
@@ -383,14 +388,63 @@ bool DSMSensor::readSamples() throw(nidas::util::IOException)
     return exhausted;
 }
 
+/*
+ * Same as readSamples(), but record the read and scan latencies.
+ */
+bool DSMSensor::readSamplesTimed() throw(nidas::util::IOException)
+{
+    dsm_time_t t0 = n_u::getSystemTime();
+    bool exhausted = readBuffer();
+    dsm_time_t t1 = n_u::getSystemTime();
+    _pipelineLatency[PipelineLatency::READ].record(t1 - t0);
+
+    for (;;) {
+        t0 = t1;
+        Sample* samp = nextSample();
+        if (!samp) break;
+        t1 = n_u::getSystemTime();
+        _pipelineLatency[PipelineLatency::SCAN].record(t1 - t0);
+        _rawSource.distribute(samp);
+        t1 = n_u::getSystemTime();
+    }
+    return exhausted;
+}
+
 bool DSMSensor::receive(const Sample *samp) throw()
 {
-    list<const Sample*> results;
-    process(samp,results);
-    _source.distribute(results);	// distribute does the freeReference
+    _processResults.clear();
+    if (PipelineLatency::enabled()) {
+        dsm_time_t t0 = n_u::getSystemTime();
+        _pipelineLatency[PipelineLatency::RAW_SORT].record(t0 - samp->getTimeTag());
+        processInto(samp,_processResults);
+        _pipelineLatency[PipelineLatency::PROCESS].record(n_u::getSystemTime() - t0);
+    }
+    else processInto(samp,_processResults);
+
+    // distribute does the freeReference
+    for (unsigned int i = 0; i < _processResults.size(); i++)
+        _source.distribute(_processResults[i]);
     return true;
 }
 
+bool DSMSensor::processInto(const Sample* samp,
+    vector<const Sample*>& results) throw()
+{
+    list<const Sample*> lresults;
+    bool res = process(samp,lresults);
+    results.insert(results.end(),lresults.begin(),lresults.end());
+    return res;
+}
+
+bool DSMSensor::processIntoList(const Sample* samp,
+    list<const Sample*>& results) throw()
+{
+    vector<const Sample*> vresults;
+    bool res = processInto(samp,vresults);
+    results.insert(results.end(),vresults.begin(),vresults.end());
+    return res;
+}
+
 
 void
 DSMSensor::
@@ -868,12 +922,12 @@ Looper* DSMSensor::getLooper()
     if (!_looper) {
         _looper = new Looper();
         try {
-            _looper->setThreadScheduler(n_u::Thread::NU_THREAD_RR,51);
+            RealTimeProfile::getInstance()->apply(
+                RealTimeProfile::LOOPER,_looper);
         }
         catch(const n_u::Exception& e) {
             n_u::Logger::getInstance()->log(LOG_WARNING,
-                "DSMSensor Looper thread cannot be realtime %s: %s",
-                n_u::Thread::getPolicyString(n_u::Thread::NU_THREAD_RR).c_str(),
+                "DSMSensor Looper thread cannot be realtime: %s",
                 e.what());
         }
     }
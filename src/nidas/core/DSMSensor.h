@@ -33,6 +33,7 @@
 #include "IODevice.h"
 #include "DOMable.h"
 #include "Dictionary.h"
+#include "LatencyHistogram.h"
 
 #include <nidas/util/IOException.h>
 #include <nidas/util/InvalidParameterException.h>
@@ -41,6 +42,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 
 #include <fcntl.h>
 
@@ -729,10 +731,47 @@ public:
     virtual bool process(const Sample*,std::list<const Sample*>& result)
     	throw() = 0;
 
+    /**
+     * Apply further necessary processing to a raw sample from this
+     * DSMSensor, appending the resultant sample(s) to a vector provided
+     * by the caller. receive() calls this method, with a vector
+     * that it clears and re-uses for every sample, so that once
+     * the vector has grown to hold the results of one sample, processing
+     * does not allocate memory for the result list, as it does
+     * when pushing onto a std::list.
+     *
+     * The default implementation is an adapter which calls
+     * process(const Sample*,std::list<const Sample*>&) and
+     * appends its results, so existing sensors work unchanged.
+     * A sensor can avoid the list by overriding this method, and
+     * implementing process(const Sample*,std::list<const Sample*>&)
+     * with processIntoList(). Since receive() calls processInto(),
+     * such a sensor should not be sub-classed by a sensor which only
+     * overrides process(const Sample*,std::list<const Sample*>&).
+     */
+    virtual bool processInto(const Sample*,std::vector<const Sample*>& result)
+    	throw();
+
     void printStatusHeader(std::ostream& ostr) throw();
     virtual void printStatus(std::ostream&) throw();
     void printStatusTrailer(std::ostream& ostr) throw();
 
+    /**
+     * Latency histograms of the read, scan, raw sort and process
+     * stages of this sensor's samples. These are only updated
+     * if PipelineLatency::enabled().
+     */
+    PipelineLatency& getPipelineLatency() { return _pipelineLatency; }
+
+    /**
+     * Write the summaries of the latency histograms of this sensor,
+     * then reset them.
+     */
+    virtual void printLatency(std::ostream& ostr)
+    {
+        _pipelineLatency.printAndReset(ostr,getName());
+    }
+
     /**
      * Update the sensor sampling statistics.  Should be called
      * every periodUsec by a user of this sensor.
@@ -890,6 +929,14 @@ public:
     virtual void executeXmlRpc(XmlRpc::XmlRpcValue&, XmlRpc::XmlRpcValue&)
         throw() {}
 
+    /**
+     * Fetch a pointer to a static instance of a Looper thread.
+     * Use this Looper for periodic callbacks, as for prompting,
+     * in support of a DSMSensor, or for the timed writes of
+     * an output of its samples.
+     */
+    static Looper* getLooper();
+
     static void deleteLooper();
 
     /**
@@ -904,6 +951,13 @@ public:
 
 protected:
 
+    /**
+     * Adapter for sensors which override processInto(),
+     * to implement process(const Sample*,std::list<const Sample*>&).
+     */
+    bool processIntoList(const Sample*,std::list<const Sample*>& result)
+    	throw();
+
     /**
      * Read into my SampleScanner's buffer.
      */
@@ -940,13 +994,6 @@ protected:
 
     void setFullSuffix(const std::string& val) { _fullSuffix = val; }
 
-    /**
-     * Fetch a pointer to a static instance of a Looper thread.
-     * Use this Looper for periodic callbacks, as for prompting,
-     * in support of a DSMSensor.
-     */
-    static Looper* getLooper();
-
     /**
      * Return the sampling lag for this sensor in microseconds.
      * A positive lag means one should adjust the sample time tags
@@ -1165,8 +1212,22 @@ private:
 
     int _station;
 
+    PipelineLatency _pipelineLatency;
+
 private:
 
+    /**
+     * Results of processInto(), re-used by receive() for each sample.
+     * receive() is called by the one thread of the sorter that
+     * this sensor is a client of, so this needs no locking.
+     */
+    std::vector<const Sample*> _processResults;
+
+    /**
+     * readSamples(), recording the READ and SCAN latencies.
+     */
+    bool readSamplesTimed() throw(nidas::util::IOException);
+
     // no copying
     DSMSensor(const DSMSensor& x);
 
@@ -34,6 +34,7 @@
 #include "Site.h"
 #include "ProjectConfigs.h"
 #include "SampleOutputRequestThread.h"
+#include "SampleBus.h"
 #include "XMLParser.h"
 #include "Version.h"
 
@@ -72,6 +73,7 @@ DSMServerApp::DSMServerApp():
     _signalMask(),
     _myThreadId(::pthread_self()),
     _datasetName(),
+    _sampleBusSpec(),
     _app("dsm_server")
 {
     setupSignals();
@@ -81,6 +83,7 @@ DSMServerApp::~DSMServerApp()
 {
     SampleOutputRequestThread::destroyInstance();
     SamplePools::deleteInstance();
+    SampleBusWriter::deleteInstance();
 }
 
 int DSMServerApp::parseRunstring(int argc, char** argv)
@@ -94,10 +97,16 @@ int DSMServerApp::parseRunstring(int argc, char** argv)
          "Set environment variables specifed for the dataset\n"
          "as found in the xml file specifed by $NIDAS_DATASETS or \n"
          "$ISFS/projects/$PROJECT/ISFS/config/datasets.xml");
+    NidasAppArg SampleBus
+        ("--samplebus", "name[:MB]",
+         "Publish the raw samples to a shared memory sample bus of MB\n"
+         "megabytes, default 16, which local programs can read as\n"
+         "input shm:name, without a socket to this process.");
 
     _app.enableArguments(_app.loggingArgs() | _app.Version | _app.Help |
                          _app.Username | _app.Hostname | _app.DebugDaemon |
-                         ExternalControl | OptionalProcessing | DatasetName);
+                         ExternalControl | OptionalProcessing | DatasetName |
+                         SampleBus);
     ArgVector args = _app.parseArgs(argc, argv);
     if (_app.helpRequested())
     {
@@ -107,6 +116,18 @@ int DSMServerApp::parseRunstring(int argc, char** argv)
     _externalControl = ExternalControl.asBool();
     _optionalProcessing = OptionalProcessing.asBool();
     _datasetName = DatasetName.getValue();
+    _sampleBusSpec = SampleBus.getValue();
+    if (_sampleBusSpec.length() > 0) {
+        try {
+            string name;
+            unsigned int mbytes;
+            SampleBusWriter::parseSpec(_sampleBusSpec,name,mbytes);
+        }
+        catch (const n_u::InvalidParameterException& e) {
+            cerr << e.what() << endl;
+            return usage();
+        }
+    }
 
     int opt_char;		/* option character */
     while ((opt_char = getopt(argc, argv, "cdl:orS:u:h:v")) != -1) {
@@ -283,6 +304,17 @@ int DSMServerApp::run() throw()
 
         project.setConfigName(_xmlFileName);
 
+        if (_sampleBusSpec.length() > 0) {
+            try {
+                SampleBusWriter::createInstance(_sampleBusSpec)->setHeader();
+            }
+            catch (const n_u::Exception& e) {
+                PLOG(("%s",e.what()));
+                _runState = ERROR;
+                continue;
+            }
+        }
+
 	DSMServer* server = 0;
 
 	try {
@@ -151,6 +151,11 @@ private:
 
     std::string _datasetName;
 
+    /**
+     * Name and size of the shared memory sample bus, if any.
+     */
+    std::string _sampleBusSpec;
+
     NidasApp _app;
 
     /** Copy not needed */
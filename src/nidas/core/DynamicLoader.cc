@@ -109,7 +109,11 @@ lookup(const std::string& library,const std::string& name)
     void* libhandle;
 
     if (mi == _libhandles.end()) {
-        libhandle = dlopen(library.c_str(), RTLD_LAZY| RTLD_GLOBAL);
+        // RTLD_NODELETE: the static initializers of the library
+        // add its creator functions to the DOMObjectFactory table,
+        // so its code must stay mapped even if it is dlclose()d below.
+        libhandle = dlopen(library.c_str(),
+            RTLD_LAZY | RTLD_GLOBAL | RTLD_NODELETE);
 	if (libhandle == 0) {
             // In case other code is calling dl functions, check for
             // non-null dlerror(), since constructing a std::string from a
@@ -135,7 +139,8 @@ lookup(const std::string& library,const std::string& name)
         if (errptr) errStr = errptr;
         else errStr = library + ": " + name + ": unknown error";
 
-        // If no symbols have been found in this library so far, unload it.
+        // If no symbols have been found in this library so far, close it.
+        // It isn't unmapped, because of RTLD_NODELETE.
         if (mi == _libhandles.end()) dlclose(libhandle);
 
         // dlerror() string contains the library name (or the program name
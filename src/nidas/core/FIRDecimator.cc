@@ -0,0 +1,103 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#include "FIRDecimator.h"
+
+#include <sstream>
+
+using namespace nidas::core;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+FIRDecimator::FIRDecimator(int nchannels, const vector<float>& coefs,
+    int decimation) throw(n_u::InvalidParameterException):
+    _nchannels(nchannels),_decimation(decimation),
+    _coefs(coefs.rbegin(), coefs.rend()),_ncoefs(coefs.size()),
+    _delay(0.0),_history(),_next(0),_countdown(0)
+{
+    if (_nchannels <= 0)
+        throw n_u::InvalidParameterException("FIRDecimator","nchannels",
+            "must be > 0");
+    if (_decimation <= 0)
+        throw n_u::InvalidParameterException("FIRDecimator","decimation",
+            "must be > 0");
+    if (_ncoefs == 0)
+        throw n_u::InvalidParameterException("FIRDecimator","coefficients",
+            "none given");
+
+    double sum = 0.0;
+    double moment = 0.0;
+    for (int i = 0; i < _ncoefs; i++) {
+        sum += coefs[i];
+        moment += i * coefs[i];
+    }
+    if (sum == 0.0)
+        throw n_u::InvalidParameterException("FIRDecimator","coefficients",
+            "sum is zero");
+    _delay = moment / sum;
+
+    _history.resize(2 * _ncoefs * _nchannels);
+    reset();
+}
+
+void FIRDecimator::reset()
+{
+    _next = 0;
+    // Wait for a full window before the first output.
+    _countdown = _ncoefs;
+}
+
+void FIRDecimator::output(float* out) const
+{
+    // window of the last _ncoefs scans, oldest first
+    const float* hp = &_history[_next * _nchannels];
+    const float* cp = &_coefs[0];
+
+    for (int c = 0; c < _nchannels; c++) out[c] = 0.0;
+    for (int k = 0; k < _ncoefs; k++, hp += _nchannels) {
+        float coef = cp[k];
+        for (int c = 0; c < _nchannels; c++) out[c] += coef * hp[c];
+    }
+}
+
+vector<float> FIRDecimator::cicCoefficients(int decimation, int order)
+{
+    vector<double> coefs(1, 1.0);
+    double gain = 1.0;
+    for (int i = 0; i < order; i++) {
+        vector<double> conv(coefs.size() + decimation - 1, 0.0);
+        for (unsigned int j = 0; j < coefs.size(); j++)
+            for (int k = 0; k < decimation; k++)
+                conv[j + k] += coefs[j];
+        coefs.swap(conv);
+        gain *= decimation;
+    }
+    vector<float> res(coefs.size());
+    for (unsigned int i = 0; i < coefs.size(); i++)
+        res[i] = coefs[i] / gain;
+    return res;
+}
@@ -0,0 +1,152 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#ifndef NIDAS_CORE_FIRDECIMATOR_H
+#define NIDAS_CORE_FIRDECIMATOR_H
+
+#include <nidas/util/InvalidParameterException.h>
+
+#include <vector>
+
+namespace nidas { namespace core {
+
+/**
+ * A decimating FIR filter of a number of channels which are sampled
+ * together, as in a scan of an A2D.
+ *
+ * Each call to add() adds a scan of input values. Every decimation
+ * scans add() returns true, and the filtered scan is then fetched
+ * with output(). The filter is only evaluated at the output times,
+ * which is what a polyphase decimator does, so the cost per output is
+ * the number of coefficients times the number of channels, and an input
+ * scan which does not produce an output costs only a copy.
+ *
+ * The history is kept as scans of contiguous channel values, twice,
+ * so that the window of the last ncoefs scans is always contiguous,
+ * and the inner loop of the filter is a multiply-add over the channels
+ * of a scan, which the compiler can vectorize.
+ *
+ * A NaN input value results in NaN outputs for its channel while it
+ * is within the window of the filter.
+ */
+class FIRDecimator
+{
+public:
+
+    /**
+     * @param nchannels Number of values in each input and output scan.
+     * @param coefs Filter coefficients, coefs[0] is applied to
+     *      the most recent scan.
+     * @param decimation Number of input scans for each output scan.
+     */
+    FIRDecimator(int nchannels, const std::vector<float>& coefs,
+        int decimation)
+        throw(nidas::util::InvalidParameterException);
+
+    int getNumChannels() const { return _nchannels; }
+
+    int getDecimation() const { return _decimation; }
+
+    /**
+     * Delay of the filter output, in input scans: the centroid of
+     * the coefficients, which for a symmetric, linear-phase,
+     * filter is (ncoefs - 1) / 2. Users subtract this from
+     * the time tag of the input scan which produced an output.
+     */
+    double getDelay() const { return _delay; }
+
+    /**
+     * Add a scan of getNumChannels() values.
+     * @return true if an output is due, which should then be
+     *      fetched with output() before the next add().
+     */
+    bool add(const float* in)
+    {
+        float* h1 = &_history[_next * _nchannels];
+        float* h2 = h1 + _ncoefs * _nchannels;
+        for (int c = 0; c < _nchannels; c++) h1[c] = h2[c] = in[c];
+        if (++_next == _ncoefs) _next = 0;
+
+        if (--_countdown > 0) return false;
+        _countdown = _decimation;
+        return true;
+    }
+
+    /**
+     * Evaluate the filter over the last ncoefs scans, writing
+     * getNumChannels() values to out.
+     */
+    void output(float* out) const;
+
+    /**
+     * Forget the history. The next output will be after ncoefs
+     * more input scans, in order not to output values from a
+     * partially filled window.
+     */
+    void reset();
+
+    /**
+     * Coefficients of a FIR filter equivalent to a CIC decimator of
+     * the given order: the convolution of order boxcars of decimation
+     * points, normalized to a gain of one.
+     */
+    static std::vector<float> cicCoefficients(int decimation, int order);
+
+private:
+
+    int _nchannels;
+
+    int _decimation;
+
+    /**
+     * Coefficients in the order they are applied to the window,
+     * oldest scan first.
+     */
+    std::vector<float> _coefs;
+
+    int _ncoefs;
+
+    double _delay;
+
+    /**
+     * 2 * ncoefs scans. Scan i is stored at i and i + ncoefs.
+     */
+    std::vector<float> _history;
+
+    /**
+     * Index of the next scan in _history.
+     */
+    int _next;
+
+    /**
+     * Number of input scans until the next output.
+     */
+    int _countdown;
+};
+
+}}	// namespace nidas namespace core
+
+#endif
@@ -30,6 +30,7 @@
 #include "IOChannel.h"
 
 #include <iostream>
+#include <cassert>
 
 namespace nidas { namespace core {
 
@@ -106,6 +107,28 @@ public:
      */
     size_t skip(size_t len) throw(nidas::util::IOException);
 
+    /**
+     * Pointer to the available() bytes in the internal buffer,
+     * so that they can be parsed, or modified, in place, without
+     * a copy, and then consumed. The bytes remain in place after
+     * consume(), until the next read().
+     */
+    char* peek()
+    {
+        return _tail;
+    }
+
+    /**
+     * Consume len bytes of the available() data in the
+     * internal buffer, typically after a peek().
+     */
+    void consume(size_t len) throw()
+    {
+        assert(len <= available());
+        _tail += len;
+        addNumInputBytes(len);
+    }
+
     /**
      * Move the read buffer pointer backwards by len number of bytes,
      * so that the next readBuf will return data that was previously read.  
@@ -0,0 +1,129 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#include "LatencyHistogram.h"
+
+#include <nidas/util/Logger.h>
+
+#include <algorithm>
+
+using namespace nidas::core;
+using namespace std;
+
+using nidas::util::LogScheme;
+
+const unsigned int LatencyHistogram::MAX_VALUE;
+const int LatencyHistogram::SUB_BITS;
+const unsigned int LatencyHistogram::NSUB;
+const unsigned int LatencyHistogram::NBINS;
+
+LatencyHistogram::LatencyHistogram(): _counts(),_count(0),_max(0)
+{
+}
+
+/* static */
+unsigned int LatencyHistogram::binUpperBound(unsigned int i)
+{
+    if (i < 2 * NSUB) return i;
+    unsigned int k = i - 2 * NSUB;
+    unsigned int shift = k / NSUB + 1;
+    unsigned int sub = k % NSUB + NSUB;
+    return ((sub + 1) << shift) - 1;
+}
+
+unsigned int LatencyHistogram::getPercentile(double pct) const
+{
+    unsigned int count = _count;
+    if (count == 0) return 0;
+
+    // number of counts at or below the percentile, at least one
+    unsigned long long target =
+        (unsigned long long)(pct / 100.0 * count + 0.5);
+    if (target < 1) target = 1;
+
+    unsigned long long sum = 0;
+    for (unsigned int i = 0; i < NBINS; i++) {
+        sum += _counts[i];
+        if (sum >= target) return std::min(binUpperBound(i),_max);
+    }
+    return _max;
+}
+
+void LatencyHistogram::reset()
+{
+    for (unsigned int i = 0; i < NBINS; i++) _counts[i] = 0;
+    _count = 0;
+    _max = 0;
+}
+
+void LatencyHistogram::printSummary(ostream& ostr) const
+{
+    ostr << "n=" << getCount() <<
+        " p50=" << getPercentile(50.0) <<
+        " p90=" << getPercentile(90.0) <<
+        " p99=" << getPercentile(99.0) <<
+        " max=" << getMax();
+}
+
+int PipelineLatency::_enabled = -1;
+
+/* static */
+int PipelineLatency::checkEnabled()
+{
+    return LogScheme::current().getParameterT("pipeline_latency",0) != 0;
+}
+
+/* static */
+const char* PipelineLatency::getStageName(enum stage s)
+{
+    switch (s) {
+    case READ: return "read";
+    case SCAN: return "scan";
+    case RAW_SORT: return "rawsort";
+    case PROCESS: return "process";
+    case PROC_SORT: return "procsort";
+    case OUTPUT: return "output";
+    case SYNC: return "sync";
+    default: return "unknown";
+    }
+}
+
+void PipelineLatency::printAndReset(ostream& ostr, const string& name)
+{
+    for (int i = 0; i < NSTAGES; i++)
+        printAndReset(ostr,name,(enum stage)i,_hist[i]);
+}
+
+/* static */
+void PipelineLatency::printAndReset(ostream& ostr, const string& name,
+        enum stage s, LatencyHistogram& hist)
+{
+    if (hist.getCount() == 0) return;
+    ostr << name << ' ' << getStageName(s) << ' ';
+    hist.printSummary(ostr);
+    ostr << '\n';
+    hist.reset();
+}
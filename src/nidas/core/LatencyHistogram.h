@@ -0,0 +1,230 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#ifndef NIDAS_CORE_LATENCYHISTOGRAM_H
+#define NIDAS_CORE_LATENCYHISTOGRAM_H
+
+#include <iostream>
+#include <string>
+
+namespace nidas { namespace core {
+
+/**
+ * A histogram of latencies in microseconds, with log-linear bins
+ * in the style of an HDR histogram: values less than 32 usec have
+ * their own bin, and larger values are binned with 16 bins per power
+ * of two, giving a resolution of about 6% over the range of 0 to
+ * 2^31 microseconds.
+ *
+ * record() may be called concurrently from any number of threads.
+ * It does not take a lock, the counts are incremented with atomic
+ * builtins.  Readers such as the status threads see a consistent
+ * enough picture for reporting, but a reset() that happens while
+ * another thread is recording may lose a few counts.
+ */
+class LatencyHistogram
+{
+public:
+
+    LatencyHistogram();
+
+    /**
+     * Add a latency to the histogram. Negative values, which can
+     * happen if the system clock is stepped, are counted as 0.
+     */
+    void record(long long usecs)
+    {
+        unsigned int v;
+        if (usecs <= 0) v = 0;
+        else if (usecs >= MAX_VALUE) v = MAX_VALUE;
+        else v = (unsigned int) usecs;
+        __sync_fetch_and_add(&_counts[binIndex(v)],1);
+        __sync_fetch_and_add(&_count,1);
+        unsigned int m = _max;
+        while (v > m) {
+            unsigned int prev = __sync_val_compare_and_swap(&_max,m,v);
+            if (prev == m) break;
+            m = prev;
+        }
+    }
+
+    /**
+     * Number of latencies recorded since construction or the last reset().
+     */
+    unsigned int getCount() const { return _count; }
+
+    /**
+     * Maximum latency recorded, in microseconds.
+     */
+    unsigned int getMax() const { return _max; }
+
+    /**
+     * Estimate of the latency, in microseconds, below which the given
+     * percentage of the recorded latencies fall.  Since the histogram
+     * has a limited resolution, the upper bound of the bin containing
+     * the percentile is returned, or the maximum value if it is less.
+     * @param pct Percentile, from 0 to 100.
+     * @return 0 if nothing has been recorded.
+     */
+    unsigned int getPercentile(double pct) const;
+
+    /**
+     * Zero the counts.
+     */
+    void reset();
+
+    /**
+     * Write a one line summary of the histogram to a stream:
+     * "n=count p50=usec p90=usec p99=usec max=usec".
+     */
+    void printSummary(std::ostream& ostr) const;
+
+    /**
+     * Index of the bin containing a value.
+     */
+    static unsigned int binIndex(unsigned int v)
+    {
+        if (v < 2 * NSUB) return v;
+        int msb = 31 - __builtin_clz(v);
+        int shift = msb - SUB_BITS;
+        return 2 * NSUB + (shift - 1) * NSUB + ((v >> shift) - NSUB);
+    }
+
+    /**
+     * Largest value that is binned into bin i.
+     */
+    static unsigned int binUpperBound(unsigned int i);
+
+    /**
+     * Values larger than this, in microseconds, are counted as this value.
+     */
+    static const unsigned int MAX_VALUE = 0x7fffffff;
+
+    /**
+     * log2 of the number of bins per power of two.
+     */
+    static const int SUB_BITS = 4;
+
+    static const unsigned int NSUB = 1 << SUB_BITS;
+
+    static const unsigned int NBINS = 2 * NSUB + (30 - SUB_BITS) * NSUB;
+
+private:
+
+    unsigned int _counts[NBINS];
+
+    unsigned int _count;
+
+    unsigned int _max;
+
+    /** No copying. */
+    LatencyHistogram(const LatencyHistogram&);
+
+    /** No assignment. */
+    LatencyHistogram& operator=(const LatencyHistogram&);
+};
+
+/**
+ * The set of LatencyHistograms for the stages that a sample passes
+ * through on its way from a sensor to an output.  A DSMSensor keeps
+ * one of these for the stages it is involved in, and SampleSorters
+ * and SampleOutputs keep one for their own stage.
+ *
+ * Measuring latency costs two clock reads per sample per stage,
+ * so it is disabled by default.  It is enabled by setting the
+ * "pipeline_latency" log parameter to a non-zero value, for example
+ * with the --logparam pipeline_latency=1 option of dsm or dsm_server.
+ */
+class PipelineLatency
+{
+public:
+
+    /**
+     * Stages in the life of a sample.
+     * READ: duration of a DSMSensor::readBuffer().
+     * SCAN: duration of a successful SampleScanner::nextSample().
+     * RAW_SORT: age of a raw sample, now - timetag, when it
+     *  leaves the raw SampleSorter, or when it is received by
+     *  its DSMSensor for processing.
+     * PROCESS: duration of DSMSensor::process().
+     * PROC_SORT: age of a processed sample when it leaves the processed
+     *  SampleSorter.
+     * OUTPUT: duration of writing a sample to a SampleOutput.
+     * SYNC: system time from the first sample placed in an aircraft
+     *  sync record to the distribution of the record.
+     */
+    enum stage { READ, SCAN, RAW_SORT, PROCESS, PROC_SORT, OUTPUT, SYNC,
+        NSTAGES };
+
+    PipelineLatency(): _hist() {}
+
+    LatencyHistogram& operator[](enum stage s) { return _hist[s]; }
+
+    const LatencyHistogram& operator[](enum stage s) const { return _hist[s]; }
+
+    /**
+     * Write a summary line for each stage which has counts,
+     * prefixed by name, then reset the histograms.
+     */
+    void printAndReset(std::ostream& ostr, const std::string& name);
+
+    /**
+     * Write a summary line for one stage, if it has counts,
+     * then reset the histogram.
+     */
+    static void printAndReset(std::ostream& ostr, const std::string& name,
+        enum stage s, LatencyHistogram& hist);
+
+    static const char* getStageName(enum stage s);
+
+    /**
+     * Whether latencies should be measured, from the "pipeline_latency"
+     * log parameter.
+     */
+    static bool enabled()
+    {
+        if (_enabled < 0) _enabled = checkEnabled();
+        return _enabled > 0;
+    }
+
+private:
+
+    static int checkEnabled();
+
+    static int _enabled;
+
+    LatencyHistogram _hist[NSTAGES];
+
+    /** No copying. */
+    PipelineLatency(const PipelineLatency&);
+
+    /** No assignment. */
+    PipelineLatency& operator=(const PipelineLatency&);
+};
+
+}}	// namespace nidas namespace core
+
+#endif
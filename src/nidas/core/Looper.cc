@@ -28,6 +28,9 @@
 #include <nidas/util/Logger.h>
 #include <nidas/util/UTime.h>
 
+#include <signal.h>
+#include <errno.h>
+
 using namespace std;
 using namespace nidas::core;
 
@@ -35,11 +38,18 @@ namespace n_u = nidas::util;
 
 Looper::Looper():
     n_u::Thread("Looper"),
-    _clientMutex(), _clients(),
-    _clientPeriods(), _clientOffsets(),
-    _clientDivs(), _clientMods(),
-    _sleepMsec(0)
+    _clientCond(), _clients(), _schedule(),
+    _notifying(0), _sleepUntil(0), _sequence(0)
+{
+    // SIGUSR1 wakes the Looper. It is blocked, and
+    // then unblocked in pselect.
+    blockSignal(SIGUSR1);
+}
+
+Looper::~Looper()
 {
+    map<LooperClient*, ClientInfo*>::iterator ci = _clients.begin();
+    for ( ; ci != _clients.end(); ++ci) delete ci->second;
 }
 
 void Looper::addClient(LooperClient* clnt, unsigned int msecPeriod,
@@ -49,32 +59,60 @@ void Looper::addClient(LooperClient* clnt, unsigned int msecPeriod,
 
     if (msecPeriod < 5) throw n_u::InvalidParameterException(
     	"Looper","addClient","requested callback period is too small ");
-    // round to nearest 10 milliseconds, which better
-    // matches the precision of the system nanosleep.
-    msecPeriod += 5;
-    msecPeriod = msecPeriod - msecPeriod % 10;
 
-    n_u::Synchronized autoLock(_clientMutex);
+    n_u::Synchronized autoLock(_clientCond);
+
+    ClientInfo* info;
+    map<LooperClient*, ClientInfo*>::iterator ci = _clients.find(clnt);
+    if (ci != _clients.end()) {
+        // re-registration with a new period or offset
+        info = ci->second;
+        if (info != _notifying) _schedule.erase(info);
+        info->periodUsec = (dsm_time_t)msecPeriod * USECS_PER_MSEC;
+        info->offsetUsec = (dsm_time_t)(msecOffset % msecPeriod) *
+            USECS_PER_MSEC;
+        info->removed = false;
+    }
+    else {
+        info = new ClientInfo(clnt,msecPeriod,msecOffset,_sequence++);
+        _clients[clnt] = info;
+    }
+
+    info->setNextDeadline(n_u::getSystemTime());
+    // If the client's looperNotify() is being called, run()
+    // puts it back in the schedule.
+    if (info != _notifying) _schedule.insert(info);
 
-    _clientPeriods[clnt] = msecPeriod;
-    _clientOffsets[clnt] = msecOffset;
+    DLOG(("Looper, client period=%u msec, offset=%u msec",
+                msecPeriod, msecOffset % msecPeriod));
 
-    setupClientMaps();
+    if (!isRunning()) start();
+    else if (_sleepUntil != 0 && info->deadline < _sleepUntil) wake();
 }
 
 void Looper::removeClient(LooperClient* clnt)
 {
-    _clientMutex.lock();
-    map<LooperClient*, unsigned int>::iterator ci = _clientPeriods.find(clnt);
-    if (ci != _clientPeriods.end()) _clientPeriods.erase(ci);
-
-    ci = _clientOffsets.find(clnt);
-    if (ci != _clientOffsets.end()) _clientOffsets.erase(ci);
-
-    setupClientMaps();
+    _clientCond.lock();
+    map<LooperClient*, ClientInfo*>::iterator ci = _clients.find(clnt);
+    if (ci != _clients.end()) {
+        ClientInfo* info = ci->second;
+        _clients.erase(ci);
+        // run() deletes the client it is notifying.
+        if (info == _notifying) {
+            info->removed = true;
+            // Wait for its looperNotify() to return, unless this is
+            // called from it or from another client of this Looper.
+            if (Thread::currentThreadId() != getId())
+                while (_notifying == info) _clientCond.wait();
+        }
+        else {
+            _schedule.erase(info);
+            delete info;
+        }
+    }
 
     bool haveClients = !_clients.empty();
-    _clientMutex.unlock();
+    _clientCond.unlock();
 
     if (!haveClients && isRunning()) {
 	interrupt();
@@ -86,68 +124,43 @@ void Looper::removeClient(LooperClient* clnt)
     }
 }
 
-/* Use Euclidian resursive algorimthm to find greatest common divisor.
- * Thanks to Wikipedia. */
-int Looper::gcd(unsigned int a, unsigned int b)
+void Looper::interrupt()
 {
-    if (b == 0) return a;
-    return gcd(b,a % b);
+    Thread::interrupt();
+    wake();
 }
 
-void Looper::setupClientMaps()
+void Looper::wake()
 {
-    map<LooperClient*, unsigned int>::iterator ci;
-    unsigned int sleepval = 0;
-
-    /* determine greatest common divisor of periods */
-    for (ci = _clientPeriods.begin(); ci != _clientPeriods.end(); ) {
-        unsigned int per = ci->second;
-        if (sleepval == 0) sleepval = per;
-        else sleepval = gcd(sleepval,per);
-        ++ci;
+    try {
+        kill(SIGUSR1);
     }
-    for (ci = _clientOffsets.begin(); ci != _clientOffsets.end(); ) {
-        unsigned int off = ci->second;
-        if (off != 0) sleepval = gcd(sleepval,off);
-        ++ci;
-    }
-
-    _clientDivs.clear();
-    _clientMods.clear();
-    _clients.clear();
-    if (sleepval == 0) return;      // no clients
-
-    for (ci = _clientPeriods.begin(); ci != _clientPeriods.end(); ++ci) {
-        LooperClient* clnt = ci->first;
-	unsigned int per = ci->second;
-	unsigned int offset = _clientOffsets[clnt];
-
-        DLOG(("sleepval=%u, per=%u offset=%u\n",
-                    sleepval, per, offset));
-
-	assert((per % sleepval) == 0);
-	_clientDivs[clnt] = per / sleepval;
-
-	assert((offset % sleepval) == 0);
-	_clientMods[clnt] = offset / sleepval;
-
-        // add client to list so that fastest clients are called
-        // first, in the order that they registered.
-        list<LooperClient*>::iterator cli = _clients.begin();
-        for ( ; cli != _clients.end(); ++cli) {
-            if (_clientPeriods[*cli] > per) break;
-        }
-        _clients.insert(cli, clnt);
+    catch (const n_u::Exception& e) {
+        WLOG(("%s: %s",getName().c_str(),e.what()));
     }
+}
 
-    assert(_clients.size() == _clientPeriods.size());
-    assert(_clients.size() == _clientOffsets.size());
-
-    _sleepMsec = sleepval;
-    ILOG(("Looper, sleepMsec=%d",_sleepMsec));
-
+void Looper::printJitter(ostream& ostr, LooperClient* clnt,
+        const string& name)
+{
+    n_u::Autolock autoLock(_clientCond);
+    map<LooperClient*, ClientInfo*>::iterator ci = _clients.find(clnt);
+    if (ci == _clients.end()) return;
+    LatencyHistogram& jitter = ci->second->jitter;
+    if (jitter.getCount() == 0) return;
+    ostr << name << " looper ";
+    jitter.printSummary(ostr);
+    ostr << ", missed=" << ci->second->missed << '\n';
+    jitter.reset();
+    ci->second->missed = 0;
+}
 
-    if (!isRunning()) start();
+/* Use Euclidian resursive algorimthm to find greatest common divisor.
+ * Thanks to Wikipedia. */
+int Looper::gcd(unsigned int a, unsigned int b)
+{
+    if (b == 0) return a;
+    return gcd(b,a % b);
 }
 
 /*
@@ -155,37 +168,78 @@ void Looper::setupClientMaps()
  */
 int Looper::run() throw(n_u::Exception)
 {
-    if (n_u::sleepUntil(_sleepMsec)) return RUN_OK;
+    // get the existing signal mask
+    sigset_t sigmask;
+    pthread_sigmask(SIG_BLOCK,NULL,&sigmask);
+    // unblock SIGUSR1 in pselect
+    sigdelset(&sigmask,SIGUSR1);
 
-    ILOG(("Looper starting, sleepMsec=%d", _sleepMsec));
+    ILOG(("Looper starting"));
+
+    _clientCond.lock();
     while (!amInterrupted()) {
-	unsigned int tnow =
-            (unsigned int)(n_u::getSystemTime() / USECS_PER_MSEC % MSECS_PER_DAY);
-	unsigned int cntr = (tnow + _sleepMsec / 2) / _sleepMsec;
-
-	_clientMutex.lock();
-	// make a copy of the list
-	list<LooperClient*> clnts(_clients.begin(),_clients.end());
-	_clientMutex.unlock();
-
-        // If more than one client are to be called on this
-        // wakeup, fastest clients are called first, and if
-        // more than one at the same rate, in the order that they
-        // registered with Looper.
-	list<LooperClient*>::const_iterator ci = clnts.begin();
-	for ( ; ci != clnts.end(); ++ci) {
-	    LooperClient* clnt = *ci;
-
-            _clientMutex.lock();
-            unsigned int cdiv = _clientDivs[clnt];
-            unsigned int cmod = _clientMods[clnt];
-            _clientMutex.unlock();
-            VLOG(("cntr=%u, cdiv=%u cmod=%u\n",
-                    cntr, cdiv, cmod));
-            if (cdiv > 0 && (cntr % cdiv) == cmod) clnt->looperNotify();
-	}
-	if (n_u::sleepUntil(_sleepMsec)) return RUN_OK;
+
+        dsm_time_t tnow = n_u::getSystemTime();
+
+        if (_schedule.empty() || (*_schedule.begin())->deadline > tnow) {
+            // Sleep until the next deadline, or until woken.
+            // A SIGUSR1 sent after the unlock is held until pselect.
+            struct timespec sleepTime;
+            struct timespec* sleepp = 0;
+            if (!_schedule.empty()) {
+                _sleepUntil = (*_schedule.begin())->deadline;
+                dsm_time_t dt = _sleepUntil - tnow;
+                sleepTime.tv_sec = dt / USECS_PER_SEC;
+                sleepTime.tv_nsec = (dt % USECS_PER_SEC) * NSECS_PER_USEC;
+                sleepp = &sleepTime;
+            }
+            else _sleepUntil = LONG_LONG_MAX;
+            _clientCond.unlock();
+
+            if (::pselect(0,NULL,NULL,NULL,sleepp,&sigmask) < 0 &&
+                    errno != EINTR) {
+                int ierr = errno;
+                _clientCond.lock();
+                _sleepUntil = 0;
+                _clientCond.unlock();
+                throw n_u::IOException("Looper","pselect",ierr);
+            }
+            _clientCond.lock();
+            _sleepUntil = 0;
+            continue;
+        }
+
+        // Call the client with the earliest deadline, without holding
+        // the lock, so that it can add or remove clients.
+        ClientInfo* info = *_schedule.begin();
+        _schedule.erase(_schedule.begin());
+        _notifying = info;
+        _clientCond.unlock();
+
+        info->jitter.record(tnow - info->deadline);
+        VLOG(("Looper, deadline=%lld, jitter=%lld usec",
+                    info->deadline, tnow - info->deadline));
+        info->client->looperNotify();
+
+        _clientCond.lock();
+        _notifying = 0;
+        _clientCond.broadcast();
+        if (info->removed) {
+            delete info;
+            continue;
+        }
+        // The deadline is already in the future if the client
+        // was re-registered by addClient() during the call.
+        if (info->deadline <= tnow) {
+            info->deadline += info->periodUsec;
+            // If deadlines were missed, skip them.
+            if (info->deadline <= tnow) {
+                info->missed += (tnow - info->deadline) / info->periodUsec + 1;
+                info->setNextDeadline(tnow);
+            }
+        }
+        _schedule.insert(info);
     }
+    _clientCond.unlock();
     return RUN_OK;
 }
-
@@ -29,6 +29,8 @@
 #define NIDAS_CORE_LOOPER_H
 
 #include "LooperClient.h"
+#include "LatencyHistogram.h"
+#include "Sample.h"
 
 #include <nidas/util/Thread.h>
 #include <nidas/util/ThreadSupport.h>
@@ -39,43 +41,73 @@
 #include <sys/select.h>
 #include <assert.h>
 
-#include <list>
+#include <iostream>
+#include <map>
+#include <set>
 
 namespace nidas { namespace core {
 
 /**
- * Looper is a Thread that periodically loops, calling
- * the LooperClient::looperNotify() method of
- * LooperClients at the requested intervals.
+ * Looper is a Thread that calls the LooperClient::looperNotify()
+ * method of LooperClients at their requested periods and offsets.
+ *
+ * The clients are kept in order of their next deadline, and
+ * the Looper sleeps until the earliest one, rather than waking
+ * on a tick which divides all the periods. Registering a client
+ * whose deadline is earlier than the one the Looper is sleeping
+ * for wakes the Looper with a SIGUSR1.
  */
 class Looper : public nidas::util::Thread {
 public:
 
     Looper();
 
+    ~Looper();
+
     /**
      * Add a client to the Looper whose
      * LooperClient::looperNotify() method should be
-     * called every msec number of milliseconds.
-     * @param msecPeriod Time period, in milliseconds.
-     * Since the system nanosleep function is only precise
-     * to about 10 milliseconds, and to reduce system load,
-     * this value is rounded to the nearest 10 milliseconds.
+     * called every msecPeriod number of milliseconds.
+     * The client is called when the system time, in
+     * milliseconds since 1970, modulo msecPeriod, is msecOffset.
+     * @param msecPeriod Time period, in milliseconds. Must be
+     *      at least 5 milliseconds.
+     * @param msecOffset Offset, in milliseconds.
      */
     void addClient(LooperClient *clnt,unsigned int msecPeriod,
             unsigned int msecOffset)
     	throw(nidas::util::InvalidParameterException);
 
     /**
-     * Remove a client from the Looper.
+     * Remove a client from the Looper. After this returns,
+     * looperNotify() of the client is not called again, and, unless
+     * removeClient() is called from the Looper thread, a call which
+     * has started has returned, so that the client can be deleted.
+     * The caller must not hold a lock which looperNotify() takes.
      */
     void removeClient(LooperClient *clnt);
 
+    /**
+     * Interrupt the Looper, waking it if it is sleeping.
+     */
+    void interrupt();
+
     /**
      * Thread function.
      */
     virtual int run() throw(nidas::util::Exception);
 
+    /**
+     * Write a summary of the jitter of the calls to a client,
+     * the system time of a call to looperNotify() minus its
+     * deadline, in microseconds, prefixed by name, and the number
+     * of deadlines which were skipped because a call was later
+     * than a period, then reset the statistics. Nothing is written if
+     * the client is not registered or has not been called.
+     */
+    void printJitter(std::ostream& ostr, LooperClient* clnt,
+        const std::string& name);
+
     /**
      * Utility function for finding greatest common divisor.
      */
@@ -83,20 +115,112 @@ public:
 
 private:
 
-    void setupClientMaps();
+    /**
+     * A registered client and its schedule.
+     */
+    class ClientInfo
+    {
+    public:
+        ClientInfo(LooperClient* clnt, unsigned int msecPeriod,
+                unsigned int msecOffset, unsigned int seq):
+            client(clnt),
+            periodUsec((dsm_time_t)msecPeriod * USECS_PER_MSEC),
+            offsetUsec((dsm_time_t)(msecOffset % msecPeriod) *
+                    USECS_PER_MSEC),
+            deadline(0),sequence(seq),removed(false),jitter(),missed(0)
+        {
+        }
+
+        /**
+         * Set deadline to the first time after tnow
+         * which is offsetUsec past a multiple of periodUsec.
+         */
+        void setNextDeadline(dsm_time_t tnow)
+        {
+            deadline = tnow - (tnow - offsetUsec) % periodUsec + periodUsec;
+        }
+
+        LooperClient* client;
+
+        dsm_time_t periodUsec;
+
+        dsm_time_t offsetUsec;
+
+        dsm_time_t deadline;
+
+        /**
+         * Order of registration.
+         */
+        unsigned int sequence;
+
+        /**
+         * Removed while its looperNotify() was being called.
+         */
+        bool removed;
+
+        LatencyHistogram jitter;
+
+        /**
+         * Number of deadlines skipped.
+         */
+        unsigned int missed;
+
+    private:
+        /** No copying. */
+        ClientInfo(const ClientInfo&);
+
+        /** No assignment. */
+        ClientInfo& operator=(const ClientInfo&);
+    };
+
+    /**
+     * Order of the clients in the schedule: by deadline, then
+     * if more than one client is to be called at the same time,
+     * fastest clients first, in the order that they registered.
+     */
+    class DeadlineLess
+    {
+    public:
+        bool operator()(const ClientInfo* a, const ClientInfo* b) const
+        {
+            if (a->deadline != b->deadline) return a->deadline < b->deadline;
+            if (a->periodUsec != b->periodUsec)
+                return a->periodUsec < b->periodUsec;
+            return a->sequence < b->sequence;
+        }
+    };
+
+    void wake();
+
+    /**
+     * Lock of the clients and schedule, which is signaled when
+     * a looperNotify() returns.
+     */
+    nidas::util::Cond _clientCond;
 
-    nidas::util::Mutex _clientMutex;
+    std::map<LooperClient*, ClientInfo*> _clients;
 
-    std::list<LooperClient*> _clients;
+    std::set<ClientInfo*, DeadlineLess> _schedule;
 
-    std::map<LooperClient*, unsigned int> _clientPeriods;
-    std::map<LooperClient*, unsigned int> _clientOffsets;
+    /**
+     * The client whose looperNotify() is being called,
+     * which is not in _schedule.
+     */
+    ClientInfo* _notifying;
+
+    /**
+     * The deadline that the Looper is sleeping until, 0 if
+     * it is not sleeping.
+     */
+    dsm_time_t _sleepUntil;
 
-    std::map<LooperClient*, unsigned int> _clientDivs;
-    std::map<LooperClient*, unsigned int> _clientMods;
+    unsigned int _sequence;
 
-    unsigned int _sleepMsec;
+    /** No copying. */
+    Looper(const Looper&);
 
+    /** No assignment. */
+    Looper& operator=(const Looper&);
 };
 
 }}	// namespace nidas namespace core
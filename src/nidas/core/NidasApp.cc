@@ -395,6 +395,7 @@ NidasApp(const std::string& name) :
   _endTime(LONG_LONG_MAX),
   _dataFileNames(),
   _sockAddr(),
+  _sampleBusName(),
   _outputFileName(),
   _outputFileLength(0),
   _help(false),
@@ -750,6 +751,9 @@ parseInputs(const std::vector<std::string>& inputs_,
       url = url.substr(5);
       _sockAddr.reset(new nidas::util::UnixSocketAddress(url));
     }
+    else if (url.length() > 4 && !url.compare(0,4,"shm:")) {
+      _sampleBusName = url.substr(4);
+    }
     else
       _dataFileNames.push_back(url);
   }
@@ -974,6 +978,7 @@ updateUsage()
   if (allowSockets)
   {
     oss << "  unix:sockpath       unix socket name\n";
+    oss << "  shm:name            sample bus of a local dsm or dsm_server\n";
   }
   if (allowFiles)
   {
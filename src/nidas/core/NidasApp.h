@@ -793,7 +793,8 @@ public:
     bool
     inputsProvided()
     {
-        return _dataFileNames.size() > 0  || _sockAddr.get();
+        return _dataFileNames.size() > 0  || _sockAddr.get() ||
+            !_sampleBusName.empty();
     }
 
     /**
@@ -1057,6 +1058,17 @@ public:
         return _sockAddr.get();
     }
 
+    /**
+     * If parseInputs() parsed a sample bus specifier, shm:name, then
+     * this method returns the name of the bus, otherwise an empty
+     * string.  See SampleBusChannel.
+     **/
+    const std::string&
+    sampleBusName()
+    {
+        return _sampleBusName;
+    }
+
     /**
      * Return the hostname passed to the Hostname argument, if any,
      * otherwise return the current hostname as returned by gethostname().
@@ -1155,6 +1167,8 @@ private:
 
     nidas::util::auto_ptr<nidas::util::SocketAddress> _sockAddr;
 
+    std::string _sampleBusName;
+
     std::string _outputFileName;
     int _outputFileLength;
 
@@ -34,6 +34,8 @@
 #include "DOMObjectFactory.h"
 #include "SampleOutput.h"
 #include "SampleArchiver.h"
+#include "SampleMatcher.h"
+#include "DSMSensor.h"
 #include "FileSet.h"
 
 #include <nidas/util/Inet4Address.h>
@@ -74,7 +76,7 @@ Project::Project():
     _name(),_sysname(),_configVersion(),_configName(),_flightName(),
     _dictionary(this),_sites(),
     _sensorCatalog(0),_dsmCatalog(0),_serviceCatalog(0),
-    _servers(),_lookupLock(),_dsmById(),_sensorMapLock(),
+    _servers(),_sampleMatcher(0),_lookupLock(),_dsmById(),_sensorMapLock(),
     _sensorById(),_siteByStationNumber(),_siteByName(),
     _usedIds(),_maxSiteNumber(0),_minSiteNumber(0),
     _parameters(),_dataset()
@@ -624,6 +626,80 @@ dsm_sample_id_t Project::getUniqueSampleId(unsigned int dsmid)
     return id;
 }
 
+namespace {
+    /**
+     * Read the id attribute of an element as DSMSensor and SampleTag
+     * do, where a leading 0 means octal and 0x means hex.
+     */
+    bool readIdAttribute(const xercesc::DOMElement* node, unsigned int& id)
+    {
+        XDOMElement xnode(node);
+        const string& idstr = xnode.getAttributeValue("id");
+        if (idstr.length() == 0) return false;
+        istringstream ist(idstr);
+        ist.unsetf(ios::dec);
+        ist >> id;
+        return !ist.fail();
+    }
+
+    void addSampleIds(const xercesc::DOMElement* node, unsigned int sensorId,
+        set<unsigned int>& ids)
+    {
+        xercesc::DOMNode* child;
+        for (child = node->getFirstChild(); child != 0;
+                child=child->getNextSibling())
+        {
+            if (child->getNodeType() != xercesc::DOMNode::ELEMENT_NODE) continue;
+            XDOMElement xchild((xercesc::DOMElement*) child);
+            unsigned int sampleId;
+            if (xchild.getNodeName() == "sample" &&
+                readIdAttribute((xercesc::DOMElement*) child,sampleId))
+                ids.insert(sensorId + sampleId);
+        }
+    }
+}
+
+bool Project::selectSensor(unsigned int dsmid,
+    const xercesc::DOMElement* node, const list<DSMSensor*>& sensors) const
+{
+    if (!_sampleMatcher) return true;
+    if (!_sampleMatcher->matchDSM(dsmid)) return false;
+
+    XDOMElement xnode(node);
+    const xercesc::DOMElement* cnode = 0;
+    const string& idref = xnode.getAttributeValue("IDREF");
+    if (idref.length() > 0 && _sensorCatalog)
+        cnode = _sensorCatalog->find(idref);
+
+    unsigned int sensorId;
+    if (!readIdAttribute(node,sensorId) &&
+        !(cnode && readIdAttribute(cnode,sensorId))) {
+        // An element without a class can only override, by devicename,
+        // a sensor from the dsmcatalog entry, which may have been skipped.
+        const string& devname = xnode.getAttributeValue("devicename");
+        if (devname.length() == 0 ||
+            DSMSensor::getClassName(node,this).length() > 0) return true;
+        list<DSMSensor*>::const_iterator si = sensors.begin();
+        for ( ; si != sensors.end(); ++si)
+            if ((*si)->getDeviceName() == devname) return true;
+        return false;
+    }
+
+    set<unsigned int> ids;
+    ids.insert(sensorId);
+    if (cnode) addSampleIds(cnode,sensorId,ids);
+    addSampleIds(node,sensorId,ids);
+
+    set<unsigned int>::const_iterator ii = ids.begin();
+    for ( ; ii != ids.end(); ++ii) {
+        dsm_sample_id_t id = 0;
+        id = SET_DSM_ID(id,dsmid);
+        id = SET_SHORT_ID(id,*ii);
+        if (_sampleMatcher->match(id)) return true;
+    }
+    return false;
+}
+
 const Parameter* Project::getParameter(const string& name) const
 {
     list<Parameter*>::const_iterator pi;
@@ -54,6 +54,7 @@ class DSMCatalog;
 class ServiceCatalog;
 class FileSet;
 class Parameter;
+class SampleMatcher;
 
 /**
  */
@@ -214,6 +215,31 @@ public:
     void setServiceCatalog(ServiceCatalog* val) { _serviceCatalog = val; }
     ServiceCatalog* getServiceCatalog() const { return _serviceCatalog; }
 
+    /**
+     * Set a SampleMatcher which selects the DSMSensors to be created by
+     * fromDOMElement(), for a program which only reads some samples.
+     * DSMs which cannot match are left without sensors, and a sensor
+     * is only created if its raw sample id, or the id of one of the
+     * samples in its element or sensorcatalog entry, is matched.
+     * The sensor classes of the rest are never loaded. The Project
+     * does not own the SampleMatcher.
+     */
+    void setSampleMatcher(SampleMatcher* val) { _sampleMatcher = val; }
+
+    SampleMatcher* getSampleMatcher() const { return _sampleMatcher; }
+
+    /**
+     * Does the SampleMatcher select a sensor element of a DSM? The
+     * ids are read from the element and its catalog entry without
+     * creating the sensor. True if there is no SampleMatcher, or
+     * the sensor id is not known until the sensor is created.
+     * An element with neither an id nor a class, which overrides
+     * a sensor of a dsmcatalog entry by devicename, is selected
+     * if that sensor is in sensors, the ones created so far.
+     */
+    bool selectSensor(unsigned int dsmid, const xercesc::DOMElement* node,
+        const std::list<DSMSensor*>& sensors) const;
+
     DSMServerIterator getDSMServerIterator() const;
 
     DSMServiceIterator getDSMServiceIterator() const;
@@ -352,6 +378,8 @@ private:
 
     std::list<DSMServer*> _servers;
 
+    SampleMatcher* _sampleMatcher;
+
     mutable nidas::util::Mutex _lookupLock;
 
     mutable std::map<dsm_sample_id_t,const DSMConfig*> _dsmById;
@@ -0,0 +1,333 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#include "RealTimeProfile.h"
+#include "Sample.h"
+#include <nidas/util/Logger.h>
+
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/mman.h>
+#include <malloc.h>
+#include <unistd.h>
+
+using namespace nidas::core;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+RealTimeProfile* RealTimeProfile::_instance = 0;
+
+namespace {
+    const char* roleNames[] = {
+        "sensors", "rawsorter", "procsorter", "looper", "status"
+    };
+
+    /**
+     * Allocate, touch and free nbytes of heap from the malloc arena
+     * of the calling thread, keeping the freed memory in the process
+     * rather than returning it to the system, where it would fault
+     * again.
+     */
+    void touchHeap(size_t nbytes)
+    {
+        ::mallopt(M_TRIM_THRESHOLD,-1);
+        ::mallopt(M_MMAP_MAX,0);
+
+        char* heap = (char*) ::malloc(nbytes);
+        if (!heap) return;
+        long pagesize = ::sysconf(_SC_PAGESIZE);
+        if (pagesize <= 0) pagesize = 4096;
+        // volatile, so that the compiler does not remove the
+        // stores to memory which is freed without being read
+        volatile char* vp = heap;
+        for (size_t i = 0; i < nbytes; i += pagesize) vp[i] = 0;
+        ::free(heap);
+    }
+}
+
+RealTimeProfile::RealTimeProfile():
+    _roles(),_lockMemory(false),_lockMemorySet(false),
+    _prefaultMBytes(0),_prefaultSet(false)
+{
+    // The scheduling that these threads have always had.
+    _roles[SENSORS].policy = n_u::Thread::NU_THREAD_FIFO;
+    _roles[SENSORS].priority = 50;
+    _roles[RAW_SORTER].policy = n_u::Thread::NU_THREAD_FIFO;
+    _roles[RAW_SORTER].priority = 40;
+    _roles[PROC_SORTER].policy = n_u::Thread::NU_THREAD_FIFO;
+    _roles[PROC_SORTER].priority = 30;
+    _roles[LOOPER].policy = n_u::Thread::NU_THREAD_RR;
+    _roles[LOOPER].priority = 51;
+}
+
+RealTimeProfile* RealTimeProfile::getInstance()
+{
+    if (!_instance) _instance = new RealTimeProfile();
+    return _instance;
+}
+
+void RealTimeProfile::deleteInstance()
+{
+    delete _instance;
+    _instance = 0;
+}
+
+const char* RealTimeProfile::getRoleName(Role role)
+{
+    return roleNames[role];
+}
+
+RealTimeProfile::Role RealTimeProfile::getRole(const string& name)
+    throw(n_u::InvalidParameterException)
+{
+    for (int i = 0; i < NUM_ROLES; i++)
+        if (name == roleNames[i]) return (Role) i;
+    throw n_u::InvalidParameterException("realtime","unknown thread role",name);
+}
+
+void RealTimeProfile::setPriority(Role role, const string& spec)
+    throw(n_u::InvalidParameterException)
+{
+    RoleSettings& rs = _roles[role];
+    if (spec == "NONRT") {
+        rs.policy = n_u::Thread::NU_THREAD_OTHER;
+        rs.priority = 0;
+        rs.prioritySet = true;
+        return;
+    }
+
+    string::size_type colon = spec.find(':');
+    if (colon == string::npos)
+        throw n_u::InvalidParameterException(getRoleName(role),
+            "priority (should be RT_FIFO:n, RT_RR:n or NONRT)",spec);
+
+    string policy = spec.substr(0,colon);
+    istringstream ist(spec.substr(colon+1));
+    int priority;
+    ist >> priority;
+    if (ist.fail())
+        throw n_u::InvalidParameterException(getRoleName(role),
+            "cannot read priority",spec);
+
+    if (policy == "RT_FIFO") rs.policy = n_u::Thread::NU_THREAD_FIFO;
+    else if (policy == "RT_RR") rs.policy = n_u::Thread::NU_THREAD_RR;
+    else
+        throw n_u::InvalidParameterException(getRoleName(role),
+            "priority (should be RT_FIFO:n, RT_RR:n or NONRT)",spec);
+    rs.priority = priority;
+    rs.prioritySet = true;
+}
+
+void RealTimeProfile::setCPUs(Role role, const string& cpulist)
+    throw(n_u::InvalidParameterException)
+{
+    set<int> cpus;
+    istringstream ist(cpulist);
+    string range;
+    while (getline(ist,range,',')) {
+        if (range.empty()) continue;
+        int first, last;
+        char dash = 0;
+        istringstream rst(range);
+        rst >> first;
+        if (!rst.fail() && !rst.eof()) {
+            rst >> dash >> last;
+            if (dash != '-') rst.setstate(ios::failbit);
+        }
+        else last = first;
+        if (rst.fail() || first < 0 || last < first)
+            throw n_u::InvalidParameterException(getRoleName(role),
+                "cpus",cpulist);
+        for (int cpu = first; cpu <= last; cpu++) cpus.insert(cpu);
+    }
+    _roles[role].cpus = cpus;
+    _roles[role].cpusSet = true;
+}
+
+void RealTimeProfile::parse(const string& spec)
+    throw(n_u::InvalidParameterException)
+{
+    istringstream ist(spec);
+    string setting;
+    while (getline(ist,setting,';')) {
+        if (setting.empty()) continue;
+        if (setting == "lock") {
+            setLockMemory(true);
+            continue;
+        }
+        string::size_type eq = setting.find('=');
+        if (eq == string::npos)
+            throw n_u::InvalidParameterException("realtime",
+                "setting (should be role=priority@cpus, prefault=MB or lock)",
+                setting);
+        string name = setting.substr(0,eq);
+        string value = setting.substr(eq+1);
+
+        if (name == "prefault") {
+            istringstream vst(value);
+            unsigned int mbytes;
+            vst >> mbytes;
+            if (vst.fail())
+                throw n_u::InvalidParameterException("realtime",name,value);
+            setPrefaultMBytes(mbytes);
+            continue;
+        }
+
+        Role role = getRole(name);
+        string::size_type at = value.find('@');
+        if (at != 0) setPriority(role,value.substr(0,at));
+        if (at != string::npos) setCPUs(role,value.substr(at+1));
+    }
+}
+
+void RealTimeProfile::fromDOMElement(const xercesc::DOMElement* node)
+    throw(n_u::InvalidParameterException)
+{
+    XDOMElement xnode(node);
+    const string& lock = xnode.getAttributeValue("lockMemory");
+    if (lock.length() > 0) {
+        if (lock == "true" || lock == "1") setLockMemory(true);
+        else if (lock == "false" || lock == "0") setLockMemory(false);
+        else throw n_u::InvalidParameterException("realtime",
+            "lockMemory",lock);
+    }
+    const string& prefault = xnode.getAttributeValue("prefault");
+    if (prefault.length() > 0) {
+        istringstream ist(prefault);
+        unsigned int mbytes;
+        ist >> mbytes;
+        if (ist.fail())
+            throw n_u::InvalidParameterException("realtime",
+                "prefault",prefault);
+        setPrefaultMBytes(mbytes);
+    }
+
+    xercesc::DOMNode* child;
+    for (child = node->getFirstChild(); child != 0;
+            child=child->getNextSibling())
+    {
+        if (child->getNodeType() != xercesc::DOMNode::ELEMENT_NODE) continue;
+        XDOMElement xchild((xercesc::DOMElement*) child);
+        const string& elname = xchild.getNodeName();
+        if (elname != "thread")
+            throw n_u::InvalidParameterException("realtime",
+                "unknown element",elname);
+
+        Role role = getRole(xchild.getAttributeValue("role"));
+        const string& priority = xchild.getAttributeValue("priority");
+        if (priority.length() > 0) setPriority(role,priority);
+        const string& cpus = xchild.getAttributeValue("cpus");
+        if (cpus.length() > 0) setCPUs(role,cpus);
+    }
+}
+
+void RealTimeProfile::update(const RealTimeProfile& other)
+{
+    for (int i = 0; i < NUM_ROLES; i++) {
+        const RoleSettings& rs = other._roles[i];
+        if (rs.prioritySet) {
+            _roles[i].policy = rs.policy;
+            _roles[i].priority = rs.priority;
+            _roles[i].prioritySet = true;
+        }
+        if (rs.cpusSet) {
+            _roles[i].cpus = rs.cpus;
+            _roles[i].cpusSet = true;
+        }
+    }
+    if (other._lockMemorySet) setLockMemory(other._lockMemory);
+    if (other._prefaultSet) setPrefaultMBytes(other._prefaultMBytes);
+}
+
+void RealTimeProfile::apply(Role role, n_u::Thread* thread) const
+    throw(n_u::Exception)
+{
+    const RoleSettings& rs = _roles[role];
+    if (rs.policy != n_u::Thread::NU_THREAD_OTHER)
+        thread->setThreadScheduler(rs.policy,rs.priority);
+    if (!rs.cpus.empty())
+        thread->setCPUAffinity(rs.cpus);
+}
+
+void RealTimeProfile::prefault() const
+{
+    static bool done = false;
+    if (done) return;
+    done = true;
+
+    if (_lockMemory) {
+        if (::mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+            WLOG(("mlockall: %s",n_u::Exception::errnoToString(errno).c_str()));
+        else ILOG(("memory locked"));
+    }
+    if (_prefaultMBytes == 0) return;
+
+    size_t nbytes = (size_t)_prefaultMBytes * 1024 * 1024;
+
+    touchHeap(nbytes / 2);
+
+    SamplePool<SampleT<char> >::getInstance()->prefault(nbytes / 4);
+    SamplePool<SampleT<float> >::getInstance()->prefault(nbytes / 4);
+    ILOG(("prefaulted %u MB of heap and sample pools",_prefaultMBytes));
+}
+
+void RealTimeProfile::prefaultThread() const
+{
+    if (_prefaultMBytes == 0) return;
+    touchHeap((size_t)_prefaultMBytes * 1024 * 1024 / 4);
+}
+
+void RealTimeProfile::log() const
+{
+    for (int i = 0; i < NUM_ROLES; i++) {
+        const RoleSettings& rs = _roles[i];
+        ostringstream ost;
+        switch (rs.policy) {
+        case n_u::Thread::NU_THREAD_FIFO:
+            ost << "RT_FIFO:" << rs.priority;
+            break;
+        case n_u::Thread::NU_THREAD_RR:
+            ost << "RT_RR:" << rs.priority;
+            break;
+        default:
+            ost << "NONRT";
+            break;
+        }
+        if (!rs.cpus.empty()) {
+            ost << " cpus=";
+            for (set<int>::const_iterator ci = rs.cpus.begin();
+                ci != rs.cpus.end(); ++ci) {
+                if (ci != rs.cpus.begin()) ost << ',';
+                ost << *ci;
+            }
+        }
+        ILOG(("realtime %s: %s",roleNames[i],ost.str().c_str()));
+    }
+}
@@ -0,0 +1,229 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#ifndef NIDAS_CORE_REALTIMEPROFILE_H
+#define NIDAS_CORE_REALTIMEPROFILE_H
+
+#include "DOMable.h"
+#include <nidas/util/Thread.h>
+#include <nidas/util/InvalidParameterException.h>
+
+#include <string>
+#include <set>
+
+namespace nidas { namespace core {
+
+/**
+ * The real-time configuration of the data path of a dsm process:
+ * the scheduling policy, priority and set of CPUs of each role of
+ * thread, and whether to lock and prefault memory at startup.
+ *
+ * The defaults are the priorities that the threads have always
+ * been given, with no CPU affinity or prefaulting. They are
+ * changed by a \<realtime\> element of a \<dsm\>:
+ * @code
+ *   <realtime lockMemory="true" prefault="16">
+ *       <thread role="sensors" priority="RT_FIFO:60" cpus="1"/>
+ *       <thread role="rawsorter" priority="RT_FIFO:45" cpus="1"/>
+ *   </realtime>
+ * @endcode
+ * or by a specification on the dsm command line, which overrides
+ * the XML:
+ * @code
+ *   --realtime "sensors=RT_FIFO:60@1;rawsorter=RT_FIFO:45@1;prefault=16;lock"
+ * @endcode
+ */
+class RealTimeProfile: public DOMable
+{
+public:
+
+    /**
+     * The roles of threads in a dsm.
+     */
+    enum Role {
+        SENSORS,        // SensorHandler, which reads and timetags samples
+        RAW_SORTER,     // raw sorter, which also writes the archive outputs
+        PROC_SORTER,    // processed sorter
+        LOOPER,         // Looper, which sends sensor prompts
+        STATUS,         // status thread
+        NUM_ROLES
+    };
+
+    RealTimeProfile();
+
+    /**
+     * The profile of this process, which is applied to its threads.
+     */
+    static RealTimeProfile* getInstance();
+
+    static void deleteInstance();
+
+    /**
+     * Name of a role, as used in the XML and on the command line.
+     */
+    static const char* getRoleName(Role role);
+
+    /**
+     * @param name Name of a role.
+     * @throw InvalidParameterException if name is not a role.
+     */
+    static Role getRole(const std::string& name)
+        throw(nidas::util::InvalidParameterException);
+
+    /**
+     * Set the scheduling of a role.
+     * @param spec "RT_FIFO:priority", "RT_RR:priority" or "NONRT".
+     */
+    void setPriority(Role role, const std::string& spec)
+        throw(nidas::util::InvalidParameterException);
+
+    /**
+     * Set the CPUs of a role.
+     * @param cpulist CPU numbers and ranges, separated by commas,
+     *      as in /sys/devices/system/cpu/online, for example "0-1,3".
+     *      An empty list clears the affinity.
+     */
+    void setCPUs(Role role, const std::string& cpulist)
+        throw(nidas::util::InvalidParameterException);
+
+    /**
+     * Set whether to mlockall() in prefault().
+     */
+    void setLockMemory(bool val)
+    {
+        _lockMemory = val;
+        _lockMemorySet = true;
+    }
+
+    bool getLockMemory() const
+    {
+        return _lockMemory;
+    }
+
+    /**
+     * Set the megabytes of sample pool and heap memory to
+     * be allocated and touched in prefault().
+     */
+    void setPrefaultMBytes(unsigned int val)
+    {
+        _prefaultMBytes = val;
+        _prefaultSet = true;
+    }
+
+    unsigned int getPrefaultMBytes() const
+    {
+        return _prefaultMBytes;
+    }
+
+    /**
+     * Parse a command line specification: settings separated by
+     * semicolons, each of which is one of
+     *   role=priority, role=priority\@cpulist, role=\@cpulist,
+     *   prefault=megabytes, lock.
+     */
+    void parse(const std::string& spec)
+        throw(nidas::util::InvalidParameterException);
+
+    void fromDOMElement(const xercesc::DOMElement*)
+        throw(nidas::util::InvalidParameterException);
+
+    /**
+     * Change the settings of this profile which are set in another.
+     */
+    void update(const RealTimeProfile& other);
+
+    /**
+     * Set the scheduling and CPU affinity of a thread for a role.
+     * Call before the thread is started.
+     */
+    void apply(Role role, nidas::util::Thread* thread) const
+        throw(nidas::util::Exception);
+
+    /**
+     * Lock memory if requested, and allocate and touch the
+     * prefault megabytes, a quarter each in the pools of raw and
+     * processed samples and half in the heap. The heap is then not
+     * trimmed, so that the pages stay resident.
+     *
+     * The heap memory is in the malloc arena of the calling thread,
+     * typically the main arena. glibc gives other threads arenas of
+     * their own, so the threads of the data path also call
+     * prefaultThread() when they start.
+     */
+    void prefault() const;
+
+    /**
+     * Allocate and touch a quarter of the prefault megabytes in the
+     * malloc arena of the calling thread, so that the heap allocations
+     * of the thread, such as the samples and set nodes of a sorter,
+     * do not fault. Called at the start of the SensorHandler and
+     * real-time SampleSorter threads. Does nothing if the prefault
+     * size is zero.
+     */
+    void prefaultThread() const;
+
+    /**
+     * Log the settings.
+     */
+    void log() const;
+
+private:
+
+    static RealTimeProfile* _instance;
+
+    struct RoleSettings
+    {
+        RoleSettings():
+            policy(nidas::util::Thread::NU_THREAD_OTHER),priority(0),
+            cpus(),prioritySet(false),cpusSet(false)
+        {
+        }
+
+        enum nidas::util::Thread::SchedPolicy policy;
+
+        int priority;
+
+        std::set<int> cpus;
+
+        bool prioritySet;
+
+        bool cpusSet;
+    };
+
+    RoleSettings _roles[NUM_ROLES];
+
+    bool _lockMemory;
+
+    bool _lockMemorySet;
+
+    unsigned int _prefaultMBytes;
+
+    bool _prefaultSet;
+};
+
+}}	// namespace nidas namespace core
+
+#endif
@@ -222,6 +222,17 @@ void SampleArchiver::flush() throw()
     }
 }
 
+void SampleArchiver::printLatency(ostream& ostr) throw()
+{
+    n_u::Autolock alock(_connectionMutex);
+    set<SampleOutput*>::const_iterator oi = _connectedOutputs.begin();
+    for ( ; oi != _connectedOutputs.end(); ++oi) {
+        SampleOutput* output = *oi;
+        PipelineLatency::printAndReset(ostr,output->getName(),
+            PipelineLatency::OUTPUT,output->getWriteLatencyHistogram());
+    }
+}
+
 void SampleArchiver::printStatus(ostream& ostr,float deltat,int &zebra)
     throw()
 {
@@ -92,6 +92,8 @@ public:
 
     void printStatus(std::ostream&,float deltat,int&) throw();
 
+    void printLatency(std::ostream&) throw();
+
 private:
 
     nidas::util::Mutex _connectionMutex;
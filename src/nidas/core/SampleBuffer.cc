@@ -56,7 +56,7 @@ SampleBuffer::SampleBuffer(const std::string& name,bool raw) :
     _heapSize(0),_heapBlock(false),_heapCond(),
     _discardedSamples(0),_realTimeFutureSamples(0),_discardWarningCount(1000),
     _doFlush(false),_flushed(true),
-    _realTime(false)
+    _realTime(false),_latencyHist()
 {
 #ifndef USE_DEQUE
     _inserterBuf = &_sampleBufs[0];
@@ -238,6 +238,8 @@ int SampleBuffer::run() throw(n_u::Exception)
     struct timespec sleepr = { 0, NSECS_PER_SEC / 100 };
 #endif
 
+    bool timeit = PipelineLatency::enabled();
+
     _sampleBufCond.lock();
 
     for (;;) {
@@ -300,6 +302,8 @@ int SampleBuffer::run() throw(n_u::Exception)
             _sampleBufCond.unlock();
 
 	    ssum += s->getDataByteLength() + s->getHeaderLength();
+            if (timeit)
+                _latencyHist.record(n_u::getSystemTime() - s->getTimeTag());
 	    _source.distribute(s);
 #ifdef TEST_CPU_TIME
             if (ntotal++ == 1000 * 60 * 5) {
@@ -317,6 +321,8 @@ int SampleBuffer::run() throw(n_u::Exception)
 	for (si = _consumerBuf->begin(); si != _consumerBuf->end(); ++si) {
 	    const Sample *s = *si;
 	    ssum += s->getDataByteLength() + s->getHeaderLength();
+            if (timeit)
+                _latencyHist.record(n_u::getSystemTime() - s->getTimeTag());
 	    _source.distribute(s);
 #ifdef TEST_CPU_TIME
             if (ntotal++ == 1000 * 60 * 5) {
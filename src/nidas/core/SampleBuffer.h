@@ -249,6 +249,8 @@ public:
         return 0;
     }
 
+    LatencyHistogram& getLatencyHistogram() { return _latencyHist; }
+
 private:
 
     /**
@@ -334,6 +336,8 @@ private:
      */
     bool _realTime;
 
+    LatencyHistogram _latencyHist;
+
     size_t sizeNoLock() const;
 
     bool emptyNoLock() const;
@@ -0,0 +1,360 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#include "SampleBus.h"
+#include "Sample.h"
+#include "SampleInputHeader.h"
+#include "HeaderSource.h"
+
+#include <nidas/util/Logger.h>
+
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <byteswap.h>
+
+using namespace nidas::core;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+SampleBusWriter* SampleBusWriter::_instance = 0;
+
+namespace {
+
+    const char BUS_MAGIC[8] = { 'N','I','D','A','S','B','U','S' };
+
+    const unsigned int BUS_VERSION = 1;
+
+    inline size_t recordLength(size_t slen)
+    {
+        return (sizeof(SampleBusRecord) + slen + 7) & ~(size_t)7;
+    }
+
+    /*
+     * Loads and stores of the fields which are shared with the other
+     * processes. They are 8 byte aligned, so these are single accesses,
+     * also on 32 bit systems. The ordering between them is done with
+     * __sync_synchronize().
+     */
+    template<class T>
+    inline T load(const T& val)
+    {
+        return __atomic_load_n(&val,__ATOMIC_RELAXED);
+    }
+
+    template<class T>
+    inline void store(T& var, T val)
+    {
+        __atomic_store_n(&var,val,__ATOMIC_RELAXED);
+    }
+}
+
+SampleBusWriter::SampleBusWriter(const string& name, unsigned int mbytes)
+    throw(n_u::IOException):
+    _name(name),_mutex(),_control(0),_ring(0),_mapLength(0),_discarded(0)
+{
+    string path = "/" + name;
+    ::shm_unlink(path.c_str());
+
+    int fd = ::shm_open(path.c_str(),O_RDWR | O_CREAT | O_EXCL,0644);
+    if (fd < 0) throw n_u::IOException(path,"shm_open",errno);
+
+    size_t capacity = (size_t)mbytes * 1024 * 1024;
+    _mapLength = sizeof(SampleBusControl) + capacity;
+
+    // ftruncate zeroes the memory
+    if (::ftruncate(fd,_mapLength) < 0) {
+        int ierr = errno;
+        ::close(fd);
+        ::shm_unlink(path.c_str());
+        throw n_u::IOException(path,"ftruncate",ierr);
+    }
+    void* addr = ::mmap(0,_mapLength,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+    int ierr = errno;
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        ::shm_unlink(path.c_str());
+        throw n_u::IOException(path,"mmap",ierr);
+    }
+    _control = (SampleBusControl*) addr;
+    _ring = (char*) addr + sizeof(SampleBusControl);
+
+    _control->version = BUS_VERSION;
+    _control->capacity = capacity;
+    _control->writerPid = ::getpid();
+    __sync_synchronize();
+    // readers check the magic last
+    ::memcpy(_control->magic,BUS_MAGIC,sizeof(BUS_MAGIC));
+    ILOG(("sample bus %s: %u MB",path.c_str(),mbytes));
+}
+
+SampleBusWriter::~SampleBusWriter()
+{
+    string path = "/" + _name;
+    ::munmap(_control,_mapLength);
+    ::shm_unlink(path.c_str());
+    if (_discarded > 0)
+        WLOG(("sample bus %s: %u samples too large for the ring",
+            path.c_str(),_discarded));
+}
+
+void SampleBusWriter::parseSpec(const string& spec, string& name,
+    unsigned int& mbytes) throw(n_u::InvalidParameterException)
+{
+    string::size_type colon = spec.find(':');
+    name = spec.substr(0,colon);
+    mbytes = 16;
+    if (colon != string::npos) {
+        istringstream ist(spec.substr(colon+1));
+        ist >> mbytes;
+        if (ist.fail() || mbytes == 0 || mbytes > 4096)
+            throw n_u::InvalidParameterException("samplebus",
+                "megabytes (1-4096)",spec);
+    }
+    if (name.empty() || name.find('/') != string::npos)
+        throw n_u::InvalidParameterException("samplebus",
+            "name (without a slash)",spec);
+}
+
+SampleBusWriter* SampleBusWriter::createInstance(const string& spec)
+    throw(n_u::IOException,n_u::InvalidParameterException)
+{
+    if (!_instance) {
+        string name;
+        unsigned int mbytes;
+        parseSpec(spec,name,mbytes);
+        _instance = new SampleBusWriter(name,mbytes);
+    }
+    return _instance;
+}
+
+void SampleBusWriter::deleteInstance()
+{
+    delete _instance;
+    _instance = 0;
+}
+
+void SampleBusWriter::setHeader()
+{
+    SampleInputHeader header;
+    HeaderSource::setDefaults(header);
+    string hdr = header.toString();
+    if (hdr.length() > sizeof(_control->header)) {
+        WLOG(("sample bus %s: header of %zu bytes is too long",
+            _name.c_str(),hdr.length()));
+        return;
+    }
+    n_u::Autolock autolock(_mutex);
+    _control->headerLength = 0;
+    __sync_synchronize();
+    ::memcpy(_control->header,hdr.c_str(),hdr.length());
+    __sync_synchronize();
+    _control->headerLength = hdr.length();
+}
+
+bool SampleBusWriter::receive(const Sample* s) throw()
+{
+    size_t slen = s->getHeaderLength() + s->getDataByteLength();
+    size_t rlen = recordLength(slen);
+    unsigned long long capacity = _control->capacity;
+
+    if (rlen > capacity / 4) {
+        if (!(_discarded++ % 1000))
+            WLOG(("sample bus %s: sample (%d,%d) of %zu bytes is too large",
+                _name.c_str(),s->getDSMId(),s->getSpSId(),slen));
+        return false;
+    }
+
+    n_u::Autolock autolock(_mutex);
+
+    unsigned long long head = load(_control->head);
+    size_t off = head % capacity;
+
+    if (off + rlen > capacity) {
+        // Skip the rest of the ring, marking it if there is room.
+        size_t rest = capacity - off;
+        store(_control->reserved,head + rest);
+        __sync_synchronize();
+        if (rest >= sizeof(SampleBusRecord)) {
+            SampleBusRecord* pad = (SampleBusRecord*)(_ring + off);
+            store(pad->pos,head);
+            store(pad->num,load(_control->nrecords));
+            store(pad->length,0u);
+        }
+        __sync_synchronize();
+        head += rest;
+        store(_control->head,head);
+        off = 0;
+    }
+
+    store(_control->reserved,head + rlen);
+    __sync_synchronize();
+
+    unsigned long long nrecords = load(_control->nrecords);
+    SampleBusRecord* rec = (SampleBusRecord*)(_ring + off);
+    store(rec->pos,head);
+    store(rec->num,nrecords);
+    store(rec->length,(unsigned int)slen);
+    rec->spare = 0;
+
+    char* cp = (char*)(rec + 1);
+#if __BYTE_ORDER == __BIG_ENDIAN
+    SampleHeader header;
+    header.setTimeTag(bswap_64(s->getTimeTag()));
+    header.setDataByteLength(bswap_32(s->getDataByteLength()));
+    header.setRawId(bswap_32(s->getRawId()));
+    ::memcpy(cp,&header,SampleHeader::getSizeOf());
+#else
+    ::memcpy(cp,s->getHeaderPtr(),s->getHeaderLength());
+#endif
+    ::memcpy(cp + s->getHeaderLength(),s->getConstVoidDataPtr(),
+        s->getDataByteLength());
+
+    __sync_synchronize();
+    store(_control->nrecords,nrecords + 1);
+    store(_control->head,head + rlen);
+    return true;
+}
+
+SampleBusReader::SampleBusReader(const string& name)
+    throw(n_u::IOException):
+    _name(name),_control(0),_ring(0),_mapLength(0),
+    _pos(0),_current(0),_num(0),_dropped(0),_overruns(0)
+{
+    string path = "/" + name;
+    int fd = ::shm_open(path.c_str(),O_RDONLY,0);
+    if (fd < 0) throw n_u::IOException(path,"shm_open",errno);
+
+    struct stat statbuf;
+    if (::fstat(fd,&statbuf) < 0) {
+        int ierr = errno;
+        ::close(fd);
+        throw n_u::IOException(path,"fstat",ierr);
+    }
+    _mapLength = statbuf.st_size;
+    if (_mapLength <= sizeof(SampleBusControl)) {
+        ::close(fd);
+        throw n_u::IOException(path,"attach","not a sample bus");
+    }
+
+    void* addr = ::mmap(0,_mapLength,PROT_READ,MAP_SHARED,fd,0);
+    int ierr = errno;
+    ::close(fd);
+    if (addr == MAP_FAILED) throw n_u::IOException(path,"mmap",ierr);
+
+    _control = (const SampleBusControl*) addr;
+    _ring = (const char*) addr + sizeof(SampleBusControl);
+
+    if (::memcmp(_control->magic,BUS_MAGIC,sizeof(BUS_MAGIC)) ||
+        _control->version != BUS_VERSION ||
+        _control->capacity != _mapLength - sizeof(SampleBusControl)) {
+        ::munmap(addr,_mapLength);
+        throw n_u::IOException(path,"attach","not a sample bus");
+    }
+    __sync_synchronize();
+    _pos = load(_control->head);
+    _current = _pos;
+    // The records from head on are numbered from at least this.
+    __sync_synchronize();
+    _num = load(_control->nrecords);
+}
+
+SampleBusReader::~SampleBusReader()
+{
+    ::munmap(const_cast<SampleBusControl*>(_control),_mapLength);
+}
+
+string SampleBusReader::getHeader() const
+{
+    unsigned int len = _control->headerLength;
+    __sync_synchronize();
+    if (len > sizeof(_control->header)) len = 0;
+    return string(_control->header,len);
+}
+
+bool SampleBusReader::writerAlive() const
+{
+    return ::kill(_control->writerPid,0) == 0 || errno == EPERM;
+}
+
+void SampleBusReader::resync()
+{
+    _overruns++;
+    _pos = load(_control->head);
+}
+
+const char* SampleBusReader::next(size_t& len)
+{
+    unsigned long long capacity = _control->capacity;
+
+    for (;;) {
+        unsigned long long head = load(_control->head);
+        __sync_synchronize();
+        if (_pos >= head) return 0;
+
+        if (load(_control->reserved) > _pos + capacity) {
+            resync();
+            continue;
+        }
+
+        size_t off = _pos % capacity;
+        size_t rest = capacity - off;
+        if (rest < sizeof(SampleBusRecord)) {
+            _pos += rest;
+            continue;
+        }
+
+        const SampleBusRecord* rec = (const SampleBusRecord*)(_ring + off);
+        unsigned long long num = load(rec->num);
+        unsigned int length = load(rec->length);
+        _current = _pos;
+
+        // Check the sequence number of the record, and that it
+        // wasn't overwritten while reading its header.
+        if (load(rec->pos) != _pos || length > capacity / 4 || !valid()) {
+            resync();
+            continue;
+        }
+
+        if (length == 0) {
+            _pos += rest;
+            continue;
+        }
+
+        if (num > _num) _dropped += num - _num;
+        _num = num + 1;
+        _pos += recordLength(length);
+        len = length;
+        return (const char*)(rec + 1);
+    }
+}
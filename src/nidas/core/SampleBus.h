@@ -0,0 +1,332 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#ifndef NIDAS_CORE_SAMPLEBUS_H
+#define NIDAS_CORE_SAMPLEBUS_H
+
+#include "SampleClient.h"
+#include <nidas/util/ThreadSupport.h>
+#include <nidas/util/IOException.h>
+#include <nidas/util/InvalidParameterException.h>
+
+#include <string>
+
+namespace nidas { namespace core {
+
+/**
+ * Layout of the shared memory of a sample bus: a ring of samples
+ * written by one process, a SampleBusWriter, and read by any
+ * number of local processes, each with a SampleBusReader.
+ *
+ * The memory, in /dev/shm, starts with a SampleBusControl, of
+ * sizeof(SampleBusControl) bytes, followed by the ring. Positions
+ * in the ring are counted in bytes from the creation of the bus,
+ * and are never reset, so that a position modulo the ring size
+ * is an offset into the ring. Each sample is stored in a record, aligned on
+ * 8 bytes, of a SampleBusRecord followed by the sample in the format
+ * of a NIDAS archive: its header, in little-endian order, and its data.
+ * A record is never split across the end of the ring. If a record
+ * doesn't fit, the rest of the ring is skipped, marked with a
+ * record of zero length if there is room for one.
+ *
+ * The writer never waits for readers. It advances "reserved" before
+ * writing a record and "head" after, and readers check that their
+ * record has not been overwritten by comparing its position with
+ * those values, the sequence numbers of the bus.
+ *
+ * The 64 bit fields which are changed while readers are attached,
+ * the sequence numbers and the fields of a SampleBusRecord, are
+ * accessed with the __atomic builtins, so that a reader on a
+ * 32 bit system does not see half of an update.
+ */
+struct SampleBusControl
+{
+    char magic[8];
+
+    unsigned int version;
+
+    /**
+     * Length of the NIDAS header, with the configuration name and
+     * software version, which is followed by the samples in an archive.
+     */
+    unsigned int headerLength;
+
+    /**
+     * Size of the ring, in bytes.
+     */
+    unsigned long long capacity;
+
+    /**
+     * Position after the last record which has been written.
+     */
+    unsigned long long head;
+
+    /**
+     * Position after the record being written. Data in the ring
+     * before (reserved - capacity) has been overwritten.
+     */
+    unsigned long long reserved;
+
+    /**
+     * Number of records written.
+     */
+    unsigned long long nrecords;
+
+    /**
+     * Process id of the writer.
+     */
+    int writerPid;
+
+    int spare;
+
+    char header[8192 - 64];
+};
+
+struct SampleBusRecord
+{
+    /**
+     * Position of this record in the ring.
+     */
+    unsigned long long pos;
+
+    /**
+     * Number of this record.
+     */
+    unsigned long long num;
+
+    /**
+     * Length of the sample, header plus data, which follows.
+     * 0 marks the unused end of the ring.
+     */
+    unsigned int length;
+
+    unsigned int spare;
+};
+
+/**
+ * A SampleClient which publishes the samples it receives into a sample
+ * bus in shared memory, from which they can be read by local processes
+ * with a SampleBusReader or a SampleBusChannel, without the copy and
+ * socket write for each reader of a SampleOutputStream. Readers do not
+ * slow the writer. A reader which falls more than the size of the ring
+ * behind skips ahead, and counts the samples it missed.
+ *
+ * The dsm and dsm_server processes create one with the --samplebus
+ * option and publish their raw samples to it. It is read with
+ * an input URL of "shm:name", for example "data_dump -i 1,-1 shm:dsm".
+ */
+class SampleBusWriter: public SampleClient
+{
+public:
+
+    /**
+     * Create the shared memory of a bus, /dev/shm/name, replacing
+     * one of the same name.
+     * @param name Name of the bus, without a slash.
+     * @param mbytes Size of the ring in megabytes.
+     */
+    SampleBusWriter(const std::string& name, unsigned int mbytes)
+        throw(nidas::util::IOException);
+
+    /**
+     * Remove the shared memory. Readers which have attached
+     * can read what was written, but are no longer updated.
+     */
+    ~SampleBusWriter();
+
+    /**
+     * The bus of this process, which its pipelines publish to.
+     */
+    static SampleBusWriter* getInstance() { return _instance; }
+
+    /**
+     * Create the bus of this process, from a specification
+     * "name" or "name:megabytes", unless it exists.
+     */
+    static SampleBusWriter* createInstance(const std::string& spec)
+        throw(nidas::util::IOException,
+            nidas::util::InvalidParameterException);
+
+    static void deleteInstance();
+
+    /**
+     * Check a specification of createInstance().
+     */
+    static void parseSpec(const std::string& spec, std::string& name,
+        unsigned int& mbytes)
+        throw(nidas::util::InvalidParameterException);
+
+    const std::string& getName() const { return _name; }
+
+    /**
+     * Set the NIDAS header from the current Project, for readers
+     * which attach after this call.
+     */
+    void setHeader();
+
+    /**
+     * Copy a sample into the ring. Returns false if it is too large.
+     * Concurrent callers are serialized, this is a single
+     * writer with respect to the readers.
+     */
+    bool receive(const Sample* s) throw();
+
+    void flush() throw() {}
+
+    unsigned long long getNumPublished() const
+    {
+        return __atomic_load_n(&_control->nrecords,__ATOMIC_RELAXED);
+    }
+
+private:
+
+    static SampleBusWriter* _instance;
+
+    std::string _name;
+
+    nidas::util::Mutex _mutex;
+
+    SampleBusControl* _control;
+
+    char* _ring;
+
+    size_t _mapLength;
+
+    unsigned int _discarded;
+
+    /** No copying. */
+    SampleBusWriter(const SampleBusWriter&);
+
+    /** No assignment. */
+    SampleBusWriter& operator=(const SampleBusWriter&);
+};
+
+/**
+ * A cursor into a sample bus. The samples are not copied:
+ * next() returns a pointer into the shared memory,
+ * and after using the sample, which must not take longer than the
+ * time for the writer to go once around the ring, valid() should be
+ * checked to see that the writer did not overwrite it meanwhile.
+ */
+class SampleBusReader
+{
+public:
+
+    /**
+     * Attach, read-only, to the shared memory of a bus. Reading starts
+     * at the latest sample.
+     * @throws IOException if the bus doesn't exist.
+     */
+    SampleBusReader(const std::string& name)
+        throw(nidas::util::IOException);
+
+    ~SampleBusReader();
+
+    const std::string& getName() const { return _name; }
+
+    /**
+     * The NIDAS header of the bus.
+     */
+    std::string getHeader() const;
+
+    /**
+     * The next sample, in archive format: a little-endian
+     * SampleHeader followed by the data.
+     * @param len Set to the number of bytes of the sample.
+     * @return 0 if no sample is available.
+     */
+    const char* next(size_t& len);
+
+    /**
+     * Whether the sample most recently returned by next() is still
+     * intact. If not, it should be discarded.
+     */
+    bool valid() const
+    {
+        __sync_synchronize();
+        return __atomic_load_n(&_control->reserved,__ATOMIC_RELAXED) <=
+            _current + _control->capacity;
+    }
+
+    /**
+     * Whether the writing process is still running.
+     */
+    bool writerAlive() const;
+
+    /**
+     * Number of samples which were overwritten before they were read.
+     */
+    unsigned long long getNumDropped() const { return _dropped; }
+
+    /**
+     * Number of times this reader fell behind by more than the ring.
+     */
+    unsigned int getNumOverruns() const { return _overruns; }
+
+private:
+
+    /**
+     * Skip to the latest sample, after falling behind.
+     */
+    void resync();
+
+    std::string _name;
+
+    const SampleBusControl* _control;
+
+    const char* _ring;
+
+    size_t _mapLength;
+
+    /**
+     * Position of the next record.
+     */
+    unsigned long long _pos;
+
+    /**
+     * Position of the record returned by next().
+     */
+    unsigned long long _current;
+
+    /**
+     * Number of the next record expected.
+     */
+    unsigned long long _num;
+
+    unsigned long long _dropped;
+
+    unsigned int _overruns;
+
+    /** No copying. */
+    SampleBusReader(const SampleBusReader&);
+
+    /** No assignment. */
+    SampleBusReader& operator=(const SampleBusReader&);
+};
+
+}}	// namespace nidas namespace core
+
+#endif
@@ -0,0 +1,122 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#include "SampleBusChannel.h"
+
+#include <nidas/util/EOFException.h>
+#include <nidas/util/Logger.h>
+
+#include <cstring>
+#include <ctime>
+
+using namespace nidas::core;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+SampleBusChannel::SampleBusChannel(const string& name)
+    throw(n_u::IOException):
+    _reader(new SampleBusReader(name)),_name("shm:" + name),
+    _header(),_headerOffset(0),_pending(),_pendingOffset(0),
+    _overruns(0),_discarded(0),_newInput(true)
+{
+    _header = _reader->getHeader();
+}
+
+SampleBusChannel::~SampleBusChannel()
+{
+    if (getNumDropped() > 0)
+        WLOG(("%s: %llu samples dropped",getName().c_str(),
+            getNumDropped()));
+    delete _reader;
+}
+
+SampleBusChannel* SampleBusChannel::clone() const
+{
+    return new SampleBusChannel(_reader->getName());
+}
+
+size_t SampleBusChannel::read(void* buf, size_t len)
+    throw(n_u::IOException)
+{
+    char* cp = (char*) buf;
+
+    if (_headerOffset < _header.length()) {
+        size_t l = std::min(len,_header.length() - _headerOffset);
+        ::memcpy(cp,_header.c_str() + _headerOffset,l);
+        _headerOffset += l;
+        return l;
+    }
+    _newInput = false;
+
+    // 1/100th of a second, up to a second.
+    struct timespec slp = { 0, 10 * NSECS_PER_MSEC };
+    for (int nsleep = 0; ; nsleep++) {
+
+        if (_pendingOffset < _pending.size()) {
+            size_t l = std::min(len,_pending.size() - _pendingOffset);
+            ::memcpy(cp,&_pending[_pendingOffset],l);
+            _pendingOffset += l;
+            return l;
+        }
+
+        size_t nout = 0;
+        const char* samp;
+        size_t slen;
+        while (nout < len && (samp = _reader->next(slen))) {
+            if (slen <= len - nout) {
+                ::memcpy(cp + nout,samp,slen);
+                if (_reader->valid()) nout += slen;
+                else _discarded++;
+            }
+            else {
+                _pending.assign(samp,samp + slen);
+                _pendingOffset = 0;
+                if (!_reader->valid()) {
+                    _pending.clear();
+                    _discarded++;
+                }
+                break;
+            }
+        }
+
+        if (_reader->getNumOverruns() != _overruns) {
+            _overruns = _reader->getNumOverruns();
+            WLOG(("%s: reader fell behind, %llu samples dropped",
+                getName().c_str(),getNumDropped()));
+        }
+
+        if (nout > 0) return nout;
+        if (_pendingOffset < _pending.size()) continue;
+
+        if (nsleep == 100) {
+            if (!_reader->writerAlive())
+                throw n_u::EOFException(getName(),"read");
+            return 0;
+        }
+        if (::nanosleep(&slp,0) < 0) return 0;
+    }
+}
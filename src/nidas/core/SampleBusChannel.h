@@ -0,0 +1,166 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#ifndef NIDAS_CORE_SAMPLEBUSCHANNEL_H
+#define NIDAS_CORE_SAMPLEBUSCHANNEL_H
+
+#include "IOChannel.h"
+#include "SampleBus.h"
+
+#include <string>
+#include <vector>
+
+namespace nidas { namespace core {
+
+/**
+ * An IOChannel which reads a sample bus, so that a SampleInputStream
+ * can read the samples published by a local dsm or dsm_server as
+ * it would read an archive: the NIDAS header of the bus, followed
+ * by the samples. Each sample is copied once, from the shared
+ * memory into the buffer of the read.
+ *
+ * Reads wait for samples by polling the bus, so that the writer
+ * needn't wake readers. A read returns 0 if there are no samples
+ * for a second, or if it was interrupted by a signal, which a
+ * SampleInputStream treats as no data. An EOFException is
+ * thrown if the writer has exited.
+ */
+class SampleBusChannel: public IOChannel {
+
+public:
+
+    /**
+     * Attach to the bus.
+     * @param name Name of the bus, as given to SampleBusWriter.
+     */
+    SampleBusChannel(const std::string& name)
+        throw(nidas::util::IOException);
+
+    ~SampleBusChannel();
+
+    /**
+     * Attaches another reader to the bus.
+     */
+    SampleBusChannel* clone() const;
+
+    void requestConnection(IOChannelRequester* rqstr)
+    	throw(nidas::util::IOException)
+    {
+        rqstr->connected(this);
+    }
+
+    IOChannel* connect() throw(nidas::util::IOException)
+    {
+	return this;
+    }
+
+    void setNonBlocking(bool) throw (nidas::util::IOException) {}
+
+    bool isNonBlocking() const throw (nidas::util::IOException)
+    {
+        return false;
+    }
+
+    bool isNewInput() const { return _newInput; }
+
+    size_t getBufferSize() const throw() { return 65536; }
+
+    size_t read(void* buf, size_t len) throw (nidas::util::IOException);
+
+    size_t write(const void*, size_t) throw (nidas::util::IOException)
+    {
+        throw nidas::util::IOException(getName(),"write","read-only");
+    }
+
+    size_t write(const struct iovec*, int) throw (nidas::util::IOException)
+    {
+        throw nidas::util::IOException(getName(),"write","read-only");
+    }
+
+    void close() throw (nidas::util::IOException) {}
+
+    int getFd() const { return -1; }
+
+    const std::string& getName() const { return _name; }
+
+    /**
+     * Number of samples which were overwritten by the writer before
+     * they were read, or while they were being copied.
+     */
+    unsigned long long getNumDropped() const
+    {
+        return _reader->getNumDropped() + _discarded;
+    }
+
+    void setName(const std::string& val) { _name = val; }
+
+    void fromDOMElement(const xercesc::DOMElement*)
+	throw(nidas::util::InvalidParameterException)
+    {
+        throw nidas::util::InvalidParameterException(
+		"SampleBusChannel::fromDOMElement not supported");
+    }
+
+private:
+
+    SampleBusReader* _reader;
+
+    std::string _name;
+
+    /**
+     * NIDAS header, and how much of it has been read.
+     */
+    std::string _header;
+
+    size_t _headerOffset;
+
+    /**
+     * A sample which did not fit in a read, and how much of it
+     * has been read.
+     */
+    std::vector<char> _pending;
+
+    size_t _pendingOffset;
+
+    unsigned int _overruns;
+
+    /**
+     * Samples discarded because they were overwritten during the copy.
+     */
+    unsigned long long _discarded;
+
+    bool _newInput;
+
+    /** No copying. */
+    SampleBusChannel(const SampleBusChannel&);
+
+    /** No assignment. */
+    SampleBusChannel& operator=(const SampleBusChannel&);
+};
+
+}}	// namespace nidas namespace core
+
+#endif
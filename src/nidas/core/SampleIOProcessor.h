@@ -238,6 +238,12 @@ public:
 
     virtual void printStatus(std::ostream&,float,int&) throw() {}
 
+    /**
+     * Write the write latency summaries of the connected outputs,
+     * as done by PipelineLatency::printAndReset().
+     */
+    virtual void printLatency(std::ostream&) throw() {}
+
     virtual void init(dsm_time_t) throw()
     {
     }
@@ -0,0 +1,187 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#ifndef NIDAS_CORE_SAMPLEIDMAP_H
+#define NIDAS_CORE_SAMPLEIDMAP_H
+
+#include "Sample.h"
+
+#include <vector>
+#include <utility>
+
+namespace nidas { namespace core {
+
+/**
+ * A map from sample ids to values, for the lookups that are done
+ * on each sample, which are otherwise done with a
+ * std::map<dsm_sample_id_t,T>.
+ *
+ * The values are kept in a vector, in the order they were added, and
+ * the index of each value, its slot, is found with a two level table:
+ * the first level is indexed by the DSM id of the sample id, the second
+ * by the sensor+sample id, offset by the smallest sensor+sample id of
+ * that DSM. The sensor+sample ids of a DSM are usually within a range
+ * of a few hundred, so the tables are small, and a find() is two array
+ * reads and a bounds check, rather than a tree search.
+ *
+ * The interface is a subset of std::map, so that it can replace one
+ * with few changes: find(), end(), operator[], begin(), size(), clear(),
+ * and iterators which point to a std::pair, with the id in first
+ * and the value in second. Values cannot be erased individually.
+ * Iteration is in order of insertion, not in order of sample id.
+ *
+ * Like a std::vector, adding an id invalidates iterators, pointers
+ * and references to the values. It is intended for read-mostly
+ * use: the ids are added once the SampleTags are known, and
+ * then looked up for each sample.  It does no locking.
+ */
+template<typename T>
+class SampleIdMap
+{
+public:
+
+    typedef std::pair<dsm_sample_id_t, T> value_type;
+
+    typedef typename std::vector<value_type>::iterator iterator;
+
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+    SampleIdMap(): _values(), _tables() {}
+
+    iterator begin() { return _values.begin(); }
+
+    iterator end() { return _values.end(); }
+
+    const_iterator begin() const { return _values.begin(); }
+
+    const_iterator end() const { return _values.end(); }
+
+    size_t size() const { return _values.size(); }
+
+    bool empty() const { return _values.empty(); }
+
+    void clear()
+    {
+        _values.clear();
+        _tables.clear();
+    }
+
+    /**
+     * Return an iterator pointing to the value for a sample id,
+     * or end() if the id is not in the map. Only the DSM and
+     * sensor+sample fields of id are used, the sample type is ignored.
+     */
+    iterator find(dsm_sample_id_t id)
+    {
+        int slot = getSlot(id);
+        if (slot < 0) return _values.end();
+        return _values.begin() + slot;
+    }
+
+    const_iterator find(dsm_sample_id_t id) const
+    {
+        int slot = getSlot(id);
+        if (slot < 0) return _values.end();
+        return _values.begin() + slot;
+    }
+
+    /**
+     * Return a reference to the value for a sample id,
+     * adding a default value if the id is not in the map.
+     */
+    T& operator[](dsm_sample_id_t id)
+    {
+        int slot = getSlot(id);
+        if (slot < 0) slot = insert(id);
+        return _values[slot].second;
+    }
+
+private:
+
+    /**
+     * Second level table, for one DSM.
+     */
+    struct Table
+    {
+        Table(): base(0), slots() {}
+
+        /**
+         * Sensor+sample id of slots[0].
+         */
+        unsigned int base;
+
+        /**
+         * Index into _values for sensor+sample ids from base
+         * to base + slots.size() - 1, or -1 if an id is not in the map.
+         */
+        std::vector<int> slots;
+    };
+
+    int getSlot(dsm_sample_id_t id) const
+    {
+        unsigned int dsmid = GET_DSM_ID(id);
+        if (dsmid >= _tables.size()) return -1;
+        const Table& table = _tables[dsmid];
+        // if the id is less than base, this wraps to a large number
+        unsigned int i = GET_SPS_ID(id) - table.base;
+        if (i >= table.slots.size()) return -1;
+        return table.slots[i];
+    }
+
+    int insert(dsm_sample_id_t id)
+    {
+        id = GET_FULL_ID(id);
+        unsigned int dsmid = GET_DSM_ID(id);
+        unsigned int spsid = GET_SPS_ID(id);
+
+        if (dsmid >= _tables.size()) _tables.resize(dsmid + 1);
+        Table& table = _tables[dsmid];
+
+        if (table.slots.empty()) {
+            table.base = spsid;
+            table.slots.push_back(-1);
+        }
+        else if (spsid < table.base) {
+            table.slots.insert(table.slots.begin(), table.base - spsid, -1);
+            table.base = spsid;
+        }
+        else if (spsid - table.base >= table.slots.size())
+            table.slots.resize(spsid - table.base + 1, -1);
+
+        int slot = _values.size();
+        _values.push_back(value_type(id, T()));
+        table.slots[spsid - table.base] = slot;
+        return slot;
+    }
+
+    std::vector<value_type> _values;
+
+    std::vector<Table> _tables;
+};
+
+}}	// namespace nidas namespace core
+
+#endif
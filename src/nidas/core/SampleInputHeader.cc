@@ -51,6 +51,8 @@ const SampleInputHeader::headerField SampleInputHeader::headers[] = {
 	    &SampleInputHeader::getConfigName,false },
     { "config version:",15, &SampleInputHeader::setConfigVersion,
 	    &SampleInputHeader::getConfigVersion,false },
+    { "sample encoding:",16, &SampleInputHeader::setSampleEncoding,
+	    &SampleInputHeader::getSampleEncoding,false },
     // old
     { "site name:",10, &SampleInputHeader::setSystemName,
 	    &SampleInputHeader::getSystemName,true },
@@ -81,7 +83,7 @@ const int SampleInputHeader::HEADER_BUF_LEN = 256;
 
 SampleInputHeader::SampleInputHeader():
     _archiveVersion(),_softwareVersion(),_projectName(),_systemName(),
-    _configName(),_configVersion(),_dummy(),
+    _configName(),_configVersion(),_sampleEncoding(),_dummy(),
     _minMagicLen(INT_MAX), _imagic(-1),
     _endTag(-1),_tagMatch(-1),
     _size(0),
@@ -110,7 +112,8 @@ SampleInputHeader::SampleInputHeader(const SampleInputHeader& x):
     _projectName(x._projectName),
     _systemName(x._systemName),
     _configName(x._configName),
-    _configVersion(x._configVersion),_dummy(),
+    _configVersion(x._configVersion),
+    _sampleEncoding(x._sampleEncoding),_dummy(),
     _minMagicLen(x._minMagicLen), _imagic(x._imagic),
     _endTag(x._endTag),_tagMatch(x._tagMatch),
     _size(x._size),
@@ -130,6 +133,7 @@ SampleInputHeader& SampleInputHeader::operator =(const SampleInputHeader& x)
         _systemName = x._systemName;
         _configName = x._configName;
         _configVersion = x._configVersion;
+        _sampleEncoding = x._sampleEncoding;
         _minMagicLen = x._minMagicLen;
         _imagic = x._imagic;
         _endTag = x._endTag;
@@ -158,6 +162,8 @@ bool SampleInputHeader::parse(IOStream* iostream)
         switch (_stage) {
         case PARSE_START:
             _size = 0;
+            // not in the headers of the default encoding
+            _sampleEncoding.clear();
             _stage = PARSE_MAGIC;
             // fallthrough
         case PARSE_MAGIC:
@@ -345,6 +351,9 @@ string SampleInputHeader::toString() const
         int nc = ::strlen(str);
         if (headers[itag].getFunc) {
             const string& val = (this->*headers[itag].getFunc)();
+            if (val.empty() &&
+                headers[itag].getFunc == &SampleInputHeader::getSampleEncoding)
+                continue;
             ost << str << ' ' << val << '\n';
         }
         else {      // end tag
@@ -362,7 +371,9 @@ string SampleInputHeader::toString() const
 size_t SampleInputHeader::write(SampleOutput* output) const
 	throw(n_u::IOException)
 {
-    string hdr = toString();
+    SampleInputHeader header(*this);
+    header.setSampleEncoding(output->getSampleEncoding());
+    string hdr = header.toString();
     return output->write(hdr.c_str(),hdr.length());
 }
 
@@ -79,6 +79,10 @@ public:
      */
     std::string toString() const;
 
+    /**
+     * Write the header to a SampleOutput, with the sample encoding
+     * of the output.
+     */
     size_t write(SampleOutput* output) const throw(nidas::util::IOException);
 
     size_t write(IOStream* iostream) const throw(nidas::util::IOException);
@@ -101,6 +105,17 @@ public:
     void setConfigVersion(const std::string& val) { _configVersion = val; }
     const std::string& getConfigVersion() const { return _configVersion; }
 
+    /**
+     * Encoding of the samples which follow the header, empty for the
+     * default, a full SampleHeader in front of the data of each sample,
+     * or CompactHeaderEncoder::ENCODING. It is only written to the
+     * header if it isn't empty, so that a program which doesn't know
+     * of the field fails to read the header, rather than misreading
+     * the samples, and other headers are unchanged.
+     */
+    void setSampleEncoding(const std::string& val) { _sampleEncoding = val; }
+    const std::string& getSampleEncoding() const { return _sampleEncoding; }
+
 protected:
 
     bool parseMagic(IOStream* iostream) throw(nidas::util::ParseException);
@@ -151,6 +166,8 @@ private:
 
     std::string _configVersion;
 
+    std::string _sampleEncoding;
+
     std::string _dummy;
 
     /**
@@ -154,6 +154,29 @@ match(const Sample* samp)
 }
 
 
+bool
+SampleMatcher::
+matchDSM(int dsmid)
+{
+  bool all_excludes = true;
+  range_matches_t::iterator ri;
+  for (ri = _ranges.begin(); ri != _ranges.end(); ++ri)
+  {
+    all_excludes = all_excludes && (!ri->include);
+    if (ri->dsm1 == -1 || (dsmid >= ri->dsm1 && dsmid <= ri->dsm2))
+    {
+      if (ri->include)
+        return true;
+      // All the samples from this DSM are excluded.
+      if (ri->sid1 == -1)
+        return false;
+    }
+  }
+  // Implicitly included if there are no ranges or only excluded ranges.
+  return all_excludes;
+}
+
+
 bool
 SampleMatcher::
 exclusiveMatch()
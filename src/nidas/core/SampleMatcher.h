@@ -74,6 +74,15 @@ public:
     bool
     match(const Sample* samp);
 
+    /**
+     * Return true if any sample ID from the given DSM could satisfy the
+     * range criteria, so that the configuration of a DSM for which this
+     * returns false need not be created.  This errs towards true: a DSM
+     * whose samples are only partially excluded is a possible match.
+     **/
+    bool
+    matchDSM(int dsmid);
+
     /**
      * Return true if this matcher can only match a single ID pair
      * (DSM,SID), meaning only one range has been added and it specifies
@@ -48,7 +48,8 @@ SampleOutputBase::SampleOutputBase():
     _headerSource(0),_dsm(0),
     _nsamplesDiscarded(0),_parameters(),_constParameters(),
     _sourceTags(),
-    _original(this), _latency(0.25),_reconnectDelaySecs(-2)
+    _original(this), _latency(0.25),_reconnectDelaySecs(-2),
+    _writeLatency()
 {
 }
 
@@ -61,7 +62,8 @@ SampleOutputBase::SampleOutputBase(IOChannel* ioc,SampleConnectionRequester* rqs
     _headerSource(0),_dsm(0),
     _nsamplesDiscarded(0),_parameters(),_constParameters(),
     _sourceTags(),
-    _original(this), _latency(0.25),_reconnectDelaySecs(-2)
+    _original(this), _latency(0.25),_reconnectDelaySecs(-2),
+    _writeLatency()
 {
 }
 
@@ -77,7 +79,8 @@ SampleOutputBase::SampleOutputBase(SampleOutputBase& x,IOChannel* ioc):
     _headerSource(x._headerSource),_dsm(x._dsm),
     _nsamplesDiscarded(0),_parameters(),_constParameters(),
     _sourceTags(),
-    _original(&x),_latency(x._latency),_reconnectDelaySecs(x._reconnectDelaySecs)
+    _original(&x),_latency(x._latency),_reconnectDelaySecs(x._reconnectDelaySecs),
+    _writeLatency()
 {
     _iochan->setDSMConfig(getDSMConfig());
 
@@ -304,6 +307,13 @@ size_t SampleOutputBase::write(const void* buf, size_t len)
     return lout;
 }
 
+void SampleOutputBase::setSampleEncoding(const string& val)
+	throw(n_u::InvalidParameterException)
+{
+    if (val.length() > 0 && val != "full")
+        throw n_u::InvalidParameterException(getName(),"encoding",val);
+}
+
 void SampleOutputBase::fromDOMElement(const xercesc::DOMElement* node)
 	throw(n_u::InvalidParameterException)
 {
@@ -338,6 +348,8 @@ void SampleOutputBase::fromDOMElement(const xercesc::DOMElement* node)
 		    	aname,aval);
 		setLatency(val);
 	    }
+	    else if (aname == "encoding")
+		setSampleEncoding(aval);
 	    else throw n_u::InvalidParameterException(
 	    	string("SampleOutputBase: unrecognized attribute: ") + aname);
 	}
@@ -33,6 +33,7 @@
 #include "IOStream.h"
 #include "HeaderSource.h"
 #include "ConnectionRequester.h"
+#include "LatencyHistogram.h"
 
 // #include <nidas/util/McSocket.h>
 
@@ -135,6 +136,21 @@ public:
 
     virtual float getLatency() const = 0;
 
+    /**
+     * Set the encoding of the samples, as in the sample encoding
+     * of a SampleInputHeader.
+     */
+    virtual void setSampleEncoding(const std::string& val)
+    	throw(nidas::util::InvalidParameterException) = 0;
+
+    virtual std::string getSampleEncoding() const = 0;
+
+    /**
+     * Histogram of the time taken to write samples, updated
+     * if PipelineLatency::enabled().
+     */
+    virtual LatencyHistogram& getWriteLatencyHistogram() = 0;
+
 protected:
 
     virtual SampleOutput* clone(IOChannel* iochannel) = 0;
@@ -295,6 +311,17 @@ public:
 
     float getLatency() const { return _latency; }
 
+    /**
+     * SampleOutputBase only supports the default encoding,
+     * a full SampleHeader on each sample, which is "" or "full".
+     */
+    void setSampleEncoding(const std::string& val)
+    	throw(nidas::util::InvalidParameterException);
+
+    std::string getSampleEncoding() const { return ""; }
+
+    LatencyHistogram& getWriteLatencyHistogram() { return _writeLatency; }
+
 protected:
     /**
      * Protected copy constructor, with a new, connected IOChannel.
@@ -365,6 +392,8 @@ private:
 
     int _reconnectDelaySecs;
 
+    LatencyHistogram _writeLatency;
+
     /**
      * No copy.
      */
@@ -28,6 +28,7 @@
 #include "SampleBuffer.h"
 #include "SampleSorter.h"
 #include "DSMSensor.h"
+#include "RealTimeProfile.h"
 
 #include <nidas/util/Logger.h>
 
@@ -52,10 +53,14 @@ SamplePipeline::SamplePipeline() :
         _rawHeapMax (100000000),
         _procHeapMax(100000000),
 #endif
+        _rawSorterLengthMin(0.0),_rawSorterLengthMax(0.0),
+        _procSorterLengthMin(0.0),_procSorterLengthMax(0.0),
+        _rawHeapMin(1000000),_procHeapMin(1000000),
         _heapBlock(false),
         _keepStats(false),
         _rawLateSampleCacheSize(0),
-        _procLateSampleCacheSize(0)
+        _procLateSampleCacheSize(0),
+        _rawSorterShards(1)
 {
 }
 
@@ -119,7 +124,15 @@ void SamplePipeline::rawinit()
     n_u::Autolock autolock(_rawMutex);
     if (!_rawSorter) {
         if (getRawSorterLength() > 0) {
-            _rawSorter = new SampleSorter(_name + "RawSorter",true);
+            SampleSorter* sorter = new SampleSorter(_name + "RawSorter",true);
+            sorter->setNumShards(getRawSorterShards());
+            if (getRawSorterLengthMax() > 0) {
+                sorter->setAdaptive(true);
+                sorter->setLengthBounds(getRawSorterLengthMin(),
+                    getRawSorterLengthMax());
+                sorter->setHeapMaxBounds(getRawHeapMin(),getRawHeapMax());
+            }
+            _rawSorter = sorter;
             _rawSorter->setLengthSecs(getRawSorterLength());
             _rawSorter->setLateSampleCacheSize(getRawLateSampleCacheSize());
         }
@@ -136,7 +149,8 @@ void SamplePipeline::rawinit()
               _rawSorter->getKeepStats()) << _rawSorter->getRealTime());
         if (getRealTime())
         {
-            _rawSorter->setRealTimeFIFOPriority(40);
+            RealTimeProfile::getInstance()->apply(
+                RealTimeProfile::RAW_SORTER,_rawSorter);
         }
         _rawSorter->start();
     }
@@ -147,7 +161,14 @@ void SamplePipeline::procinit()
     n_u::Autolock autolock(_procMutex);
     if (!_procSorter) {
         if (getProcSorterLength() > 0) {
-            _procSorter = new SampleSorter(_name + "ProcSorter",false);
+            SampleSorter* sorter = new SampleSorter(_name + "ProcSorter",false);
+            if (getProcSorterLengthMax() > 0) {
+                sorter->setAdaptive(true);
+                sorter->setLengthBounds(getProcSorterLengthMin(),
+                    getProcSorterLengthMax());
+                sorter->setHeapMaxBounds(getProcHeapMin(),getProcHeapMax());
+            }
+            _procSorter = sorter;
             _procSorter->setLengthSecs(getProcSorterLength());
             _procSorter->setLateSampleCacheSize(getProcLateSampleCacheSize());
         }
@@ -164,12 +185,57 @@ void SamplePipeline::procinit()
               _procSorter->getKeepStats()) << _procSorter->getRealTime());
         if (getRealTime())
         {
-            _procSorter->setRealTimeFIFOPriority(30);
+            RealTimeProfile::getInstance()->apply(
+                RealTimeProfile::PROC_SORTER,_procSorter);
         }
         _procSorter->start();
     }
 }
 
+void SamplePipeline::printLatency(std::ostream& ostr)
+{
+    _rawMutex.lock();
+    if (_rawSorter)
+        PipelineLatency::printAndReset(ostr,_rawSorter->getName(),
+            PipelineLatency::RAW_SORT,_rawSorter->getLatencyHistogram());
+    _rawMutex.unlock();
+
+    _procMutex.lock();
+    if (_procSorter)
+        PipelineLatency::printAndReset(ostr,_procSorter->getName(),
+            PipelineLatency::PROC_SORT,_procSorter->getLatencyHistogram());
+    _procMutex.unlock();
+}
+
+namespace {
+    void printSorter(std::ostream& ostr, SampleThread* thread)
+    {
+        ostr << thread->getName() <<
+            ": length=" << thread->getLengthSecs() <<
+            " heapMax=" << thread->getHeapMax() <<
+            " heapSize=" << thread->getHeapSize() <<
+            " discarded=" << thread->getNumDiscardedSamples();
+        SampleSorter* sorter = dynamic_cast<SampleSorter*>(thread);
+        if (sorter) {
+            ostr << " late=" << sorter->getNumEarlySamples() <<
+                " late/s=" << sorter->getLateSampleRate();
+            if (sorter->getAdaptive()) ostr << " adaptive";
+        }
+        ostr << '\n';
+    }
+}
+
+void SamplePipeline::printSorterStatus(std::ostream& ostr)
+{
+    _rawMutex.lock();
+    if (_rawSorter) printSorter(ostr,_rawSorter);
+    _rawMutex.unlock();
+
+    _procMutex.lock();
+    if (_procSorter) printSorter(ostr,_procSorter);
+    _procMutex.unlock();
+}
+
 void SamplePipeline::connect(SampleSource* src) throw()
 {
     rawinit();
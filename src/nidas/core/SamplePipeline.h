@@ -275,6 +275,19 @@ public:
         return _procSorter->getNumFutureSamples();
     }
 
+    /**
+     * Write the latency summaries of the raw and processed sorters,
+     * as done by PipelineLatency::printAndReset().
+     */
+    void printLatency(std::ostream& ostr);
+
+    /**
+     * Write a line for each sorter with its length, heapMax, heap size,
+     * and the rate of late samples, which arrived before the
+     * sorter window. See SampleSorter::getLateSampleRate().
+     */
+    void printSorterStatus(std::ostream& ostr);
+
     /**
      * Set length of raw SampleSorter, in seconds.
      */
@@ -301,6 +314,37 @@ public:
         return _procSorterLength;
     }
 
+    /**
+     * Set the bounds of the length of the raw SampleSorter, in seconds.
+     * If maxSecs is greater than zero the sorter adapts its length,
+     * and its heapMax between getRawHeapMin() and getRawHeapMax(),
+     * to the data, starting at getRawSorterLength().
+     * See SampleSorter::setAdaptive(). Default: 0, 0.
+     */
+    void setRawSorterLengthBounds(float minSecs, float maxSecs)
+    {
+        _rawSorterLengthMin = minSecs;
+        _rawSorterLengthMax = maxSecs;
+    }
+
+    float getRawSorterLengthMin() const { return _rawSorterLengthMin; }
+
+    float getRawSorterLengthMax() const { return _rawSorterLengthMax; }
+
+    /**
+     * Set the bounds of the length of the processed SampleSorter,
+     * in seconds. See setRawSorterLengthBounds().
+     */
+    void setProcSorterLengthBounds(float minSecs, float maxSecs)
+    {
+        _procSorterLengthMin = minSecs;
+        _procSorterLengthMax = maxSecs;
+    }
+
+    float getProcSorterLengthMin() const { return _procSorterLengthMin; }
+
+    float getProcSorterLengthMax() const { return _procSorterLengthMax; }
+
     /**
      * Set the maximum amount of heap memory to use for sorting samples.
      * @param val Maximum size of heap in bytes.
@@ -319,6 +363,22 @@ public:
 
     size_t getProcHeapMax() const { return _procHeapMax; }
 
+    /**
+     * Lower bound of the heapMax of an adaptive raw sorter, in bytes.
+     * See setRawSorterLengthBounds(). Default: 1000000.
+     */
+    void setRawHeapMin(size_t val) { _rawHeapMin = val; }
+
+    size_t getRawHeapMin() const { return _rawHeapMin; }
+
+    /**
+     * Lower bound of the heapMax of an adaptive processed sorter, in bytes.
+     * See setProcSorterLengthBounds(). Default: 1000000.
+     */
+    void setProcHeapMin(size_t val) { _procHeapMin = val; }
+
+    size_t getProcHeapMin() const { return _procHeapMin; }
+
     /**
      * @param val If true, and heapSize exceeds heapMax,
      *   then wait for heapSize to be less then heapMax,
@@ -374,6 +434,20 @@ public:
         return _procLateSampleCacheSize;
     }
 
+    /**
+     * Set the number of shards of the raw sample sorter.
+     * See SampleSorter::setNumShards(val). Default: 1.
+     */
+    void setRawSorterShards(unsigned int val)
+    {
+        _rawSorterShards = val;
+    }
+
+    unsigned int getRawSorterShards() const
+    {
+        return _rawSorterShards;
+    }
+
 private:
 
     void rawinit();
@@ -406,6 +480,18 @@ private:
 
     size_t _procHeapMax;
 
+    float _rawSorterLengthMin;
+
+    float _rawSorterLengthMax;
+
+    float _procSorterLengthMin;
+
+    float _procSorterLengthMax;
+
+    size_t _rawHeapMin;
+
+    size_t _procHeapMin;
+
     bool _heapBlock;
 
     bool _keepStats;
@@ -414,6 +500,8 @@ private:
 
     unsigned int _procLateSampleCacheSize;
 
+    unsigned int _rawSorterShards;
+
     /**
      * No copying.
      */
@@ -129,6 +129,16 @@ public:
 
     int getNLargeSamplesIn() const { return _nlarge; }
 
+    /**
+     * Allocate about nbytes of samples into the pool, a third each
+     * in small, medium and large samples, writing to their data so
+     * that the memory is resident before the pool is used in a
+     * real-time data path. Samples allocated after the pool is
+     * empty come from the malloc arena of the allocating thread,
+     * see RealTimeProfile::prefaultThread().
+     */
+    void prefault(size_t nbytes);
+
 private:
 
     SamplePool();
@@ -254,6 +264,26 @@ SamplePool<SampleType>::~SamplePool() {
     SamplePools::getInstance()->removePool(this);
 }
 
+template<class SampleType>
+void SamplePool<SampleType>::prefault(size_t nbytes)
+{
+    const unsigned int lens[] = {
+        SMALL_SAMPLE_MAXSIZE - 1, MEDIUM_SAMPLE_MAXSIZE - 1,
+        MEDIUM_SAMPLE_MAXSIZE * 4 };
+
+    std::vector<SampleType*> samps;
+    for (unsigned int i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        size_t n = nbytes / 3 / (lens[i] * SampleType::sizeofDataType());
+        for (size_t j = 0; j < n; j++) {
+            SampleType* samp = getSample(lens[i]);
+            ::memset(samp->getVoidDataPtr(),0,samp->getAllocByteLength());
+            samps.push_back(samp);
+        }
+    }
+    for (unsigned int i = 0; i < samps.size(); i++)
+        samps[i]->freeReference();
+}
+
 template<class SampleType>
 SampleType* SamplePool<SampleType>::getSample(unsigned int len)
 throw(SampleLengthException)
@@ -57,9 +57,14 @@
  * method if the number of bytes in the SortedSampleSet has reached heapMax, but
  * there are no aged samples.
  *
+ * In adaptive mode the sorter length and heapMax are also set periodically
+ * from the disorder of the timetags and the rate of bytes received,
+ * so that a sorter fed by a few slow sensors is not as long,
+ * or allowed as much memory, as one fed by many fast ones.
  */
 
 #include "SampleSorter.h"
+#include "RealTimeProfile.h"
 
 #include <nidas/util/Logger.h>
 #include <nidas/util/UTime.h>
@@ -79,10 +84,29 @@ namespace n_u = nidas::util;
 using nidas::util::endlog;
 using nidas::util::LogScheme;
 
+namespace {
+    /**
+     * Percentile of the disorder of the samples from a DSM which
+     * the sorter length should cover.
+     */
+    const double ADAPT_PERCENTILE = 99.9;
+
+    /**
+     * Shortest adaptive sorter length.
+     */
+    const unsigned int MIN_ADAPT_LENGTH_USEC = 10 * USECS_PER_MSEC;
+
+    /**
+     * Seconds of data, beyond the sorter length, that the heap
+     * should hold while the sorting thread is slow.
+     */
+    const double HEAP_STALL_SECS = 5.0;
+}
+
 SampleSorter::SampleSorter(const std::string& name,bool raw) :
     SampleThread(name),_source(raw),
     _sorterLengthUsec(250*USECS_PER_MSEC),
-    _samples(),_sampleSetCond(),_flushCond(),
+    _samples(),_shards(),_inputStats(),_sampleSetCond(),_flushCond(),
 #ifdef NIDAS_EMBEDDED
     _heapMax(5 * 1000 * 1000),
 #else
@@ -92,7 +116,11 @@ SampleSorter::SampleSorter(const std::string& name,bool raw) :
     _discardedSamples(0),_realTimeFutureSamples(0),_earlySamples(0),
     _discardWarningCount(1000), _earlyWarningCount(_discardWarningCount),
     _doFlush(false),_flushed(true),_dummy(),
-    _realTime(false),_maxSorterLengthUsec(0),_lateSampleCacheSize(0)
+    _realTime(false),_maxSorterLengthUsec(0),_lateSampleCacheSize(0),
+    _latencyHist(),_adaptive(false),_minLengthUsec(0),_maxLengthUsec(0),
+    _minHeapMax(0),_maxHeapMax(0),_adaptPeriodUsec(10 * USECS_PER_SEC),
+    _adaptTime(0),_adaptEarlySamples(0),
+    _lateSampleRate(0.0)
 {
     // Allow the discard warning count to be overridden.
     _discardWarningCount =
@@ -130,6 +158,11 @@ SampleSorter::~SampleSorter()
         (*si)->freeReference();
     }
     _samples.clear();
+    setNumShards(0);
+
+    std::map<unsigned int, InputStats*>::const_iterator ii;
+    for (ii = _inputStats.begin(); ii != _inputStats.end(); ++ii)
+        delete ii->second;
 
     ILOG(("%s: maxSorterLength=%.3f sec, excess=%.3f sec, discarded=%d",
           getName().c_str(),(double)_maxSorterLengthUsec/USECS_PER_SEC,
@@ -189,20 +222,38 @@ int SampleSorter::run() throw(n_u::Exception)
      * sys     0m4.370s
      */
 
+    // The samples and set nodes allocated by this thread come from
+    // its own malloc arena, which the dsm prefault does not cover.
+    if (getRealTime()) RealTimeProfile::getInstance()->prefaultThread();
+
     ILOG(("%s: sorterLength=%.3f sec, lateSampleCache=%d, "
           "heapMax=%d, heapBlock=%d",
           getName().c_str(), (double)_sorterLengthUsec/USECS_PER_SEC,
           _lateSampleCacheSize, _heapMax,_heapBlock));
+    if (_adaptive) {
+        if (_maxLengthUsec == 0) _maxLengthUsec = _sorterLengthUsec;
+        if (_maxHeapMax == 0) _maxHeapMax = _heapMax;
+        ILOG(("%s: adaptive, sorterLength=[%.3f,%.3f] sec, heapMax=[%zu,%zu]",
+              getName().c_str(),getMinLengthSecs(),getMaxLengthSecs(),
+              _minHeapMax,_maxHeapMax));
+    }
 
     static n_u::LogContext sslog(LOG_VERBOSE, "sample_sorter");
     static n_u::LogMessage ssmsg(&sslog);
     static SampleTracer st;
     dsm_time_t tlast = 0;
+    bool timeit = PipelineLatency::enabled();
 
     _sampleSetCond.lock();
+    _adaptTime = n_u::getSystemTime();
 
     while (! isInterrupted()) {
 
+        if (!_shards.empty()) mergeShards();
+
+        dsm_time_t tadapt = n_u::getSystemTime();
+        if (tadapt >= _adaptTime + _adaptPeriodUsec) adapt(tadapt);
+
         size_t nsamp = _samples.size();
 
         if (nsamp <= _lateSampleCacheSize) {
@@ -217,7 +268,7 @@ int SampleSorter::run() throw(n_u::Exception)
             }
 
             if (!_doFlush) {	// not enough samples, wait
-                _sampleSetCond.wait();
+                waitForSamples();
                 continue;
             }
         }
@@ -259,7 +310,7 @@ int SampleSorter::run() throw(n_u::Exception)
                 _heapExceeded = false;
             }
             _heapCond.unlock();
-            _sampleSetCond.wait();
+            waitForSamples();
             continue;
         }
 
@@ -298,6 +349,7 @@ int SampleSorter::run() throw(n_u::Exception)
 	// loop over the aged samples
 	std::vector<const Sample *>::const_iterator si = agedsamples.begin();
 	size_t ssum = 0;
+        dsm_time_t tnow = (timeit ? n_u::getSystemTime() : 0);
 
         // track the maximum length of the sorting buffer in micro seconds,
         // as the time of latest sample - time of earliest sample
@@ -335,6 +387,7 @@ int SampleSorter::run() throw(n_u::Exception)
             {
                 st.msg(s, "distribute ") << " from " << getName() << endlog;
             }
+            if (timeit) _latencyHist.record(tnow - s->getTimeTag());
             _source.distribute(s);
 	}
 	heapDecrement(ssum);
@@ -342,6 +395,8 @@ int SampleSorter::run() throw(n_u::Exception)
 	_sampleSetCond.lock();
     }
 
+    if (!_shards.empty()) mergeShards();
+
     // warning if remaining samples
     if (_samples.size() > 0)
         WLOG(("SampleSorter (%s) run method exiting, _samples.size()=%zu",
@@ -405,10 +460,12 @@ void SampleSorter::interrupt()
 void SampleSorter::heapDecrement(size_t bytes)
 {
     _heapCond.lock();
-    if (!_heapBlock) _heapSize -= bytes;
+    // With shards, receive() may increment _heapSize without
+    // holding _heapCond, so it is always changed atomically.
+    if (!_heapBlock) __sync_sub_and_fetch(&_heapSize,bytes);
     else {
 	if (_heapExceeded) {	// receive() method is waiting on _heapCond
-	    _heapSize -= bytes;
+	    __sync_sub_and_fetch(&_heapSize,bytes);
             // To reduce trashing, wait until heap has decreased to 50% of _heapMax
             // before signalling a waiting thread.
             // Note there is a possibility that more than 50% of the heap
@@ -422,7 +479,7 @@ void SampleSorter::heapDecrement(size_t bytes)
                 _heapExceeded = false;
 	    }
 	}
-	else _heapSize -= bytes;
+	else __sync_sub_and_fetch(&_heapSize,bytes);
     }
     _heapCond.unlock();
 }
@@ -446,9 +503,14 @@ void SampleSorter::flush() throw()
     // be fully flushed, since the other thread may be sending
     // samples. So we have to use a _flushed logical, rather
     // than simply check _samples.empty().
+    // Samples in the shards have not been seen by the consumer thread,
+    // which will clear _flushed when it merges them.
     if (_flushed) {
-        _sampleSetCond.unlock();
-        return;
+        if (shardsEmpty()) {
+            _sampleSetCond.unlock();
+            return;
+        }
+        _flushed = false;
     }
 
     _doFlush = true;
@@ -509,44 +571,81 @@ bool SampleSorter::receive(const Sample *s) throw()
         }
     }
 
-    // Check if the heapSize will exceed heapMax
-    _heapCond.lock();
-    if (!_heapBlock) {
-        // Real-time behaviour, discard samples rather than blocking threads
-        if (_heapSize + slen > _heapMax) {
+    if (!_shards.empty() && !_heapBlock) {
+        // Real-time behaviour with shards. Increment the heap size
+        // without a lock, backing out the increment if heapMax is
+        // exceeded.
+        if (__sync_add_and_fetch(&_heapSize,slen) > _heapMax) {
+            __sync_sub_and_fetch(&_heapSize,slen);
+            _heapCond.lock();
             _heapExceeded = true;
 	    _heapCond.unlock();
-	    if (!(_discardedSamples++ % _discardWarningCount))
+            // Other threads may be discarding samples too.
+            unsigned int ndiscard =
+                __sync_add_and_fetch(&_discardedSamples,1);
+	    if (!((ndiscard - 1) % _discardWarningCount))
 	    	WLOG(("%d discarded samples because "
                   "heapSize(%d) + sampleSize(%d) is > than heapMax(%d)",
-                  _discardedSamples,_heapSize,slen,_heapMax));
+                  ndiscard,_heapSize,slen,_heapMax));
 	    return false;
-	}
-	_heapSize += slen;
-        _heapExceeded = false;
+        }
+        if (_heapExceeded) {
+            _heapCond.lock();
+            _heapExceeded = false;
+	    _heapCond.unlock();
+        }
     }
     else {
-        // Post-processing: this thread will block until heap
-        // gets smaller than _heapMax
-	_heapSize += slen;
-	// if heapMax will be exceeded, then wait until heapSize comes down
-	while (_heapSize > _heapMax) {
-            // We want to avoid a deadlock where the consumer thread is waiting
-            // in SampleSorter::run because it has no aged samples,
-            // while the producer thread is waiting in this receive() method
-            // because the heap is exceeded. Setting/checking
-            // _heapExceeded with _heapCond locked should do the trick.
-            _heapExceeded = true;
-            DLOG(("") << getName() << ": heap(" << _heapSize <<
-                ") > max(" << _heapMax << "), waiting");
-	    _sampleSetCond.signal();
-	    // Wait until consumer thread has distributed enough samples
-	    _heapCond.wait();
-	    // cerr << "received heap signal, heapSize=" << heapSize << endl;
-	}
-        _heapExceeded = false;
+        // Check if the heapSize will exceed heapMax
+        _heapCond.lock();
+        if (!_heapBlock) {
+            // Real-time behaviour, discard samples rather than blocking threads
+            if (_heapSize + slen > _heapMax) {
+                _heapExceeded = true;
+                _heapCond.unlock();
+                if (!(_discardedSamples++ % _discardWarningCount))
+                    WLOG(("%d discarded samples because "
+                      "heapSize(%d) + sampleSize(%d) is > than heapMax(%d)",
+                      _discardedSamples,_heapSize,slen,_heapMax));
+                return false;
+            }
+            __sync_add_and_fetch(&_heapSize,slen);
+            _heapExceeded = false;
+        }
+        else {
+            // Post-processing: this thread will block until heap
+            // gets smaller than _heapMax
+            __sync_add_and_fetch(&_heapSize,slen);
+            // if heapMax will be exceeded, then wait until heapSize comes down
+            while (_heapSize > _heapMax) {
+                // We want to avoid a deadlock where the consumer thread is waiting
+                // in SampleSorter::run because it has no aged samples,
+                // while the producer thread is waiting in this receive() method
+                // because the heap is exceeded. Setting/checking
+                // _heapExceeded with _heapCond locked should do the trick.
+                _heapExceeded = true;
+                DLOG(("") << getName() << ": heap(" << _heapSize <<
+                    ") > max(" << _heapMax << "), waiting");
+                _sampleSetCond.signal();
+                // Wait until consumer thread has distributed enough samples
+                _heapCond.wait();
+                // cerr << "received heap signal, heapSize=" << heapSize << endl;
+            }
+            _heapExceeded = false;
+        }
+        _heapCond.unlock();
+    }
+
+    if (!_shards.empty()) {
+        // The consumer thread checks for early samples when
+        // it merges the shards.
+        Shard* shard = getShard();
+        s->holdReference();
+        shard->mutex.lock();
+        shard->samples.insert(shard->samples.end(),s);
+        shard->mutex.unlock();
+        return true;
     }
-    _heapCond.unlock();
 
     _sampleSetCond.lock();
 
@@ -556,22 +655,11 @@ bool SampleSorter::receive(const Sample *s) throw()
     // but do not discard samples.
 
     SortedSampleSet::const_reverse_iterator latest = _samples.rbegin();
-    if (latest != _samples.rend() &&
-        s->getTimeTag() < (*latest)->getTimeTag() - _sorterLengthUsec)
-    {
-        if (!(_earlySamples++ % _earlyWarningCount))
-        {
-            dsm_time_t wend = (*latest)->getTimeTag();
-            dsm_time_t wbegin = wend - _sorterLengthUsec;
-            WLOG(("Early sample (%d,%d) @ ", 
-                  s->getDSMId(), s->getSpSId())
-                 << SampleTracer::format_time(s->getTimeTag())
-                 << " (" << _earlySamples << " total)"
-                 << ": prior to sorter window ["
-                 << SampleTracer::format_time(wbegin) << ", "
-                 << SampleTracer::format_time(wend) << "]");
-        }
+    if (latest != _samples.rend()) {
+        earlySample(s,(*latest)->getTimeTag());
+        if (_adaptive) addInputStats(s,(*latest)->getTimeTag());
     }
+    else if (_adaptive) addInputStats(s,s->getTimeTag());
 
     // If the sorter has been interrupted or is not otherwise running, then
     // this does not accept any more samples.  However, rather than
@@ -593,3 +681,166 @@ bool SampleSorter::receive(const Sample *s) throw()
     return true;
 }
 
+
+void SampleSorter::earlySample(const Sample* s, dsm_time_t latest)
+{
+    if (s->getTimeTag() >= latest - _sorterLengthUsec) return;
+
+    if (!(_earlySamples++ % _earlyWarningCount))
+    {
+        dsm_time_t wbegin = latest - _sorterLengthUsec;
+        WLOG(("Early sample (%d,%d) @ ", 
+              s->getDSMId(), s->getSpSId())
+             << SampleTracer::format_time(s->getTimeTag())
+             << " (" << _earlySamples << " total)"
+             << ": prior to sorter window ["
+             << SampleTracer::format_time(wbegin) << ", "
+             << SampleTracer::format_time(latest) << "]");
+    }
+}
+
+void SampleSorter::addInputStats(const Sample* s, dsm_time_t latest)
+{
+    InputStats*& stats = _inputStats[s->getDSMId()];
+    if (!stats) stats = new InputStats();
+    stats->disorder.record(latest - s->getTimeTag());
+    stats->nbytes += s->getDataByteLength() + s->getHeaderLength();
+}
+
+void SampleSorter::adapt(dsm_time_t tnow)
+{
+    double dt = (double)(tnow - _adaptTime) / USECS_PER_SEC;
+    _lateSampleRate = (_earlySamples - _adaptEarlySamples) / dt;
+    _adaptEarlySamples = _earlySamples;
+    _adaptTime = tnow;
+
+    if (!_adaptive) return;
+
+    unsigned int disorder = 0;
+    unsigned long long nbytes = 0;
+    std::map<unsigned int, InputStats*>::const_iterator ii;
+    for (ii = _inputStats.begin(); ii != _inputStats.end(); ++ii) {
+        InputStats* stats = ii->second;
+        if (stats->disorder.getCount() > 0)
+            disorder = std::max(disorder,
+                stats->disorder.getPercentile(ADAPT_PERCENTILE));
+        nbytes += stats->nbytes;
+        stats->disorder.reset();
+        stats->nbytes = 0;
+    }
+    if (nbytes == 0) return;
+
+    // Shorten gradually, so that a quiet period doesn't leave the
+    // sorter too short when the disorder returns.
+    unsigned int length = disorder + disorder / 2;
+    length = std::max(length,_sorterLengthUsec / 2);
+    length = std::min(std::max(length,_minLengthUsec),_maxLengthUsec);
+    length = std::max(length,MIN_ADAPT_LENGTH_USEC);
+
+    double secs = (double)length / USECS_PER_SEC + HEAP_STALL_SECS;
+    size_t heapMax = (size_t)(2.0 * nbytes / dt * secs);
+    heapMax = std::min(std::max(heapMax,_minHeapMax),_maxHeapMax);
+
+    if (length != _sorterLengthUsec) {
+        ILOG(("%s: disorder=%.3f sec, sorterLength changed from "
+              "%.3f to %.3f sec",getName().c_str(),
+              (double)disorder / USECS_PER_SEC,
+              (double)_sorterLengthUsec / USECS_PER_SEC,
+              (double)length / USECS_PER_SEC));
+        _sorterLengthUsec = length;
+    }
+
+    _heapCond.lock();
+    // Ignore small changes in the data rate.
+    if (heapMax > _heapMax + _heapMax / 10 ||
+        heapMax < _heapMax - _heapMax / 10) {
+        ILOG(("%s: %.0f bytes/sec, heapMax changed from %zu to %zu",
+              getName().c_str(),nbytes / dt,_heapMax,heapMax));
+        _heapMax = heapMax;
+        // A thread blocked in receive() is signalled as before,
+        // when the heap falls below half of the new heapMax.
+    }
+    _heapCond.unlock();
+}
+
+void SampleSorter::setNumShards(unsigned int val)
+{
+    for (unsigned int i = 0; i < _shards.size(); i++) {
+        Shard* shard = _shards[i];
+        SortedSampleSet::const_iterator si = shard->samples.begin();
+        for ( ; si != shard->samples.end(); ++si) (*si)->freeReference();
+        delete shard;
+    }
+    _shards.clear();
+    if (val > 1)
+        for (unsigned int i = 0; i < val; i++) _shards.push_back(new Shard());
+}
+
+SampleSorter::Shard* SampleSorter::getShard()
+{
+    // Thread ids are typically addresses of thread control
+    // blocks, whose low order bits are the same. Mix them.
+    unsigned long id = (unsigned long) n_u::Thread::currentThreadId();
+    id ^= id >> 16;
+    id *= 0x45d9f3bUL;
+    id ^= id >> 16;
+    return _shards[id % _shards.size()];
+}
+
+void SampleSorter::mergeShards()
+{
+    for (unsigned int i = 0; i < _shards.size(); i++) {
+        Shard* shard = _shards[i];
+        // Only hold the lock of the shard to swap out its samples.
+        SortedSampleSet run;
+        shard->mutex.lock();
+        run.swap(shard->samples);
+        shard->mutex.unlock();
+        if (run.empty()) continue;
+
+        _flushed = false;
+
+        // The samples of a shard are sorted, so only the leading ones
+        // can be early.
+        SortedSampleSet::const_reverse_iterator latest = _samples.rbegin();
+        if (latest != _samples.rend()) {
+            dsm_time_t tlatest = (*latest)->getTimeTag();
+            SortedSampleSet::const_iterator si = run.begin();
+            for ( ; si != run.end() &&
+                (*si)->getTimeTag() < tlatest - _sorterLengthUsec; ++si)
+                earlySample(*si,tlatest);
+            if (_adaptive)
+                for (si = run.begin(); si != run.end(); ++si)
+                    addInputStats(*si,tlatest);
+        }
+        else if (_adaptive) {
+            SortedSampleSet::const_iterator si = run.begin();
+            for ( ; si != run.end(); ++si)
+                addInputStats(*si,(*si)->getTimeTag());
+        }
+        _samples.insert(run.begin(),run.end());
+    }
+}
+
+bool SampleSorter::shardsEmpty()
+{
+    for (unsigned int i = 0; i < _shards.size(); i++) {
+        Shard* shard = _shards[i];
+        n_u::Autolock autolock(shard->mutex);
+        if (!shard->samples.empty()) return false;
+    }
+    return true;
+}
+
+void SampleSorter::waitForSamples()
+{
+    if (_shards.empty()) {
+        _sampleSetCond.wait();
+        return;
+    }
+    // 1/100th of a second, see the CPU times above.
+    struct timespec slp = { 0, 10 * NSECS_PER_MSEC };
+    _sampleSetCond.unlock();
+    ::nanosleep(&slp,0);
+    _sampleSetCond.lock();
+}
@@ -31,6 +31,10 @@
 #include "SampleSourceSupport.h"
 #include "SortedSampleSet.h"
 
+#include <algorithm>
+#include <vector>
+#include <map>
+
 namespace nidas { namespace core {
 
 /**
@@ -47,6 +51,16 @@ namespace nidas { namespace core {
  * sent to clients.
  * This can be a client of multiple SampleSources, so that the
  * distributed samples are sorted in time.
+ *
+ * With setNumShards(n > 1), the threads calling receive() do not
+ * contend on one lock. Each producer thread inserts its samples into
+ * one of n shards, selected by its thread id, each a SortedSampleSet
+ * with its own lock. The sorting thread periodically merges the shards
+ * into its own SortedSampleSet, from which samples are aged off
+ * as before, so the distributed samples are in the same order.
+ *
+ * With setAdaptive(true), the sorter length and heapMax are not fixed,
+ * but follow the data, within bounds. See setAdaptive().
  */
 class SampleSorter : public SampleThread
 {
@@ -176,6 +190,21 @@ public:
      */
     size_t size() const { return _samples.size(); }
 
+    /**
+     * Number of shards in which received samples are collected
+     * before being merged by the sorting thread. If less than 2,
+     * samples are inserted directly into the sorted set
+     * of the sorting thread, and the producer threads contend
+     * on its lock. Must be set before samples are received.
+     * Default: 1.
+     */
+    void setNumShards(unsigned int val);
+
+    unsigned int getNumShards() const
+    {
+        return std::max((size_t)1,_shards.size());
+    }
+
     void setLengthSecs(float val)
     {
         _sorterLengthUsec = (unsigned int)((double)val * USECS_PER_SEC);
@@ -270,6 +299,79 @@ public:
         return _lateSampleCacheSize;
     }
 
+    LatencyHistogram& getLatencyHistogram() { return _latencyHist; }
+
+    /**
+     * Adapt the sorter length and heapMax to the data. The disorder
+     * of the samples from each DSM, the latest timetag in the sorter
+     * minus the timetag of a sample when it is received, and the number
+     * of bytes received, are accumulated, and every getAdaptPeriodSecs()
+     * the sorter length is set to the largest 99.9th percentile of
+     * the disorder of the DSMs, plus 50%, and heapMax to twice the bytes
+     * received in the sorter length plus 5 seconds, within the bounds
+     * of setLengthBounds() and setHeapMaxBounds(). The length is reduced
+     * by at most half in each period. If an upper bound is not set,
+     * the length or heapMax when the thread starts is used.
+     * Default: false.
+     */
+    void setAdaptive(bool val) { _adaptive = val; }
+
+    bool getAdaptive() const { return _adaptive; }
+
+    /**
+     * Period, in seconds of system time, of the adaptation, and
+     * of the late sample rate. Default: 10.
+     */
+    void setAdaptPeriodSecs(float val)
+    {
+        _adaptPeriodUsec = (dsm_time_t)((double)val * USECS_PER_SEC);
+    }
+
+    float getAdaptPeriodSecs() const
+    {
+        return (double)_adaptPeriodUsec / USECS_PER_SEC;
+    }
+
+    /**
+     * Bounds of the sorter length, in seconds, in adaptive mode.
+     * Lengths less than 0.01 seconds are not used.
+     */
+    void setLengthBounds(float minSecs, float maxSecs)
+    {
+        _minLengthUsec = (unsigned int)((double)minSecs * USECS_PER_SEC);
+        _maxLengthUsec = (unsigned int)((double)maxSecs * USECS_PER_SEC);
+    }
+
+    float getMinLengthSecs() const
+    {
+        return (double)_minLengthUsec / USECS_PER_SEC;
+    }
+
+    float getMaxLengthSecs() const
+    {
+        return (double)_maxLengthUsec / USECS_PER_SEC;
+    }
+
+    /**
+     * Bounds of heapMax, in bytes, in adaptive mode.
+     */
+    void setHeapMaxBounds(size_t minBytes, size_t maxBytes)
+    {
+        _minHeapMax = minBytes;
+        _maxHeapMax = maxBytes;
+    }
+
+    size_t getMinHeapMax() const { return _minHeapMax; }
+
+    size_t getMaxHeapMax() const { return _maxHeapMax; }
+
+    /**
+     * Early samples, see getNumEarlySamples(), per second of
+     * system time, over the most recent adaptation period.
+     * These samples arrived too late to be necessarily sorted.
+     */
+    float getLateSampleRate() const { return _lateSampleRate; }
+
 private:
 
     SampleSourceSupport _source;
@@ -286,6 +388,101 @@ private:
 
     SortedSampleSet _samples;
 
+    /**
+     * Samples received by a group of producer threads since the
+     * sorting thread last merged them into _samples.
+     */
+    class Shard
+    {
+    public:
+        Shard(): mutex(),samples() {}
+
+        nidas::util::Mutex mutex;
+
+        SortedSampleSet samples;
+
+    private:
+        // No copying.
+        Shard(const Shard&);
+
+        // No assignment.
+        Shard& operator=(const Shard&);
+    };
+
+    std::vector<Shard*> _shards;
+
+    /**
+     * Shard of the calling thread.
+     */
+    Shard* getShard();
+
+    /**
+     * Move the samples in the shards to _samples. Called by
+     * the sorting thread with _sampleSetCond locked.
+     */
+    void mergeShards();
+
+    /**
+     * Are all shards empty?
+     */
+    bool shardsEmpty();
+
+    /**
+     * Wait for more samples, with _sampleSetCond locked.
+     * Without shards, wait on _sampleSetCond, which receive()
+     * signals. With shards, receive() does not signal, and
+     * the sorting thread sleeps for a short time.
+     */
+    void waitForSamples();
+
+    /**
+     * Count, and periodically warn about, a sample which is earlier
+     * than the sorter window ending at latest.
+     */
+    void earlySample(const Sample* s, dsm_time_t latest);
+
+    /**
+     * Statistics of the samples received from one DSM, for
+     * adapting the sorter to the data.
+     */
+    class InputStats
+    {
+    public:
+        InputStats(): disorder(),nbytes(0) {}
+
+        /**
+         * Latest timetag in the sorter minus the timetag of each sample.
+         */
+        LatencyHistogram disorder;
+
+        unsigned long long nbytes;
+
+    private:
+        // No copying.
+        InputStats(const InputStats&);
+
+        // No assignment.
+        InputStats& operator=(const InputStats&);
+    };
+
+    /**
+     * InputStats by DSM id. Accessed with _sampleSetCond locked.
+     */
+    std::map<unsigned int, InputStats*> _inputStats;
+
+    /**
+     * Add a sample to the InputStats of its DSM, with _sampleSetCond
+     * locked.
+     */
+    void addInputStats(const Sample* s, dsm_time_t latest);
+
+    /**
+     * Update the late sample rate and, in adaptive mode, set the sorter
+     * length and heapMax from the InputStats. Called by the sorting
+     * thread with _sampleSetCond locked.
+     */
+    void adapt(dsm_time_t tnow);
+
     /**
      * Utility function to decrement the heap size after writing
      * one or more samples. If the heapSize has has shrunk below
@@ -373,6 +570,32 @@ private:
 
     unsigned int _lateSampleCacheSize;
 
+    LatencyHistogram _latencyHist;
+
+    bool _adaptive;
+
+    unsigned int _minLengthUsec;
+
+    unsigned int _maxLengthUsec;
+
+    size_t _minHeapMax;
+
+    size_t _maxHeapMax;
+
+    dsm_time_t _adaptPeriodUsec;
+
+    /**
+     * System time of the last call of adapt().
+     */
+    dsm_time_t _adaptTime;
+
+    /**
+     * Value of _earlySamples at _adaptTime.
+     */
+    unsigned int _adaptEarlySamples;
+
+    float _lateSampleRate;
+
     /**
      * No copy.
      */
@@ -88,7 +88,7 @@ void SampleSourceSupport::addSampleClient(SampleClient* c) throw()
 void SampleSourceSupport::removeSampleClient(SampleClient* c) throw()
 {
     _clientMapLock.lock();
-    map<dsm_sample_id_t,SampleClientList>::iterator ci =
+    SampleIdMap<SampleClientList>::iterator ci =
         _clientsBySampleId.begin();
     for ( ; ci != _clientsBySampleId.end(); ++ci)
         ci->second.remove(c);
@@ -103,7 +103,7 @@ void SampleSourceSupport::addSampleClientForTag(SampleClient* client,
 {
     _clientMapLock.lock();
 
-    map<dsm_sample_id_t,SampleClientList>::iterator ci =
+    SampleIdMap<SampleClientList>::iterator ci =
         _clientsBySampleId.find(tag->getId());
 
     if (ci == _clientsBySampleId.end()) {
@@ -123,7 +123,7 @@ void SampleSourceSupport::removeSampleClientForTag(SampleClient* client,
 {
     _clientMapLock.lock();
 
-    map<dsm_sample_id_t,SampleClientList>::iterator ci =
+    SampleIdMap<SampleClientList>::iterator ci =
         _clientsBySampleId.find(tag->getId());
     if (ci != _clientsBySampleId.end())
         ci->second.remove(client);
@@ -160,7 +160,7 @@ void SampleSourceSupport::distribute(const Sample* sample) throw()
      */
 
    _clientMapLock.lock();
-    map<dsm_sample_id_t,SampleClientList>::const_iterator ci =
+    SampleIdMap<SampleClientList>::const_iterator ci =
         _clientsBySampleId.find(sample->getId());
     if (ci != _clientsBySampleId.end()) {
         SampleClientList tmp(ci->second);
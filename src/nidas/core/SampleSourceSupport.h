@@ -29,6 +29,7 @@
 
 #include "SampleSource.h"
 #include "SampleClientList.h"
+#include "SampleIdMap.h"
 
 #include <set>
 #include <map>
@@ -175,7 +176,7 @@ private:
     /**
      * Current clients of specific samples.
      */
-    std::map<dsm_sample_id_t,SampleClientList> _clientsBySampleId;
+    SampleIdMap<SampleClientList> _clientsBySampleId;
 
     std::set<SampleClient*> _clientSet;
 
@@ -29,6 +29,7 @@
 
 #include "SampleSource.h"
 #include "SampleClient.h"
+#include "LatencyHistogram.h"
 
 #include <nidas/util/Thread.h>
 #include <nidas/util/ThreadSupport.h>
@@ -128,6 +129,13 @@ public:
 
     virtual unsigned int getLateSampleCacheSize() const = 0;
 
+    /**
+     * Histogram of the age, system time minus timetag, of samples
+     * as they are distributed from this thread. Only updated if
+     * PipelineLatency::enabled().
+     */
+    virtual LatencyHistogram& getLatencyHistogram() = 0;
+
 };
 
 }}	// namespace nidas namespace core
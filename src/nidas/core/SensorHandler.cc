@@ -26,6 +26,7 @@
 
 #include "SensorHandler.h"
 #include "DSMEngine.h"
+#include "RealTimeProfile.h"
 #include <nidas/util/Logger.h>
 #include <nidas/util/UTime.h>
 
@@ -442,6 +443,10 @@ int SensorHandler::run() throw(n_u::Exception)
     // NotifyPipe::notify() to send a byte over the pipe to cause the
     // polling wait to return and check the flag.
 
+    // Samples which do not fit in the pools are allocated from the
+    // malloc arena of this thread.
+    RealTimeProfile::getInstance()->prefaultThread();
+
     dsm_time_t rtime = 0;
 
 #if POLLING_METHOD == POLL_EPOLL_ET || POLLING_METHOD == POLL_EPOLL_LT
@@ -205,6 +205,16 @@ void SerialSensor::stopPrompting() throw(n_u::IOException)
     }
 }
 
+void SerialSensor::printLatency(std::ostream& ostr)
+{
+    DSMSensor::printLatency(ostr);
+    if (_prompting) {
+        list<Prompter*>::const_iterator pi = _prompters.begin();
+        for (; pi != _prompters.end(); ++pi)
+            getLooper()->printJitter(ostr,*pi,getName());
+    }
+}
+
 void SerialSensor::printStatus(std::ostream& ostr) throw()
 {
     DSMSensor::printStatus(ostr);
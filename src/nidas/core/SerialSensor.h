@@ -135,6 +135,11 @@ public:
 
     void printStatus(std::ostream& ostr) throw();
 
+    /**
+     * Adds the jitter of the prompts to the latency summaries.
+     */
+    void printLatency(std::ostream& ostr);
+
     /**
      * Is prompting active, i.e. isPrompted() is true, and startPrompting
      * has been called?
@@ -91,6 +91,10 @@ void StatusHandler::startElement(const XMLCh * const /* uri */,
         _element = STATUS;
     else if ((string) XMLStringConverter(qname) == "samplepool")
         _element = SAMPLEPOOL;
+    else if ((string) XMLStringConverter(qname) == "latency")
+        _element = LATENCY;
+    else if ((string) XMLStringConverter(qname) == "sorter")
+        _element = SORTER;
 }
 
 void StatusHandler::endElement(const XMLCh * const /* uri */,
@@ -128,6 +132,18 @@ const XMLSize_t /* length */)
         _listener->_samplePool[_src] = XMLStringConverter(chars);
         break;
 
+    case LATENCY:
+        _listener->_statusMutex.lock();
+        _listener->_latency[_src] = XMLStringConverter(chars);
+        _listener->_statusMutex.unlock();
+        break;
+
+    case SORTER:
+        _listener->_statusMutex.lock();
+        _listener->_sorter[_src] = XMLStringConverter(chars);
+        _listener->_statusMutex.unlock();
+        break;
+
     case NONE:
         break;
     }
@@ -72,7 +72,7 @@ public:
                 const XMLSize_t length);
 #endif
 
-    enum elementType { SOURCE, TIME, STATUS, SAMPLEPOOL, NONE };
+    enum elementType { SOURCE, TIME, STATUS, SAMPLEPOOL, LATENCY, SORTER, NONE };
 
 private:
 
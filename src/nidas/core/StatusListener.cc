@@ -44,7 +44,8 @@ namespace n_u = nidas::util;
 
 StatusListener::StatusListener():Thread("StatusListener"),
     _clocksMutex(), _statusMutex(),
-    _clocks(),_oldclk(),_nstale(),_status(),_samplePool(),
+    _clocks(),_oldclk(),_nstale(),_status(),_samplePool(),_latency(),
+    _sorter(),
     _parser(0), _handler(new StatusHandler(this))
 {
     unblockSignal(SIGUSR1);
@@ -114,7 +115,8 @@ int StatusListener::run() throw(n_u::Exception)
         return RUN_EXCEPTION;
     }
     n_u::Inet4SocketAddress from;
-    char buf[8192];
+    // status messages with latency summaries can be larger than 8K
+    char buf[65536];
 
     for (; !isInterrupted();) {
         // blocking read on multicast socket
@@ -187,3 +189,21 @@ void GetStatus::execute(XmlRpc::XmlRpcValue & params,
     result = _listener->_status[arg];
     _listener->_statusMutex.unlock();
 }
+
+void GetLatency::execute(XmlRpc::XmlRpcValue & params,
+                         XmlRpc::XmlRpcValue & result)
+{
+    std::string & arg = params[0];
+    _listener->_statusMutex.lock();
+    result = _listener->_latency[arg];
+    _listener->_statusMutex.unlock();
+}
+
+void GetSorter::execute(XmlRpc::XmlRpcValue & params,
+                        XmlRpc::XmlRpcValue & result)
+{
+    std::string & arg = params[0];
+    _listener->_statusMutex.lock();
+    result = _listener->_sorter[arg];
+    _listener->_statusMutex.unlock();
+}
@@ -39,6 +39,8 @@ namespace nidas { namespace core {
 class StatusHandler;
 class GetClocks;
 class GetStatus;
+class GetLatency;
+class GetSorter;
 
 
 /// thread that listens to multicast messages from all of the DSMs.
@@ -47,6 +49,8 @@ class StatusListener:public nidas::util::Thread
     friend class StatusHandler;
     friend class GetClocks;
     friend class GetStatus;
+    friend class GetLatency;
+    friend class GetSorter;
 
 public:
     StatusListener();
@@ -70,6 +74,12 @@ private:
     /// this map contains the latest sample pool message from each DSM
     std::map < std::string, std::string > _samplePool;
 
+    /// this map contains the latest pipeline latency summary from each DSM
+    std::map < std::string, std::string > _latency;
+
+    /// this map contains the latest sorter status from each DSM
+    std::map < std::string, std::string > _sorter;
+
     /// SAX parser
     xercesc::SAX2XMLReader * _parser;
 
@@ -142,6 +152,62 @@ private:
 
 };
 
+/// gets the latest pipeline latency summary of a DSM or dsm_server.
+class GetLatency:public XmlRpc::XmlRpcServerMethod
+{
+public:
+    GetLatency(XmlRpc::XmlRpcServer * s, StatusListener * lstn):
+        XmlRpc::XmlRpcServerMethod("GetLatency", s), _listener(lstn)
+    {
+    }
+
+    void execute(XmlRpc::XmlRpcValue & params,
+            XmlRpc::XmlRpcValue & result);
+
+    std::string help() {
+        return std::string("help GetLatency");
+    }
+
+private:
+    /// reference to listener thread
+    StatusListener * _listener;
+
+    /** No copying. */
+    GetLatency(const GetLatency&);
+
+    /** No assignment. */
+    GetLatency& operator=(const GetLatency&);
+
+};
+
+/// gets the latest sorter lengths, heap limits and late sample rates of a DSM.
+class GetSorter:public XmlRpc::XmlRpcServerMethod
+{
+public:
+    GetSorter(XmlRpc::XmlRpcServer * s, StatusListener * lstn):
+        XmlRpc::XmlRpcServerMethod("GetSorter", s), _listener(lstn)
+    {
+    }
+
+    void execute(XmlRpc::XmlRpcValue & params,
+            XmlRpc::XmlRpcValue & result);
+
+    std::string help() {
+        return std::string("help GetSorter");
+    }
+
+private:
+    /// reference to listener thread
+    StatusListener * _listener;
+
+    /** No copying. */
+    GetSorter(const GetSorter&);
+
+    /** No assignment. */
+    GetSorter& operator=(const GetSorter&);
+
+};
+
 }}  // namespace nidas namespace core
 
 #endif
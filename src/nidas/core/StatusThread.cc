@@ -120,6 +120,16 @@ int DSMEngineStat::run() throw(n_u::Exception)
             }
             if (sensor) sensor->printStatusTrailer(statStream);
             statStream << "]]></status>";
+
+            statStream << "<sorter><![CDATA[";
+            engine->printSorterStatus(statStream);
+            statStream << "]]></sorter>";
+
+            if (PipelineLatency::enabled()) {
+                statStream << "<latency><![CDATA[";
+                engine->printLatency(statStream);
+                statStream << "]]></latency>";
+            }
         }
         statStream << "</group>" << endl;
 
@@ -32,6 +32,7 @@
 #include <nidas/util/Logger.h>
 
 #include <cmath>
+#include <cstring>
 
 #include <iostream>
 
@@ -43,6 +44,7 @@ namespace n_u = nidas::util;
 
 A2DSensor::A2DSensor() :
     DSMSensor(),_sampleCfgs(),_sampleInfos(),
+    _decimators(),_filterScan(),_decimatorTimes(),
     _badRawSamples(0),_maxNChannels(0),
     _convSlopes(0),_convIntercepts(0),
     _scanRate(0), _prevChan(-1),
@@ -59,6 +61,8 @@ A2DSensor::~A2DSensor()
     delete [] _convIntercepts;
     for (unsigned int i = 0; i < _sampleCfgs.size(); i++)
         delete _sampleCfgs[i];
+    for (unsigned int i = 0; i < _decimators.size(); i++)
+        delete _decimators[i];
 }
 
 void A2DSensor::open(int flags)
@@ -66,6 +70,15 @@ void A2DSensor::open(int flags)
 {
     DSMSensor::open(flags);
     initParameters();
+    resetDecimators();
+}
+
+void A2DSensor::resetDecimators()
+{
+    for (unsigned int i = 0; i < _decimators.size(); i++) {
+        if (_decimators[i]) _decimators[i]->reset();
+        _decimatorTimes[i] = 0;
+    }
 }
 
 void A2DSensor::close() throw(n_u::IOException)
@@ -226,10 +239,17 @@ bool A2DSensor::process(const Sample* insamp,list<const Sample*>& results) throw
     SampleTag* stag = sinfo.stag;
     const vector<Variable*>& vars = stag->getVariables();
 
-    SampleT<float>* osamp = getSample<float>(sinfo.nvalues);
-    osamp->setTimeTag(insamp->getTimeTag());
-    osamp->setId(stag->getId());
-    float *fp = osamp->getDataPtr();
+    FIRDecimator* decimator = _decimators[sindex];
+
+    // If the sample is decimated here, convert the scan into _filterScan,
+    // and only create an output sample when the filter has an output.
+    SampleT<float>* osamp = 0;
+    float* fp;
+    if (decimator) fp = &_filterScan[0];
+    else {
+        osamp = getSample<float>(sinfo.nvalues);
+        fp = osamp->getDataPtr();
+    }
     const float* fpend = fp + sinfo.nvalues;
 
     for (unsigned int ivar = 0; ivar < vars.size(); ivar++) {
@@ -249,6 +269,17 @@ bool A2DSensor::process(const Sample* insamp,list<const Sample*>& results) throw
     }
 
     for ( ; fp < fpend; ) *fp++ = floatNAN;
+
+    dsm_time_t tt = insamp->getTimeTag();
+    if (decimator) {
+        if (!decimate(sindex, tt)) return false;
+        osamp = getSample<float>(sinfo.nvalues);
+        ::memcpy(osamp->getDataPtr(), &_filterScan[0],
+            sinfo.nvalues * sizeof(float));
+    }
+    osamp->setTimeTag(tt);
+    osamp->setId(stag->getId());
+
     applyConversions(stag, osamp);
     results.push_back(osamp);
 
@@ -317,6 +348,18 @@ void A2DSensor::validate()
 
      If only one sample is configured, the driver does not add
      an id to the samples (backward compatibility)
+
+     A sample can also be filtered and decimated in process(), rather
+     than by the driver, with a filter parameter of "fir" or "cic".
+     The driver then sends every scan of the sample, and they are passed
+     through a FIRDecimator, with a decimation of the scan rate divided
+     by the sample rate. A fir filter needs a "coefficients" parameter,
+     a cic filter has an "order" parameter, default 3:
+
+            <sample id="3" rate="50">
+                <parameter name="filter" value="cic" type="string"/>
+                <parameter name="order" value="4" type="int"/>
+                ...
      */
     DSMSensor::validate();
 
@@ -342,7 +385,14 @@ void A2DSensor::validate()
     const std::list<SampleTag*>& tags = getSampleTags();
     std::list<SampleTag*>::const_iterator ti = tags.begin();
 
+    // The decimation of the fir and cic filters is the scan rate
+    // divided by the sample rate, so determine the scan rate first.
     for ( ; ti != tags.end(); ++ti) {
+        int rate = (int)(*ti)->getRate();
+        if (getScanRate() < rate) setScanRate(rate);
+    }
+
+    for (ti = tags.begin(); ti != tags.end(); ++ti) {
         SampleTag* tag = *ti;
 
         float frate = tag->getRate();
@@ -354,7 +404,6 @@ void A2DSensor::validate()
         }
 
         int rate = (int)frate;
-        if (getScanRate() < rate) setScanRate(rate);
         int boxcarNpts = 1;
         bool temperature = false;
 
@@ -366,6 +415,12 @@ void A2DSensor::validate()
         int timeavgRate = tag->getRate();
 
         enum nidas_short_filter filterType = NIDAS_FILTER_PICKOFF;
+
+        // filter parameter of "fir" or "cic": the driver sends
+        // every scan, which are filtered and decimated in process().
+        string userFilter;
+        vector<float> firCoefs;
+        int cicOrder = 3;
         const std::list<const Parameter*>& params = tag->getParameters();
         list<const Parameter*>::const_iterator pi;
         for (pi = params.begin(); pi != params.end(); ++pi) {
@@ -380,6 +435,7 @@ void A2DSensor::validate()
                     if (fname == "boxcar") filterType = NIDAS_FILTER_BOXCAR;
                     else if (fname == "pickoff") filterType = NIDAS_FILTER_PICKOFF;
                     else if (fname == "timeavg") filterType = NIDAS_FILTER_TIMEAVG;
+                    else if (fname == "fir" || fname == "cic") userFilter = fname;
                     else throw n_u::InvalidParameterException(getName(),"sample",
                             fname + " filter is not supported");
             }
@@ -395,6 +451,17 @@ void A2DSensor::validate()
                             "bad rate parameter");
                     timeavgRate = (int)param->getNumericValue(0);
             }
+            else if (pname == "coefficients") {
+                    firCoefs.clear();
+                    for (int i = 0; i < param->getLength(); i++)
+                        firCoefs.push_back(param->getNumericValue(i));
+            }
+            else if (pname == "order") {
+                    if (param->getLength() != 1)
+                        throw n_u::InvalidParameterException(getName(),"sample",
+                            "bad order parameter");
+                    cicOrder = (int)param->getNumericValue(0);
+            }
             else if (pname == "temperature") {
                     if (param->getLength() != 1)
                         throw n_u::InvalidParameterException(getName(),"sample",
@@ -425,6 +492,32 @@ void A2DSensor::validate()
             }
         }
 
+        int decimation = 1;
+        if (!userFilter.empty()) {
+            ostringstream ost;
+            if (getScanRate() % rate) {
+                ost << "scan rate=" << getScanRate() <<
+                    " Hz is not a multiple of the sample rate=" << rate << " Hz";
+                throw n_u::InvalidParameterException(getName(),
+                    userFilter + " filter", ost.str());
+            }
+            decimation = getScanRate() / rate;
+            if (userFilter == "cic") {
+                if (cicOrder <= 0) {
+                    ost << cicOrder << " must be > 0";
+                    throw n_u::InvalidParameterException(getName(),
+                        "cic order", ost.str());
+                }
+                firCoefs = FIRDecimator::cicCoefficients(decimation, cicOrder);
+            }
+            else if (firCoefs.empty())
+                throw n_u::InvalidParameterException(getName(),"coefficients",
+                    "coefficients parameter must be given with fir filter");
+            // driver sends every scan
+            filterType = NIDAS_FILTER_PICKOFF;
+            rate = getScanRate();
+        }
+
         int sindex = _sampleInfos.size();       // sample index, 0,1,...
 
         const vector<Variable*>& vars = tag->getVariables();
@@ -553,8 +646,19 @@ void A2DSensor::validate()
         }
         sinfo.nvalues = nvalues;
 
+        FIRDecimator* decimator = 0;
+        if (!userFilter.empty()) {
+            decimator = new FIRDecimator(nvalues, firCoefs, decimation);
+            if ((int)_filterScan.size() < nvalues) _filterScan.resize(nvalues);
+            ILOG(("%s: sample %d, %s filter of %d coefficients, decimation=%d",
+                getName().c_str(), sindex, userFilter.c_str(),
+                (int)firCoefs.size(), decimation));
+        }
+
         _sampleInfos.push_back(sinfo);
         _sampleCfgs.push_back(scfg);
+        _decimators.push_back(decimator);
+        _decimatorTimes.push_back(0);
     }
 }
 
@@ -27,6 +27,7 @@
 #define NIDAS_DYNLD_A2DSENSOR_H
 
 #include <nidas/core/DSMSensor.h>
+#include <nidas/core/FIRDecimator.h>
 
 #include <nidas/linux/a2d.h>
 
@@ -246,6 +247,48 @@ protected:
 
     std::vector<A2DSampleInfo> _sampleInfos;
 
+    /**
+     * Decimating filters of each sample, indexed by sample index, for
+     * samples with a filter parameter of "fir" or "cic". These samples
+     * are sent by the driver at the scan rate, and are filtered and
+     * decimated in process(). NULL if the sample is filtered
+     * by the driver.
+     */
+    std::vector<FIRDecimator*> _decimators;
+
+    /**
+     * Buffer of the converted values of a scan, before it is filtered.
+     */
+    std::vector<float> _filterScan;
+
+    /**
+     * Time tag of the last scan passed to each decimator.
+     */
+    std::vector<dsm_time_t> _decimatorTimes;
+
+    /**
+     * Pass a scan of values of a sample through its decimator.
+     * The decimator is reset if a scan is missing, more than one and
+     * a half scan periods after the last, so that the scans before
+     * the gap are not mixed into the outputs after it.
+     * @return true if there is an output scan, in _filterScan,
+     *      with a time tag which is tt corrected for the delay of
+     *      the filter.
+     */
+    bool decimate(unsigned int sindex, dsm_time_t& tt)
+    {
+        FIRDecimator* decimator = _decimators[sindex];
+        if (tt - _decimatorTimes[sindex] >
+            USECS_PER_SEC * 3 / (2 * getScanRate())) decimator->reset();
+        _decimatorTimes[sindex] = tt;
+
+        if (!decimator->add(&_filterScan[0])) return false;
+        decimator->output(&_filterScan[0]);
+        tt -= (dsm_time_t)(decimator->getDelay() * USECS_PER_SEC /
+            getScanRate() + 0.5);
+        return true;
+    }
+
     /**
      * Counter of number of raw samples of wrong size.
      */
@@ -254,6 +297,12 @@ protected:
 protected:
     void initParameters();
 
+    /**
+     * Clear the history of the decimating filters, as when
+     * the sensor is opened.
+     */
+    void resetDecimators();
+
     int _maxNChannels;
 
     /**
@@ -26,6 +26,8 @@
 
 #include "AsciiOutput.h"
 #include <nidas/core/UnixIOChannel.h>
+#include <nidas/core/DSMSensor.h>
+#include <nidas/core/Looper.h>
 #include "raf/IRIGSensor.h"
 #include <nidas/util/Logger.h>
 #include <nidas/util/UTime.h>
@@ -42,15 +44,17 @@ namespace n_r = nidas::dynld::raf;
 NIDAS_CREATOR_FUNCTION(AsciiOutput)
 
 AsciiOutput::AsciiOutput():
-    SampleOutputBase(),_ostr(),
-    _format(HEX),_prevTT(),_headerOut(false)
+    SampleOutputBase(),_buf(),_bufLock(),
+    _format(HEX),_prevTT(),_headerOut(false),_flushing(false)
 {
+    _buf.setTimeFormat("%Y %m %d %H:%M:%S.%3f ");
 }
 
 AsciiOutput::AsciiOutput(IOChannel* ioc,SampleConnectionRequester* rqstr):
-    SampleOutputBase(ioc,rqstr),_ostr(),
-    _format(HEX),_prevTT(),_headerOut(false)
+    SampleOutputBase(ioc,rqstr),_buf(),_bufLock(),
+    _format(HEX),_prevTT(),_headerOut(false),_flushing(false)
 {
+    _buf.setTimeFormat("%Y %m %d %H:%M:%S.%3f ");
     setName("AsciiOutput: " + getIOChannel()->getName());
 }
 
@@ -59,12 +63,20 @@ AsciiOutput::AsciiOutput(IOChannel* ioc,SampleConnectionRequester* rqstr):
  */
 AsciiOutput::AsciiOutput(AsciiOutput& x,IOChannel* ioc):
     SampleOutputBase(x,ioc),
-    _ostr(),_format(x._format),
-    _prevTT(),_headerOut(false)
+    _buf(),_bufLock(),_format(x._format),
+    _prevTT(),_headerOut(false),_flushing(false)
 {
+    _buf.setTimeFormat("%Y %m %d %H:%M:%S.%3f ");
     setName("AsciiOutput: " + getIOChannel()->getName());
 }
 
+AsciiOutput::~AsciiOutput()
+{
+    // Looper::removeClient() waits for a looperNotify() which
+    // has started.
+    stopFlushing();
+}
+
 AsciiOutput* AsciiOutput::clone(IOChannel* ioc)
 {
     // invoke copy constructor
@@ -87,44 +99,133 @@ void AsciiOutput::connect(SampleSource* source)
 
 void AsciiOutput::printHeader() throw(n_u::IOException)
 {
-    _ostr << "|- id --| |--- date time -------| deltaT    bytes" << endl;
-    getIOChannel()->write(_ostr.str().c_str(),_ostr.str().length());
-    _ostr.str("");
-    _ostr.clear();
+    static const char header[] =
+        "|- id --| |--- date time -------| deltaT    bytes\n";
+    getIOChannel()->write(header,sizeof(header)-1);
     _headerOut = true;
 }
 
+void AsciiOutput::writeBuffer() throw(n_u::IOException)
+{
+    if (_buf.empty()) return;
+    // clear the buffer even if the write fails
+    try {
+        getIOChannel()->write(_buf.data(),_buf.size());
+    }
+    catch(const n_u::IOException&) {
+        _buf.written();
+        throw;
+    }
+    _buf.written();
+}
+
+void AsciiOutput::flush() throw()
+{
+    n_u::Synchronized autosync(_bufLock);
+    if (!getIOChannel()) return;
+    try {
+        writeBuffer();
+    }
+    catch(const n_u::IOException& ioe) {
+        // The error will be seen again, and the output
+        // disconnected, by the next receive().
+	n_u::Logger::getInstance()->log(LOG_ERR,
+            "%s: %s",getName().c_str(),ioe.what());
+    }
+}
+
+void AsciiOutput::stopFlushing()
+{
+    if (_flushing) {
+        DSMSensor::getLooper()->removeClient(this);
+        _flushing = false;
+    }
+}
+
+void AsciiOutput::close() throw(n_u::IOException)
+{
+    stopFlushing();
+    n_u::Synchronized autosync(_bufLock);
+    if (getIOChannel()) {
+        try {
+            writeBuffer();
+        }
+        catch(const n_u::IOException&) {
+            SampleOutputBase::close();
+            throw;
+        }
+    }
+    SampleOutputBase::close();
+}
+
 bool AsciiOutput::receive(const Sample* samp) throw()
 {
     if (!getIOChannel()) return false;
 
-    dsm_time_t tt = samp->getTimeTag();
+    if (!_flushing) {
+        try {
+            DSMSensor::getLooper()->addClient(this,FLUSH_MSECS,0);
+        }
+        catch(const n_u::InvalidParameterException& e) {
+            n_u::Logger::getInstance()->log(LOG_WARNING,
+                "%s: %s",getName().c_str(),e.what());
+        }
+        _flushing = true;
+    }
 
-    if (tt >= getNextFileTime()) {
-	createNextFile(tt);
-	_headerOut = false;
+    _bufLock.lock();
+    bool ok = formatSample(samp);
+    _bufLock.unlock();
+
+    if (!ok) {
+        // this disconnect may schedule this object to be deleted
+        // in another thread, so don't do anything after the
+        // disconnect except return;
+        disconnect();
+        return false;
     }
+    return true;
+}
 
-    if (!_headerOut) {
-	try {
-	    printHeader();
-	}
-	catch(const n_u::IOException& ioe) {
-	    n_u::Logger::getInstance()->log(LOG_ERR,
+void AsciiOutput::looperNotify() throw()
+{
+    n_u::Synchronized autosync(_bufLock);
+    if (!getIOChannel()) return;
+    try {
+        writeBuffer();
+    }
+    catch(const n_u::IOException& ioe) {
+        // The error will be seen again, and the output
+        // disconnected, by the next receive().
+	n_u::Logger::getInstance()->log(LOG_ERR,
             "%s: %s",getName().c_str(),ioe.what());
-            // this disconnect may schedule this object to be deleted
-            // in another thread, so don't do anything after the
-            // disconnect except return;
-	    disconnect();
-	    return false;
-	}
+    }
+}
+
+bool AsciiOutput::formatSample(const Sample* samp) throw()
+{
+    dsm_time_t tt = samp->getTimeTag();
+
+    try {
+        if (tt >= getNextFileTime()) {
+            // samples formatted so far belong in the current file
+            writeBuffer();
+            createNextFile(tt);
+            _headerOut = false;
+        }
+
+        if (!_headerOut) printHeader();
+    }
+    catch(const n_u::IOException& ioe) {
+        n_u::Logger::getInstance()->log(LOG_ERR,
+        "%s: %s",getName().c_str(),ioe.what());
+        return false;
     }
 
     dsm_sample_id_t sampid = samp->getId();
 
     double ttdiff = 0.0;
-    map<dsm_sample_id_t,dsm_time_t>::iterator pti =
-    	_prevTT.find(sampid);
+    SampleIdMap<dsm_time_t>::iterator pti = _prevTT.find(sampid);
 
     if (pti != _prevTT.end()) {
         ttdiff = (double)(tt - pti->second) / USECS_PER_SEC;
@@ -132,72 +233,77 @@ bool AsciiOutput::receive(const Sample* samp) throw()
     }
     else _prevTT[sampid] = tt;
 
-    n_u::UTime ut(tt);
-
-    _ostr << setw(3) << GET_DSM_ID(sampid) << ',' <<
-    	setw(5) << GET_SHORT_ID(sampid) << ' ' <<
-	ut.format(true,"%Y %m %d %H:%M:%S.%3f ") <<
-	setfill(' ') << setprecision(3) << setw(5) << ttdiff << ' ' <<
-	setw(7) << setfill(' ') << samp->getDataByteLength() << ' ';
+    _buf.appendInt(GET_DSM_ID(sampid),3);
+    _buf.append(',');
+    _buf.appendInt(GET_SHORT_ID(sampid),5);
+    _buf.append(' ');
+    _buf.appendTime(tt);
+    _buf.appendGeneral(ttdiff,3,5);
+    _buf.append(' ');
+    _buf.appendInt(samp->getDataByteLength(),7);
+    _buf.append(' ');
 
     switch (samp->getType()) {
     case FLOAT_ST:
     case DOUBLE_ST:
 	{
-	_ostr << setprecision(7) << setfill(' ');
-	for (unsigned int i = 0; i < samp->getDataLength(); i++)
-	    _ostr << setw(10) << samp->getDataValue(i) << ' ';
-	_ostr << endl;
+	for (unsigned int i = 0; i < samp->getDataLength(); i++) {
+	    _buf.appendGeneral(samp->getDataValue(i),7,10);
+	    _buf.append(' ');
+        }
+	_buf.append('\n');
 	}
 	break;
     case CHAR_ST:
     default:
 	switch(_format) {
 	case ASCII:
-	    {
-	    string dstr((const char*)samp->getConstVoidDataPtr(),
+	    _buf.append((const char*)samp->getConstVoidDataPtr(),
 		    samp->getDataByteLength());
-	    _ostr << dstr << endl;
-	    }
+	    _buf.append('\n');
 	    break;
 	case HEX:
 	    {
 	    const unsigned char* cp =
 		    (const unsigned char*) samp->getConstVoidDataPtr();
-	    _ostr << setfill('0');
-	    for (unsigned int i = 0; i < samp->getDataByteLength(); i++)
-		_ostr << hex << setw(2) << (unsigned int)cp[i] << dec << ' ';
-	    _ostr << endl;
+	    for (unsigned int i = 0; i < samp->getDataByteLength(); i++) {
+		_buf.appendHex(cp[i],2);
+		_buf.append(' ');
+            }
+	    _buf.append('\n');
 	    }
 	    break;
 	case SIGNED_SHORT:
 	    {
 	    const short* sp =
 		    (const short*) samp->getConstVoidDataPtr();
-	    _ostr << setfill(' ');
-	    for (unsigned int i = 0; i < samp->getDataByteLength()/2; i++)
-		_ostr << setw(6) << sp[i] << ' ';
-	    _ostr << endl;
+	    for (unsigned int i = 0; i < samp->getDataByteLength()/2; i++) {
+		_buf.appendInt(sp[i],6);
+		_buf.append(' ');
+            }
+	    _buf.append('\n');
 	    }
 	    break;
 	case UNSIGNED_SHORT:
 	    {
 	    const unsigned short* sp =
 		    (const unsigned short*) samp->getConstVoidDataPtr();
-	    _ostr << setfill(' ');
-	    for (unsigned int i = 0; i < samp->getDataByteLength()/2; i++)
-		_ostr << setw(6) << sp[i] << ' ';
-	    _ostr << endl;
+	    for (unsigned int i = 0; i < samp->getDataByteLength()/2; i++) {
+		_buf.appendInt(sp[i],6);
+		_buf.append(' ');
+            }
+	    _buf.append('\n');
 	    }
 	    break;
 	case FLOAT:
 	    {
 	    const float* fp =
 		    (const float*) samp->getConstVoidDataPtr();
-	    _ostr << setprecision(6) << setfill(' ');
-	    for (unsigned int i = 0; i < samp->getDataByteLength()/4; i++)
-		_ostr << setw(10) << fp[i] << ' ';
-	    _ostr << endl;
+	    for (unsigned int i = 0; i < samp->getDataByteLength()/4; i++) {
+		_buf.appendGeneral(fp[i],6,10);
+		_buf.append(' ');
+            }
+	    _buf.append('\n');
 	    }
 	    break;
 	case IRIG:
@@ -212,10 +318,13 @@ bool AsciiOutput::receive(const Sample* samp) throw()
 	    n_u::UTime itt((dsm_time_t) tv.tv_sec * USECS_PER_SEC
 	    	+ tv.tv_usec);
 
-	    _ostr << itt.format(true,"%Y %m %d %H:%M:%S.%6f ") << 
-		' ' << setw(2) << setfill('0') << hex << (int)status << dec <<
-		'(' << n_r::IRIGSensor::statusString(status) << ')';
-	    _ostr << endl;
+	    _buf.append(itt.format(true,"%Y %m %d %H:%M:%S.%6f "));
+	    _buf.append(' ');
+	    _buf.appendHex(status,2);
+	    _buf.append('(');
+	    _buf.append(n_r::IRIGSensor::statusString(status));
+	    _buf.append(')');
+	    _buf.append('\n');
 	    }
 	    break;
 	case DEFAULT:
@@ -224,21 +333,15 @@ bool AsciiOutput::receive(const Sample* samp) throw()
 	break;
     }
 
-    try {
-	getIOChannel()->write(_ostr.str().c_str(),_ostr.str().length());
-    }
-    catch(const n_u::IOException& ioe) {
-        _ostr.str("");
-	n_u::Logger::getInstance()->log(LOG_ERR,
-	"%s: %s",getName().c_str(),ioe.what());
-        // this disconnect may schedule this object to be deleted
-        // in another thread, so don't do anything after the
-        // disconnect except return;
-	disconnect();
-	return false;
+    if (_buf.writeDue()) {
+        try {
+            writeBuffer();
+        }
+        catch(const n_u::IOException& ioe) {
+            n_u::Logger::getInstance()->log(LOG_ERR,
+            "%s: %s",getName().c_str(),ioe.what());
+            return false;
+        }
     }
-    _ostr.str("");
-    _ostr.clear();
     return true;
 }
-
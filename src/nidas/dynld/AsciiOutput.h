@@ -28,6 +28,10 @@
 #define NIDAS_DYNLD_ASCIIOUTPUT_H
 
 #include <nidas/core/SampleOutput.h>
+#include <nidas/core/SampleIdMap.h>
+#include <nidas/core/LooperClient.h>
+#include <nidas/util/FormatBuffer.h>
+#include <nidas/util/ThreadSupport.h>
 
 #include <iostream>
 
@@ -41,7 +45,12 @@ namespace dynld {
 
 using namespace nidas::core;
 
-class AsciiOutput: public SampleOutputBase
+/**
+ * Write samples as lines of text. The lines are formatted into a buffer,
+ * which is written when it is full, or from a Looper callback every
+ * half second, so that the output of a quiet input is not held back.
+ */
+class AsciiOutput: public SampleOutputBase, public LooperClient
 {
 public:
 
@@ -52,12 +61,18 @@ public:
 
     AsciiOutput(IOChannel* iochannel,SampleConnectionRequester* rqstr=0);
 
-    virtual ~AsciiOutput() {}
+    virtual ~AsciiOutput();
 
     /**
      * Implementation of SampleClient::flush().
+     * Write the formatted samples to the IOChannel.
      */
-    void flush() throw() {}
+    void flush() throw();
+
+    /**
+     * Write the formatted samples and close the IOChannel.
+     */
+    void close() throw(nidas::util::IOException);
 
     void requestConnection(SampleConnectionRequester* requester) throw();
 
@@ -73,6 +88,12 @@ public:
 
     bool receive(const Sample* samp) throw();
 
+    /**
+     * Implementation of LooperClient::looperNotify().
+     * Write the formatted samples to the IOChannel.
+     */
+    void looperNotify() throw();
+
 protected:
 
     AsciiOutput* clone(IOChannel* iochannel);
@@ -84,19 +105,56 @@ protected:
 
     void printHeader() throw(nidas::util::IOException);
 
+    /**
+     * Write the formatted samples to the IOChannel.
+     */
+    void writeBuffer() throw(nidas::util::IOException);
+
 private:
 
-    std::ostringstream _ostr;
+    /**
+     * Format a sample into the buffer, and write the buffer if
+     * it is due. Returns false on an IOException.
+     */
+    bool formatSample(const Sample* samp) throw();
+
+    /**
+     * Remove this output from the Looper.
+     */
+    void stopFlushing();
+
+    /**
+     * Period of looperNotify().
+     */
+    static const unsigned int FLUSH_MSECS = 500;
+
+    /**
+     * Samples are formatted into this buffer, which is written
+     * to the IOChannel when it is full, or has not been written for
+     * a while, or before the IOChannel changes to a new file.
+     */
+    nidas::util::FormatBuffer _buf;
+
+    /**
+     * Lock of the buffer, which is written by receive() in the
+     * thread of the sample source, and by looperNotify().
+     */
+    nidas::util::Mutex _bufLock;
 
     format_t _format;
 
     /**
      * Previous time tags by sample id. Used for displaying time diffs.
      */
-    std::map<dsm_sample_id_t,dsm_time_t> _prevTT;
+    SampleIdMap<dsm_time_t> _prevTT;
 
     bool _headerOut;
 
+    /**
+     * Whether this output has been added to the Looper.
+     */
+    bool _flushing;
+
     /**
      * Copy constructor.
      */
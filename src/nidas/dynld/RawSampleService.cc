@@ -36,6 +36,7 @@
 #include <nidas/core/NidsIterators.h>
 #include <nidas/core/SamplePipeline.h>
 #include <nidas/core/SampleIOProcessor.h>
+#include <nidas/core/SampleBus.h>
 #include <nidas/util/EOFException.h>
 #include <nidas/util/Process.h>
 #include <nidas/util/Logger.h>
@@ -52,6 +53,10 @@
 #include <sys/select.h>
 #endif
 
+#ifdef HAVE_EPOLL_PWAIT
+#include <sys/epoll.h>
+#endif
+
 using namespace nidas::core;
 using namespace nidas::dynld;
 using namespace std;
@@ -62,16 +67,30 @@ NIDAS_CREATOR_FUNCTION(RawSampleService)
 
 RawSampleService::RawSampleService():
     DSMService("RawSampleService"),
-    _pipeline(0),_workers(),_dsms(),_workerMutex(),
+    _pipeline(0),_workers(),_pollWorkers(),_polledInputs(),
+    _dsms(),_workerMutex(),
     _nsampsLast(), _nbytesLast(),
     _rawSorterLength(0.25), _procSorterLength(1.0),
     _rawHeapMax(5000000), _procHeapMax(5000000),
-    _rawLateSampleCacheSize(0), _procLateSampleCacheSize(0)
+    _rawLateSampleCacheSize(0), _procLateSampleCacheSize(0),
+    _rawSorterShards(1),_numWorkers(0)
 {
 }
 
 RawSampleService::~RawSampleService()
 {
+    // The pool threads push samples into the pipeline, stop them first.
+    for (unsigned int i = 0; i < _pollWorkers.size(); i++) {
+        PollWorker* worker = _pollWorkers[i];
+        if (worker->isRunning()) worker->interrupt();
+        try {
+            if (!worker->isJoined()) worker->join();
+        }
+        catch(const n_u::Exception& e) {
+            WLOG(("%s: %s", getName().c_str(),e.what()));
+        }
+        delete worker;
+    }
     // pipeline::join() does not throw exceptions
     if (_pipeline) _pipeline->join();
     delete _pipeline;
@@ -93,6 +112,8 @@ void RawSampleService::schedule(bool optionalProcessing) throw(n_u::Exception)
     _pipeline->setRawLateSampleCacheSize(getRawLateSampleCacheSize());
     _pipeline->setProcLateSampleCacheSize(getProcLateSampleCacheSize());
 
+    _pipeline->setRawSorterShards(getRawSorterShards());
+
     _pipeline->setRawHeapMax(getRawHeapMax());
     _pipeline->setProcHeapMax(getProcHeapMax());
 
@@ -147,6 +168,31 @@ void RawSampleService::schedule(bool optionalProcessing) throw(n_u::Exception)
 	    }
 	}
     }
+
+    // Publish the sorted raw samples to the shared memory bus
+    if (SampleBusWriter::getInstance())
+        _pipeline->getRawSampleSource()->addSampleClient(
+            SampleBusWriter::getInstance());
+
+#ifdef HAVE_EPOLL_PWAIT
+    for (unsigned int i = 0; i < getNumWorkers(); i++) {
+        PollWorker* worker = new PollWorker(this);
+        try {
+            worker->setThreadScheduler(getSchedPolicy(),getSchedPriority());
+        }
+        catch (const n_u::Exception& e) {
+            WLOG(("%s: %s", getName().c_str(),e.what()));
+        }
+        worker->start();
+        _pollWorkers.push_back(worker);
+    }
+#else
+    if (getNumWorkers() > 0)
+        WLOG(("%s: epoll_pwait not available, starting a thread "
+            "for each input rather than a pool of %u",
+            getName().c_str(),getNumWorkers()));
+#endif
+
     const list<SampleInput*>& inputs = getInputs();
     list<SampleInput*>::const_iterator li = inputs.begin();
     for ( ; li != inputs.end(); ++li) {
@@ -165,6 +211,13 @@ void RawSampleService::interrupt() throw()
         // Note: proc may not have been connected to begin with
         proc->disconnect(_pipeline);
     }
+    if (SampleBusWriter::getInstance())
+        _pipeline->getRawSampleSource()->removeSampleClient(
+            SampleBusWriter::getInstance());
+    for (unsigned int i = 0; i < _pollWorkers.size(); i++) {
+        PollWorker* worker = _pollWorkers[i];
+        if (worker->isRunning()) worker->interrupt();
+    }
     DSMService::interrupt();
 }
 
@@ -212,6 +265,33 @@ void RawSampleService::connect(SampleInput* input) throw()
     // the input.
     _pipeline->connect(input);
 
+    // If there is a pool of PollWorkers, add the input to the
+    // running one with the fewest inputs.
+    PollWorker* pworker = 0;
+    for (unsigned int i = 0; i < _pollWorkers.size(); i++) {
+        PollWorker* pw = _pollWorkers[i];
+        if (!pw->isRunning()) continue;
+        if (!pworker || pw->getNumInputs() < pworker->getNumInputs())
+            pworker = pw;
+    }
+    if (pworker) {
+        _workerMutex.lock();
+        _polledInputs[input] = pworker;
+        _dsms[input] = dsm; // may be 0
+        _workerMutex.unlock();
+        try {
+            pworker->add(input);
+            return;
+        }
+        catch (const n_u::IOException& e) {
+            WLOG(("%s: %s", getName().c_str(),e.what()));
+            _workerMutex.lock();
+            _polledInputs.erase(input);
+            _dsms.erase(input);
+            _workerMutex.unlock();
+        }
+    }
+
     // Create a Worker to handle the input.
     // Worker owns the SampleInputStream.
     Worker* worker = new Worker(this,input);
@@ -255,11 +335,20 @@ void RawSampleService::disconnect(SampleInput* input) throw()
     	" input=" << input << endl;
 #endif
 
-    _pipeline->disconnect(input);
+    if (_pipeline) _pipeline->disconnect(input);
 
     // figure out the Worker for the input.
     n_u::Autolock tlock(_workerMutex);
 
+    // An input of a PollWorker is disconnected by the PollWorker,
+    // which then closes it.
+    map<SampleInput*,PollWorker*>::iterator pi = _polledInputs.find(input);
+    if (pi != _polledInputs.end()) {
+        _polledInputs.erase(pi);
+        _dsms.erase(input);
+        return;
+    }
+
     map<SampleInput*,Worker*>::iterator wi = _workers.find(input);
     if (wi == _workers.end()) {
 	n_u::Logger::getInstance()->log(LOG_ERR,
@@ -394,6 +483,243 @@ int RawSampleService::Worker::run() throw(n_u::Exception)
     return RUN_OK;
 }
 
+#ifdef HAVE_EPOLL_PWAIT
+
+RawSampleService::PollWorker::PollWorker(RawSampleService* svc):
+    Thread(svc->getName()+"PollWorker"),_svc(svc),_epollfd(-1),
+    _inputs(),_pollErrs(),_inputsMutex(),_stopped(false)
+{
+    // SIGUSR1 is unblocked in epoll_pwait
+    blockSignal(SIGUSR1);
+}
+
+RawSampleService::PollWorker::~PollWorker()
+{
+    // close inputs left after an exception in run()
+    while (!_inputs.empty()) remove(*_inputs.begin(),false);
+    if (_epollfd >= 0) ::close(_epollfd);
+}
+
+void RawSampleService::PollWorker::interrupt()
+{
+    Thread::interrupt();
+    try {
+        kill(SIGUSR1);
+    }
+    catch (const n_u::Exception& e) {}
+}
+
+int RawSampleService::PollWorker::getNumInputs() const
+{
+    n_u::Autolock alock(_inputsMutex);
+    return _inputs.size();
+}
+
+void RawSampleService::PollWorker::add(SampleInput* input)
+    throw(n_u::IOException)
+{
+    n_u::Autolock alock(_inputsMutex);
+
+    if (_stopped)
+        throw n_u::IOException(input->getName(),"add",
+            getName() + " is not polling");
+
+    if (_epollfd < 0) {
+        _epollfd = ::epoll_create(10);
+        if (_epollfd < 0)
+            throw n_u::IOException(getName(),"epoll_create",errno);
+    }
+
+    input->setNonBlocking(true);
+
+    struct epoll_event event;
+    ::memset(&event,0,sizeof(event));
+#ifdef EPOLLRDHUP
+    event.events = EPOLLIN | EPOLLRDHUP;
+#else
+    event.events = EPOLLIN;
+#endif
+    event.data.ptr = input;
+
+    if (::epoll_ctl(_epollfd,EPOLL_CTL_ADD,input->getFd(),&event) < 0)
+        throw n_u::IOException(input->getName(),"epoll_ctl add",errno);
+    _inputs.insert(input);
+}
+
+void RawSampleService::PollWorker::remove(SampleInput* input,bool reconnect)
+{
+    _inputsMutex.lock();
+    if (::epoll_ctl(_epollfd,EPOLL_CTL_DEL,input->getFd(),NULL) < 0) {
+        n_u::IOException e(input->getName(),"epoll_ctl del",errno);
+        WLOG(("%s: %s",getName().c_str(),e.what()));
+    }
+    _inputs.erase(input);
+    _pollErrs.erase(input);
+    _inputsMutex.unlock();
+
+    _svc->disconnect(input);
+
+    try {
+	input->close();
+    }
+    catch(const n_u::IOException& e) {
+	n_u::Logger::getInstance()->log(LOG_ERR,
+	    "%s: %s: %s",
+		_svc->getName().c_str(),input->getName().c_str(),e.what());
+    }
+
+    if (reconnect) {
+        DLOG(("%s: %s: requesting reconnection",
+                    _svc->getName().c_str(),input->getName().c_str()));
+        input->getOriginal()->requestConnection(_svc);
+    }
+    if (input != input->getOriginal()) delete input;
+}
+
+int RawSampleService::PollWorker::run() throw(n_u::Exception)
+{
+    // get the existing signal mask
+    sigset_t sigmask;
+    pthread_sigmask(SIG_BLOCK,NULL,&sigmask);
+    // unblock SIGUSR1 in epoll_pwait
+    sigdelset(&sigmask,SIGUSR1);
+
+    // After an exception the inputs are closed, and their reconnection
+    // requested, which adds them to another worker.
+    bool reconnect = false;
+    try {
+        pollInputs(sigmask);
+    }
+    catch (const n_u::Exception& e) {
+        n_u::Logger::getInstance()->log(LOG_ERR,
+            "%s: %s", getName().c_str(),e.what());
+        reconnect = true;
+    }
+
+    _inputsMutex.lock();
+    _stopped = true;
+    _inputsMutex.unlock();
+
+    while (getNumInputs() > 0) {
+        _inputsMutex.lock();
+        SampleInput* input = *_inputs.begin();
+        _inputsMutex.unlock();
+        remove(input,reconnect);
+    }
+    return RUN_OK;
+}
+
+void RawSampleService::PollWorker::pollInputs(const sigset_t& sigmask)
+    throw(n_u::IOException)
+{
+    _inputsMutex.lock();
+    if (_epollfd < 0) _epollfd = ::epoll_create(10);
+    int epollfd = _epollfd;
+    _inputsMutex.unlock();
+    if (epollfd < 0)
+        throw n_u::IOException(getName(),"epoll_create",errno);
+
+    const int NEVENTS = 16;
+    struct epoll_event events[NEVENTS];
+
+    while (!isInterrupted()) {
+        int nfd = ::epoll_pwait(epollfd,events,NEVENTS,-1,&sigmask);
+        if (nfd < 0) {
+            if (errno == EINTR) continue;
+            throw n_u::IOException(getName(),"epoll_pwait",errno);
+        }
+
+        for (int i = 0; i < nfd; i++) {
+            SampleInput* input = (SampleInput*) events[i].data.ptr;
+            uint32_t ev = events[i].events;
+#ifdef EPOLLRDHUP
+            if (ev & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+#else
+            if (ev & (EPOLLERR | EPOLLHUP))
+#endif
+            {
+#ifdef EPOLLRDHUP
+                if (ev & EPOLLRDHUP)
+                    WLOG(("%s: EPOLLRDHUP",input->getName().c_str()));
+#endif
+                if (ev & EPOLLERR)
+                    WLOG(("%s: EPOLLERR",input->getName().c_str()));
+                if (ev & EPOLLHUP)
+                    WLOG(("%s: EPOLLHUP",input->getName().c_str()));
+
+                // Try the read anyway, which should report the EOF
+                // or error, but give up on an input which doesn't.
+                if (_pollErrs[input]++ > 10) {
+                    remove(input,true);
+                    continue;
+                }
+            }
+
+            // One read of the input, whose samples are distributed.
+            try {
+                input->readSamples();
+            }
+            catch(const n_u::EOFException& e) {
+                n_u::Logger::getInstance()->log(LOG_INFO,
+                    "%s: %s: %s",
+                        _svc->getName().c_str(),input->getName().c_str(),e.what());
+                remove(input,true);
+            }
+            catch(const n_u::IOException& e) {
+                n_u::Logger::getInstance()->log(LOG_ERR,
+                    "%s: %s: %s",
+                        _svc->getName().c_str(),input->getName().c_str(),e.what());
+                remove(input,true);
+            }
+        }
+    }
+}
+
+#else
+
+// Without epoll_pwait, schedule() does not create PollWorkers.
+RawSampleService::PollWorker::PollWorker(RawSampleService* svc):
+    Thread(svc->getName()+"PollWorker"),_svc(svc),_epollfd(-1),
+    _inputs(),_pollErrs(),_inputsMutex(),_stopped(false)
+{
+}
+
+RawSampleService::PollWorker::~PollWorker()
+{
+}
+
+void RawSampleService::PollWorker::interrupt()
+{
+    Thread::interrupt();
+}
+
+int RawSampleService::PollWorker::getNumInputs() const
+{
+    return 0;
+}
+
+void RawSampleService::PollWorker::add(SampleInput* input)
+    throw(n_u::IOException)
+{
+    throw n_u::IOException(input->getName(),"epoll_pwait","not supported");
+}
+
+void RawSampleService::PollWorker::remove(SampleInput*,bool)
+{
+}
+
+int RawSampleService::PollWorker::run() throw(n_u::Exception)
+{
+    return RUN_OK;
+}
+
+void RawSampleService::PollWorker::pollInputs(const sigset_t&)
+    throw(n_u::IOException)
+{
+}
+
+#endif
+
 void RawSampleService::printClock(ostream& ostr) throw()
 {
     SampleSource* raw = _pipeline->getRawSampleSource();
@@ -571,6 +897,36 @@ void RawSampleService::printStatus(ostream& ostr,float deltat) throw()
         proc->printStatus(ostr,deltat,zebra);
     }
     ostr << "</tbody></table>]]></status>\n";
+
+    if (PipelineLatency::enabled()) printLatency(ostr);
+}
+
+void RawSampleService::printLatency(ostream& ostr) throw()
+{
+    ostr << "<latency><![CDATA[";
+
+    _workerMutex.lock();
+    std::map<SampleInput*,const DSMConfig*>::const_iterator ii =  _dsms.begin();
+    for ( ; ii != _dsms.end(); ++ii) {
+        const DSMConfig* dsm = ii->second;
+        if (!dsm) continue;
+        const list<DSMSensor*>& sensors = dsm->getSensors();
+        list<DSMSensor*>::const_iterator si = sensors.begin();
+        for ( ; si != sensors.end(); ++si) {
+            DSMSensor* sensor = *si;
+            sensor->getPipelineLatency().printAndReset(ostr,sensor->getName());
+        }
+    }
+    _workerMutex.unlock();
+
+    _pipeline->printLatency(ostr);
+
+    ProcessorIterator pi = getProcessorIterator();
+    for ( ; pi.hasNext(); ) {
+        SampleIOProcessor* proc = pi.next();
+        proc->printLatency(ostr);
+    }
+    ostr << "]]></latency>\n";
 }
 
 /*
@@ -624,6 +980,22 @@ void RawSampleService::fromDOMElement(const xercesc::DOMElement* node)
                 if (aname[0] == 'r') setRawLateSampleCacheSize(val);
                 else setProcLateSampleCacheSize(val);
 	    }
+            else if (aname == "workers") {
+		unsigned int val;
+		istringstream ist(aval);
+		ist >> val;
+		if (ist.fail()) throw n_u::InvalidParameterException(
+		    string("dsm") + ": " + getName(), aname,aval);
+                setNumWorkers(val);
+	    }
+            else if (aname == "rawSorterShards") {
+		unsigned int val;
+		istringstream ist(aval);
+		ist >> val;
+		if (ist.fail()) throw n_u::InvalidParameterException(
+		    string("dsm") + ": " + getName(), aname,aval);
+                setRawSorterShards(val);
+	    }
         }
     }
     list<SampleInput*>::iterator li = _inputs.begin();
@@ -29,6 +29,10 @@
 #define NIDAS_DYNLD_RAWSAMPLESERVICE_H
 
 #include <nidas/core/DSMService.h>
+#include <nidas/util/IOException.h>
+
+#include <set>
+#include <vector>
 
 namespace nidas {
 
@@ -67,6 +71,12 @@ public:
 
     void printStatus(std::ostream& ostr,float deltat) throw();
 
+    /**
+     * Write the <latency> element of the status, containing the
+     * PipelineLatency summaries of the sensors, sorters and outputs.
+     */
+    void printLatency(std::ostream& ostr) throw();
+
     /**
      * Get the length of the SampleSorter of raw Samples, in seconds.
      */
@@ -177,6 +187,97 @@ public:
         _procLateSampleCacheSize = val;
     }
 
+    /**
+     * Number of shards of the raw sample sorter, so that the
+     * threads receiving samples from the DSMs do not contend
+     * on one lock. See SampleSorter::setNumShards(val). Default: 1.
+     */
+    unsigned int getRawSorterShards() const
+    {
+        return _rawSorterShards;
+    }
+
+    void setRawSorterShards(unsigned int val)
+    {
+        _rawSorterShards = val;
+    }
+
+    /**
+     * Number of threads in a pool which read from all the
+     * connected inputs, polling them with epoll. If zero,
+     * a thread is started for each connected input.
+     * Must be set before schedule(). Default: 0.
+     */
+    unsigned int getNumWorkers() const
+    {
+        return _numWorkers;
+    }
+
+    void setNumWorkers(unsigned int val)
+    {
+        _numWorkers = val;
+    }
+
+    /**
+     * Thread of a fixed pool, which waits with epoll for data on
+     * the file descriptors of any number of SampleInputs. The
+     * inputs are non-blocking, and an input with data is read
+     * once per poll, so that a busy input cannot starve the others.
+     * The header and the samples of an input are parsed
+     * incrementally from what has been read.
+     * Public so that it can be tested on its own.
+     */
+    class PollWorker: public nidas::util::Thread
+    {
+        public:
+            PollWorker(RawSampleService* svc);
+            ~PollWorker();
+            /**
+             * Add an input. PollWorker then owns it, and closes
+             * it on an error or EOF.
+             */
+            void add(nidas::core::SampleInput *input)
+                throw(nidas::util::IOException);
+            int getNumInputs() const;
+            /**
+             * Poll and read the inputs until interrupted. An exception
+             * from epoll is logged rather than thrown. The inputs
+             * are then removed and their reconnection requested.
+             */
+            int run() throw(nidas::util::Exception);
+            void interrupt();
+        private:
+            /**
+             * Stop polling an input, disconnect and close it, and,
+             * if reconnect is true, request a new connection.
+             */
+            void remove(nidas::core::SampleInput *input,bool reconnect);
+            /**
+             * Wait with epoll_pwait, which unblocks the signals
+             * not in sigmask, and read the inputs with data,
+             * until interrupted.
+             */
+            void pollInputs(const sigset_t& sigmask)
+                throw(nidas::util::IOException);
+            RawSampleService* _svc;
+            int _epollfd;
+            std::set<nidas::core::SampleInput*> _inputs;
+            /**
+             * Number of polls with an error condition on an input.
+             */
+            std::map<nidas::core::SampleInput*,int> _pollErrs;
+            mutable nidas::util::Mutex _inputsMutex;
+            /**
+             * Set when run() has stopped polling, after which
+             * add() throws IOException.
+             */
+            bool _stopped;
+            /** No copying. */
+            PollWorker(const PollWorker&);
+            /** No assignment. */
+            PollWorker& operator=(const PollWorker&);
+    };
+
 private:
 
     nidas::core::SamplePipeline* _pipeline;
@@ -205,6 +306,13 @@ private:
      */
     std::map<nidas::core::SampleInput*,Worker*> _workers;
 
+    std::vector<PollWorker*> _pollWorkers;
+
+    /**
+     * The PollWorker of each SampleInput, if using a pool.
+     */
+    std::map<nidas::core::SampleInput*,PollWorker*> _polledInputs;
+
     std::map<nidas::core::SampleInput*,const nidas::core::DSMConfig*> _dsms;
 
     nidas::util::Mutex _workerMutex;
@@ -231,6 +339,10 @@ private:
 
     unsigned int _procLateSampleCacheSize;
 
+    unsigned int _rawSorterShards;
+
+    unsigned int _numWorkers;
+
     /**
      * Copying not supported.
      */
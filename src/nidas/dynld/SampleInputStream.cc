@@ -59,7 +59,9 @@ SampleInputStream::SampleInputStream(bool raw):
     _maxSampleLength(UINT_MAX),
     _minSampleTime(LONG_LONG_MIN),
     _maxSampleTime(LONG_LONG_MAX),
-    _original(this),_raw(raw)
+    _original(this),_raw(raw),_rawBlock(),
+    _compact(false),_decoder(),_cbuf(),_clen(0),_dataToSkip(0),
+    _corrupt(false)
 {
 }
 
@@ -76,7 +78,9 @@ SampleInputStream::SampleInputStream(IOChannel* iochannel, bool raw):
     _maxSampleLength(UINT_MAX),
     _minSampleTime(LONG_LONG_MIN),
     _maxSampleTime(LONG_LONG_MAX),
-    _original(this),_raw(raw)
+    _original(this),_raw(raw),_rawBlock(),
+    _compact(false),_decoder(),_cbuf(),_clen(0),_dataToSkip(0),
+    _corrupt(false)
 {
     setIOChannel(iochannel);
     _iostream = new IOStream(*_iochan,_iochan->getBufferSize());
@@ -97,7 +101,9 @@ SampleInputStream::SampleInputStream(SampleInputStream& x,
     _filterBadSamples(x._filterBadSamples),_maxDsmId(x._maxDsmId),
     _maxSampleLength(x._maxSampleLength),_minSampleTime(x._minSampleTime),
     _maxSampleTime(x._maxSampleTime),
-    _original(&x),_raw(x._raw)
+    _original(&x),_raw(x._raw),_rawBlock(),
+    _compact(false),_decoder(),_cbuf(),_clen(0),_dataToSkip(0),
+    _corrupt(false)
 {
     setIOChannel(iochannel);
     _iostream = new IOStream(*_iochan,_iochan->getBufferSize());
@@ -235,6 +241,7 @@ void SampleInputStream::readInputHeader() throw(n_u::IOException)
     _dataToRead = 0;
     _inputHeader.read(_iostream);
     _inputHeaderParsed = true;
+    resetSampleDecoding();
 }
 
 bool SampleInputStream::parseInputHeader() throw(n_u::IOException)
@@ -254,9 +261,26 @@ bool SampleInputStream::parseInputHeader() throw(n_u::IOException)
     catch(const n_u::ParseException& e) {
         throw n_u::IOException(getName(),"read header",e.what());
     }
+    if (_inputHeaderParsed) resetSampleDecoding();
     return _inputHeaderParsed;
 }
 
+void SampleInputStream::resetSampleDecoding() throw()
+{
+    const string& encoding = _inputHeader.getSampleEncoding();
+    _compact = encoding == CompactHeaderEncoder::ENCODING;
+    if (!_compact && encoding.length() > 0 && encoding != "full") {
+        WLOG(("%s: unknown sample encoding \"%s\", input discarded",
+            getName().c_str(),encoding.c_str()));
+        _compact = true;
+        _corrupt = true;
+    }
+    else _corrupt = false;
+    _decoder.reset();
+    _clen = 0;
+    _dataToSkip = 0;
+}
+
 namespace {
     void logBadSampleHeader(const string& name,size_t nbad,long long pos,bool raw, const SampleHeader& header)
     {
@@ -300,6 +324,14 @@ bool SampleInputStream::readSamples() throw(n_u::IOException)
 
     // process all samples in buffer
     for (;;) {
+        // Between samples, parse whole samples in place.
+        // nextSample() then assembles a sample split across reads.
+        if (_compact) {
+            if (!_samp && _clen == 0 && _dataToSkip == 0 && !_corrupt)
+                distributeCompactBlock();
+        }
+        else if (!_samp && _headerToRead == _sheader.getSizeOf())
+            distributeBlock();
         Sample* samp = nextSample();
         if (!samp) break;
         _source.distribute(samp);
@@ -307,6 +339,202 @@ bool SampleInputStream::readSamples() throw(n_u::IOException)
     return true;
 }
 
+namespace {
+    /**
+     * Can nidas::core::getSample() create a sample of this
+     * type and byte length?
+     */
+    inline bool validTypeLength(unsigned int type, unsigned int len)
+    {
+        static const unsigned int sizes[] = {
+            1, 1, sizeof(short), sizeof(short),
+            4, 4, sizeof(float), sizeof(double), 8 };
+        return type < UNKNOWN_ST && len % sizes[type] == 0;
+    }
+
+    /**
+     * Copy a little-endian sample header from a buffer.
+     */
+    inline void copyHeader(SampleHeader& header, const char* cp)
+    {
+        ::memcpy(&header,cp,header.getSizeOf());
+#if __BYTE_ORDER == __BIG_ENDIAN
+        header.setTimeTag(bswap_64(header.getTimeTag()));
+        header.setDataByteLength(bswap_32(header.getDataByteLength()));
+        header.setRawId(bswap_32(header.getRawId()));
+#endif
+    }
+}
+
+void SampleInputStream::distributeBlock() throw()
+{
+    const size_t hlen = _sheader.getSizeOf();
+    const char* bp = _iostream->peek();
+    const char* eb = bp + _iostream->available();
+    const char* cp = bp;
+
+    while ((size_t)(eb - cp) >= hlen) {
+        copyHeader(_sheader,cp);
+
+        Sample* samp = 0;
+        if (!badHeader(_sheader)) {
+            size_t dlen = _sheader.getDataByteLength();
+            // leave a partial sample for nextSample()
+            if ((size_t)(eb - cp) - hlen < dlen) break;
+            // getSample can return NULL if type or length are bad
+            samp = nidas::core::getSample((sampleType)_sheader.getType(),dlen);
+        }
+
+        if (!samp) {
+            // Bad header. Scan ahead a byte at a time for a header
+            // which isn't screened out. The sample type is in
+            // the high bits of the last byte of the little-endian
+            // header, so most bytes are rejected by looking at that
+            // byte alone, without copying the header.
+            SampleHeader bad = _sheader;
+            const char* bad0 = cp;
+            for (cp++; (size_t)(eb - cp) >= hlen; cp++) {
+                unsigned int type = (unsigned char)cp[hlen - 1] >> 2;
+                if (_raw ? type != CHAR_ST :
+                    _filterBadSamples && type >= UNKNOWN_ST) continue;
+                copyHeader(_sheader,cp);
+                if (!badHeader(_sheader)) break;
+            }
+            // Each position counts as a bad sample, as in
+            // sampleFromHeader(). Log if a multiple of 1000 was passed.
+            size_t nbad = cp - bad0;
+            if (_badSamples % 1000 == 0 || _badSamples % 1000 + nbad > 1000)
+                logBadSampleHeader(getName(),_badSamples + nbad,
+                    _iostream->getNumInputBytes() + (bad0 - bp),_raw,bad);
+            _badSamples += nbad;
+            continue;
+        }
+
+        samp->setTimeTag(_sheader.getTimeTag());
+        samp->setId(_sheader.getId());
+        ::memcpy(samp->getVoidDataPtr(),cp + hlen,_sheader.getDataByteLength());
+        cp += hlen + _sheader.getDataByteLength();
+
+        _source.distribute(samp);
+    }
+    _iostream->consume(cp - bp);
+}
+
+void SampleInputStream::distributeCompactBlock() throw()
+{
+    const char* bp = _iostream->peek();
+    const char* eb = bp + _iostream->available();
+    const char* cp = bp;
+
+    while (cp < eb) {
+        size_t hlen;
+        try {
+            hlen = _decoder.decode(cp,eb - cp,_sheader);
+        }
+        catch (const n_u::ParseException& e) {
+            // reported by nextCompactSample()
+            break;
+        }
+        size_t dlen = _sheader.getDataByteLength();
+        // leave a partial sample for nextCompactSample()
+        if (hlen == 0 || (size_t)(eb - cp) - hlen < dlen) break;
+        _decoder.accept();
+        cp += hlen;
+
+        Sample* samp = 0;
+        if (!badHeader(_sheader))
+            samp = nidas::core::getSample((sampleType)_sheader.getType(),dlen);
+        if (!samp) {
+            if (!(_badSamples++ % 1000))
+                logBadSampleHeader(getName(),_badSamples,
+                    _iostream->getNumInputBytes() + (cp - bp),_raw,_sheader);
+            cp += dlen;
+            continue;
+        }
+        samp->setTimeTag(_sheader.getTimeTag());
+        samp->setId(_sheader.getId());
+        ::memcpy(samp->getVoidDataPtr(),cp,dlen);
+        cp += dlen;
+
+        _source.distribute(samp);
+    }
+    _iostream->consume(cp - bp);
+}
+
+Sample* SampleInputStream::nextCompactSample(bool keepreading)
+    throw(n_u::IOException)
+{
+    for (;;) {
+        if (_samp && _dataToRead == 0) {
+            Sample* out = _samp;
+            _samp = 0;
+            return out;
+        }
+        if (_iostream->available() == 0) {
+            if (!keepreading) return 0;
+            if (_iostream->read() == 0) continue;
+            if (_expectHeader && _iostream->isNewInput()) {
+                // discard a partial sample, and start over
+                readInputHeader();
+                if (!_compact) return nextSample(keepreading);
+                continue;
+            }
+        }
+
+        if (_corrupt) {
+            _iostream->consume(_iostream->available());
+            continue;
+        }
+        if (_dataToSkip > 0) {
+            size_t len = std::min(_dataToSkip,_iostream->available());
+            _iostream->consume(len);
+            _dataToSkip -= len;
+            continue;
+        }
+        if (_samp) {
+            size_t len = _iostream->readBuf(_dptr,_dataToRead);
+            _dptr += len;
+            _dataToRead -= len;
+            continue;
+        }
+
+        // Assemble a header which is split across reads a byte at
+        // a time. The decoder throws an exception if the header is
+        // not complete in MAX_LENGTH bytes, the size of _cbuf.
+        _iostream->readBuf(_cbuf + _clen,1);
+        _clen++;
+        size_t hlen;
+        try {
+            hlen = _decoder.decode(_cbuf,_clen,_sheader);
+        }
+        catch (const n_u::ParseException& e) {
+            WLOG(("%s: %s, filepos=%lld, discarding the rest of the input",
+                getName().c_str(),e.what(),_iostream->getNumInputBytes()));
+            _corrupt = true;
+            _clen = 0;
+            continue;
+        }
+        if (hlen == 0) continue;
+        _decoder.accept();
+        _clen = 0;
+
+        size_t dlen = _sheader.getDataByteLength();
+        if (!badHeader(_sheader))
+            _samp = nidas::core::getSample((sampleType)_sheader.getType(),dlen);
+        if (!_samp) {
+            if (!(_badSamples++ % 1000))
+                logBadSampleHeader(getName(),_badSamples,
+                    _iostream->getNumInputBytes(),_raw,_sheader);
+            _dataToSkip = dlen;
+            continue;
+        }
+        _samp->setTimeTag(_sheader.getTimeTag());
+        _samp->setId(_sheader.getId());
+        _dptr = (char*) _samp->getVoidDataPtr();
+        _dataToRead = dlen;
+    }
+}
+
 
 bool
 SampleInputStream::
@@ -324,6 +552,7 @@ readSampleHeader(bool keepreading) throw(n_u::IOException)
         if (keepreading && _expectHeader && _iostream->isNewInput()) {
                 _iostream->backup(len);
                 readInputHeader();
+                if (_compact) return false;
         }
         if (!keepreading && _headerToRead > 0) 
             return false;   // no more data
@@ -384,10 +613,15 @@ Sample* SampleInputStream::nextSample() throw()
 Sample* SampleInputStream::nextSample(bool keepreading) throw(n_u::IOException)
 {
     for (;;) {
+        if (_compact) return nextCompactSample(keepreading);
+
         if (_headerToRead > 0) {
 
-            if (! readSampleHeader(keepreading))
+            if (! readSampleHeader(keepreading)) {
+                // a new input file with compact headers
+                if (_compact) continue;
                 return 0;
+            }
 
 #if __BYTE_ORDER == __BIG_ENDIAN
             _sheader.setTimeTag(bswap_64(_sheader.getTimeTag()));
@@ -431,14 +665,7 @@ sampleFromHeader() throw()
     Sample* samp = 0;
 
     // screen bad headers.
-    if ((_raw && _sheader.getType() != CHAR_ST) ||
-        (_filterBadSamples &&
-         (_sheader.getType() >= UNKNOWN_ST ||
-          GET_DSM_ID(_sheader.getId()) > _maxDsmId ||
-          _sheader.getDataByteLength() > _maxSampleLength ||
-          _sheader.getDataByteLength() == 0 ||
-          _sheader.getTimeTag() < _minSampleTime ||
-          _sheader.getTimeTag() > _maxSampleTime))) {
+    if (badHeader(_sheader)) {
         samp = 0;
     }
     // getSample can return NULL if type or length are bad
@@ -470,6 +697,56 @@ Sample* SampleInputStream::readSample() throw(n_u::IOException)
     return nextSample(true);
 }
 
+char* SampleInputStream::readRawBlock(size_t& len) throw(n_u::IOException)
+{
+    const size_t hlen = _sheader.getSizeOf();
+    assert(!_samp && _headerToRead == hlen);
+
+    char* bp = _iostream->peek();
+    char* eb = bp + _iostream->available();
+    char* cp = bp;
+
+    // Compact headers are expanded by readSample().
+    SampleHeader header;
+    while (!_compact && (size_t)(eb - cp) >= hlen) {
+        copyHeader(header,cp);
+        // leave bad headers to readSample()
+        if (badHeader(header) ||
+            !validTypeLength(header.getType(),header.getDataByteLength()))
+            break;
+        size_t slen = hlen + header.getDataByteLength();
+        if ((size_t)(eb - cp) < slen) break;
+        cp += slen;
+    }
+    if (cp > bp) {
+        _iostream->consume(cp - bp);
+        len = cp - bp;
+        return bp;
+    }
+
+    // A bad header, a partial sample, or nothing in the buffer.
+    // readSample() reads more, reads the header of a new input file,
+    // and skips bad headers.
+    Sample* samp = readSample();
+    size_t dlen = samp->getDataByteLength();
+    len = hlen + dlen;
+    if (_rawBlock.size() < len) _rawBlock.resize(len);
+
+#if __BYTE_ORDER == __BIG_ENDIAN
+    header.setTimeTag(bswap_64(samp->getTimeTag()));
+    header.setDataByteLength(bswap_32(dlen));
+    header.setRawId(bswap_32(samp->getRawId()));
+#else
+    header.setTimeTag(samp->getTimeTag());
+    header.setDataByteLength(dlen);
+    header.setRawId(samp->getRawId());
+#endif
+    ::memcpy(&_rawBlock[0],&header,hlen);
+    ::memcpy(&_rawBlock[hlen],samp->getConstVoidDataPtr(),dlen);
+    samp->freeReference();
+    return &_rawBlock[0];
+}
+
 /*
  * Search for a sample with timetag >= tt.
  */
@@ -479,6 +756,19 @@ void SampleInputStream::search(const n_u::UTime& tt) throw(n_u::IOException)
     if (_samp) _samp->freeReference();
     _samp = 0;
     for (;;) {
+        // Compact headers can't be skipped over without decoding them.
+        if (_compact) {
+            Sample* samp = nextCompactSample(true);
+            if (!samp) return;
+            if (samp->getTimeTag() >= tt.toUsecs()) {
+                // returned by the next nextSample()
+                _samp = samp;
+                _dataToRead = 0;
+                return;
+            }
+            samp->freeReference();
+            continue;
+        }
         if (_headerToRead > 0) {
             while (_headerToRead > 0) {
 		len = _iostream->read(_hptr,_headerToRead);
@@ -488,22 +778,17 @@ void SampleInputStream::search(const n_u::UTime& tt) throw(n_u::IOException)
                 if (_expectHeader && _iostream->isNewInput()) {
                     _iostream->backup(len);
                     readInputHeader();
+                    if (_compact) break;
                 }
             }
+            if (_compact) continue;
 
 #if __BYTE_ORDER == __BIG_ENDIAN
             _sheader.setTimeTag(bswap_64(_sheader.getTimeTag()));
             _sheader.setDataByteLength(bswap_32(_sheader.getDataByteLength()));
             _sheader.setRawId(bswap_32(_sheader.getRawId()));
 #endif
-	    if ((_raw && _sheader.getType() != CHAR_ST) ||
-                (_filterBadSamples &&
-                (_sheader.getType() >= UNKNOWN_ST ||
-                    GET_DSM_ID(_sheader.getId()) > _maxDsmId ||
-                _sheader.getDataByteLength() > _maxSampleLength ||
-                _sheader.getDataByteLength() == 0 ||
-                _sheader.getTimeTag() < _minSampleTime ||
-                _sheader.getTimeTag() > _maxSampleTime))) {
+	    if (badHeader(_sheader)) {
                 if (!(_badSamples++ % 1000))
                     logBadSampleHeader(getName(),_badSamples,
                             _iostream->getNumInputBytes()-_sheader.getSizeOf(),_raw,_sheader);
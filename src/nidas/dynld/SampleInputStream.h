@@ -32,9 +32,12 @@
 #include <nidas/core/SampleSourceSupport.h>
 #include <nidas/core/SampleStats.h>
 #include <nidas/core/Sample.h>
+#include <nidas/core/CompactSampleHeader.h>
 #include <nidas/core/NidsIterators.h>
 #include <nidas/util/UTime.h>
 
+#include <vector>
+
 namespace nidas {
 
 namespace core {
@@ -263,6 +266,21 @@ public:
      */
     nidas::core::Sample* readSample() throw(nidas::util::IOException);
 
+    /**
+     * Read a block of whole samples, as they are in the input,
+     * with little-endian headers, for copying samples without
+     * decoding each into a Sample. Bad headers are screened and
+     * skipped as by readSample(). Typically the block points into
+     * the input buffer. A sample split across physical reads is
+     * assembled by readSample() and returned in a block of its
+     * own. The block remains valid until the next read from this
+     * SampleInputStream, and may be modified in place, for example
+     * to patch sample ids. Not to be mixed with readSamples().
+     * @param len Returns the length of the block, in bytes.
+     * @return pointer to the block, never NULL.
+     */
+    char* readRawBlock(size_t& len) throw(nidas::util::IOException);
+
 
     /**
      * Distribute a sample to my clients. One could use this
@@ -351,6 +369,47 @@ private:
      **/
     nidas::core::Sample* sampleFromHeader() throw();
 
+    /**
+     * Is a sample header to be screened out, because of its type,
+     * or, if _filterBadSamples, its id, length or time?
+     */
+    bool badHeader(const nidas::core::SampleHeader& header) const
+    {
+        return (_raw && header.getType() != nidas::core::CHAR_ST) ||
+            (_filterBadSamples &&
+             (header.getType() >= nidas::core::UNKNOWN_ST ||
+              GET_DSM_ID(header.getId()) > _maxDsmId ||
+              header.getDataByteLength() > _maxSampleLength ||
+              header.getDataByteLength() == 0 ||
+              header.getTimeTag() < _minSampleTime ||
+              header.getTimeTag() > _maxSampleTime));
+    }
+
+    /**
+     * Parse and distribute the complete samples in the IOStream
+     * buffer in place, rather than copying each header and
+     * sample separately out of the IOStream.  Must be called
+     * between samples. A partial sample at the end of the buffer
+     * is left in the buffer for nextSample().
+     */
+    void distributeBlock() throw();
+
+    /**
+     * distributeBlock() for samples with compact headers.
+     */
+    void distributeCompactBlock() throw();
+
+    /**
+     * nextSample(keepreading) for samples with compact headers.
+     */
+    nidas::core::Sample* nextCompactSample(bool keepreading)
+        throw(nidas::util::IOException);
+
+    /**
+     * Start decoding samples in the encoding of a new SampleInputHeader.
+     */
+    void resetSampleDecoding() throw();
+
     /**
      * Service that has requested my input.
      */
@@ -405,6 +464,39 @@ private:
 
     bool _raw;
 
+    /**
+     * Buffer for a sample which readRawBlock() assembled with readSample().
+     */
+    std::vector<char> _rawBlock;
+
+    /**
+     * Whether the samples have compact headers, from the
+     * sample encoding of the SampleInputHeader.
+     */
+    bool _compact;
+
+    nidas::core::CompactHeaderDecoder _decoder;
+
+    /**
+     * A compact header which is split across reads.
+     */
+    char _cbuf[nidas::core::CompactHeaderEncoder::MAX_LENGTH];
+
+    size_t _clen;
+
+    /**
+     * Bytes left to skip of the data of a screened out sample
+     * with a compact header.
+     */
+    size_t _dataToSkip;
+
+    /**
+     * A compact header could not be decoded. The rest of the input,
+     * up to the header of a new file, is discarded, since the
+     * following headers can't be found.
+     */
+    bool _corrupt;
+
     /**
      * No regular copy.
      */
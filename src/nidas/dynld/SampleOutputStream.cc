@@ -28,6 +28,7 @@
 #include <nidas/core/StatusThread.h>
 
 #include <nidas/util/Logger.h>
+#include <nidas/util/UTime.h>
 
 #include <iostream>
 
@@ -45,7 +46,7 @@ NIDAS_CREATOR_FUNCTION(SampleOutputStream)
 
 SampleOutputStream::SampleOutputStream():
     SampleOutputBase(),_iostream(0),
-    _maxUsecs(0),_lastFlushTT(0)
+    _maxUsecs(0),_lastFlushTT(0),_compact(false),_encoder()
 {
     _maxUsecs = (int)(getLatency() * USECS_PER_SEC);
     _maxUsecs = std::max(_maxUsecs,USECS_PER_SEC / 50);
@@ -53,7 +54,7 @@ SampleOutputStream::SampleOutputStream():
 
 SampleOutputStream::SampleOutputStream(IOChannel* i, SampleConnectionRequester* rqstr):
     SampleOutputBase(i,rqstr),_iostream(0),
-    _maxUsecs(0),_lastFlushTT(0)
+    _maxUsecs(0),_lastFlushTT(0),_compact(false),_encoder()
 {
     _maxUsecs = (int)(getLatency() * USECS_PER_SEC);
     _maxUsecs = std::max(_maxUsecs,USECS_PER_SEC / 50);
@@ -67,7 +68,7 @@ SampleOutputStream::SampleOutputStream(IOChannel* i, SampleConnectionRequester*
 
 SampleOutputStream::SampleOutputStream(SampleOutputStream& x,IOChannel* ioc):
     SampleOutputBase(x,ioc),_iostream(0),
-    _maxUsecs(0),_lastFlushTT(0)
+    _maxUsecs(0),_lastFlushTT(0),_compact(x._compact),_encoder()
 {
     _maxUsecs = (int)(getLatency() * USECS_PER_SEC);
     _maxUsecs = std::max(_maxUsecs,USECS_PER_SEC / 50);
@@ -95,6 +96,19 @@ void SampleOutputStream::close() throw(n_u::IOException)
     SampleOutputBase::close();
 }
 
+void SampleOutputStream::setSampleEncoding(const string& val)
+    	throw(nidas::util::InvalidParameterException)
+{
+    if (val == CompactHeaderEncoder::ENCODING) _compact = true;
+    else if (val.length() == 0 || val == "full") _compact = false;
+    else throw n_u::InvalidParameterException(getName(),"encoding",val);
+}
+
+string SampleOutputStream::getSampleEncoding() const
+{
+    return _compact ? CompactHeaderEncoder::ENCODING : "";
+}
+
 void SampleOutputStream::setLatency(float val)
     	throw(nidas::util::InvalidParameterException)
 {
@@ -145,6 +159,7 @@ bool SampleOutputStream::receive(const Sample *samp) throw()
     try {
         if (tsamp >= getNextFileTime()) {
             if (_iostream) _iostream->flush();
+            _encoder.reset();
             createNextFile(tsamp);
         }
         if ((tsamp - _lastFlushTT) > _maxUsecs) {
@@ -152,7 +167,13 @@ bool SampleOutputStream::receive(const Sample *samp) throw()
             streamFlush = true;
         }
 
-        bool success = write(samp,streamFlush) > 0;
+        bool success;
+        if (PipelineLatency::enabled()) {
+            dsm_time_t t0 = n_u::getSystemTime();
+            success = write(samp,streamFlush) > 0;
+            getWriteLatencyHistogram().record(n_u::getSystemTime() - t0);
+        }
+        else success = write(samp,streamFlush) > 0;
         if (!success) {
             if (!(incrementDiscardedSamples() % 1000)) 
                 WLOG(("%s: %zd samples discarded due to output jambs",
@@ -175,6 +196,41 @@ bool SampleOutputStream::receive(const Sample *samp) throw()
     return true;
 }
 
+bool SampleOutputStream::receiveBlock(const void* buf, size_t len,
+        dsm_time_t tfirst, dsm_time_t tlast) throw()
+{
+    bool streamFlush = false;
+
+    try {
+        if (tfirst >= getNextFileTime()) {
+            if (_iostream) _iostream->flush();
+            _encoder.reset();
+            createNextFile(tfirst);
+        }
+        if ((tlast - _lastFlushTT) > _maxUsecs) {
+            _lastFlushTT = tlast;
+            streamFlush = true;
+        }
+        size_t wlen;
+        if (_compact) wlen = writeCompactBlock(buf,len,streamFlush);
+        else wlen = write(buf,len,streamFlush);
+        if (wlen == 0) {
+            if (!(incrementDiscardedSamples() % 1000))
+                WLOG(("%s: %zd sample blocks discarded due to output jambs",
+                      getName().c_str(), getNumDiscardedSamples()));
+        }
+    }
+    catch(const n_u::IOException& ioe) {
+        if (ioe.getErrno() == EPIPE)
+            NLOG(("%s: %s, disconnecting", getName().c_str(), ioe.what()));
+        else
+            ELOG(("%s: %s, disconnecting", getName().c_str(), ioe.what()));
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
 size_t SampleOutputStream::write(const void* buf, size_t len, bool flush)
 	throw(n_u::IOException)
 {
@@ -185,6 +241,11 @@ size_t SampleOutputStream::write(const void* buf, size_t len, bool flush)
 size_t SampleOutputStream::write(const Sample* samp, bool streamFlush) throw(n_u::IOException)
 {
     if (!_iostream) return 0;
+    if (_compact)
+        return writeCompact(samp->getTimeTag(),samp->getRawId(),
+            samp->getConstVoidDataPtr(),samp->getDataByteLength(),
+            streamFlush);
+
     static int nsamps = 0;
     struct iovec iov[2];
 
@@ -214,3 +275,47 @@ size_t SampleOutputStream::write(const Sample* samp, bool streamFlush) throw(n_u
     return l;
 }
 
+
+size_t SampleOutputStream::writeCompact(dsm_time_t tt, dsm_sample_id_t rawId,
+    const void* data, unsigned int len, bool streamFlush)
+    throw(n_u::IOException)
+{
+    char header[CompactHeaderEncoder::MAX_LENGTH];
+    struct iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len = _encoder.encode(tt,rawId,len,header);
+    iov[1].iov_base = const_cast<void*>(data);
+    iov[1].iov_len = len;
+
+    size_t l = _iostream->write(iov,2,streamFlush);
+    // a sample which wasn't written is left out of the encoding
+    if (l > 0) _encoder.accept();
+    return l;
+}
+
+size_t SampleOutputStream::writeCompactBlock(const void* buf, size_t len,
+    bool streamFlush) throw(n_u::IOException)
+{
+    if (!_iostream) return 0;
+    const size_t hlen = SampleHeader::getSizeOf();
+    const char* cp = (const char*) buf;
+    const char* eb = cp + len;
+    size_t lout = 0;
+
+    SampleHeader header;
+    while ((size_t)(eb - cp) >= hlen) {
+        ::memcpy(&header,cp,hlen);
+#if __BYTE_ORDER == __BIG_ENDIAN
+        header.setTimeTag(bswap_64(header.getTimeTag()));
+        header.setDataByteLength(bswap_32(header.getDataByteLength()));
+        header.setRawId(bswap_32(header.getRawId()));
+#endif
+        size_t dlen = header.getDataByteLength();
+        cp += hlen;
+        if ((size_t)(eb - cp) < dlen) break;
+        lout += writeCompact(header.getTimeTag(),header.getRawId(),cp,dlen,
+            streamFlush && cp + dlen == eb);
+        cp += dlen;
+    }
+    return lout;
+}
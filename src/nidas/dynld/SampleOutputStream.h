@@ -29,6 +29,7 @@
 
 
 #include <nidas/core/SampleOutput.h>
+#include <nidas/core/CompactSampleHeader.h>
 
 namespace nidas { namespace dynld {
 
@@ -70,6 +71,19 @@ public:
 
     bool receive(const Sample *s) throw();
 
+    /**
+     * Write a block of whole samples which are already in the
+     * little-endian format of this stream, as read with
+     * SampleInputStream::readRawBlock(). As with receive(), a new
+     * file is started if tfirst is at or past getNextFileTime(),
+     * so the caller should start a new block with the first
+     * sample whose time is past getNextFileTime().
+     * @param tfirst Time tag of the first sample in the block.
+     * @param tlast Time tag of the last sample in the block.
+     */
+    bool receiveBlock(const void* buf, size_t len,
+        dsm_time_t tfirst, dsm_time_t tlast) throw();
+
     void flush() throw();
 
     size_t write(const void* buf, size_t len, bool streamFlush)
@@ -86,6 +100,17 @@ public:
     void setLatency(float val)
     	throw(nidas::util::InvalidParameterException);
 
+    /**
+     * Set the encoding of the samples: "" or "full", the default,
+     * or CompactHeaderEncoder::ENCODING, "compact", for a compact
+     * header in front of the data of each sample in place of the
+     * 16 byte SampleHeader.
+     */
+    void setSampleEncoding(const std::string& val)
+    	throw(nidas::util::InvalidParameterException);
+
+    std::string getSampleEncoding() const;
+
 protected:
 
     SampleOutputStream* clone(IOChannel* iochannel);
@@ -101,6 +126,21 @@ protected:
 
 private:
 
+    /**
+     * Write a sample with a compact header.
+     */
+    size_t writeCompact(dsm_time_t tt, dsm_sample_id_t rawId,
+        const void* data, unsigned int len, bool streamFlush)
+        throw(nidas::util::IOException);
+
+    /**
+     * Write a block of samples with full little-endian
+     * SampleHeaders, as passed to receiveBlock(), with
+     * compact headers.
+     */
+    size_t writeCompactBlock(const void* buf, size_t len, bool streamFlush)
+        throw(nidas::util::IOException);
+
     /**
      * Maximum number of microseconds between physical writes.
      */
@@ -111,6 +151,10 @@ private:
      */
     dsm_time_t _lastFlushTT;
 
+    bool _compact;
+
+    CompactHeaderEncoder _encoder;
+
     /**
      * No copy.
      */
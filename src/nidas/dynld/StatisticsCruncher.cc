@@ -125,7 +125,7 @@ StatisticsCruncher::StatisticsCruncher(StatisticsProcessor* proc,
 
 StatisticsCruncher::~StatisticsCruncher()
 {
-    map<dsm_sample_id_t,sampleInfo >::iterator vmi;
+    SampleIdMap<sampleInfo>::iterator vmi;
     for (vmi = _sampleMap.begin(); vmi != _sampleMap.end(); ++vmi) {
 	struct sampleInfo& sinfo = vmi->second;
 	vector<unsigned int*>& vindices = sinfo.varIndices;
@@ -304,7 +304,7 @@ void StatisticsCruncher::attach(SampleSource* source)
 	const SampleTag* intag = *inti;
 	dsm_sample_id_t id = intag->getId();
 
-	map<dsm_sample_id_t,sampleInfo >::iterator vmi =
+	SampleIdMap<sampleInfo>::iterator vmi =
 	    _sampleMap.find(id);
 
 	if (vmi != _sampleMap.end()) {
@@ -1323,7 +1323,7 @@ bool StatisticsCruncher::receive(const Sample* samp) throw()
 
     dsm_sample_id_t id = samp->getId();
 
-    map<dsm_sample_id_t,sampleInfo >::iterator vmi =
+    SampleIdMap<sampleInfo>::iterator vmi =
     	_sampleMap.find(id);
     if (vmi == _sampleMap.end()) {
         WLOG(("unrecognized sample, id=") << samp->getDSMId() << ',' << samp->getSpSId() <<
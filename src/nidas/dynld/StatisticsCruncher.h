@@ -31,6 +31,7 @@
 #include <nidas/core/SampleClient.h>
 #include <nidas/core/SamplePipeline.h>
 #include <nidas/core/NearestResampler.h>
+#include <nidas/core/SampleIdMap.h>
 #include <nidas/util/UTime.h>
 
 #include <vector>
@@ -326,7 +327,7 @@ private:
 	std::vector<unsigned int*> varIndices;
     };
 
-    std::map<dsm_sample_id_t,sampleInfo > _sampleMap;
+    nidas::core::SampleIdMap<sampleInfo> _sampleMap;
 
     float* _xMin;
 
@@ -193,6 +193,12 @@ void ATIK_Sonic::removeShadowCorrection(dsm_time_t, float* ) throw()
 bool ATIK_Sonic::process(const Sample* samp,
 	std::list<const Sample*>& results) throw()
 {
+    return processIntoList(samp,results);
+}
+
+bool ATIK_Sonic::processInto(const Sample* samp,
+	std::vector<const Sample*>& results) throw()
+{
 
     float uvwt[4];
     float counts[3] = {0.0,0.0,0.0};
@@ -201,12 +207,9 @@ bool ATIK_Sonic::process(const Sample* samp,
     dsm_time_t timetag;
 
     if (getScanfers().size() > 0) {
-        std::list<const Sample*> parseResults;
-        SerialSensor::process(samp,parseResults);
-        if (parseResults.empty()) return false;
-
         // result from base class parsing of ASCII
-        const Sample* psamp = parseResults.front();
+        const Sample* psamp = parseSample(samp);
+        if (!psamp) return false;
         timetag = psamp->getTimeTag();
 
         unsigned int nvals = psamp->getDataLength();
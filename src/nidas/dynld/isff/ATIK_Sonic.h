@@ -53,6 +53,9 @@ public:
     bool process(const nidas::core::Sample* samp,std::list<const nidas::core::Sample*>& results)
     	throw();
 
+    bool processInto(const nidas::core::Sample* samp,std::vector<const nidas::core::Sample*>& results)
+    	throw();
+
     /**
      * Apply the path shadow correction and described in the comments
      * for _maxShadowAngle, and _shadowFactor.
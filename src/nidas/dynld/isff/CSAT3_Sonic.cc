@@ -589,6 +589,12 @@ float CSAT3_Sonic::correctTcForPathCurvature(float tc, float, float, float)
 bool CSAT3_Sonic::process(const Sample* samp,
         std::list<const Sample*>& results) throw()
 {
+    return processIntoList(samp,results);
+}
+
+bool CSAT3_Sonic::processInto(const Sample* samp,
+        std::vector<const Sample*>& results) throw()
+{
 
     size_t inlen = samp->getDataByteLength();
     if (inlen < _windInLen) return false;	// not enough data
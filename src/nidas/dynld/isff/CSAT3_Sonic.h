@@ -77,6 +77,9 @@ public:
     bool process(const Sample* samp,std::list<const Sample*>& results)
     	throw();
 
+    bool processInto(const Sample* samp,std::vector<const Sample*>& results)
+    	throw();
+
     void parseParameters() throw(nidas::util::InvalidParameterException);
 
     /**
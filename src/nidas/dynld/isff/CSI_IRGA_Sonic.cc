@@ -194,6 +194,12 @@ bool CSI_IRGA_Sonic::reportBadCRC()
 bool CSI_IRGA_Sonic::process(const Sample* samp,
 	std::list<const Sample*>& results) throw()
 {
+    return processIntoList(samp,results);
+}
+
+bool CSI_IRGA_Sonic::processInto(const Sample* samp,
+	std::vector<const Sample*>& results) throw()
+{
 
     const char* buf = (const char*) samp->getConstVoidDataPtr();
     unsigned int len = samp->getDataByteLength();
@@ -298,14 +304,10 @@ bool CSI_IRGA_Sonic::process(const Sample* samp,
         }
     }
     else {
-        std::list<const Sample*> parseResults;
-
-        SerialSensor::process(samp,parseResults);
-
-        if (parseResults.empty()) return false;
-
         // result from base class parsing of ASCII
-        psamp = parseResults.front();
+        psamp = parseSample(samp);
+
+        if (!psamp) return false;
 
         // base class has adjusted time tag for latency jitter
         wsamptime = psamp->getTimeTag() - _timeDelay;
@@ -58,6 +58,9 @@ public:
     bool process(const Sample* samp,std::list<const Sample*>& results)
     	throw();
 
+    bool processInto(const Sample* samp,std::vector<const Sample*>& results)
+    	throw();
+
     /**
      * Calculate the CRC signature of a data record. From EC150 manual.
      */
@@ -104,12 +104,17 @@ void Licor7500::validate() throw(n_u::InvalidParameterException)
 bool Licor7500::process(const Sample* samp,
 	std::list<const Sample*>& results) throw()
 {
+    return processIntoList(samp,results);
+}
+
+bool Licor7500::processInto(const Sample* samp,
+	std::vector<const Sample*>& results) throw()
+{
 
-    nidas::core::SerialSensor::process(samp,results);
+    const Sample* csamp = parseSample(samp);
 
-    if (results.empty()) return false;
+    if (!csamp) return false;
 
-    const Sample* csamp = results.front();
     unsigned int slen = csamp->getDataLength();
 
     float diag = floatNAN;
@@ -140,8 +145,9 @@ bool Licor7500::process(const Sample* samp,
 
         csamp->freeReference();
 
-        results.front() = news;
+        csamp = news;
     }
+    results.push_back(csamp);
     return true;
 }
 
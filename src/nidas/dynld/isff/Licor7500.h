@@ -50,6 +50,9 @@ public:
     bool process(const nidas::core::Sample* samp,std::list<const nidas::core::Sample*>& results)
     	throw();
 
+    bool processInto(const nidas::core::Sample* samp,std::vector<const nidas::core::Sample*>& results)
+    	throw();
+
 private:
 
     /**
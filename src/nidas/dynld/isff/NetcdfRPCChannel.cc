@@ -448,7 +448,7 @@ void NetcdfRPCChannel::write(const Sample* samp)
 
     dsm_sample_id_t sampid = samp->getId();
 
-    map<dsm_sample_id_t,NcVarGroupFloat*>::const_iterator gi =
+    SampleIdMap<NcVarGroupFloat*>::const_iterator gi =
     	_groupById.find(sampid);
 
     VLOG(("NetcdfRPCChannel::write: ")
@@ -33,6 +33,7 @@
 
 #include <nidas/core/IOChannel.h>
 #include <nidas/core/SampleTag.h>
+#include <nidas/core/SampleIdMap.h>
 #include <nidas/core/Parameter.h>
 
 #include <nc_server_rpc.h>
@@ -288,9 +289,9 @@ private:
 
     time_t _lastNonBatchWrite;
 
-    std::map<dsm_sample_id_t,NcVarGroupFloat*> _groupById;
+    SampleIdMap<NcVarGroupFloat*> _groupById;
 
-    std::map<dsm_sample_id_t,int> _stationIndexById;
+    SampleIdMap<int> _stationIndexById;
 
     std::list<NcVarGroupFloat*> _groups;
     
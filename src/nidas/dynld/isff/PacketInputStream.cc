@@ -30,7 +30,12 @@
 #include <nidas/core/Project.h>
 #include <nidas/core/SampleTag.h>
 
+#include <nidas/util/EOFException.h>
 #include <nidas/util/Logger.h>
+#include <nidas/util/Thread.h>
+
+#include <algorithm>
+#include <sstream>
 
 using namespace nidas::core;
 using namespace nidas::dynld::isff;
@@ -46,7 +51,7 @@ NIDAS_CREATOR_FUNCTION_NS(isff,PacketInputStream)
 PacketInputStream::PacketInputStream(IOChannel* iochannel)
     throw(n_u::InvalidParameterException):
     _iochan(iochannel),_iostream(0),_packetParser(0),
-    _projectsByConfigId()
+    _projectsByConfigId(),_nthreads(1),_parsers(),_eof(false)
 {
     if (_iochan)
         _iostream = new IOStream(*_iochan,_iochan->getBufferSize());
@@ -58,7 +63,7 @@ PacketInputStream::PacketInputStream(IOChannel* iochannel)
 PacketInputStream::PacketInputStream(const PacketInputStream&,
 	IOChannel* iochannel):
     _iochan(iochannel),_iostream(0),_packetParser(0),
-    _projectsByConfigId()
+    _projectsByConfigId(),_nthreads(1),_parsers(),_eof(false)
 {
     if (_iochan)
         _iostream = new IOStream(*_iochan,_iochan->getBufferSize());
@@ -77,6 +82,7 @@ PacketInputStream::~PacketInputStream()
     delete _iostream;
     delete _iochan;
     delete _packetParser;
+    for (unsigned int i = 0; i < _parsers.size(); i++) delete _parsers[i];
     map<int,GOESProject*>::const_iterator pi =
     	_projectsByConfigId.begin();
     for ( ; pi != _projectsByConfigId.end(); ++pi) delete pi->second;
@@ -117,15 +123,19 @@ void PacketInputStream::close() throw(n_u::IOException)
     _iostream = 0;
     delete _packetParser;
     _packetParser = 0;
+    for (unsigned int i = 0; i < _parsers.size(); i++) delete _parsers[i];
+    _parsers.clear();
     _iochan->close();
 }
 
 bool PacketInputStream::readSamples() throw(n_u::IOException)
 {
+    if (_nthreads > 1) return readBatch();
+
     char packet[1024];
     size_t len = _iostream->readUntil(packet,sizeof(packet),'\n');
 
-    if (packet[len-1] != '\n')
+    if (len == 0 || packet[len-1] != '\n')
     	throw n_u::IOException(getName(),"readUntil",
 		"no termination character found");
 
@@ -134,100 +144,259 @@ bool PacketInputStream::readSamples() throw(n_u::IOException)
     for (i = 0; i < len && ::isspace(packet[i]); i++);
     if (i == len) return false;
 
+    vector<Sample*> samples;
+    try {
+        decodePacket(*_packetParser,packet,samples);
+    }
+    catch(const n_u::InvalidParameterException& e) {
+        for (i = 0; i < samples.size(); i++) samples[i]->freeReference();
+	throw n_u::IOException(getName(),"readSamples",e.what());
+    }
+    for (i = 0; i < samples.size(); i++) _source.distribute(samples[i]);
+    return true;
+}
+
+void PacketInputStream::decodePacket(PacketParser& parser,
+    const char* packet, vector<Sample*>& samples) const
+    throw(n_u::InvalidParameterException)
+{
     PacketParser::packet_type ptype;
 
     try {
-	ptype = _packetParser->parse(packet);
+	ptype = parser.parse(packet);
     }
     catch (const n_u::ParseException& e) {
 	n_u::Logger::getInstance()->log(LOG_WARNING,
 	    "%s: %s",getName().c_str(),e.what());
-	return true;
+	return;
     }
 
 #ifdef DEBUG
-    cerr << hex << _packetParser->getStationId() << dec << ' ' << 
-    	_packetParser->getPacketTime().format(true,"%c") << ' ' <<
-	*_packetParser->getPacketInfo() << endl;
+    cerr << hex << parser.getStationId() << dec << ' ' << 
+    	parser.getPacketTime().format(true,"%c") << ' ' <<
+	*parser.getPacketInfo() << endl;
 #endif
 
     switch(ptype) {
     case PacketParser::NESDIS_PT:
 	break;
     default:
-        return true;
+        return;
     }
 
-    dsm_time_t tpack = _packetParser->getPacketTime().toUsecs();
-    const PacketInfo* pinfo = _packetParser->getPacketInfo();
+    dsm_time_t tpack = parser.getPacketTime().toUsecs();
+    const PacketInfo* pinfo = parser.getPacketInfo();
 
-    try {
+    const GOESProject* gp = getGOESProject(parser.getConfigId());
+    int stationNumber = gp->getStationNumber(parser.getStationId());
 
-	const GOESProject* gp = getGOESProject(_packetParser->getConfigId());
-	int stationNumber = gp->getStationNumber(_packetParser->getStationId());
+    int xmitIntervalUsec = gp->getXmitInterval(stationNumber) *
+            USECS_PER_SEC;
+    int xmitOffsetUsec = gp->getXmitOffset(stationNumber) * USECS_PER_SEC;
 
-	int xmitIntervalUsec = gp->getXmitInterval(stationNumber) *
-		USECS_PER_SEC;
-	int xmitOffsetUsec = gp->getXmitOffset(stationNumber) * USECS_PER_SEC;
+    // send a sample of GOES info
+    const SampleTag* tag = gp->getGOESSampleTag(stationNumber);
+    if (!tag) return;
 
-	// send a sample of GOES info
-	const SampleTag* tag = gp->getGOESSampleTag(stationNumber);
-        if (!tag) return true;
+    // Time of transmit interval.
+    dsm_time_t txmit = tpack - (tpack % xmitIntervalUsec);
 
-	// Time of transmit interval.
-	dsm_time_t txmit = tpack - (tpack % xmitIntervalUsec);
+    // expected station transmission time
+    dsm_time_t texpect = txmit + xmitOffsetUsec;
 
-	// expected station transmission time
-	dsm_time_t texpect = txmit + xmitOffsetUsec;
+    int tdiff = (tpack - texpect) / USECS_PER_SEC;
 
-	int tdiff = (tpack - texpect) / USECS_PER_SEC;
+    SampleT<float>* samp = getSample<float>(tag->getVariables().size());
+    assert(samp->getDataLength() == 5);
 
-	SampleT<float>* samp = getSample<float>(tag->getVariables().size());
-	assert(samp->getDataLength() == 5);
+    // sample time is middle of transmit interval
+    samp->setTimeTag(txmit - xmitIntervalUsec / 2);
+    samp->setId(tag->getId());
 
-	// sample time is middle of transmit interval
-	samp->setTimeTag(txmit - xmitIntervalUsec / 2);
-	samp->setId(tag->getId());
+    float* fptr = samp->getDataPtr();
+    fptr[0] = tdiff;
+    fptr[1] = pinfo->getSignalStrength();
+    fptr[2] = pinfo->getFreqOffset();
+    fptr[3] = pinfo->getChannel();
+    fptr[4] = pinfo->getStatusInt();
+    samples.push_back(samp);
 
-	float* fptr = samp->getDataPtr();
-	fptr[0] = tdiff;
-	fptr[1] = pinfo->getSignalStrength();
-	fptr[2] = pinfo->getFreqOffset();
-	fptr[3] = pinfo->getChannel();
-	fptr[4] = pinfo->getStatusInt();
-	_source.distribute(samp);
+    DLOG(("packetParser->getSampleId()=") << parser.getSampleId());
+    if (parser.getSampleId() >= 0) {
 
-// #define DEBUG
-        DLOG(("packetParser->getSampleId()=") <<
-            _packetParser->getSampleId());
-	if (_packetParser->getSampleId() >= 0) {
+        DLOG(("packetParser->getConfigId()=") << parser.getConfigId());
 
-            DLOG(("packetParser->getConfigId()=") <<
-                _packetParser->getConfigId());
+        tag = findSampleTag(parser.getConfigId(),
+            parser.getStationId(),parser.getSampleId());
 
-	    tag = findSampleTag(_packetParser->getConfigId(),
-		_packetParser->getStationId(),_packetParser->getSampleId());
+        if (!tag) return;
 
-	    if (!tag) return true;
+        size_t nvars = tag->getVariables().size();
 
-	    size_t nvars = tag->getVariables().size();
-	    // cerr << "nvars=" << nvars << endl;
+        samp = getSample<float>(nvars);
 
-	    samp = getSample<float>(nvars);
+        samp->setTimeTag(txmit - xmitIntervalUsec / 2);
+        samp->setId(tag->getId());
 
-	    // cerr << "xmitInterval=" << xmitInterval << " tdiff=" << tdiff << endl;
+        parser.parseData(samp->getDataPtr(),nvars);
 
-	    samp->setTimeTag(txmit - xmitIntervalUsec / 2);
-	    samp->setId(tag->getId());
+        samples.push_back(samp);
+    }
+}
 
-	    _packetParser->parseData(samp->getDataPtr(),nvars);
+/**
+ * Thread which decodes its share of a batch of packets.
+ */
+class PacketInputStream::DecodeThread: public n_u::Thread
+{
+public:
+    DecodeThread(const PacketInputStream& input, PacketParser& parser,
+        const vector<char>& buf, const vector<size_t>& offsets,
+        const vector<int>& owners, int owner,
+        vector<vector<Sample*> >& samples):
+        n_u::Thread("PacketDecode"),_input(input),_parser(parser),
+        _buf(buf),_offsets(offsets),_owners(owners),_owner(owner),
+        _samples(samples)
+    {
+    }
 
-	    _source.distribute(samp);
-	}
+    int run() throw(n_u::Exception)
+    {
+        for (unsigned int i = 0; i < _owners.size(); i++) {
+            if (_owners[i] != _owner) continue;
+            _input.decodePacket(_parser,&_buf[_offsets[i]],
+                _samples[i]);
+        }
+        return RUN_OK;
+    }
+
+private:
+    const PacketInputStream& _input;
+    PacketParser& _parser;
+    const vector<char>& _buf;
+    const vector<size_t>& _offsets;
+    const vector<int>& _owners;
+    int _owner;
+    vector<vector<Sample*> >& _samples;
+
+    // No copying.
+    DecodeThread(const DecodeThread&);
+
+    // No assignment.
+    DecodeThread& operator=(const DecodeThread&);
+};
+
+namespace {
+
+bool
+timeTagLess(const Sample* s1, const Sample* s2)
+{
+    return s1->getTimeTag() < s2->getTimeTag();
+}
+
+}
+
+bool PacketInputStream::readBatch() throw(n_u::IOException)
+{
+    if (_eof) throw n_u::EOFException(getName(),"read");
+
+    // Number of packets in a batch.  Large enough that the cost
+    // of starting the threads is small.
+    const int BATCH_SIZE = 4096;
+
+    // Create the projects before the threads look them up.
+    try {
+        getGOESProject(0);
     }
     catch(const n_u::InvalidParameterException& e) {
 	throw n_u::IOException(getName(),"readSamples",e.what());
     }
+
+    while ((signed)_parsers.size() < _nthreads)
+        _parsers.push_back(new PacketParser());
+
+    // Maximum length of a packet, including the trailing NUL.
+    const size_t PACKET_MAX = 1024;
+
+    // Packets are read, NUL terminated, directly into one buffer,
+    // and decoded from there by the threads.
+    vector<char> buf;
+    buf.reserve(BATCH_SIZE * 256);
+    vector<size_t> offsets;
+    vector<int> owners;
+
+    size_t off = 0;
+    try {
+        while ((signed)offsets.size() < BATCH_SIZE) {
+            buf.resize(off + PACKET_MAX);
+            char* packet = &buf[off];
+            size_t len = _iostream->readUntil(packet,PACKET_MAX,'\n');
+            if (len == 0 || packet[len-1] != '\n')
+                throw n_u::IOException(getName(),"readUntil",
+                    "no termination character found");
+
+            // toss empty packets
+            size_t i;
+            for (i = 0; i < len && ::isspace(packet[i]); i++);
+            if (i == len) continue;
+
+            // Packets of a station, identified by its 8 character
+            // GOES id, are decoded by the same thread.
+            unsigned int hash = 0;
+            for (i = 0; i < 8 && i < len; i++)
+                hash = hash * 31 + (unsigned char)packet[i];
+
+            offsets.push_back(off);
+            owners.push_back(hash % _nthreads);
+            off += len + 1;
+        }
+    }
+    catch (const n_u::EOFException&) {
+        _eof = true;
+        if (offsets.empty()) throw;
+    }
+    buf.resize(off);
+
+    vector<vector<Sample*> > samples(offsets.size());
+
+    vector<DecodeThread*> threads;
+    for (int i = 0; i < _nthreads; i++) {
+        DecodeThread* thread = new DecodeThread(*this,*_parsers[i],
+            buf,offsets,owners,i,samples);
+        thread->start();
+        threads.push_back(thread);
+    }
+
+    string errmsg;
+    for (int i = 0; i < _nthreads; i++) {
+        try {
+            threads[i]->join();
+        }
+        catch(const n_u::Exception& e) {
+            if (errmsg.empty()) errmsg = e.what();
+        }
+        delete threads[i];
+    }
+
+    vector<Sample*> sorted;
+    for (unsigned int i = 0; i < samples.size(); i++)
+        sorted.insert(sorted.end(),samples[i].begin(),samples[i].end());
+
+    if (!errmsg.empty()) {
+        for (unsigned int i = 0; i < sorted.size(); i++)
+            sorted[i]->freeReference();
+	throw n_u::IOException(getName(),"readSamples",errmsg);
+    }
+
+    // Samples of a batch are distributed in time order. The stable
+    // sort keeps the order of samples with equal time tags the
+    // same as that of the packets. Samples are not re-ordered
+    // across batches, so a sample of this batch may be earlier
+    // than one distributed from the previous batch.
+    std::stable_sort(sorted.begin(),sorted.end(),timeTagLess);
+
+    for (unsigned int i = 0; i < sorted.size(); i++)
+        _source.distribute(sorted[i]);
     return true;
 }
 
@@ -263,7 +432,7 @@ const GOESProject*
 }
 
 const SampleTag* PacketInputStream::findSampleTag(int configId,
-	int goesId,int sampleId) throw(n_u::InvalidParameterException)
+	int goesId,int sampleId) const throw(n_u::InvalidParameterException)
 {
     const GOESProject* gp = getGOESProject(configId);
     int stationNumber = gp->getStationNumber(goesId);
@@ -30,6 +30,8 @@
 #include "Packets.h"
 #include <nidas/dynld/SampleInputStream.h>
 
+#include <vector>
+
 namespace nidas {
 
 namespace core {
@@ -98,6 +100,21 @@ public:
      */
     bool readSamples() throw(nidas::util::IOException);
 
+    /**
+     * Number of threads used to decode packets. With more than one,
+     * readSamples() reads a batch of up to 4096 packets into one
+     * buffer and decodes them there in parallel, with all packets
+     * from a station decoded by the same thread. The decoded samples
+     * of a batch are distributed sorted by time. They are only
+     * sorted within a batch, not across batches, so the output
+     * is not time ordered overall unless the input is.
+     * Default: 1, packets are decoded and distributed one at a time,
+     * in the order they are read.
+     */
+    void setNumThreads(int val) { _nthreads = val; }
+
+    int getNumThreads() const { return _nthreads; }
+
     void close() throw(nidas::util::IOException);
 
     /** 
@@ -107,7 +124,25 @@ public:
 
 private:
 
-    const nidas::core::SampleTag* findSampleTag(int configId, int goesId, int sampleId)
+    class DecodeThread;
+
+    /**
+     * Parse a packet and append the samples decoded from it to samples.
+     * ParseExceptions are logged, and the packet is skipped.
+     * Does not modify the state of this PacketInputStream,
+     * and so may be called from more than one thread,
+     * each with its own PacketParser.
+     */
+    void decodePacket(PacketParser& parser, const char* packet,
+        std::vector<nidas::core::Sample*>& samples) const
+        throw(nidas::util::InvalidParameterException);
+
+    /**
+     * Read and decode a batch of packets with _nthreads threads.
+     */
+    bool readBatch() throw(nidas::util::IOException);
+
+    const nidas::core::SampleTag* findSampleTag(int configId, int goesId, int sampleId) const
 	    throw(nidas::util::InvalidParameterException);
 
     const GOESProject* getGOESProject(int configid) const
@@ -121,6 +156,20 @@ private:
 
     mutable std::map<int,GOESProject*> _projectsByConfigId;
 
+    int _nthreads;
+
+    /**
+     * One PacketParser for each decoding thread.
+     */
+    std::vector<PacketParser*> _parsers;
+
+    /**
+     * Set when the input ended while reading a batch. The samples of
+     * the partial batch are distributed, and the next readSamples()
+     * throws EOFException.
+     */
+    bool _eof;
+
     /**
      * No copy.
      */
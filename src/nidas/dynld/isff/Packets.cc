@@ -38,17 +38,55 @@ using namespace std;
 
 namespace n_u = nidas::util;
 
-/* static */
-::regex_t** PacketParser::_packetPreg = 0;
-
 /* static */
 ::regex_t** PacketParser::_infoPreg = 0;
 
 /* static */
 nidas::util::Mutex PacketParser::_pregMutex;
 
+/* static */
+int PacketParser::_nInfoTypes = 0;
+
+namespace {
+
+/**
+ * Value of an upper case hex digit, or -1.
+ */
+inline int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline bool inRange(char c, char c1, char c2)
+{
+    return c >= c1 && c <= c2;
+}
+
+/**
+ * Value of n decimal digits, or -1 if they are not all digits.
+ */
+inline int decimal(const char* cp, int n)
+{
+    int val = 0;
+    for (int i = 0; i < n; i++) {
+        if (!inRange(cp[i],'0','9')) return -1;
+        val = val * 10 + cp[i] - '0';
+    }
+    return val;
+}
+
+inline int skipSpaces(const char* cp)
+{
+    int n = 0;
+    for ( ; cp[n] == ' '; n++);
+    return n;
+}
+
+}
+
 PacketParser::PacketParser() throw(n_u::ParseException):
-    _nPacketTypes(0),_nInfoTypes(0),
     _nmatch(10), _pmatch(0),
     _packetInfo(0), _infoType(-1),
     _packetTime((time_t)0),_stationId(-1),
@@ -60,35 +98,22 @@ PacketParser::PacketParser() throw(n_u::ParseException):
 
     n_u::Autolock autolock(_pregMutex);
 
-    // Check if regular expressions need compiling
-    if (!_packetPreg) {
+    // Check if regular expressions need compiling.
+    // The packet header and the NESDIS info fields are fixed
+    // format, and are parsed directly by parseHeader() and
+    // matchNESDISInfo(), following these regular expressions:
+    //
+    // NESDIS message header:
+    // stnid         yr           doy             hr        mn            sc
+    // "^([0-9A-F]{8})([0-9]{2})([0-3][0-9][0-9])([0-2][0-9])([0-5][0-9])([0-5][0-9]) *"
+    //
+    // NESDIS type info fields:
+    //   quality      dbm    freq offset  mod  dq  chann   E/W      len
+    // "^[G?WDQABITUMN][0-9]{2}[-+][0-9A-F][NLH][NFP][0-9]{3}[EW]..[0-9]{5} *"
+    if (!_infoPreg) {
 	int regstatus;
 
-	const char *packetRE[] = {
-// Extended regular expression for parsing a Packet NESDIS message
-// stnid         yr           doy             hr        mn            sc
-"^([0-9A-F]{8})([0-9]{2})([0-3][0-9][0-9])([0-2][0-9])([0-5][0-9])([0-5][0-9]) *",
-	};
-
-	_nPacketTypes = sizeof(packetRE) / sizeof(packetRE[0]);
-	_packetPreg = new ::regex_t *[_nPacketTypes];
-
-	for (int i = 0; i < _nPacketTypes; i++) {
-	    _packetPreg[i] = new ::regex_t;
-	    if ((regstatus = ::regcomp(_packetPreg[i],packetRE[i],REG_EXTENDED))
-		!= 0) {
-		char regerrbuf[64];
-		::regerror(regstatus,_packetPreg[i],regerrbuf,sizeof regerrbuf);
-		delete _packetPreg[i]; _packetPreg[i] = 0;
-		throw n_u::ParseException(string("regcomp: ") + regerrbuf + ": " +
-			packetRE[i]);
-	    }
-	}
 	const char *infoRE[] = {
-// Extended regular expression for parsing NESDIS type info fields
-//   quality      dbm    freq offset  mod  dq  chann   E/W      len
-"^[G?WDQABITUMN][0-9]{2}[-+][0-9A-F][NLH][NFP][0-9]{3}[EW]..[0-9]{5} *",
-
 // Extended regular expression for parsing SUTRON info fields
 // "^[0-9] +[-+0-9.]+ +[0-9]+ +[0-9]+ +[-+0-9.]+ *",
 "^[0-9] +(([-+]?[0-9]+\\.?[0-9]*)|([-+]?\\.?[0-9]+)) *[0-9]+ *[0-9]+ *(([-+]?[0-9]+\\.?[0-9]*)|([-+]?\\.?[0-9]+)) *",
@@ -116,6 +141,50 @@ PacketParser::~PacketParser()
     delete [] _pmatch;
 }
 
+int PacketParser::parseHeader(const char* packet)
+{
+    unsigned int stationId = 0;
+    for (int i = 0; i < 8; i++) {
+        int d = hexDigit(packet[i]);
+        if (d < 0) return -1;
+        stationId = (stationId << 4) + d;
+    }
+    const char* cp = packet + 8;
+    // check that there are 11 digits before looking at the
+    // leading digit of each field
+    for (int i = 0; i < 11; i++)
+        if (!inRange(cp[i],'0','9')) return -1;
+    if (!inRange(cp[2],'0','3') || !inRange(cp[5],'0','2') ||
+        !inRange(cp[7],'0','5') || !inRange(cp[9],'0','5')) return -1;
+
+    int year = decimal(cp,2);
+    int jday = decimal(cp + 2,3);
+    int hour = decimal(cp + 5,2);
+    int minute = decimal(cp + 7,2);
+    int sec = decimal(cp + 9,2);
+
+    _stationId = stationId;
+    _packetTime = n_u::UTime(true,year,jday,hour,minute,sec);
+    cp += 11;
+    return cp - packet + skipSpaces(cp);
+}
+
+int PacketParser::matchNESDISInfo(const char* cp)
+{
+    if (!::strchr("G?WDQABITUMN",cp[0]) || cp[0] == '\0') return -1;
+    if (decimal(cp + 1,2) < 0) return -1;
+    if (cp[3] != '-' && cp[3] != '+') return -1;
+    if (hexDigit(cp[4]) < 0) return -1;
+    if (cp[5] != 'N' && cp[5] != 'L' && cp[5] != 'H') return -1;
+    if (cp[6] != 'N' && cp[6] != 'F' && cp[6] != 'P') return -1;
+    if (decimal(cp + 7,3) < 0) return -1;
+    if (cp[10] != 'E' && cp[10] != 'W') return -1;
+    // two characters, of any value
+    if (cp[11] == '\0' || cp[12] == '\0') return -1;
+    if (decimal(cp + 13,5) < 0) return -1;
+    return 18 + skipSpaces(cp + 18);
+}
+
 PacketParser::packet_type PacketParser::parse(const char* packet)
 	throw(n_u::ParseException)
 {
@@ -125,74 +194,43 @@ PacketParser::packet_type PacketParser::parse(const char* packet)
     _configId = -1;
     _sampleId = -1;
 
-    int packetType;
-
-    int regstatus;
-
     // parse beginning of packet 
-    for (packetType = 0; packetType < _nPacketTypes; packetType++) {
-	if ((regstatus = ::regexec(_packetPreg[packetType],packet,
-	    	_nmatch,_pmatch,0)) == 0) break;
-    }
-    if (packetType == _nPacketTypes) {      // not a packet
+    int headerLen = parseHeader(packet);
+    if (headerLen < 0) {      // not a packet
 	ostringstream ost;
 	ost << "Bad packet (" << strlen(packet) << " bytes) \"" <<
 		packet << "\"";
 	throw n_u::ParseException(ost.str());
     }
 
+    _packetPtr = packet + headerLen;
 
-    _packetPtr = packet;
-    switch(packetType) {
-    case NESDIS_PT:
-	{
-	    int year,jday,hour,minute,sec;
-	    assert(_pmatch[1].rm_so >= 0 && _pmatch[2].rm_so >= 0);
-
-	    // hex goesid
-	    if (sscanf(_packetPtr + _pmatch[1].rm_so,"%8x",&_stationId) != 1)
-		throw n_u::ParseException(string("bad goesid in packet:") +
-			string(_packetPtr + _pmatch[1].rm_so,8));
-
-	    // date
-	    if (sscanf(_packetPtr + _pmatch[2].rm_so,"%2d%3d%2d%2d%2d",
-		    &year,&jday,&hour,&minute,&sec) != 5)
-		throw n_u::ParseException(string("bad date in packet:") +
-			string(_packetPtr + _pmatch[2].rm_so,11));
-
-	    _packetTime = n_u::UTime(true,year,jday,hour,minute,sec);
-	}
-	break;
-    }
-
-    _packetPtr += _pmatch[0].rm_eo;
     // parse info fields
-    int itype = 0;
-    switch(packetType) {
-    case NESDIS_PT:
-	for (itype = 0; itype < _nInfoTypes; itype++)
-	    if ((regstatus = ::regexec(_infoPreg[itype],_packetPtr,
-	    	_nmatch,_pmatch,0)) == 0) break;
-	break;
-    }
-
-    if (itype == _nInfoTypes) {      // no match to any info type
-	ostringstream ost;
-	ost << "Bad packet (" << strlen(packet) << " bytes) \"" <<
-		packet << "\"";
-	throw n_u::ParseException(ost.str());
+    int itype;
+    int infoLen = matchNESDISInfo(_packetPtr);
+    if (infoLen >= 0) itype = NESDIS_IT;
+    else {
+	for (itype = SUTRON_IT; itype < _nInfoTypes + SUTRON_IT; itype++)
+	    if (::regexec(_infoPreg[itype - SUTRON_IT],_packetPtr,
+	    	_nmatch,_pmatch,0) == 0) break;
+        if (itype == _nInfoTypes + SUTRON_IT) {      // no match to any info type
+            ostringstream ost;
+            ost << "Bad packet (" << strlen(packet) << " bytes) \"" <<
+                    packet << "\"";
+            throw n_u::ParseException(ost.str());
+        }
+	assert(_pmatch[0].rm_so == 0);
+        infoLen = _pmatch[0].rm_eo;
     }
 
     switch(itype) {
     case NESDIS_IT:
-	assert(_pmatch[0].rm_so >= 0);
 	if (itype != _infoType) {
 	    delete _packetInfo;
 	    _packetInfo = new NESDISPacketInfo();
 	}
 	break;
     case SUTRON_IT:
-	assert(_pmatch[0].rm_so >= 0);
 	if (itype != _infoType) {
 	    delete _packetInfo;
 	    _packetInfo = new SutronPacketInfo();
@@ -201,8 +239,8 @@ PacketParser::packet_type PacketParser::parse(const char* packet)
     }
     _infoType = itype;
 
-    _packetInfo->scan(_packetPtr + _pmatch[0].rm_so);
-    _packetPtr += _pmatch[0].rm_eo;
+    _packetInfo->scan(_packetPtr);
+    _packetPtr += infoLen;
 
     int stringLength = ::strlen(_packetPtr);
 
@@ -226,7 +264,7 @@ PacketParser::packet_type PacketParser::parse(const char* packet)
 	if (_packetPtr < _endOfPacket) _sampleId = *_packetPtr++ & 0x3f;
     }
 
-    return (packet_type) packetType;
+    return NESDIS_PT;
 }
 
 void PacketParser::parseData(float* fptr, int nvars)
@@ -165,13 +165,28 @@ public:
 
 private:
 
-    static ::regex_t** _packetPreg;
+    /**
+     * Parse the fixed format header of a NESDIS packet, setting
+     * _stationId and _packetTime.
+     * @return length of the header, including trailing spaces,
+     *      or -1 if it is not a valid header.
+     */
+    int parseHeader(const char* packet);
 
-    static ::regex_t** _infoPreg;
+    /**
+     * Match the fixed format NESDIS info fields.
+     * @return length of the info fields, including trailing spaces,
+     *      or -1 if they do not match.
+     */
+    static int matchNESDISInfo(const char* str);
 
-    int _nPacketTypes;
+    /**
+     * Compiled regular expressions of the info fields which are
+     * not NESDIS, starting with SUTRON_IT.
+     */
+    static ::regex_t** _infoPreg;
 
-    int _nInfoTypes;
+    static int _nInfoTypes;
 
     /**
      * Max number of parenthesized expressions in any regular expression.
@@ -100,8 +100,11 @@ Wind3D::~Wind3D()
 void Wind3D::despike(dsm_time_t tt,
 	float* uvwt,int n,bool* spikeOrMissing) throw()
 {
-    vector<double> dvec(n);	// despiked data
-    double* duvwt = &dvec.front();
+    // despiked data. This is called for every sample, so avoid
+    // allocating a vector on the heap.
+    float duvwt[sizeof(_despiker)/sizeof(_despiker[0])];
+    n = std::min(n,(int)(sizeof(_despiker)/sizeof(_despiker[0])));
+
     /*
      * Despike data
      */
@@ -686,15 +689,17 @@ void Wind3D::getTransducerRotation(dsm_time_t tt) throw()
 bool Wind3D::process(const Sample* samp,
 	std::list<const Sample*>& results) throw()
 {
+    return processIntoList(samp,results);
+}
 
-    std::list<const Sample*> parseResults;
-
-    SerialSensor::process(samp,parseResults);
-
-    if (parseResults.empty()) return false;
+bool Wind3D::processInto(const Sample* samp,
+	std::vector<const Sample*>& results) throw()
+{
 
     // result from base class parsing of ASCII
-    const Sample* psamp = parseResults.front();
+    const Sample* psamp = parseSample(samp);
+
+    if (!psamp) return false;
 
     unsigned int nParsedVals = psamp->getDataLength();
     const float* pdata = (const float*) psamp->getConstVoidDataPtr();
@@ -248,7 +248,7 @@ void WisardMote::addMoteSampleTag(SampleTag* tag)
          << hex << tag->getSpSId() << dec
          << ", ntags=" << getSampleTags().size());
     
-    if (_sampleTagsById[tag->getId()]) {
+    if (_sampleTagsById.find(tag->getId()) != _sampleTagsById.end()) {
         WLOG(("%s: duplicate processed sample tag for id %d,%#x",
                     getName().c_str(), tag->getDSMId(),tag->getSpSId()));
         delete tag;
@@ -417,7 +417,8 @@ throw ()
 
         // sample id of processed sample
         dsm_sample_id_t sid = getId() + (header.moteId << 8) + sensorType;
-        SampleTag* stag = _sampleTagsById[sid];
+        SampleIdMap<SampleTag*>::const_iterator ti = _sampleTagsById.find(sid);
+        SampleTag* stag = (ti != _sampleTagsById.end() ? ti->second : 0);
         SampleT<float>* osamp = 0;
 
         /* create an output floating point sample */
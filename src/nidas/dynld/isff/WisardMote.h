@@ -75,6 +75,7 @@
 
 #include <nidas/core/SerialSensor.h>
 #include <nidas/core/Sample.h>
+#include <nidas/core/SampleIdMap.h>
 #include <nidas/util/EndianConverter.h>
 #include <nidas/util/InvalidParameterException.h>
 
@@ -351,7 +352,7 @@ private:
      * The processed sample tags for each id. This will
      * have non-zero size only for the processing WisardMote.
      */
-    std::map<dsm_sample_id_t, SampleTag*> _sampleTagsById;
+    SampleIdMap<SampleTag*> _sampleTagsById;
 
     /**
      * Pointer to the WisardMote that does the processing for
@@ -162,6 +162,40 @@ void PSQLChannel::flush() throw(nidas::util::IOException)
     }
 }
 
+void PSQLChannel::copyBinary(const string& table, const void* buf, size_t len)
+	throw(nidas::util::IOException)
+{
+    flush();
+
+    string command = "COPY " + table + " FROM STDIN BINARY";
+
+    // The copy data is sent in one piece, which is simpler
+    // with a blocking connection.
+    PQsetnonblocking(_conn, false);
+
+    string errmsg;
+    PGresult* res = PQexec(_conn, command.c_str());
+    if (PQresultStatus(res) != PGRES_COPY_IN)
+        errmsg = PQresultErrorMessage(res);
+    PQclear(res);
+
+    if (errmsg.empty()) {
+        if (PQputCopyData(_conn, (const char*)buf, len) != 1 ||
+            PQputCopyEnd(_conn, 0) != 1)
+            errmsg = PQerrorMessage(_conn);
+        while ( (res = PQgetResult(_conn)) ) {
+            if (PQresultStatus(res) != PGRES_COMMAND_OK && errmsg.empty())
+                errmsg = PQresultErrorMessage(res);
+            PQclear(res);
+        }
+    }
+
+    PQsetnonblocking(_conn, true);
+
+    if (!errmsg.empty())
+        throw nidas::util::IOException(getName(), command, errmsg);
+}
+
 void PSQLChannel::fromDOMElement(const DOMElement* node)
 	throw(nidas::util::InvalidParameterException)
 {
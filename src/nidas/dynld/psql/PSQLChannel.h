@@ -78,6 +78,15 @@ public:
                                                                                 
     void flush() throw(nidas::util::IOException);
 
+    /**
+     * Send rows to a table with a "COPY table FROM STDIN BINARY"
+     * command.  buf contains the rows in the PostgreSQL binary
+     * COPY format, including the file header and trailer.
+     * Unlike write(), this waits for the result of the COPY.
+     */
+    void copyBinary(const std::string& table, const void* buf, size_t len)
+        throw(nidas::util::IOException);
+
     void close() throw(nidas::util::IOException);
 
     int getFd() const { return -1; }
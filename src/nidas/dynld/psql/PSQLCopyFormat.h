@@ -0,0 +1,133 @@
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/* -*- mode: c++; c-basic-offset: 4; -*- */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#ifndef NIDAS_DYNLD_PSQL_PSQLCOPYFORMAT_H
+#define NIDAS_DYNLD_PSQL_PSQLCOPYFORMAT_H
+
+#include <nidas/core/Sample.h>
+#include <nidas/core/Variable.h>
+#include <nidas/util/EndianConverter.h>
+
+#include <vector>
+#include <cmath>
+
+namespace nidas { namespace dynld { namespace psql {
+
+/**
+ * Encoding of float samples as rows in the PostgreSQL binary COPY
+ * format, for PSQLSampleOutput. A row has a field count, then for
+ * each field a length and the value, all big-endian. The first field
+ * is the time tag, in microseconds since the PostgreSQL epoch of
+ * 2000-01-01, and the others are the variables of the sample, as
+ * doubles, except Clock, which is not a column of the tables.
+ *
+ * This does not depend on libpq, so that it can be tested without
+ * a database.
+ */
+class PSQLCopyFormat
+{
+public:
+
+    /**
+     * Microseconds from 1970 to the PostgreSQL epoch of 2000-01-01.
+     */
+    static const long long EPOCH_USECS = 946684800LL * USECS_PER_SEC;
+
+    /**
+     * Append the signature, flags and header extension length
+     * which start a COPY.
+     */
+    static void appendHeader(std::vector<char>& buf)
+    {
+        static const char header[] = "PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0";
+        buf.insert(buf.end(), header, header + sizeof(header) - 1);
+    }
+
+    /**
+     * Append a row for a sample. NaN and infinite values are
+     * written as missingValue.
+     */
+    static void appendRow(std::vector<char>& buf,
+        const nidas::core::SampleT<float>* samp,
+        const std::vector<const nidas::core::Variable*>& vars,
+        double missingValue)
+    {
+        const nidas::util::EndianConverter* bigEndian = getConverter();
+        const float* fptr = samp->getConstDataPtr();
+
+        size_t n0 = buf.size();
+        buf.resize(n0 + 2 + 12 * (vars.size() + 1));
+        char* cp = &buf[n0];
+        char* nfieldsp = cp;
+        cp += 2;
+
+        int16_t nfields = 1;
+        bigEndian->int32Copy(8, cp);
+        bigEndian->int64Copy(samp->getTimeTag() - EPOCH_USECS, cp + 4);
+        cp += 12;
+
+        for (size_t i = 0; i < vars.size(); i++) {
+            if (!vars[i]->getName().compare("Clock")) continue;
+            double value = missingValue;
+            if (i < samp->getDataLength() &&
+                !std::isnan(fptr[i]) && !std::isinf(fptr[i]))
+                value = fptr[i];
+            bigEndian->int32Copy(8, cp);
+            bigEndian->doubleCopy(value, cp + 4);
+            cp += 12;
+            nfields++;
+        }
+        bigEndian->int16Copy(nfields, nfieldsp);
+        buf.resize(cp - &buf[0]);
+    }
+
+    /**
+     * Append the trailer which ends a COPY, a field count of -1.
+     */
+    static void appendTrailer(std::vector<char>& buf)
+    {
+        char trailer[2];
+        getConverter()->int16Copy(-1, trailer);
+        buf.insert(buf.end(), trailer, trailer + 2);
+    }
+
+    /**
+     * Length of the trailer.
+     */
+    static const size_t TRAILER_LENGTH = 2;
+
+private:
+
+    static const nidas::util::EndianConverter* getConverter()
+    {
+        return nidas::util::EndianConverter::getConverter(
+            nidas::util::EndianConverter::EC_BIG_ENDIAN);
+    }
+};
+
+}}}
+
+#endif // NIDAS_DYNLD_PSQL_PSQLCOPYFORMAT_H
@@ -26,11 +26,13 @@
 
 #include "PSQLSampleOutput.h"
 #include "PSQLChannel.h"
+#include "PSQLCopyFormat.h"
 #include <nidas/core/Project.h>
 #include <nidas/core/DSMConfig.h>
 #include <nidas/core/DSMSensor.h>
 
 #include <nidas/util/InvalidParameterException.h>
+#include <nidas/util/UTime.h>
 
 #include <time.h>
 
@@ -40,19 +42,35 @@ NIDAS_CREATOR_FUNCTION_NS(psql,PSQLSampleOutput)
 
 PSQLSampleOutput::PSQLSampleOutput(): 
     connectionRequester(0),psqlChannel(0),
-    missingValue(1.e37),first(true),dberrors(0)
+    missingValue(1.e37),first(true),dberrors(0),
+    copyMode(false),batchRows(1000),batchUsecs(USECS_PER_SEC),maxBatches(10),
+    batches(),copyWriter(0)
 {
 }
 
 PSQLSampleOutput::PSQLSampleOutput(const PSQLSampleOutput& x): 
 	name(x.name),connectionRequester(0),
 	dsms(x.dsms),psqlChannel(0),
-	missingValue(x.missingValue),first(true),dberrors(0)
+	missingValue(x.missingValue),first(true),dberrors(0),
+	copyMode(x.copyMode),batchRows(x.batchRows),batchUsecs(x.batchUsecs),
+	maxBatches(x.maxBatches),batches(),copyWriter(0)
 {
 }
 
 PSQLSampleOutput::~PSQLSampleOutput()
 {
+    if (copyWriter) {
+        copyWriter->interrupt();
+        try {
+            copyWriter->join();
+        }
+        catch(const nidas::util::Exception& e) {
+            WLOG(("") << getName() << ": " << e.what());
+        }
+        delete copyWriter;
+    }
+    map<string,Batch*>::iterator bi = batches.begin();
+    for ( ; bi != batches.end(); ++bi) delete bi->second;
     delete psqlChannel;
 }
 
@@ -118,6 +136,15 @@ connected(IOChannel* output) throw()
 
 void PSQLSampleOutput::flush() throw(nidas::util::IOException)
 {
+    if (copyWriter) {
+        map<string,Batch*>::iterator bi = batches.begin();
+        for ( ; bi != batches.end(); ++bi) {
+            if (bi->second) submitBatch(bi->second);
+            bi->second = 0;
+        }
+        copyWriter->drain();
+        return;
+    }
     if (psqlChannel) psqlChannel->flush();
 }
 
@@ -125,6 +152,18 @@ void
 PSQLSampleOutput::
 close() throw(nidas::util::IOException)
 {
+    if (copyWriter) {
+        flush();
+        copyWriter->interrupt();
+        try {
+            copyWriter->join();
+        }
+        catch(const nidas::util::Exception& e) {
+            WLOG(("") << getName() << ": " << e.what());
+        }
+        delete copyWriter;
+        copyWriter = 0;
+    }
     if (psqlChannel) psqlChannel->close();
 }
 
@@ -164,6 +203,11 @@ init() throw()
 	dropAllTables();      // Remove existing tables, this is a reset.
 	createTables();
 	initializeGlobalAttributes();
+        if (copyMode && !copyWriter) {
+            // From now on, only the CopyWriter uses the connection.
+            copyWriter = new CopyWriter(this, maxBatches);
+            copyWriter->start();
+        }
     }
     catch(const nidas::util::IOException& ioe) {
 	nidas::util::Logger::getInstance()->log(LOG_ERR,"%s: %s",
@@ -358,7 +402,19 @@ bool PSQLSampleOutput::receive(const Sample* samp) throw()
     	(int)(samp->getTimeTag() % USECS_PER_SEC) / USECS_PER_MSEC);
 
     ostringstream costr;
-    if (first) {
+    if (first && copyWriter) {
+	costr << "INSERT INTO global_attributes VALUES ('StartTime', '" <<
+		 tstr << "')";
+	submitCopyCommand(costr.str());
+	costr.str("");
+
+	costr << "INSERT INTO global_attributes VALUES ('EndTime', '" <<
+		 tstr << "')";
+	submitCopyCommand(costr.str());
+	costr.str("");
+	first = false;
+    }
+    else if (first) {
 	costr << "INSERT INTO global_attributes VALUES ('StartTime', '" <<
 		 tstr << "')";
 	submitCommand(costr.str());
@@ -387,6 +443,11 @@ bool PSQLSampleOutput::receive(const Sample* samp) throw()
     assert(tabi != tablesByRate.end());
     const string& table = tabi->second;
 
+    if (copyWriter) {
+        copySample(fsamp, tag, table);
+        return true;
+    }
+
     costr << "INSERT INTO " << table << " VALUES ('" << tstr << "',";
 
     char comma = ' ';
@@ -425,6 +486,208 @@ bool PSQLSampleOutput::receive(const Sample* samp) throw()
     return true;
 }
 
+void PSQLSampleOutput::copySample(const SampleT<float>* fsamp,
+    const SampleTag* tag, const string& table)
+{
+    dsm_time_t now = nidas::util::getSystemTime();
+
+    Batch*& batch = batches[table];
+    if (!batch) {
+        batch = new Batch();
+        batch->table = table;
+        batch->created = now;
+        PSQLCopyFormat::appendHeader(batch->data);
+    }
+
+    // One field for the time, and one for each variable but Clock,
+    // matching the columns of the table made by createTables().
+    batch->rowStarts.push_back(batch->data.size());
+    PSQLCopyFormat::appendRow(batch->data, fsamp, tag->getVariables(),
+        missingValue);
+    batch->nrows++;
+    batch->lastTime = fsamp->getTimeTag();
+
+    if (batch->nrows >= batchRows) {
+        submitBatch(batch);
+        batch = 0;
+    }
+
+    // submit batches of this and other tables which have waited long enough
+    map<string,Batch*>::iterator bi = batches.begin();
+    for ( ; bi != batches.end(); ++bi) {
+        if (bi->second && now - bi->second->created >= batchUsecs) {
+            submitBatch(bi->second);
+            bi->second = 0;
+        }
+    }
+}
+
+void PSQLSampleOutput::submitBatch(Batch* batch)
+{
+    if (batch->command.empty()) PSQLCopyFormat::appendTrailer(batch->data);
+    copyWriter->submit(batch);
+}
+
+void PSQLSampleOutput::submitCopyCommand(const string& command)
+{
+    Batch* batch = new Batch();
+    batch->command = command;
+    submitBatch(batch);
+}
+
+PSQLSampleOutput::CopyWriter::CopyWriter(PSQLSampleOutput* output,
+    unsigned int maxb):
+    nidas::util::Thread(output->getName() + " CopyWriter"),
+    _output(output),_queue(),_maxBatches(maxb),_busy(false),_cond(),
+    _nrows(0),_nrowsReported(0),_nrowsLost(0),_lastReport(0)
+{
+    blockSignal(SIGHUP);
+    blockSignal(SIGINT);
+    blockSignal(SIGTERM);
+}
+
+PSQLSampleOutput::CopyWriter::~CopyWriter()
+{
+    list<Batch*>::iterator bi = _queue.begin();
+    for ( ; bi != _queue.end(); ++bi) delete *bi;
+}
+
+void PSQLSampleOutput::CopyWriter::submit(Batch* batch)
+{
+    _cond.lock();
+    while (_queue.size() >= _maxBatches && isRunning() && !isInterrupted())
+        _cond.wait();
+    _queue.push_back(batch);
+    _cond.broadcast();
+    _cond.unlock();
+}
+
+void PSQLSampleOutput::CopyWriter::drain()
+{
+    _cond.lock();
+    while ((!_queue.empty() || _busy) && isRunning()) _cond.wait();
+    _cond.unlock();
+}
+
+void PSQLSampleOutput::CopyWriter::interrupt()
+{
+    _cond.lock();
+    nidas::util::Thread::interrupt();
+    _cond.broadcast();
+    _cond.unlock();
+}
+
+int PSQLSampleOutput::CopyWriter::run() throw(nidas::util::Exception)
+{
+    for (;;) {
+        _cond.lock();
+        // write what is queued before quitting
+        while (_queue.empty() && !isInterrupted()) _cond.wait();
+        if (_queue.empty()) {
+            _cond.unlock();
+            break;
+        }
+        Batch* batch = _queue.front();
+        _queue.pop_front();
+        _busy = true;
+        _cond.broadcast();
+        _cond.unlock();
+
+        write(batch);
+        delete batch;
+
+        _cond.lock();
+        _busy = false;
+        _cond.broadcast();
+        _cond.unlock();
+    }
+    _cond.lock();
+    _cond.broadcast();
+    _cond.unlock();
+    return RUN_OK;
+}
+
+void PSQLSampleOutput::CopyWriter::write(Batch* batch)
+{
+    try {
+        if (!batch->command.empty()) {
+            _output->submitCommand(batch->command);
+            _output->psqlChannel->flush();
+            return;
+        }
+        try {
+            _output->psqlChannel->copyBinary(batch->table,
+                &batch->data[0], batch->data.size());
+            _nrows += batch->nrows;
+        }
+        catch (const nidas::util::IOException& ioe) {
+            if (batch->nrows < 2) throw;
+            WLOG(("") << _output->getName() << ": " << ioe.what() <<
+                ", copying " << batch->nrows << " rows one at a time");
+            _output->dberrors++;
+            copyRows(batch);
+        }
+
+        nidas::util::UTime ut(batch->lastTime);
+        _output->submitCommand("UPDATE global_attributes SET value='" +
+            ut.format(true, "%Y-%m-%d %H:%M:%S.%3f") +
+            "' WHERE key='EndTime';");
+        _output->psqlChannel->flush();
+    }
+    catch (const nidas::util::IOException& ioe) {
+        _output->dberrors++;
+        nidas::util::Logger::getInstance()->log(LOG_ERR,"%s: %s",
+		_output->getName().c_str(),ioe.what());
+    }
+
+    dsm_time_t now = nidas::util::getSystemTime();
+    if (_lastReport == 0) _lastReport = now;
+    else if (now - _lastReport >= 60 * USECS_PER_SEC) {
+        double rate = (double)(_nrows - _nrowsReported) * USECS_PER_SEC /
+            (now - _lastReport);
+        ILOG(("") << _output->getName() << ": rows/sec=" << rate <<
+            ", rows=" << _nrows << ", rows lost=" << _nrowsLost <<
+            ", queued batches=" << _queue.size());
+        _nrowsReported = _nrows;
+        _lastReport = now;
+    }
+}
+
+void PSQLSampleOutput::CopyWriter::copyRows(Batch* batch)
+{
+    // The trailer follows the last row.
+    size_t dataEnd = batch->data.size() - PSQLCopyFormat::TRAILER_LENGTH;
+    vector<char> buf;
+    unsigned int nlost = 0;
+    string errmsg;
+
+    for (size_t i = 0; i < batch->rowStarts.size(); i++) {
+        size_t rowEnd = i + 1 < batch->rowStarts.size() ?
+            batch->rowStarts[i + 1] : dataEnd;
+        buf.clear();
+        PSQLCopyFormat::appendHeader(buf);
+        buf.insert(buf.end(), batch->data.begin() + batch->rowStarts[i],
+            batch->data.begin() + rowEnd);
+        PSQLCopyFormat::appendTrailer(buf);
+        try {
+            _output->psqlChannel->copyBinary(batch->table, &buf[0],
+                buf.size());
+            _nrows++;
+        }
+        catch (const nidas::util::IOException& ioe) {
+            if (errmsg.empty()) errmsg = ioe.what();
+            nlost++;
+        }
+    }
+    if (nlost > 0) {
+        _nrowsLost += nlost;
+        _output->dberrors += nlost;
+        ELOG(("") << _output->getName() << ": " << nlost << " of " <<
+            batch->rowStarts.size() << " rows of " << batch->table <<
+            " not written: " << errmsg);
+    }
+}
+
 void PSQLSampleOutput::fromDOMElement(const DOMElement* node)
         throw(nidas::util::InvalidParameterException)
 {
@@ -438,8 +701,35 @@ void PSQLSampleOutput::fromDOMElement(const DOMElement* node)
         for(int i=0;i<nSize;++i) {
             XDOMAttr attr((DOMAttr*) pAttributes->item(i));
             // get attribute name
-	    //            const std::string& aname = attr.getName();
-	    //            const std::string& aval = attr.getValue();
+            const std::string& aname = attr.getName();
+            const std::string& aval = attr.getValue();
+            istringstream ist(aval);
+            if (aname == "copy") {
+                copyMode = aval == "true" || aval == "1";
+                if (!copyMode && aval != "false" && aval != "0")
+                    throw nidas::util::InvalidParameterException(getName(),
+                        aname, aval);
+            }
+            else if (aname == "batchRows") {
+                ist >> batchRows;
+                if (ist.fail() || batchRows < 1)
+                    throw nidas::util::InvalidParameterException(getName(),
+                        aname, aval);
+            }
+            else if (aname == "batchSecs") {
+                float secs;
+                ist >> secs;
+                if (ist.fail() || secs < 0.0)
+                    throw nidas::util::InvalidParameterException(getName(),
+                        aname, aval);
+                batchUsecs = (int)(secs * USECS_PER_SEC);
+            }
+            else if (aname == "maxBatches") {
+                ist >> maxBatches;
+                if (ist.fail() || maxBatches < 1)
+                    throw nidas::util::InvalidParameterException(getName(),
+                        aname, aval);
+            }
         }
     }
 
@@ -31,12 +31,30 @@
 #define NIDAS_DYNLD_PSQL_PSQLSAMPLEOUTPUT_H
 
 #include <nidas/dynld/SampleOutputStream.h>
+#include <nidas/util/Thread.h>
 #include "PSQLChannel.h"
 
 #include <map>
+#include <list>
+#include <vector>
 
 namespace nidas { namespace dynld { namespace psql {
 
+/**
+ * Output of processed samples to tables in a PostgreSQL database.
+ *
+ * By default each sample is written with an INSERT command.
+ * If the copy attribute is "true", samples are instead appended
+ * to batches in the binary COPY format, one batch per table, which are
+ * sent with "COPY table FROM STDIN BINARY" by a writer thread.
+ * A batch is queued for the writer when it holds batchRows samples,
+ * or when batchSecs have passed since its first sample.  If maxBatches
+ * are waiting to be written, receive() blocks until the writer catches
+ * up.  The writer logs the rows per second it has written.
+ * If the COPY of a batch fails, as when one row has a duplicate key,
+ * its rows are copied one at a time, and those which fail are
+ * logged and counted as lost.
+ */
 class PSQLSampleOutput : public nidas::dynld::SampleOutputStream
 {
 public:
@@ -105,6 +123,126 @@ protected:
     void addCategory(const std::string& varName, const std::string& category)
     	throw(nidas::util::IOException);
 
+    /**
+     * Rows of a table in the binary COPY format, or a command.
+     */
+    struct Batch
+    {
+        Batch(): table(),command(),data(),rowStarts(),nrows(0),created(0),
+            lastTime(0) {}
+
+        std::string table;
+
+        /**
+         * If not empty, a command to submit, rather than rows to copy.
+         */
+        std::string command;
+
+        std::vector<char> data;
+
+        /**
+         * Offset in data of each row.
+         */
+        std::vector<size_t> rowStarts;
+
+        unsigned int nrows;
+
+        /**
+         * System time when the first row was added.
+         */
+        dsm_time_t created;
+
+        /**
+         * Time tag of the last row.
+         */
+        dsm_time_t lastTime;
+    };
+
+    /**
+     * Thread which writes the queued Batches to the database.
+     */
+    class CopyWriter: public nidas::util::Thread
+    {
+    public:
+        CopyWriter(PSQLSampleOutput* output, unsigned int maxBatches);
+
+        ~CopyWriter();
+
+        /**
+         * Queue a batch for writing, waiting while maxBatches are queued.
+         * The CopyWriter owns the batch.
+         */
+        void submit(Batch* batch);
+
+        /**
+         * Wait until the queued batches are written.
+         */
+        void drain();
+
+        int run() throw(nidas::util::Exception);
+
+        void interrupt();
+
+    private:
+
+        void write(Batch* batch);
+
+        /**
+         * Copy the rows of a batch one at a time, after a COPY of the
+         * batch failed, so that a bad row, such as one with a duplicate
+         * key, only loses that row, and not the batch.
+         */
+        void copyRows(Batch* batch);
+
+        PSQLSampleOutput* _output;
+
+        std::list<Batch*> _queue;
+
+        unsigned int _maxBatches;
+
+        /**
+         * Whether the writer is working on a batch.
+         */
+        bool _busy;
+
+        nidas::util::Cond _cond;
+
+        unsigned long long _nrows;
+
+        unsigned long long _nrowsReported;
+
+        /**
+         * Rows which could not be written, one at a time.
+         */
+        unsigned long long _nrowsLost;
+
+        dsm_time_t _lastReport;
+
+        /** No copying. */
+        CopyWriter(const CopyWriter&);
+
+        /** No assignment. */
+        CopyWriter& operator=(const CopyWriter&);
+    };
+
+    /**
+     * In copy mode, format a sample into the Batch of its table,
+     * and submit the Batches that are full or old enough.
+     */
+    void copySample(const SampleT<float>* fsamp, const SampleTag* tag,
+        const std::string& table);
+
+    /**
+     * Queue a batch, or if it is a batch of rows, add the
+     * binary COPY trailer and queue it.
+     */
+    void submitBatch(Batch* batch);
+
+    /**
+     * Queue a command to the CopyWriter.
+     */
+    void submitCopyCommand(const std::string& command);
+
     std::string name;
 
     SampleConnectionRequester* connectionRequester;
@@ -126,6 +264,27 @@ protected:
     bool first;
 
     int dberrors;
+
+    /**
+     * Write samples with COPY rather than INSERT.
+     */
+    bool copyMode;
+
+    unsigned int batchRows;
+
+    int batchUsecs;
+
+    unsigned int maxBatches;
+
+    /**
+     * Batch being filled for each table.
+     */
+    std::map<std::string,Batch*> batches;
+
+    CopyWriter* copyWriter;
+
+    /** No assignment. */
+    PSQLSampleOutput& operator=(const PSQLSampleOutput&);
 };
 
 }}}
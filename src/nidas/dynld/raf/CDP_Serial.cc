@@ -154,19 +154,8 @@ bool CDP_Serial::process(const Sample* samp,list<const Sample*>& results)
     if (! appendDataAndFindGood(samp))
         return false;
 
-    /*
-     * Copy the good record into our CDP_blk struct.
-     */
-    CDP_blk inRec;
-
-    ::memcpy(&inRec, _waitingData, packetLen() - 2);
-    ::memcpy(&inRec.chksum, _waitingData + packetLen() - 2, 2);
-
-    /*
-     * Shift the remaining data in _waitingData to the head of the line
-     */
-    _nWaitingData -= packetLen();
-    ::memmove(_waitingData, _waitingData + packetLen(), _nWaitingData);
+    // Unpacked in place, see SppSerial::dropRecord().
+    const CDP_blk& inRec = *(const CDP_blk*)_waitingData;
 
     /*
      * Create the output stuff
@@ -207,12 +196,7 @@ bool CDP_Serial::process(const Sample* samp,list<const Sample*>& results)
     *dout++ = convert(ttag,UnpackDMT_UShort(inRec.SizerThrshld),ivar++);
     *dout++ = convert(ttag,UnpackDMT_ULong(inRec.ADCoverflow),ivar++);
 
-#ifdef ZERO_BIN_HACK
-    // add a bogus zeroth bin for historical reasons
-    *dout++ = 0.0;
-#endif
-    for (int iout = 0; iout < _nChannels; ++iout)
-	*dout++ = UnpackDMT_ULong(inRec.OPCchan[iout]);
+    dout = unpackHistogram(inRec.OPCchan, dout);
 
     // Compute DELTAT.
     if (_outputDeltaT) {
@@ -225,6 +209,8 @@ bool CDP_Serial::process(const Sample* samp,list<const Sample*>& results)
     // If this fails then the correct pre-checks weren't done in validate().
     assert(dout == dend);
 
+    dropRecord();
+
     results.push_back(outs);
     return true;
 }
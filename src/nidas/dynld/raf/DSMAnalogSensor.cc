@@ -35,6 +35,7 @@
 #include <nidas/util/Logger.h>
 
 #include <cmath>
+#include <cstring>
 
 #include <iostream>
 #include <iomanip>
@@ -93,6 +94,7 @@ void DSMAnalogSensor::open(int flags)
 {
     DSMSensor::open(flags);
     init();
+    resetDecimators();
 
     int nchan;
     string ioctlcmd;
@@ -397,7 +399,7 @@ void DSMAnalogSensor::printStatus(std::ostream& ostr) throw()
     }
 }
 
-bool DSMAnalogSensor::processTemperature(const Sample* insamp, list<const Sample*>& result) throw()
+bool DSMAnalogSensor::processTemperature(const Sample* insamp, vector<const Sample*>& result) throw()
 {
     // number of data values in this raw sample. Should be two, an id and the temperature
     if (insamp->getDataByteLength() / sizeof(short) != 2) return false;
@@ -421,6 +423,11 @@ bool DSMAnalogSensor::processTemperature(const Sample* insamp, list<const Sample
 }
 
 bool DSMAnalogSensor::process(const Sample* insamp,list<const Sample*>& results) throw()
+{
+    return processIntoList(insamp,results);
+}
+
+bool DSMAnalogSensor::processInto(const Sample* insamp,vector<const Sample*>& results) throw()
 {
 
 // #define DEBUG
@@ -475,16 +482,26 @@ bool DSMAnalogSensor::process(const Sample* insamp,list<const Sample*>& results)
 
     readCalFile(insamp->getTimeTag());
 
+    size_t nresults = results.size();
+
     for (int isamp = 0; isamp < nsamp; isamp++) {
         A2DSampleInfo& sinfo = _sampleInfos[sindex];
         SampleTag* stag = sinfo.stag;
         const vector<Variable*>& vars = stag->getVariables();
+        FIRDecimator* decimator = _decimators[sindex];
 
-        SampleT<float>* osamp = getSample<float>(sinfo.nvars);
         dsm_time_t tt = insamp->getTimeTag() + isamp * _deltatUsec;
-        osamp->setTimeTag(tt - getLagUsecs());
-        osamp->setId(stag->getId());
-        float *fp = osamp->getDataPtr();
+
+        // If the sample is decimated here, convert the scan into
+        // _filterScan, and only create an output sample when the
+        // filter has an output.
+        SampleT<float>* osamp = 0;
+        float *fp;
+        if (decimator) fp = &_filterScan[0];
+        else {
+            osamp = getSample<float>(sinfo.nvars);
+            fp = osamp->getDataPtr();
+        }
 
         int ival;
         for (ival = 0; ival < sinfo.nvars && sp < spend; ival++,fp++) {
@@ -512,19 +529,35 @@ bool DSMAnalogSensor::process(const Sample* insamp,list<const Sample*>& results)
                 // Default, do as before.
                 val = getIntercept(ichan) + getSlope(ichan) * sval;
             }
+            *fp = val;
+        }
+        for ( ; ival < sinfo.nvars; ival++) *fp++ = floatNAN;
+
+        if (decimator) {
+            if (!decimate(sindex, tt)) continue;
+            osamp = getSample<float>(sinfo.nvars);
+            ::memcpy(osamp->getDataPtr(), &_filterScan[0],
+                sinfo.nvars * sizeof(float));
+        }
+        osamp->setTimeTag(tt - getLagUsecs());
+        osamp->setId(stag->getId());
 
-            // XXX @todo XXX
-            //
-            // I think this code could be replaced with a call to
-            // applyConversions() right before osamp is pushed onto the
-            // results, but just in case timing is tight I'll leave it
-            // here.  The only extra overhead would be for the function
-            // call (unless it were inlined) and the check against
-            // var->getMissingValue().
-            //
-            // ...I already replaced similar code in A2DSensor, so maybe
-            // it's silly not to do it here too.
-            // 
+        // XXX @todo XXX
+        //
+        // I think this code could be replaced with a call to
+        // applyConversions() right before osamp is pushed onto the
+        // results, but just in case timing is tight I'll leave it
+        // here.  The only extra overhead would be for the function
+        // call (unless it were inlined) and the check against
+        // var->getMissingValue().
+        //
+        // ...I already replaced similar code in A2DSensor, so maybe
+        // it's silly not to do it here too.
+        // 
+        fp = osamp->getDataPtr();
+        for (ival = 0; ival < sinfo.nvars; ival++,fp++) {
+            float val = *fp;
+            if (isnan(val)) continue;
             Variable* var = vars[ival];
             if (getApplyVariableConversions()) {
                 VariableConverter* conv = var->getConverter();
@@ -535,10 +568,9 @@ bool DSMAnalogSensor::process(const Sample* insamp,list<const Sample*>& results)
                 val = floatNAN;
             *fp = val;
         }
-        for ( ; ival < sinfo.nvars; ival++) *fp++ = floatNAN;
         results.push_back(osamp);
     }
-    return true;
+    return results.size() > nresults;
 }
 
 void DSMAnalogSensor::readCalFile(dsm_time_t tt) throw()
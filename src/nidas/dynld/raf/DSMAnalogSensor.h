@@ -91,6 +91,13 @@ public:
     bool process(const Sample*,std::list<const Sample*>& result)
         throw();
 
+    /**
+     * Native implementation of process(), which appends
+     * the A2D samples to a vector, rather than a std::list.
+     */
+    bool processInto(const Sample*,std::vector<const Sample*>& result)
+        throw();
+
     void validate() throw(nidas::util::InvalidParameterException);
 
     /**
@@ -120,7 +127,7 @@ public:
 
 protected:
 
-    bool processTemperature(const Sample*, std::list<const Sample*>& result) throw();
+    bool processTemperature(const Sample*, std::vector<const Sample*>& result) throw();
 
     /**
      * Read a filter file containing coefficients for an Analog Devices
@@ -193,15 +193,8 @@ bool PIP_Serial::process(const Sample* samp,list<const Sample*>& results)
         return false;
 
 
-    // Copy the good record into our PIP_blk struct.
-    PIP_blk inRec;
-
-    ::memcpy(&inRec, _waitingData, packetLen() - 2);
-    ::memcpy(&inRec.chksum, _waitingData + packetLen() - 4, 2);
-
-    // Shift the remaining data in _waitingData to the head of the line
-    _nWaitingData -= packetLen();
-    ::memmove(_waitingData, _waitingData + packetLen(), _nWaitingData);
+    // Unpacked in place, see SppSerial::dropRecord().
+    const PIP_blk& inRec = *(const PIP_blk*)_waitingData;
 
 //    cerr<<"reset flag:"<<UnpackDMT_UShort(inRec.resetFlag)<<endl;
 //    cerr<<"time hour:min "<<inRec.hour<<":"<<inRec.min<<endl;
@@ -239,12 +232,7 @@ bool PIP_Serial::process(const Sample* samp,list<const Sample*>& results)
     
 
 
-#ifdef ZERO_BIN_HACK
-    // add a bogus zeroth bin for historical reasons
-    *dout++ = 0.0;
-#endif
-    for (int iout = 0; iout < _nChannels; ++iout)
-	*dout++ = UnpackDMT_UShort(inRec.binCount[iout]);
+    dout = unpackHistogram(inRec.binCount, dout);
 
     // Compute DELTAT.
     if (_outputDeltaT) {
@@ -257,6 +245,8 @@ bool PIP_Serial::process(const Sample* samp,list<const Sample*>& results)
     // If this fails then the correct pre-checks weren't done in validate().
     assert(dout == dend);
 
+    dropRecord();
+
     results.push_back(outs);
  
     return true;
@@ -132,19 +132,8 @@ bool SPP300_Serial::process(const Sample* samp,list<const Sample*>& results)
     if (! appendDataAndFindGood(samp))
       return false;
 
-    /*
-     * Copy the good record into our DMT300_blk struct.
-     */
-    DMT300_blk inRec;
-
-    ::memcpy(&inRec, _waitingData, packetLen() - 2);
-    ::memcpy(&inRec.chksum, _waitingData + packetLen() - 2, 2);
-
-    /*
-     * Shift the remaining data in _waitingData to the head of the line
-     */
-    _nWaitingData -= packetLen();
-    ::memmove(_waitingData, _waitingData + packetLen(), _nWaitingData);
+    // Unpacked in place, see SppSerial::dropRecord().
+    const DMT300_blk& inRec = *(const DMT300_blk*)_waitingData;
 
     /*
      * Create the output stuff
@@ -169,12 +158,7 @@ bool SPP300_Serial::process(const Sample* samp,list<const Sample*>& results)
 //    *dout++ = convert(ttag,UnpackDMT_ULong(inRec.rejDOF),ivar++);
 //    *dout++ = convert(ttag,UnpackDMT_ULong(inRec.ADCoverflow),ivar++);
 
-#ifdef ZERO_BIN_HACK
-    // add a bogus zeroth bin for historical reasons
-    *dout++ = 0.0;
-#endif    
-    for (int iout = 0; iout < _nChannels; ++iout)
-      *dout++ = UnpackDMT_ULong(inRec.OPCchan[iout]);
+    dout = unpackHistogram(inRec.OPCchan, dout);
 
     // Compute DELTAT.
     if (_outputDeltaT) {
@@ -189,6 +173,8 @@ bool SPP300_Serial::process(const Sample* samp,list<const Sample*>& results)
     // in fromDOMElement.
     assert(dout == dend);
 
+    dropRecord();
+
     results.push_back(outs);
     return true;
 }
@@ -69,6 +69,7 @@ SppSerial::SppSerial(const std::string & probe) : DSMSerialSensor(),
     // _sampleRate(1),
     _outputDeltaT(false),
     _prevTime(0),
+    _outputTotalCount(false),
     _converters()
 {
     // If these aren't true, we're screwed!
@@ -143,30 +144,28 @@ void SppSerial::validate() throw(n_u::InvalidParameterException)
             if (var->getName().compare(0, 6, "DELTAT") == 0) {
                 _outputDeltaT = true;
             }
+            if (var->getName().compare(0, 4, "TCNT") == 0) {
+                _outputTotalCount = true;
+            }
         }
     }
 
+    int nexpected = _nChannels + _nHskp + (int)_outputDeltaT +
+        (int)_outputTotalCount;
 #ifdef ZERO_BIN_HACK
     /*
      * We'll be adding a bogus zeroth bin to the data to match historical 
      * behavior. Remove all traces of this after the netCDF file refactor.
      */
-    if (_noutValues != _nChannels + _nHskp + (int) _outputDeltaT +1) {
-        ostringstream ost;
-        ost << "total length of variables should be " << 
-            (_nChannels + _nHskp + (int)_outputDeltaT + 1) << " rather than " << _noutValues << ".\n";
-        throw n_u::InvalidParameterException(getName(), "sample",
-                ost.str());
-    }
-#else
-    if (_noutValues != _nChannels + _nHskp + (int) _outputDeltaT) {
+    nexpected++;
+#endif
+    if (_noutValues != nexpected) {
         ostringstream ost;
         ost << "total length of variables should be " << 
-            (_nChannels + _nHskp + (int) _outputDeltaT) << " rather than " << _noutValues << ".\n";
+            nexpected << " rather than " << _noutValues << ".\n";
         throw n_u::InvalidParameterException(getName(), "sample",
                 ost.str());
     }
-#endif
 
     /*
      * Allocate a new buffer for yet-to-be-handled data.  We get enough space
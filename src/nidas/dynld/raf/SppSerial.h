@@ -30,6 +30,10 @@
 #include <nidas/dynld/DSMSerialSensor.h>
 #include <nidas/core/VariableConverter.h>
 
+#include <cstring>
+#include <stdint.h>
+#include <endian.h>
+
 //
 // Add a bogus zeroth bin to the data to match historical behavior.
 // Remove all traces of this after the netCDF file refactor.
@@ -51,7 +55,7 @@ namespace nidas { namespace dynld { namespace raf {
  */
 typedef unsigned char DMT_UShort[2];
 
-inline unsigned short UnpackDMT_UShort(DMT_UShort dmtval)
+inline unsigned short UnpackDMT_UShort(const DMT_UShort dmtval)
 {
     unsigned short val = (dmtval[1] << 8) | dmtval[0];
     return val;
@@ -77,9 +81,10 @@ inline void PackDMT_UShort(DMT_UShort dmtval, unsigned short val)
  */
 typedef unsigned char DMT_ULong[4];
 
-inline unsigned long UnpackDMT_ULong(DMT_ULong dmtval)
+inline unsigned long UnpackDMT_ULong(const DMT_ULong dmtval)
 {
-    unsigned long val = dmtval[1] << 24 | dmtval[0] << 16 | 
+    unsigned long val = (unsigned long)dmtval[1] << 24 |
+        (unsigned long)dmtval[0] << 16 |
         dmtval[3] << 8 | dmtval[2]; // DMT byte order is 2301
     return val;
 }
@@ -92,6 +97,78 @@ inline void PackDMT_ULong(DMT_ULong dmtval, unsigned long val)
     dmtval[3] = (val >> 8) & 0xff;  // 1
 }
 
+/**
+ * Unpack an array of DMT_ULong histogram counts as floats, returning
+ * the sum of the counts. The result is identical to
+ * out[i] = UnpackDMT_ULong(in[i]), but on a little-endian host each
+ * count is loaded as a 32-bit word and its 16-bit halves swapped, a loop
+ * without byte shuffling which the compiler can vectorize.
+ */
+inline unsigned long long UnpackDMT_ULongs(const DMT_ULong* in, int n,
+    float* out)
+{
+    const unsigned char* ip = in[0];
+    unsigned long long sum = 0;
+    for (int i = 0; i < n; i++, ip += sizeof(DMT_ULong)) {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+        uint32_t val;
+        ::memcpy(&val, ip, sizeof(val));
+        val = (val << 16) | (val >> 16);
+#else
+        uint32_t val = (uint32_t)ip[1] << 24 | (uint32_t)ip[0] << 16 |
+            (uint32_t)ip[3] << 8 | ip[2];
+#endif
+        sum += val;
+        out[i] = val;
+    }
+    return sum;
+}
+
+/**
+ * Unpack an array of DMT_UShort counts as floats, returning
+ * the sum of the counts: out[i] = UnpackDMT_UShort(in[i]).
+ */
+inline unsigned long UnpackDMT_UShorts(const DMT_UShort* in, int n,
+    float* out)
+{
+    const unsigned char* ip = in[0];
+    unsigned long sum = 0;
+    for (int i = 0; i < n; i++, ip += sizeof(DMT_UShort)) {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+        uint16_t val;
+        ::memcpy(&val, ip, sizeof(val));
+#else
+        uint16_t val = (uint16_t)(ip[1] << 8 | ip[0]);
+#endif
+        sum += val;
+        out[i] = val;
+    }
+    return sum;
+}
+
+/**
+ * Unpack an array of DMT_UShort counts as floats, in reverse order,
+ * returning the sum of the counts: out[n-1-i] = UnpackDMT_UShort(in[i]).
+ * The UHSAS sends its histogram with the largest bin first.
+ */
+inline unsigned long UnpackDMT_UShortsReversed(const DMT_UShort* in, int n,
+    float* out)
+{
+    const unsigned char* ip = in[0];
+    unsigned long sum = 0;
+    for (int i = n - 1; i >= 0; i--, ip += sizeof(DMT_UShort)) {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+        uint16_t val;
+        ::memcpy(&val, ip, sizeof(val));
+#else
+        uint16_t val = (uint16_t)(ip[1] << 8 | ip[0]);
+#endif
+        sum += val;
+        out[i] = val;
+    }
+    return sum;
+}
+
 
 /**
  * Base class for many DMT Probes, including SPP100, SPP200, SPP300 and the CDP.
@@ -153,6 +230,49 @@ protected:
      */
     virtual int appendDataAndFindGood(const Sample* sample);
 
+    /**
+     * Drop the good record at the head of _waitingData, after it
+     * has been processed. process() unpacks the record in place, by
+     * casting _waitingData to the probe's record struct. The fields
+     * are all unsigned char arrays, so there are no alignment concerns.
+     * The chksum field of the struct is not used, it is not at the
+     * end of the record if _nChannels < MAX_CHANNELS.
+     */
+    void dropRecord()
+    {
+        _nWaitingData -= packetLen();
+        ::memmove(_waitingData, _waitingData + packetLen(), _nWaitingData);
+    }
+
+    /**
+     * Write the histogram of a record to the output sample: the bogus
+     * zeroth bin if ZERO_BIN_HACK, the _nChannels bin counts, and the total
+     * count if _outputTotalCount, all in one pass over the counts.
+     * @return pointer to the output value after the histogram.
+     */
+    float* unpackHistogram(const DMT_ULong* counts, float* dout)
+    {
+#ifdef ZERO_BIN_HACK
+        // add a bogus zeroth bin for historical reasons
+        *dout++ = 0.0;
+#endif
+        unsigned long long sum = UnpackDMT_ULongs(counts, _nChannels, dout);
+        dout += _nChannels;
+        if (_outputTotalCount) *dout++ = sum;
+        return dout;
+    }
+
+    float* unpackHistogram(const DMT_UShort* counts, float* dout)
+    {
+#ifdef ZERO_BIN_HACK
+        *dout++ = 0.0;
+#endif
+        unsigned long sum = UnpackDMT_UShorts(counts, _nChannels, dout);
+        dout += _nChannels;
+        if (_outputTotalCount) *dout++ = sum;
+        return dout;
+    }
+
     /**
      * Apply a VariableConversion to an output value.
      */
@@ -242,6 +362,13 @@ protected:
     dsm_time_t _prevTime;
     //@}
 
+    /**
+     * Whether to output the total of the histogram counts, after the
+     * histogram and before DELTAT. validate() sets this to true if there is
+     * a variable whose name starts with TCNT.
+     */
+    bool _outputTotalCount;
+
     /**
      * VariableConverters which may have been defined for each output
      * housekeeping variable. Currently there are no conversions for
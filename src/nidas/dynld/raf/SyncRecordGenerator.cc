@@ -181,6 +181,12 @@ void SyncRecordGenerator::init(dsm_time_t sampleTime) throw()
     _syncRecSource.preLoadCalibrations(sampleTime);
 }
 
+void SyncRecordGenerator::printLatency(ostream& ostr) throw()
+{
+    PipelineLatency::printAndReset(ostr,getName(),
+        PipelineLatency::SYNC,_syncRecSource.getLatencyHistogram());
+}
+
 void SyncRecordGenerator::printStatus(ostream& ostr,float deltat,int &zebra)
     throw()
 {
@@ -130,6 +130,8 @@ public:
 
     void printStatus(std::ostream&,float deltat,int&) throw();
 
+    void printLatency(std::ostream&) throw();
+
     SyncRecordSource*
     getSyncRecordSource()
     {
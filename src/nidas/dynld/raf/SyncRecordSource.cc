@@ -65,11 +65,14 @@ SyncRecordSource::SyncRecordSource():
     _intSamplesPerSec(),_rates(),_usecsPerSample(),
     _halfMaxUsecsPerSample(INT_MIN),
     _offsetUsec(),_sampleLengths(),_sampleOffsets(),
-    _varOffsets(),_varLengths(),_numVars(),_variables(),
+    _varOffsets(),_varLengths(),_numVars(),
+    _scatterIndex(),_scatterOffsets(),_scatterStrides(),_nanRecord(),
+    _variables(),
     _syncRecordHeaderSampleTag(),_syncRecordDataSampleTag(),
     _recSize(0),_syncHeaderTime(),_syncTime(),
     _current(0),
-    _syncRecord(),_dataPtr(),_unrecognizedSamples(),
+    _syncRecord(),_dataPtr(),_firstSampleTime(),_latencyHist(),
+    _unrecognizedSamples(),
     _headerStream(), _badLaterTimes(0),_badEarlierTimes(0),
     _aircraft(0),_initialized(false),_unknownSampleType(0)
 {
@@ -217,10 +220,10 @@ layoutSyncRecord()
             _offsetUsec[0].push_back(-1);
             _offsetUsec[1].push_back(-1);
 
-            int* varOffset = new int[nvars];
+            int* varOffset = new int[nvars]();
             _varOffsets.push_back(varOffset);
 
-            size_t* varLen = new size_t[nvars];
+            size_t* varLen = new size_t[nvars]();
             _varLengths.push_back(varLen);
 
             _numVars.push_back(nvars);
@@ -250,10 +253,19 @@ void SyncRecordSource::connect(SampleSource* source) throw()
         _aircraft = Aircraft::getAircraft(project);
     }
 
-    selectVariablesFromProject(project, _variables);
-    layoutSyncRecord();
+    std::list<const Variable*> variables;
+    selectVariablesFromProject(project, variables);
+    setVariables(variables);
 
     source->addSampleClient(this);
+}
+
+void
+SyncRecordSource::
+setVariables(const std::list<const Variable*>& variables)
+{
+    _variables = variables;
+    layoutSyncRecord();
     init();
 }
 
@@ -274,12 +286,33 @@ void SyncRecordSource::init()
     for (unsigned int si = 0; si < _varsByIndex.size(); si++) {
 	_sampleOffsets[si] = offset;
 	offset += _sampleLengths[si] + 1;   // add one for timeOffset
-	for (size_t i = 0; i < _numVars[si]; i++) {
+	// Only the selected variables of a sample have offsets, which
+	// may be fewer than the _numVars[si] variables of its tag.
+	for (size_t i = 0; i < _varsByIndex[si].size(); i++) {
 	    if (_varOffsets[si][i] >= 0)
 		_varOffsets[si][i] += _sampleOffsets[si];
 	}
     }
     _recSize = offset;
+    _nanRecord.assign(_recSize,doubleNAN);
+
+    // Build the scatter tables, with an entry for each value of
+    // each sample. Values of variable i of a sample are at
+    // varOffset[i] + 1 + varLen[i] * timeIndex + k in the record.
+    _scatterIndex.resize(_varsByIndex.size() + 1);
+    for (unsigned int si = 0; si < _varsByIndex.size(); si++) {
+        _scatterIndex[si] = _scatterOffsets.size();
+	for (size_t i = 0; i < _varsByIndex[si].size(); i++) {
+            int vlen = _varLengths[si][i];
+            assert(_varOffsets[si][i] + 1 + vlen * _intSamplesPerSec[si] <=
+                _recSize);
+            for (int k = 0; k < vlen; k++) {
+                _scatterOffsets.push_back(_varOffsets[si][i] + 1 + k);
+                _scatterStrides.push_back(vlen);
+            }
+        }
+    }
+    _scatterIndex[_varsByIndex.size()] = _scatterOffsets.size();
 }
 
 /* local utility function to replace one character in a string
@@ -468,6 +501,9 @@ SyncRecordSource::sendSyncRecord()
                    << " syncTime=" << tt
                    << " (" << format_time(tt) << ")");
         }
+        if (PipelineLatency::enabled())
+            _latencyHist.record(n_u::getSystemTime() -
+                _firstSampleTime[_current]);
         _source.distribute(_syncRecord[_current]);
         _syncRecord[_current] = 0;
         std::fill(_offsetUsec[_current].begin(), _offsetUsec[_current].end(), -1);
@@ -483,10 +519,15 @@ void SyncRecordSource::allocateRecord(int isync, dsm_time_t timetag)
     sp->setTimeTag(syncTime);
     sp->setId(SYNC_RECORD_ID);
     _dataPtr[isync] = sp->getDataPtr();
-    std::fill(_dataPtr[isync], _dataPtr[isync] + _recSize, doubleNAN);
+    // memcpy of a preset record is faster than a loop of NaN stores.
+    if (_recSize > 0)
+        ::memcpy(_dataPtr[isync], &_nanRecord[0], _recSize * sizeof(double));
     std::fill(_offsetUsec[isync].begin(), _offsetUsec[isync].end(), -1);
 
     _syncTime[isync] = syncTime;
+    // A record is allocated when its first sample is received.
+    if (PipelineLatency::enabled())
+        _firstSampleTime[isync] = n_u::getSystemTime();
 
     static nidas::util::LogContext lp(LOG_DEBUG);
     if (lp.active()) 
@@ -508,49 +549,28 @@ int SyncRecordSource::advanceRecord(dsm_time_t timetag)
     return _current;
 }
 
+/**
+ * Copy the values of a sample into a sync record,
+ * at the offsets in its scatter table.
+ */
 template <typename ST>
 void
-copy_variables_to_record(const Sample* samp, double* dataPtr, int recSize,
-                         int* varOffset, size_t* varLen, size_t numVar,
-                         int timeIndex)
+scatter_to_record(const Sample* samp, double* dataPtr,
+                  const int* offsets, const int* strides, size_t nvals,
+                  int timeIndex)
 {
     const ST* fp = (const ST*)samp->getConstVoidDataPtr();
-    const ST* ep = fp + samp->getDataLength();
+    size_t n = std::min((size_t)samp->getDataLength(), nvals);
 
-    for (size_t i = 0; i < numVar && fp < ep; i++) {
-        size_t outlen = varLen[i];
-        size_t inlen = std::min((size_t)(ep-fp), outlen);
-
-        if (varOffset[i] >= 0) {
-            double* dp = dataPtr + varOffset[i] + 1 + outlen * timeIndex;
-            if (0)
-            {
-                DLOG(("varOffset[") << i << "]=" << varOffset[i] <<
-                     " outlen=" << outlen << " timeIndex=" << timeIndex <<
-                     " recSize=" << recSize);
-            }
-            assert(dp + outlen <= dataPtr + recSize);
-            // XXX
-            // This is a little dangerous because it assumes if the types
-            // have the same size then they are the same type with the same
-            // representation in memory.  It fails for integer types with the
-            // same size as a double, but so far I guess that is never true
-            // on nidas platforms.
-            // XXX
-            if (sizeof(*fp) != sizeof(*dp))
-                for (unsigned int j = 0; j < inlen; j++) dp[j] = fp[j];
-            else
-                memcpy(dp, fp, inlen*sizeof(*dp));
-        }
-        fp += inlen;
-    }
+    for (size_t j = 0; j < n; j++)
+        dataPtr[offsets[j] + strides[j] * timeIndex] = fp[j];
 }
 
 int
 SyncRecordSource::
 sampleIndexFromId(dsm_sample_id_t sampleId)
 {
-    map<dsm_sample_id_t, int>::const_iterator gi;
+    SampleIdMap<int>::const_iterator gi;
     gi = _sampleIndices.find(sampleId);
     if (gi == _sampleIndices.end()) {
         _unrecognizedSamples++;
@@ -785,22 +805,24 @@ bool SyncRecordSource::receive(const Sample* samp) throw()
             << ", varLen[0]=" << varLen[0] << endlog;
     }
 	
+    size_t si0 = _scatterIndex[sampleIndex];
+    const int* offsets = &_scatterOffsets[si0];
+    const int* strides = &_scatterStrides[si0];
+    size_t nvals = _scatterIndex[sampleIndex + 1] - si0;
+
     switch (samp->getType()) {
 
     case UINT32_ST:
-        copy_variables_to_record<uint32_t>(samp, _dataPtr[isync], _recSize,
-                                           varOffset, varLen, numVar,
-                                           timeIndex);
+        scatter_to_record<uint32_t>(samp, _dataPtr[isync],
+                                    offsets, strides, nvals, timeIndex);
 	break;
     case FLOAT_ST:
-        copy_variables_to_record<float>(samp, _dataPtr[isync], _recSize,
-                                        varOffset, varLen, numVar,
-                                        timeIndex);
+        scatter_to_record<float>(samp, _dataPtr[isync],
+                                 offsets, strides, nvals, timeIndex);
 	break;
     case DOUBLE_ST:
-        copy_variables_to_record<double>(samp, _dataPtr[isync], _recSize,
-                                         varOffset, varLen, numVar,
-                                         timeIndex);
+        scatter_to_record<double>(samp, _dataPtr[isync],
+                                  offsets, strides, nvals, timeIndex);
 	break;
     default:
 	if (!(_unknownSampleType++ % 1000)) 
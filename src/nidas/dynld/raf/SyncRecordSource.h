@@ -29,6 +29,8 @@
 
 #include <nidas/core/Resampler.h>
 #include <nidas/core/SampleTag.h>
+#include <nidas/core/SampleIdMap.h>
+#include <nidas/core/LatencyHistogram.h>
 
 #define SYNC_RECORD_ID 3
 #define SYNC_RECORD_HEADER_ID 2
@@ -251,6 +253,11 @@ public:
         return _source.getSampleStats();
     }
 
+    /**
+     * Select the variables of the current Project with
+     * selectVariablesFromProject(), lay out the sync record with
+     * setVariables(), and add this as a client of @p source.
+     */
     void connect(SampleSource* source) throw();
 
     void disconnect(SampleSource* source) throw();
@@ -267,6 +274,12 @@ public:
      **/
     void sendSyncHeader() throw();
 
+    /**
+     * Lay out the sync record for a list of variables, as selected
+     * by selectVariablesFromProject(), and initialize it.
+     */
+    void setVariables(const std::list<const Variable*>& variables);
+
     bool receive(const Sample*) throw();
 
     static const int NSYNCREC = 2;
@@ -274,6 +287,14 @@ public:
     void
     preLoadCalibrations(dsm_time_t sampleTime) throw();
 
+    /**
+     * Latency of the sync records, from the system time that
+     * the first sample was placed in a record to the system time
+     * that the record was distributed. Recorded if
+     * PipelineLatency::enabled().
+     */
+    LatencyHistogram& getLatencyHistogram() { return _latencyHist; }
+
 protected:
 
     void init();
@@ -333,7 +354,7 @@ private:
      * range from 0 to the total number of different input samples -1.
      * When we receive a sample, what is its sampleIndex.
      */
-    std::map<dsm_sample_id_t, int> _sampleIndices;
+    SampleIdMap<int> _sampleIndices;
 
     /**
      * For each sample, by its index, the sampling rate, rounded up to an
@@ -388,6 +409,26 @@ private:
      */
     std::vector<size_t> _numVars;
 
+    /**
+     * Scatter tables, computed by init() from _varOffsets and
+     * _varLengths, so that receive() places each value of a sample
+     * without looping over its variables. For value j of the sample
+     * with index si, at k = _scatterIndex[si] + j, its offset into
+     * the record is _scatterOffsets[k] + _scatterStrides[k] * timeIndex.
+     * _scatterIndex has an extra element, so that the number of values
+     * of sample si is _scatterIndex[si+1] - _scatterIndex[si].
+     */
+    std::vector<size_t> _scatterIndex;
+
+    std::vector<int> _scatterOffsets;
+
+    std::vector<int> _scatterStrides;
+
+    /**
+     * A record of NaNs, copied to initialize a new sync record.
+     */
+    std::vector<double> _nanRecord;
+
     /**
      * List of all variables in the sync record.
      */
@@ -412,6 +453,13 @@ private:
 
     double* _dataPtr[2];
 
+    /**
+     * System time of the first sample placed in each sync record.
+     */
+    dsm_time_t _firstSampleTime[2];
+
+    LatencyHistogram _latencyHist;
+
     size_t _unrecognizedSamples;
 
     std::ostringstream _headerStream;
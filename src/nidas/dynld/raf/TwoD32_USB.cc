@@ -125,6 +125,10 @@ bool TwoD32_USB::processImage(const Sample * samp,
 
         const unsigned char* sos = cp;       // possible start of particle slice
 
+        // Most words are particle slices, without the first byte
+        // of a sync or overload word. Skip the byte scan for those.
+        if (!wordHasByte(cp,wordSize,0x55)) cp = eow;
+
         for (; cp < eow; ) {
             switch (*cp) {
             case 0x55:  // overload (0x55aa) or sync (0x55*) string
@@ -251,6 +251,14 @@ bool TwoD64_USB::processImageRecord(const Sample * samp,
          * a possible syncWord or overloadWord */
         const unsigned char* eow = cp + wordSize;
 
+        // Most words are particle slices, without the first byte
+        // of a sync or overload word. Skip the byte scan for those.
+        if (!wordHasByte(cp,wordSize,0x55) && !wordHasByte(cp,wordSize,0xaa)
+#ifdef SLICE_DEBUG
+            && !sdlog.active()
+#endif
+            ) cp = eow;
+
         for (; cp < eow; ) {
 #ifdef SLICE_DEBUG
             if (sdlog.active())
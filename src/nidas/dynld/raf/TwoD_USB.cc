@@ -389,69 +389,45 @@ void TwoD_USB::createSamples(dsm_time_t nextTimeTag,list < const Sample * >&resu
 /*---------------------------------------------------------------------------*/
 void TwoD_USB::processParticleSlice(Particle& p, const unsigned char * data)
 {
-    int nBytes = NumberOfDiodes() / 8;
+    // The slice is handled as 32 bit big-endian words, so that the
+    // first diode is the most significant bit of the first word,
+    // and the bits can be counted with the popcount and clz/ctz builtins.
+    // NumberOfDiodes() is a multiple of 32 for all the probes.
+    int nWords = NumberOfDiodes() / 32;
 
     /* Note that 2D data is inverted.  So a '1' means no shadowing of the diode.
      * '0' means shadowing and a particle.  Perform complement here.
      */
-    unsigned char slice[nBytes];
-    for (int i = 0; i < nBytes; ++i)
-        slice[i] = ~(data[i]);
+    uint32_t slice[nWords];
+    for (int i = 0; i < nWords; ++i)
+        slice[i] = ~bigEndian->uint32Value(data + i * 4);
 
     p.width++;
 
-    if ((slice[0] & 0x80)) { // touched edge
+    if ((slice[0] & 0x80000000)) { // touched edge
         p.edgeTouch |= 0x0F;
     }
 
-    if ((slice[nBytes-1] & 0x01)) { // touched edge
+    if ((slice[nWords-1] & 0x01)) { // touched edge
         p.edgeTouch |= 0xF0;
     }
 
     // Compute area = number of bits set in particle
-    for (int i = 0; i < nBytes; ++i)
-    {
-        unsigned char c = slice[i];
-        for (; c; p.area++)
-            c &= c - 1; // clear the least significant bit set
-    }
+    for (int i = 0; i < nWords; ++i)
+        p.area += __builtin_popcount(slice[i]);
 
     // number of bits between first and last set bit, inclusive
-    int h = NumberOfDiodes();
-    for (int i = 0; i < nBytes; ++i)
-    {
-        if (slice[i] == 0)
-        {
-            h -= 8;
-            continue;
-        }
-        int r = 7;
-        unsigned char v = slice[i];
-        while (v >>= 1)
-            r--;
-        h -= r;
-        break;
-    }
-    for (int i = nBytes-1; i >= 0; --i)
-    {
-        if (slice[i] == 0)
-        {
-            h -= 8;
-            continue;
-        }
-        int r = 0;
-        unsigned char v = slice[i];
-        while ((v & 0x01) == 0)
-        {
-            r++;
-            v >>= 1;
-        }
-        h -= r;
-        break;
-    }
+    int first = 0;
+    while (first < nWords && slice[first] == 0) first++;
+    if (first == nWords) return;    // empty slice, height is 0
+
+    int last = nWords - 1;
+    while (slice[last] == 0) last--;
+
+    int h = (last - first + 1) * 32 -
+        __builtin_clz(slice[first]) - __builtin_ctz(slice[last]);
 
-    if (h > 0)
-        p.height = std::max((unsigned)h, p.height);
+    p.height = std::max((unsigned)h, p.height);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -35,6 +35,8 @@
 
 #include <nidas/linux/usbtwod/usbtwod.h>
 
+#include <cstring>
+
 namespace nidas { namespace dynld { namespace raf {
 
 using namespace nidas::core;
@@ -186,6 +188,25 @@ protected:
      */
     virtual void processParticleSlice(Particle& p, const unsigned char * slice);
 
+    /**
+     * Does a word of n bytes, n <= 8, contain a byte equal to c,
+     * where c is not zero? The bytes are compared all at once, so that
+     * the slices of an image can be checked quickly for the bytes which
+     * may start a sync or overload word, before looking at them one
+     * byte at a time.
+     */
+    static bool wordHasByte(const unsigned char* cp, unsigned int n,
+        unsigned char c)
+    {
+        const unsigned long long ones = 0x0101010101010101ULL;
+        unsigned long long v = 0;
+        ::memcpy(&v,cp,n);
+        // Bytes which match c become zero. The bytes of v past n
+        // become c, which is not zero.
+        v ^= ones * c;
+        return ((v - ones) & ~v & (ones << 7)) != 0;
+    }
+
     /**
      * Look at particle stats/info and decide whether to accept or reject.
      * @param p is the particle information.
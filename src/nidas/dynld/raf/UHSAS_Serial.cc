@@ -25,6 +25,7 @@
 */
 
 #include "UHSAS_Serial.h"
+#include "SppSerial.h"
 #include <nidas/core/PhysConstants.h>
 #include <nidas/core/Parameter.h>
 #include <nidas/core/SampleTag.h>
@@ -527,14 +528,9 @@ bool UHSAS_Serial::process(const Sample* samp,list<const Sample*>& results)
         // If user asked for 100 values, add a bogus zeroth bin for historical reasons
         if (_nOutBins == _nValidChannels + 1) *dout++ = 0.0;
 
-        int sum = 0;
         // UHSAS puts out largest bins first
-        for (int iout = _nValidChannels-1; iout >= 0; --iout) {
-           int c = fromLittle->uint16Value(histoPtr);
-           histoPtr += sizeof(short);
-           sum += c;
-           dout[iout] = (float)c;
-        }
+        int sum = UnpackDMT_UShortsReversed((const DMT_UShort*)histoPtr,
+            _nValidChannels, dout);
         dout += _nValidChannels;
         ivar++;
 
@@ -0,0 +1,389 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#include "FormatBuffer.h"
+#include "UTime.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <climits>
+
+using namespace nidas::util;
+using namespace std;
+
+namespace {
+
+/*
+ * Powers of ten which are exactly representable as doubles.
+ */
+const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+const int MAX_POW10 = 22;
+
+/*
+ * Largest precision of the integer conversion in roundDigits().
+ */
+const int MAX_FAST_PRECISION = 12;
+
+/**
+ * Round a positive, finite value to a number of significant digits,
+ * as printf does, returning the digits as an integer of precision
+ * digits, and the decimal exponent of the first digit.
+ *
+ * The value is scaled by a power of ten with one rounded multiply
+ * or divide, so the scaled value is within a half ulp, less than
+ * 10^precision * 2^-53, of the exact value.  If the scaled value is
+ * within a few times that of a rounding boundary, the digits
+ * might differ from those of printf, which rounds the exact binary
+ * value, and false is returned.
+ */
+bool roundDigits(double aval, int precision, unsigned long long& digits,
+    int& exp10)
+{
+    int e2;
+    ::frexp(aval, &e2);
+    // The value is in [2^(e2-1), 2^e2), so this is the decimal
+    // exponent, or one less.
+    int e10 = (int)::floor((e2 - 1) * 0.30102999566398120);
+
+    int k = precision - 1 - e10;
+    if (k > MAX_POW10 || k < -MAX_POW10) return false;
+    double scaled = k >= 0 ? aval * POW10[k] : aval / POW10[-k];
+
+    if (scaled >= POW10[precision]) {
+        e10++;
+        k--;
+        if (k < -MAX_POW10) return false;
+        scaled = k >= 0 ? aval * POW10[k] : aval / POW10[-k];
+    }
+
+    double whole = ::floor(scaled);
+    double guard = POW10[precision] * (1.0 / (1LL << 50));
+    if (::fabs(scaled - whole - 0.5) <= guard) return false;
+
+    digits = (unsigned long long)whole;
+    if (scaled - whole > 0.5) digits++;
+    if (digits >= (unsigned long long)POW10[precision]) {
+        digits /= 10;
+        e10++;
+    }
+    exp10 = e10;
+    return true;
+}
+
+/**
+ * Whether the decimal value digits * 10^(exp10-precision+1) converts
+ * to the float f. Returns -1 if the decimal value is too close to
+ * the midpoint between f and one of its neighbors to decide
+ * without an exact conversion.
+ */
+int floatRoundTrips(float af, unsigned long long digits, int precision,
+    int exp10)
+{
+    int m = exp10 - precision + 1;
+    if (m > MAX_POW10 || m < -MAX_POW10) return -1;
+    double x = m >= 0 ? (double)digits * POW10[m] : (double)digits / POW10[-m];
+
+    // The midpoints between f and its neighbors are exact in double.
+    double lo = ((double)af + (double)::nextafterf(af, 0.0f)) / 2.0;
+    double hi = ((double)af + (double)::nextafterf(af, HUGE_VALF)) / 2.0;
+    double tol = x * (1.0 / (1LL << 50));
+
+    if (x > lo + tol && x < hi - tol) return 1;
+    if (x < lo - tol || x > hi + tol) return 0;
+    return -1;
+}
+
+}
+
+FormatBuffer::FormatBuffer(size_t writeSize, int writeInterval):
+    _buf(writeSize + 1024), _len(0), _writeSize(writeSize),
+    _writeInterval(writeInterval), _lastWrite(getSystemTime()),
+    _timePrefixFormat(), _timeSuffixFormat(), _fracDigits(-1),
+    _timeSecond(LONG_LONG_MIN), _timePrefix(), _timeSuffix()
+{
+    setTimeFormat("%Y %m %d %H:%M:%S.%4f");
+}
+
+void FormatBuffer::grow(size_t n)
+{
+    size_t newsize = _buf.size() * 2;
+    if (newsize < _len + n) newsize = _len + n;
+    _buf.resize(newsize);
+}
+
+bool FormatBuffer::writeDue() const
+{
+    if (_len >= _writeSize) return true;
+    return _len > 0 && getSystemTime() - _lastWrite >= _writeInterval;
+}
+
+void FormatBuffer::write(ostream& ostr)
+{
+    ostr.write(data(), _len);
+    ostr.flush();
+    written();
+}
+
+void FormatBuffer::written()
+{
+    _len = 0;
+    _lastWrite = getSystemTime();
+}
+
+void FormatBuffer::setTimeFormat(const string& fmt)
+{
+    // Split the format at the fractional seconds descriptor, as
+    // recognized by UTime::format.
+    _fracDigits = -1;
+    _timePrefixFormat = fmt;
+    _timeSuffixFormat.clear();
+    for (string::size_type i = fmt.find('%'); i != string::npos;
+            i = fmt.find('%', i + 1)) {
+        if (i + 1 < fmt.length() && fmt[i+1] == 'f') {
+            _fracDigits = 3;
+            _timePrefixFormat = fmt.substr(0, i);
+            _timeSuffixFormat = fmt.substr(i + 2);
+            break;
+        }
+        if (i + 2 < fmt.length() && ::isdigit(fmt[i+1]) && fmt[i+2] == 'f') {
+            _fracDigits = fmt[i+1] - '0';
+            _timePrefixFormat = fmt.substr(0, i);
+            _timeSuffixFormat = fmt.substr(i + 3);
+            break;
+        }
+    }
+    _timeSecond = LONG_LONG_MIN;
+}
+
+void FormatBuffer::appendTime(long long usecs)
+{
+    long long sec = usecs / USECS_PER_SEC;
+    long long frac = usecs % USECS_PER_SEC;
+    if (frac < 0) {
+        sec--;
+        frac += USECS_PER_SEC;
+    }
+
+    if (_fracDigits >= 0) {
+        // round to the number of digits, as UTime::format() does
+        long long div = 1;
+        long long mult = 1;
+        for (int i = _fracDigits; i < 6; i++) div *= 10;
+        for (int i = 6; i < _fracDigits; i++) mult *= 10;
+        frac = (frac + div / 2) / div;
+        if (frac * div >= USECS_PER_SEC) {
+            sec++;
+            frac = 0;
+        }
+        frac *= mult;
+    }
+
+    if (sec != _timeSecond) {
+        UTime ut(sec * USECS_PER_SEC);
+        _timePrefix = ut.format(true, _timePrefixFormat);
+        if (_timeSuffixFormat.empty()) _timeSuffix.clear();
+        else _timeSuffix = ut.format(true, _timeSuffixFormat);
+        _timeSecond = sec;
+    }
+
+    append(_timePrefix);
+    if (_fracDigits > 0) {
+        char tmp[24];
+        for (int i = _fracDigits - 1; i >= 0; i--) {
+            tmp[i] = '0' + frac % 10;
+            frac /= 10;
+        }
+        append(tmp, _fracDigits);
+    }
+    append(_timeSuffix);
+}
+
+void FormatBuffer::pad(int n)
+{
+    if (n <= 0) return;
+    if (_len + n > _buf.size()) grow(n);
+    for (int i = 0; i < n; i++) _buf[_len++] = ' ';
+}
+
+void FormatBuffer::appendInt(long long val, int width)
+{
+    char tmp[24];
+    char* cp = tmp + sizeof(tmp);
+    unsigned long long uval = val < 0 ? -(unsigned long long)val : val;
+    do {
+        *--cp = '0' + uval % 10;
+        uval /= 10;
+    } while (uval);
+    if (val < 0) *--cp = '-';
+    int n = tmp + sizeof(tmp) - cp;
+    pad(width - n);
+    append(cp, n);
+}
+
+void FormatBuffer::appendHex(unsigned long long val, int width)
+{
+    static const char hexdigits[] = "0123456789abcdef";
+    char tmp[24];
+    char* cp = tmp + sizeof(tmp);
+    do {
+        *--cp = hexdigits[val & 0xf];
+        val >>= 4;
+    } while (val);
+    while (cp > tmp && tmp + sizeof(tmp) - cp < width) *--cp = '0';
+    append(cp, tmp + sizeof(tmp) - cp);
+}
+
+void FormatBuffer::appendPrintf(double val, int precision, int width)
+{
+    char tmp[64];
+    int n = ::snprintf(tmp, sizeof(tmp), "%*.*g", width, precision, val);
+    if (n >= (int)sizeof(tmp)) n = sizeof(tmp) - 1;
+    append(tmp, n);
+}
+
+void FormatBuffer::appendDigits(bool neg, unsigned long long digits,
+    int precision, int exp10, int width)
+{
+    char dstr[24];
+    for (int i = precision - 1; i >= 0; i--) {
+        dstr[i] = '0' + digits % 10;
+        digits /= 10;
+    }
+    // number of significant digits, without trailing zeroes
+    int nsig = precision;
+    while (nsig > 1 && dstr[nsig-1] == '0') nsig--;
+
+    char tmp[64];
+    char* cp = tmp;
+    if (neg) *cp++ = '-';
+
+    if (exp10 < -4 || exp10 >= precision) {
+        *cp++ = dstr[0];
+        if (nsig > 1) {
+            *cp++ = '.';
+            for (int i = 1; i < nsig; i++) *cp++ = dstr[i];
+        }
+        *cp++ = 'e';
+        int e = exp10;
+        if (e < 0) {
+            *cp++ = '-';
+            e = -e;
+        }
+        else *cp++ = '+';
+        if (e >= 100) *cp++ = '0' + e / 100;
+        *cp++ = '0' + (e / 10) % 10;
+        *cp++ = '0' + e % 10;
+    }
+    else if (exp10 >= 0) {
+        int i = 0;
+        for ( ; i <= exp10; i++) *cp++ = dstr[i];
+        if (nsig > i) {
+            *cp++ = '.';
+            for ( ; i < nsig; i++) *cp++ = dstr[i];
+        }
+    }
+    else {
+        *cp++ = '0';
+        *cp++ = '.';
+        for (int i = -1; i > exp10; i--) *cp++ = '0';
+        for (int i = 0; i < nsig; i++) *cp++ = dstr[i];
+    }
+    int n = cp - tmp;
+    pad(width - n);
+    append(tmp, n);
+}
+
+void FormatBuffer::appendGeneral(double val, int precision, int width)
+{
+    if (precision < 0) precision = 6;
+    else if (precision == 0) precision = 1;
+
+    unsigned long long digits;
+    int exp10;
+
+    if (precision > MAX_FAST_PRECISION || !isfinite(val) || val == 0.0 ||
+        !roundDigits(::fabs(val), precision, digits, exp10)) {
+        appendPrintf(val, precision, width);
+        return;
+    }
+    appendDigits(val < 0.0, digits, precision, exp10, width);
+}
+
+void FormatBuffer::appendShortest(float val, int width)
+{
+    if (!isfinite(val) || val == 0.0f) {
+        appendPrintf(val, 6, width);
+        return;
+    }
+
+    float af = ::fabs(val);
+    // If a decimal value of less than 6 digits converts to a float,
+    // it is also the value of the float rounded to 6 digits,
+    // so start at 6. 9 digits are always enough.
+    for (int precision = 6; precision <= 9; precision++) {
+        unsigned long long digits;
+        int exp10;
+        if (roundDigits(af, precision, digits, exp10)) {
+            int ok = floatRoundTrips(af, digits, precision, exp10);
+            if (ok > 0) {
+                appendDigits(val < 0.0f, digits, precision, exp10, width);
+                return;
+            }
+            if (ok == 0 && precision < 9) continue;
+        }
+        char tmp[64];
+        ::snprintf(tmp, sizeof(tmp), "%.*g", precision, val);
+        if (precision == 9 || ::strtof(tmp, 0) == val) {
+            appendPrintf(val, precision, width);
+            return;
+        }
+    }
+}
+
+void FormatBuffer::appendShortest(double val, int width)
+{
+    if (!isfinite(val) || val == 0.0) {
+        appendPrintf(val, 6, width);
+        return;
+    }
+    // As with floats, a shorter representation is also
+    // the value rounded to 15 digits.
+    for (int precision = 15; precision < 17; precision++) {
+        char tmp[64];
+        ::snprintf(tmp, sizeof(tmp), "%.*g", precision, val);
+        if (::strtod(tmp, 0) == val) {
+            appendPrintf(val, precision, width);
+            return;
+        }
+    }
+    appendPrintf(val, 17, width);
+}
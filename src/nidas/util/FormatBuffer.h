@@ -0,0 +1,209 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#ifndef NIDAS_UTIL_FORMATBUFFER_H
+#define NIDAS_UTIL_FORMATBUFFER_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace nidas { namespace util {
+
+/**
+ * A reusable character buffer, with methods to append numbers and
+ * time tags in the formats that are otherwise done with std::ostream
+ * manipulators and UTime::format(), but without their overhead, for
+ * programs like data_dump and prep which write a line of text for
+ * every sample.
+ *
+ * Time tags are formatted with a UTime format containing a %nf
+ * descriptor for the fractional seconds. The part of the formatted
+ * time that does not change within a second is cached, so
+ * UTime::format() is only called once a second.
+ *
+ * appendGeneral() gives the same result as writing a double to an
+ * ostream with setprecision() and setw(), which is the "%*.*g" format
+ * of printf, but it only calls snprintf for values that are out of
+ * range of its integer conversion, or which are too close to a rounding
+ * boundary to be sure of the last digit.
+ *
+ * appendShortest() writes a value in the %g format with the fewest
+ * significant digits, but at least 6, which convert back to the
+ * identical binary value.
+ *
+ * The buffer grows as needed, and keeps its memory when it is cleared.
+ * write() and written() clear it, which a user typically calls when
+ * writeDue() returns true after appending a sample. A user whose input
+ * can go quiet should also write the buffer on a timer, or when its
+ * input is idle, since writeDue() is not checked until the next sample.
+ */
+class FormatBuffer
+{
+public:
+
+    /**
+     * @param writeSize: writeDue() returns true if the buffer contains
+     *      at least this many bytes.
+     * @param writeInterval: writeDue() returns true if this many
+     *      microseconds of system time have passed since the last write().
+     */
+    FormatBuffer(size_t writeSize = 65536, int writeInterval = 500000);
+
+    const char* data() const { return &_buf[0]; }
+
+    size_t size() const { return _len; }
+
+    bool empty() const { return _len == 0; }
+
+    void clear() { _len = 0; }
+
+    /**
+     * Whether the buffer should be written, because it is larger than
+     * writeSize, or writeInterval has passed since the last write().
+     */
+    bool writeDue() const;
+
+    /**
+     * Write the contents of the buffer to an ostream and clear it.
+     */
+    void write(std::ostream& ostr);
+
+    /**
+     * Note that the buffer has been written and clear it, for users
+     * which write data() and size() to something other than an ostream.
+     */
+    void written();
+
+    /**
+     * Set the format of appendTime(), as would be passed to
+     * UTime::format(true,fmt). Time tags are formatted in UTC.
+     * The fractional seconds descriptor, %f or %nf, may appear once.
+     */
+    void setTimeFormat(const std::string& fmt);
+
+    void appendTime(long long usecs);
+
+    void append(char c)
+    {
+        if (_len == _buf.size()) grow(1);
+        _buf[_len++] = c;
+    }
+
+    void append(const char* s, size_t n)
+    {
+        if (_len + n > _buf.size()) grow(n);
+        for (size_t i = 0; i < n; i++) _buf[_len + i] = s[i];
+        _len += n;
+    }
+
+    void append(const std::string& s)
+    {
+        append(s.data(), s.length());
+    }
+
+    /**
+     * Append an integer, right justified with spaces to a field of
+     * width characters, as with ostr << setw(width) << val.
+     */
+    void appendInt(long long val, int width = 0);
+
+    /**
+     * Append an integer in lower case hex, zero filled to width characters,
+     * as with ostr << setfill('0') << hex << setw(width) << val.
+     */
+    void appendHex(unsigned long long val, int width = 0);
+
+    /**
+     * Append a value as with ostr << setprecision(precision) <<
+     * setw(width) << val, with the default std::ostream float field.
+     */
+    void appendGeneral(double val, int precision, int width = 0);
+
+    /**
+     * Append the shortest %g representation of a float, with at
+     * least 6 significant digits, that converts back to the same float,
+     * right justified to width.
+     */
+    void appendShortest(float val, int width = 0);
+
+    /**
+     * Append the shortest %g representation of a double, with at
+     * least 15 significant digits, that converts back to the same double.
+     */
+    void appendShortest(double val, int width = 0);
+
+private:
+
+    void grow(size_t n);
+
+    /**
+     * Append n spaces, if n > 0.
+     */
+    void pad(int n);
+
+    /**
+     * Append a %g formatted value with snprintf.
+     */
+    void appendPrintf(double val, int precision, int width);
+
+    /**
+     * Append a %.precisiong value, given its decimal digits
+     * and the exponent of the first digit.
+     */
+    void appendDigits(bool neg, unsigned long long digits, int precision,
+        int exp10, int width);
+
+    std::vector<char> _buf;
+
+    size_t _len;
+
+    size_t _writeSize;
+
+    int _writeInterval;
+
+    long long _lastWrite;
+
+    std::string _timePrefixFormat;
+
+    std::string _timeSuffixFormat;
+
+    int _fracDigits;
+
+    /**
+     * Second of the cached _timePrefix and _timeSuffix.
+     */
+    long long _timeSecond;
+
+    std::string _timePrefix;
+
+    std::string _timeSuffix;
+
+};
+
+}}	// namespace nidas namespace util
+
+#endif
@@ -656,6 +656,33 @@ void Thread::setThreadSchedulerNolock(enum SchedPolicy policy,int val) throw(Exc
     }
 }
 
+void Thread::setCPUAffinity(const std::set<int>& cpus) throw(Exception)
+{
+#ifdef CPU_SET
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (std::set<int>::const_iterator ci = cpus.begin(); ci != cpus.end(); ++ci)
+        CPU_SET(*ci,&cpuset);
+
+    Synchronized autolock(_mutex);
+    int status;
+    if (_id) {
+        status = ::pthread_setaffinity_np(_id,sizeof(cpuset),&cpuset);
+        if (status)
+            throw Exception(getName(),
+                    string("pthread_setaffinity_np: ") + Exception::errnoToString(status));
+    }
+    else {
+        status = ::pthread_attr_setaffinity_np(&_thread_attr,sizeof(cpuset),&cpuset);
+        if (status)
+            throw Exception(getName(),
+                    string("pthread_attr_setaffinity_np: ") + Exception::errnoToString(status));
+    }
+#else
+    throw Exception(getName(),"CPU affinity not supported");
+#endif
+}
+
 ThreadJoiner::ThreadJoiner(Thread* thrd):
     DetachedThread("ThreadJoiner"),_thread(thrd)
 {
@@ -322,6 +322,13 @@ public:
 
     void setThreadScheduler(enum SchedPolicy policy, int priority) throw(Exception);
 
+    /**
+     * Restrict this thread to a set of CPUs, numbered from 0.
+     * If the thread is not running, the affinity is set when
+     * it is started.
+     */
+    void setCPUAffinity(const std::set<int>& cpus) throw(Exception);
+
     /**
      * Block a signal in this thread. This method is usually called
      * before this Thread has started. If this Thread is currently
@@ -0,0 +1,284 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#include "ThreadPool.h"
+#include "InterruptedException.h"
+#include "Logger.h"
+
+#include <sstream>
+
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+
+using namespace nidas::util;
+using namespace std;
+
+Task::Task(): _cond(),_done(true),_exception(0)
+{
+}
+
+Task::~Task()
+{
+    delete _exception;
+}
+
+void Task::reset() throw()
+{
+    Synchronized sync(_cond);
+    _done = false;
+    delete _exception;
+    _exception = 0;
+}
+
+void Task::finish(Exception* e) throw()
+{
+    Synchronized sync(_cond);
+    _done = true;
+    _exception = e;
+    _cond.broadcast();
+}
+
+bool Task::isDone() const
+{
+    Synchronized sync(_cond);
+    return _done;
+}
+
+void Task::wait() throw(Exception)
+{
+    Synchronized sync(_cond);
+    while (!_done) _cond.wait();
+    if (_exception) {
+        Exception* e = _exception;
+        _exception = 0;
+        // thrown by value, so that the caller need not delete it
+        Exception ex(*e);
+        delete e;
+        throw ex;
+    }
+}
+
+ThreadPool::ThreadPool(const string& name, unsigned int nthreads):
+    _name(name),_workers(),_cond(),_nqueued(0),_next(0),
+    _stopping(false),_cpuAffinity(false),_started(false)
+{
+    if (nthreads == 0) {
+        long n = ::sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = n > 0 ? n : 1;
+    }
+    for (unsigned int i = 0; i < nthreads; i++)
+        _workers.push_back(new Worker(this,i));
+}
+
+ThreadPool::~ThreadPool()
+{
+    try {
+        if (_started) stop(true);
+    }
+    catch (const Exception& e) {
+        WLOG(("%s: %s",getName().c_str(),e.what()));
+    }
+    for (unsigned int i = 0; i < _workers.size(); i++)
+        delete _workers[i];
+}
+
+void ThreadPool::setRealTimeFIFOPriority(int val) throw(Exception)
+{
+    setThreadScheduler(Thread::NU_THREAD_FIFO,val);
+}
+
+void ThreadPool::setThreadScheduler(enum Thread::SchedPolicy policy,
+    int priority) throw(Exception)
+{
+    for (unsigned int i = 0; i < _workers.size(); i++)
+        _workers[i]->setThreadScheduler(policy,priority);
+}
+
+void ThreadPool::start() throw(Exception)
+{
+    for (unsigned int i = 0; i < _workers.size(); i++)
+        _workers[i]->start();
+    _started = true;
+}
+
+void ThreadPool::submit(Task* task, int hint) throw()
+{
+    task->reset();
+
+    unsigned int i;
+    if (hint >= 0) i = hint % _workers.size();
+    else {
+        Synchronized sync(_cond);
+        i = _next++ % _workers.size();
+    }
+    _workers[i]->push(task);
+
+    // The count is incremented after the push, and decremented after
+    // a pop, so a worker never waits while a Task is queued.
+    __sync_add_and_fetch(&_nqueued,1);
+
+    Synchronized sync(_cond);
+    _cond.signal();
+}
+
+Task* ThreadPool::take(unsigned int i) throw()
+{
+    Task* task = _workers[i]->pop();
+    for (unsigned int j = 1; !task && j < _workers.size(); j++) {
+        task = _workers[(i + j) % _workers.size()]->steal();
+        if (task) _workers[i]->_nstolen++;
+    }
+    if (task) __sync_sub_and_fetch(&_nqueued,1);
+    return task;
+}
+
+void ThreadPool::join() throw(Exception)
+{
+    stop(false);
+}
+
+void ThreadPool::interrupt() throw()
+{
+    try {
+        stop(true);
+    }
+    catch (const Exception& e) {
+        WLOG(("%s: %s",getName().c_str(),e.what()));
+    }
+}
+
+void ThreadPool::stop(bool interrupt) throw(Exception)
+{
+    _cond.lock();
+    _stopping = true;
+    if (interrupt)
+        for (unsigned int i = 0; i < _workers.size(); i++)
+            _workers[i]->interrupt();
+    _cond.broadcast();
+    _cond.unlock();
+
+    if (_started) {
+        for (unsigned int i = 0; i < _workers.size(); i++)
+            if (!_workers[i]->isJoined()) _workers[i]->join();
+    }
+
+    // Tasks not run, after an interrupt, or if the pool was not started.
+    for (unsigned int i = 0; i < _workers.size(); i++) {
+        Task* task;
+        while ((task = _workers[i]->pop())) {
+            __sync_sub_and_fetch(&_nqueued,1);
+            task->finish(new InterruptedException(getName(),"task not run"));
+        }
+    }
+}
+
+unsigned long long ThreadPool::getNumStolen() const
+{
+    unsigned long long n = 0;
+    for (unsigned int i = 0; i < _workers.size(); i++)
+        n += _workers[i]->_nstolen;
+    return n;
+}
+
+namespace {
+    string workerName(const string& name, unsigned int index)
+    {
+        ostringstream ost;
+        ost << name << '_' << index;
+        return ost.str();
+    }
+}
+
+ThreadPool::Worker::Worker(ThreadPool* pool, unsigned int index):
+    Thread(workerName(pool->getName(),index)),_pool(pool),_index(index),
+    _queue(),_queueMutex(),_nstolen(0)
+{
+}
+
+void ThreadPool::Worker::push(Task* task) throw()
+{
+    Synchronized sync(_queueMutex);
+    _queue.push_back(task);
+}
+
+Task* ThreadPool::Worker::pop() throw()
+{
+    Synchronized sync(_queueMutex);
+    if (_queue.empty()) return 0;
+    Task* task = _queue.front();
+    _queue.pop_front();
+    return task;
+}
+
+Task* ThreadPool::Worker::steal() throw()
+{
+    Synchronized sync(_queueMutex);
+    if (_queue.empty()) return 0;
+    Task* task = _queue.back();
+    _queue.pop_back();
+    return task;
+}
+
+int ThreadPool::Worker::run() throw(Exception)
+{
+#ifdef CPU_SET
+    if (_pool->getCPUAffinity()) {
+        long ncpu = ::sysconf(_SC_NPROCESSORS_ONLN);
+        if (ncpu < 1) ncpu = 1;
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(_index % ncpu,&cpus);
+        int status = ::pthread_setaffinity_np(::pthread_self(),sizeof(cpus),&cpus);
+        if (status)
+            WLOG(("%s: pthread_setaffinity_np: %s",getName().c_str(),
+                Exception::errnoToString(status).c_str()));
+    }
+#endif
+
+    while (!isInterrupted()) {
+        Task* task = _pool->take(_index);
+        if (task) {
+            Exception* e = 0;
+            try {
+                task->execute();
+            }
+            catch (const Exception& ex) {
+                e = ex.clone();
+            }
+            task->finish(e);
+            continue;
+        }
+
+        Synchronized sync(_pool->_cond);
+        while (_pool->_nqueued == 0 && !_pool->_stopping && !isInterrupted())
+            _pool->_cond.wait();
+        // After a join(), run the queued Tasks before exiting.
+        if (isInterrupted() || (_pool->_stopping && _pool->_nqueued == 0))
+            break;
+    }
+    return RUN_OK;
+}
@@ -0,0 +1,312 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+#ifndef NIDAS_UTIL_THREADPOOL_H
+#define NIDAS_UTIL_THREADPOOL_H
+
+#include "Thread.h"
+#include "ThreadSupport.h"
+
+#include <deque>
+#include <vector>
+#include <string>
+
+namespace nidas { namespace util {
+
+class ThreadPool;
+
+/**
+ * A unit of work which is run by a ThreadPool. A Task is also the
+ * future of its result: after ThreadPool::submit(), wait() returns
+ * when execute() has finished, rethrowing any Exception it threw.
+ * The Task is owned by the caller, which must not delete it
+ * until it is done.
+ */
+class Task
+{
+public:
+
+    Task();
+
+    virtual ~Task();
+
+    /**
+     * The work of this Task, run in a thread of the pool.
+     */
+    virtual void execute() throw(Exception) = 0;
+
+    /**
+     * Wait until execute() has finished. If it threw an Exception,
+     * or the pool was interrupted before running this Task,
+     * throw an Exception with the same message and errno.
+     */
+    void wait() throw(Exception);
+
+    /**
+     * Has execute() finished?
+     */
+    bool isDone() const;
+
+private:
+
+    friend class ThreadPool;
+
+    /**
+     * Called by the pool when the Task is submitted.
+     */
+    void reset() throw();
+
+    /**
+     * Called by the pool when the Task is finished. Takes
+     * ownership of the Exception.
+     */
+    void finish(Exception* e) throw();
+
+    mutable Cond _cond;
+
+    bool _done;
+
+    Exception* _exception;
+
+    /** No copying */
+    Task(const Task&);
+
+    /** No assignment */
+    Task& operator=(const Task&);
+};
+
+/**
+ * A Task computing a value, which is returned by get().
+ */
+template<typename R>
+class Callable: public Task
+{
+public:
+
+    Callable(): Task(),_result() {}
+
+    /**
+     * Compute the result, run in a thread of the pool.
+     */
+    virtual R call() throw(Exception) = 0;
+
+    void execute() throw(Exception)
+    {
+        _result = call();
+    }
+
+    /**
+     * Wait for the result, and return it.
+     */
+    const R& get() throw(Exception)
+    {
+        wait();
+        return _result;
+    }
+
+private:
+    R _result;
+};
+
+/**
+ * A fixed number of threads which execute submitted Tasks.
+ *
+ * Each thread has its own queue of Tasks. A Task is added to the
+ * queue given by its affinity hint, or else to the queues in turn.
+ * A thread runs the Tasks from its own queue in the order they
+ * were submitted, and when that is empty, takes the most recently
+ * submitted Task from the back of another thread's queue.
+ * Tasks with the same hint therefore tend to run on the same
+ * thread, and the queues are only contended when a thread is idle.
+ *
+ * The scheduling policy, and affinity to a set of CPUs, are set
+ * before the threads are started.
+ */
+class ThreadPool
+{
+public:
+
+    /**
+     * Constructor. The threads are not started until start().
+     * @param name Name of the pool, the threads are named
+     *      name + "_" + index.
+     * @param nthreads Number of threads, if 0, the number of
+     *      online processors.
+     */
+    ThreadPool(const std::string& name, unsigned int nthreads = 0);
+
+    /**
+     * Interrupt and join the threads if they are running.
+     */
+    ~ThreadPool();
+
+    const std::string& getName() const
+    {
+        return _name;
+    }
+
+    unsigned int getNumThreads() const
+    {
+        return _workers.size();
+    }
+
+    /**
+     * Run the threads with the real-time FIFO policy, as done by
+     * Thread::setRealTimeFIFOPriority(), for pools whose Tasks are
+     * part of the real-time data acquisition. Must be called before
+     * start().
+     */
+    void setRealTimeFIFOPriority(int val) throw(Exception);
+
+    void setThreadScheduler(enum Thread::SchedPolicy policy, int priority)
+        throw(Exception);
+
+    /**
+     * Bind thread i of the pool to CPU i modulo the number of online
+     * processors, for a pool of one thread per processor whose
+     * Tasks are partitioned by their affinity hints. Must be called
+     * before start().
+     */
+    void setCPUAffinity(bool val)
+    {
+        _cpuAffinity = val;
+    }
+
+    bool getCPUAffinity() const
+    {
+        return _cpuAffinity;
+    }
+
+    void start() throw(Exception);
+
+    /**
+     * Queue a Task to be executed.
+     * @param task The Task, which must not be submitted again
+     *      until it is done.
+     * @param hint Affinity hint. Tasks with the same non-negative
+     *      hint are queued to the same thread. If negative, the
+     *      Task is queued to the threads in turn.
+     */
+    void submit(Task* task, int hint = -1) throw();
+
+    /**
+     * Return after all Tasks have been executed, and then
+     * stop and join the threads.
+     */
+    void join() throw(Exception);
+
+    /**
+     * Stop the threads after their current Task. Tasks which
+     * are still queued are finished with an InterruptedException.
+     */
+    void interrupt() throw();
+
+    /**
+     * Total number of Tasks taken by a thread from another
+     * thread's queue.
+     */
+    unsigned long long getNumStolen() const;
+
+private:
+
+    class Worker: public Thread
+    {
+    public:
+        Worker(ThreadPool* pool, unsigned int index);
+
+        int run() throw(Exception);
+
+        /**
+         * Take the next Task from the front of this queue.
+         */
+        Task* pop() throw();
+
+        /**
+         * Take the last Task from the back of this queue.
+         */
+        Task* steal() throw();
+
+        void push(Task* task) throw();
+
+        ThreadPool* _pool;
+
+        unsigned int _index;
+
+        std::deque<Task*> _queue;
+
+        Mutex _queueMutex;
+
+        unsigned long long _nstolen;
+
+    private:
+        /** No copying */
+        Worker(const Worker&);
+
+        /** No assignment */
+        Worker& operator=(const Worker&);
+    };
+
+    /**
+     * Next Task for worker i, from its queue, or stolen
+     * from another. NULL if all queues are empty.
+     */
+    Task* take(unsigned int i) throw();
+
+    void stop(bool interrupt) throw(Exception);
+
+    std::string _name;
+
+    std::vector<Worker*> _workers;
+
+    /**
+     * Protects _next and _stopping, and is signaled
+     * when a Task is queued or the pool is stopping.
+     */
+    Cond _cond;
+
+    /**
+     * Number of Tasks in the queues, changed atomically.
+     */
+    unsigned int _nqueued;
+
+    unsigned int _next;
+
+    bool _stopping;
+
+    bool _cpuAffinity;
+
+    bool _started;
+
+    /** No copying */
+    ThreadPool(const ThreadPool&);
+
+    /** No assignment */
+    ThreadPool& operator=(const ThreadPool&);
+};
+
+}}	// namespace nidas namespace util
+
+#endif
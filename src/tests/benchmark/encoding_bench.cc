@@ -0,0 +1,192 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+/*
+ * Benchmark of the sample encodings of SampleOutputStream: the size of
+ * an archive of small raw samples, such as counters and NMEA messages,
+ * and the rates at which it is written and read back, with full
+ * SampleHeaders and with compact headers.
+ */
+
+#include <nidas/core/HeaderSource.h>
+#include <nidas/core/SampleInputHeader.h>
+#include <nidas/core/UnixIOChannel.h>
+#include <nidas/core/SampleClient.h>
+#include <nidas/dynld/SampleOutputStream.h>
+#include <nidas/dynld/SampleInputStream.h>
+#include <nidas/util/UTime.h>
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+using namespace nidas::core;
+using nidas::dynld::SampleOutputStream;
+using nidas::dynld::SampleInputStream;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+namespace {
+
+class Header: public HeaderSource
+{
+public:
+    void sendHeader(dsm_time_t, SampleOutput* output)
+        throw(n_u::IOException)
+    {
+        SampleInputHeader header;
+        header.setArchiveVersion("1");
+        header.setProjectName("bench");
+        header.write(output);
+    }
+};
+
+class Counter: public SampleClient
+{
+public:
+    Counter(): nsamples(0) {}
+
+    bool receive(const Sample*) throw()
+    {
+        nsamples++;
+        return true;
+    }
+
+    void flush() throw() {}
+
+    unsigned long nsamples;
+};
+
+/**
+ * Write nsamp samples from 20 sensors on 4 DSMs: 4 byte counters at
+ * 20 Hz, 20 byte NMEA fragments at 10 Hz and 80 byte messages at 1 Hz,
+ * returning the elapsed seconds.
+ */
+double writeSamples(const string& path, const string& encoding,
+    unsigned int nsamp)
+{
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        cerr << path << ": " << n_u::Exception::errnoToString(errno) << endl;
+        exit(1);
+    }
+    Header header;
+    SampleOutputStream out(new UnixIOChannel(path, fd));
+    out.setSampleEncoding(encoding);
+    out.setHeaderSource(&header);
+
+    const char nmea[] = "$GPGGA,123519,4807.0";
+    const char msg[] =
+        "0.123 4.567 8.901 2.345 6.789 0.123 4.567 8.901 2.345 6.789 0.12\r\n";
+
+    long long t0 = n_u::getSystemTime();
+    dsm_time_t tt = 1300000000LL * USECS_PER_SEC;
+    unsigned int n = 0;
+    for (unsigned int isec = 0; n < nsamp; isec++) {
+        for (unsigned int i = 0; i < 20 && n < nsamp; i++) {
+            for (unsigned int j = 0; j < 20 && n < nsamp; j++) {
+                unsigned int len = 4;
+                const char* data = "\001\002\003\004";
+                if (j >= 10 && i % 2) continue;
+                if (j >= 12) {
+                    len = sizeof(nmea) - 1;
+                    data = nmea;
+                }
+                if (j == 19) {
+                    if (i) continue;
+                    len = sizeof(msg) - 1;
+                    data = msg;
+                }
+                SampleT<char>* samp = getSample<char>(len);
+                samp->setTimeTag(tt + isec * USECS_PER_SEC +
+                    i * USECS_PER_SEC / 20 + j * 137);
+                samp->setId(SET_DSM_ID(j / 5 + 1, j + 10));
+                ::memcpy(samp->getDataPtr(), data, len);
+                out.receive(samp);
+                samp->freeReference();
+                n++;
+            }
+        }
+    }
+    out.flush();
+    out.close();
+    return (n_u::getSystemTime() - t0) / (double)USECS_PER_SEC;
+}
+
+double readSamples(const string& path, unsigned long& nread)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    SampleInputStream input(new UnixIOChannel(path, fd));
+    Counter counter;
+    input.addSampleClient(&counter);
+
+    long long t0 = n_u::getSystemTime();
+    while (input.readSamples());
+    double secs = (n_u::getSystemTime() - t0) / (double)USECS_PER_SEC;
+
+    input.removeSampleClient(&counter);
+    input.close();
+    nread = counter.nsamples;
+    return secs;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int nsamp = argc > 1 ? atoi(argv[1]) : 2000000;
+    string path = argc > 2 ? argv[2] : "/tmp/encoding_bench.dat";
+
+    cout << "encoding  bytes/sample  write_samples/sec"
+        "  read_samples/sec  read_MB/sec" << endl;
+
+    const char* encodings[] = { "full", "compact" };
+    for (unsigned int i = 0; i < 2; i++) {
+        double tw = writeSamples(path, encodings[i], nsamp);
+        struct stat statbuf;
+        ::stat(path.c_str(), &statbuf);
+        unsigned long nread;
+        double tr = readSamples(path, nread);
+        if (nread != nsamp) {
+            cerr << encodings[i] << ": read " << nread <<
+                " samples of " << nsamp << endl;
+            return 1;
+        }
+        cout << setw(8) << encodings[i] << ' ' <<
+            setw(13) << fixed << setprecision(2) <<
+                (double)statbuf.st_size / nsamp << ' ' <<
+            setw(18) << setprecision(0) << nsamp / tw << ' ' <<
+            setw(17) << nsamp / tr << ' ' <<
+            setw(12) << setprecision(1) << statbuf.st_size / tr / 1.e6 << endl;
+    }
+    ::unlink(path.c_str());
+    return 0;
+}
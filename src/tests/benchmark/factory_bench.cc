@@ -0,0 +1,110 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+/*
+ * Benchmark of DOMObjectFactory::createObject(), comparing the time to
+ * create objects by class name through the table of registered creator
+ * functions with the time of the dlsym() search that createObject()
+ * did for every object before the table existed.  The numbers are
+ * the cost per object at startup of a configuration.
+ */
+
+#include <nidas/core/DOMable.h>
+#include <nidas/core/DynamicLoader.h>
+#include <nidas/util/UTime.h>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+
+using namespace nidas::core;
+namespace n_u = nidas::util;
+using namespace std;
+
+namespace {
+
+const char* classNames[] = {
+    "DSMSerialSensor", "GPS_NMEA_Serial", "ParoSci_202BG_P",
+    "UDPSocketSensor", "WxtSensor", "SampleArchiver", "FileSet",
+    "isff.ATIK_Sonic", "isff.CSAT3_Sonic", "isff.CSI_IRGA_Sonic",
+    "isff.CS_Krypton", "isff.CU_Coldwire"
+};
+
+const unsigned int NCLASSES = sizeof(classNames) / sizeof(classNames[0]);
+
+string entryName(const string& classname)
+{
+    string name = "create_nidas_dynld_" + classname;
+    for (string::size_type i = 0; i < name.length(); i++)
+        if (name[i] == '.') name[i] = '_';
+    return name;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int nloop = argc > 1 ? atoi(argv[1]) : 1000;
+
+    try {
+        DynamicLoader* loader = DynamicLoader::getInstance();
+
+        // The name is converted in each loop, as createObject() does.
+
+        long long t0 = n_u::getSystemTime();
+        for (unsigned int n = 0; n < nloop; n++) {
+            for (unsigned int i = 0; i < NCLASSES; i++) {
+                DOMObjectFactory::dom_object_ctor_t* ctor =
+                    (DOMObjectFactory::dom_object_ctor_t*)
+                        loader->lookup(entryName(classNames[i]));
+                delete ctor();
+            }
+        }
+        double tdlsym = (n_u::getSystemTime() - t0) /
+            (double)(nloop * NCLASSES);
+
+        t0 = n_u::getSystemTime();
+        for (unsigned int n = 0; n < nloop; n++)
+            for (unsigned int i = 0; i < NCLASSES; i++)
+                delete DOMObjectFactory::createObject(classNames[i]);
+        double tregistry = (n_u::getSystemTime() - t0) /
+            (double)(nloop * NCLASSES);
+
+        cout << "registered creators: " <<
+            DOMObjectFactory::getNumRegistered() << endl;
+        cout << fixed << setprecision(3) <<
+            "usec/object, dlsym:    " << tdlsym << endl <<
+            "usec/object, registry: " << tregistry << endl <<
+            "speedup:               " << setprecision(1) <<
+            tdlsym / tregistry << endl;
+    }
+    catch (const n_u::Exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#!/bin/bash
+
+# Benchmark of the processing of recorded archives, such as those from
+# the 2D imaging probes, which are the most expensive sensors to process.
+#
+# Runs data_stats -p over the given archive files, which reads, processes
+# and counts every sample, and reports the number of processed samples,
+# the CPU time, and samples and raw megabytes per CPU second.
+# Options after the file names are passed to data_stats, for example
+# -x config.xml if the archive header does not name an available
+# configuration.
+
+usage() {
+    echo "Usage: ${0##*/} [-i] [-n count] archive ... [data_stats options]
+    -i: use nidas programs found in PATH, rather than the build directory
+    -n count: number of runs, the fastest is reported, default 3"
+    exit 1
+}
+
+installed=false
+nrun=3
+
+while [ $# -gt 0 ]; do
+    case $1 in
+    -i)
+        installed=true
+        ;;
+    -n)
+        shift; nrun=$1
+        ;;
+    -*)
+        usage
+        ;;
+    *)
+        break
+        ;;
+    esac
+    shift
+done
+
+[ $# -eq 0 ] && usage
+
+files=()
+while [ $# -gt 0 ] && [ "${1:0:1}" != - ]; do
+    files=(${files[*]} $1)
+    shift
+done
+
+if ! $installed; then
+    echo $PATH | fgrep -q build/apps || PATH=../../build/apps:$PATH
+
+    llp=../../build/util:../../build/core:../../build/dynld
+    echo $LD_LIBRARY_PATH | fgrep -q build || \
+        export LD_LIBRARY_PATH=$llp${LD_LIBRARY_PATH:+":$LD_LIBRARY_PATH"}
+fi
+
+echo "data_stats executable: `which data_stats`"
+
+nbytes=`cat ${files[*]} | wc -c`
+statsf=$(mktemp --tmpdir process_bench_XXXXXX)
+trap "{ rm -f $statsf; }" EXIT
+
+best=
+for (( n = 0; n < $nrun; n++ )); do
+    # user+system seconds of the child
+    cpu=$( { /usr/bin/time -f "%U %S" data_stats -p "$@" ${files[*]} > $statsf; } 2>&1 |
+        tail -n 1 | awk '{print $1 + $2}')
+    echo "run $n: cpu=$cpu sec"
+    if [ -z "$best" ] || awk -v a=$cpu -v b=$best 'BEGIN{exit !(a < b)}'; then
+        best=$cpu
+    fi
+done
+
+# sum the sample counts of the processed samples, column 4
+nsamp=`awk '$4 ~ /^[0-9]+$/ {n += $4} END{print n + 0}' $statsf`
+
+awk -v nsamp=$nsamp -v nbytes=$nbytes -v cpu=$best '
+BEGIN {
+    printf "samples=%d bytes=%d best cpu=%.2f sec\n", nsamp, nbytes, cpu
+    if (cpu > 0) {
+        printf "samples/cpu sec=%.1f\n", nsamp / cpu
+        printf "Mbytes/cpu sec=%.2f\n", nbytes / cpu / 1.e6
+        if (nsamp > 0) printf "cpu usec/sample=%.2f\n", cpu * 1.e6 / nsamp
+    }
+}'
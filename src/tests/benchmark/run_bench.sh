@@ -0,0 +1,338 @@
+#!/bin/bash
+
+# Throughput benchmark of a dsm process, sampling simulated serial sensors
+# on pseudo-terminals.
+#
+# Starts a number of sensor_sim processes of each type: CSAT3 sonics,
+# NMEA GPS receivers and a binary A2D-like stream, generates a configuration
+# for them, and runs dsm with an archive output, and optionally a UDP
+# output of processed samples. When the sensor_sims are done, reports
+# samples/sec, CPU usec per sample, the number of dropped samples,
+# and the latency percentiles of each stage of the sample pipeline,
+# from the dsm "latency:" log messages.
+#
+# This is not part of "scons test", since the results are numbers to
+# be compared between builds, not a pass/fail check. Run it with
+# "scons bench", or directly from this directory.
+
+usage() {
+    echo "Usage: ${0##*/} [-i] [-c ncsat] [-g ngps] [-a na2d] [-r rate] [-s secs] [-u]
+    -i: use nidas programs found in PATH, rather than the build directory
+    -c ncsat: number of CSAT3 sonics, 60 Hz, default 2
+    -g ngps: number of NMEA GPS receivers, default 2
+    -a na2d: number of binary A2D-like sensors, default 2
+    -r rate: rate of the GPS and A2D sensors in Hz, default 100.
+       The A2D sensors send 4 records at this rate.
+    -s secs: length of the run in seconds, default 30
+    -u: add a UDP output of processed samples, so that the samples
+       are also processed and sorted"
+    exit 1
+}
+
+installed=false
+ncsat=2
+ngps=2
+na2d=2
+rate=100
+secs=30
+udp=false
+
+while [ $# -gt 0 ]; do
+    case $1 in
+    -i)
+        installed=true
+        ;;
+    -c)
+        shift; ncsat=$1
+        ;;
+    -g)
+        shift; ngps=$1
+        ;;
+    -a)
+        shift; na2d=$1
+        ;;
+    -r)
+        shift; rate=$1
+        ;;
+    -s)
+        shift; secs=$1
+        ;;
+    -u)
+        udp=true
+        ;;
+    *)
+        usage
+        ;;
+    esac
+    shift
+done
+
+# scons may not set HOSTNAME
+export HOSTNAME=`hostname`
+
+if ! $installed; then
+
+    echo $PATH | fgrep -q build/apps || PATH=../../build/apps:$PATH
+
+    llp=../../build/util:../../build/core:../../build/dynld
+    echo $LD_LIBRARY_PATH | fgrep -q build || \
+        export LD_LIBRARY_PATH=$llp${LD_LIBRARY_PATH:+":$LD_LIBRARY_PATH"}
+
+    if ! which dsm | fgrep -q build/; then
+        echo "dsm program not found on build directory. PATH=$PATH"
+        exit 1
+    fi
+fi
+
+echo "dsm executable: `which dsm`"
+
+kill_dsm() {
+    nkill=0
+    if [ -n "$dsmpid" ] && kill -0 $dsmpid >& /dev/null; then
+        kill -TERM $dsmpid
+        while kill -0 $dsmpid >& /dev/null; do
+            if [ $nkill -gt 10 ]; then
+                echo "Doing kill -9 $dsmpid"
+                kill -9 $dsmpid
+            fi
+            nkill=$(($nkill + 1))
+            sleep 1
+        done
+    fi
+}
+
+kill_sims() {
+    for pid in ${simpids[*]}; do
+        if kill -0 $pid >& /dev/null; then
+            kill -9 $pid
+        fi
+    done
+}
+
+export TEST=$(mktemp -d --tmpdir bench_XXXXXX)
+echo "TEST=$TEST"
+
+trap "{ kill_sims; kill_dsm; rm -rf $TEST; }" EXIT
+
+# The binary A2D-like records are 32 bytes: a 0xa5 0x5a separator, a counter
+# and 14 two byte counts. The values are kept below 0x80 so that the separator
+# does not appear in the data. sensor_sim -B sends 128 byte chunks of the
+# file, 4 records, at the given rate.
+a2dchunks=$(( $rate * $secs ))
+a2drecs=$(( $a2dchunks * 4 ))
+a2dfile=$TEST/a2d.dat
+for (( i = 0; i < 4 * 128; i++ )); do
+    rec='\xa5\x5a'
+    rec+=$(printf '\\x%02x\\x%02x' $(( i / 128 )) $(( i % 128 )))
+    for (( j = 0; j < 14; j++ )); do
+        rec+=$(printf '\\x%02x\\x%02x' $(( (i + j) % 128 )) $(( j * 8 )))
+    done
+    printf "$rec"
+done > $TEST/a2d_block.dat
+for (( n = 0; n < a2drecs; n += 4 * 128 )); do
+    cat $TEST/a2d_block.dat
+done | head -c $(( $a2drecs * 32 )) > $a2dfile
+
+ncsatmsg=$(( 60 * $secs ))
+ngpsmsg=$(( $rate * $secs ))
+
+# Write the sensor and output elements of the configuration,
+# and start the sensor_sims on pseudo-terminals.
+# Once sensor_sim opens the pseudo-terminal it does a kill -STOP on itself.
+# The CONT signal is sent when dsm has opened all the devices.
+simpids=()
+devs=()
+expected=()
+sensors=$TEST/sensors.xml
+rm -f $sensors
+id=10
+
+for (( n = 0; n < $ncsat; n++ )); do
+    dev=$TEST/csat$n
+    sensor_sim -c -r 60 -n $ncsatmsg -t $dev > /dev/null 2>&1 &
+    simpids=(${simpids[*]} $!)
+    devs=(${devs[*]} $dev)
+    expected=(${expected[*]} $ncsatmsg)
+    cat >> $sensors << EOD
+            <serialSensor class="isff.CSAT3_Sonic"
+                baud="9600" parity="none" databits="8" stopbits="1"
+                devicename="$dev" id="$id" suffix=".c$n" timeout="5">
+                <sample id="1" rate="60">
+                    <variable name="u" units="m/s"/>
+                    <variable name="v" units="m/s"/>
+                    <variable name="w" units="m/s"/>
+                    <variable name="tc" units="degC"/>
+                    <variable name="diag" units=""/>
+                </sample>
+                <message separator="\x55\xaa" position="end" length="10"/>
+            </serialSensor>
+EOD
+    id=$(($id + 10))
+done
+
+for (( n = 0; n < $ngps; n++ )); do
+    dev=$TEST/gps$n
+    sensor_sim -F data/nmea.dat -e "\n" -r $rate -n $ngpsmsg -t $dev > /dev/null 2>&1 &
+    simpids=(${simpids[*]} $!)
+    devs=(${devs[*]} $dev)
+    expected=(${expected[*]} $ngpsmsg)
+    cat >> $sensors << EOD
+            <serialSensor class="GPS_NMEA_Serial"
+                baud="115200" parity="none" databits="8" stopbits="1"
+                devicename="$dev" id="$id" suffix=".g$n">
+                <sample id="1">
+                    <variable name="GPSsecsofday" units="sec"/>
+                    <variable name="Lat" units="degree_N"/>
+                    <variable name="Lon" units="degree_E"/>
+                    <variable name="GPSqual" units="none"/>
+                    <variable name="GPSnsat" units="count"/>
+                    <variable name="GPShordil" units="none"/>
+                    <variable name="Alt" units="m"/>
+                    <variable name="GPSgeoidht" units="m"/>
+                </sample>
+                <sample id="2">
+                    <variable name="GPSstat" units="none"/>
+                    <variable name="GPSsog" units="m/s"/>
+                    <variable name="GPSgmg" units="degree_T"/>
+                </sample>
+                <message separator="\n" position="end" length="0"/>
+            </serialSensor>
+EOD
+    id=$(($id + 10))
+done
+
+for (( n = 0; n < $na2d; n++ )); do
+    dev=$TEST/a2d$n
+    sensor_sim -B $a2dfile -r $rate -o 115200n81lnr -t $dev > /dev/null 2>&1 &
+    simpids=(${simpids[*]} $!)
+    devs=(${devs[*]} $dev)
+    expected=(${expected[*]} $a2drecs)
+    # No sample tags, the binary samples are archived but not processed.
+    cat >> $sensors << EOD
+            <serialSensor class="DSMSerialSensor"
+                baud="115200" parity="none" databits="8" stopbits="1"
+                devicename="$dev" id="$id" suffix=".a$n">
+                <message separator="\xa5\x5a" position="beg" length="30"/>
+            </serialSensor>
+EOD
+    id=$(($id + 10))
+done
+
+nsensors=${#simpids[*]}
+
+udpoutput=
+if $udp; then
+    udpoutput='
+            <processor class="SampleProcessor">
+                <output class="UDPSampleOutput">
+                    <socket type="dataUDP"/>
+                </output>
+            </processor>'
+fi
+
+# No statusAddr, so the latency histograms are not reset by the
+# status thread and dsm logs them for the whole run when it shuts down.
+config=$TEST/bench.xml
+cat > $config << EOD
+<?xml version="1.0" encoding="ISO-8859-1"?>
+<project
+    xmlns="http://www.eol.ucar.edu/nidas"
+    name="bench"
+    system="ISFF"
+    config="$config"
+    version="1">
+    <logscheme name='dsm'>
+        <showfields>level,time,message</showfields>
+        <logconfig level='info'/>
+    </logscheme>
+    <site name="bench" class="isff.GroundStation">
+	<dsm name="$HOSTNAME" id="1"
+            rawSorterLength="0.5" procSorterLength="1.0"
+            rawHeapMax="100M" procHeapMax="100M">
+$(cat $sensors)
+            <output class="RawSampleOutputStream">
+                <fileset dir="$TEST"
+                    file="bench_%Y%m%d_%H%M%S.dat"
+                    length="0">
+                </fileset>
+            </output>$udpoutput
+	</dsm>
+    </site>
+</project>
+EOD
+
+dsm -d -l 6 --logparam pipeline_latency=1 $config > $TEST/dsm.log 2>&1 &
+dsmpid=$!
+
+# look for "opening" messages in dsm output, then start the sensor_sims
+sleep=0
+sleepmax=30
+while [ $sleep -lt $sleepmax ]; do
+    ndone=0
+    for dev in ${devs[*]}; do
+        fgrep -q "opening: $dev" $TEST/dsm.log && ndone=$(($ndone + 1))
+    done
+    [ $ndone -eq $nsensors ] && break
+    sleep 1
+    sleep=$(($sleep + 1))
+done
+
+if [ $sleep -ge $sleepmax ]; then
+    echo "Cannot find \"opening\" messages in dsm output."
+    cat $TEST/dsm.log
+    exit 1
+fi
+
+clktck=`getconf CLK_TCK`
+cpu_ticks() {
+    awk '{print $14 + $15}' /proc/$dsmpid/stat
+}
+
+cpu0=`cpu_ticks`
+t0=`date +%s.%N`
+kill -CONT ${simpids[*]}
+
+# wait for the sensor_sims to finish
+for pid in ${simpids[*]}; do
+    while kill -0 $pid >& /dev/null; do
+        sleep 1
+    done
+done
+# let dsm read and write what is left in the ptys and sorters
+sleep 2
+
+t1=`date +%s.%N`
+cpu1=`cpu_ticks`
+
+kill_dsm
+dsmpid=
+
+ofiles=($TEST/bench_*.dat)
+statsf=$TEST/data_stats.out
+data_stats ${ofiles[*]} > $statsf
+
+nsamp=0
+ndrop=0
+for (( i = 0; i < $nsensors; i++ )); do
+    dev=${devs[$i]}
+    n=`awk -v name=$HOSTNAME:$dev '$1 == name {n += $4} END{print n + 0}' $statsf`
+    d=$(( ${expected[$i]} - $n ))
+    [ $d -lt 0 ] && d=0
+    printf "%-30s expected=%d archived=%d dropped=%d\n" ${dev##*/} ${expected[$i]} $n $d
+    nsamp=$(( $nsamp + $n ))
+    ndrop=$(( $ndrop + $d ))
+done
+
+awk -v nsamp=$nsamp -v ndrop=$ndrop -v t0=$t0 -v t1=$t1 \
+    -v cpu=$(( $cpu1 - $cpu0 )) -v clktck=$clktck '
+BEGIN {
+    dt = t1 - t0
+    cpusec = cpu / clktck
+    printf "samples=%d dropped=%d elapsed=%.1f sec\n", nsamp, ndrop, dt
+    if (dt > 0) printf "samples/sec=%.1f\n", nsamp / dt
+    printf "dsm cpu=%.2f sec (%.1f%%)\n", cpusec, (dt > 0 ? cpusec / dt * 100 : 0)
+    if (nsamp > 0) printf "cpu usec/sample=%.2f\n", cpusec * 1.e6 / nsamp
+}'
+
+echo "latency percentiles, usec:"
+sed -n 's/.*latency: //p' $TEST/dsm.log
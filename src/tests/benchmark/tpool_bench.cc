@@ -0,0 +1,129 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+/*
+ * Benchmark of nidas::util::ThreadPool: the overhead per Task of
+ * submitting and waiting for small Tasks, and the speedup of
+ * CPU-bound Tasks with the number of threads, with the Tasks spread
+ * over the threads or all queued to one thread and stolen by the others.
+ */
+
+#include <nidas/util/ThreadPool.h>
+#include <nidas/util/UTime.h>
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <algorithm>
+#include <unistd.h>
+
+namespace n_u = nidas::util;
+using namespace std;
+
+namespace {
+
+class Spin: public n_u::Task
+{
+public:
+    Spin(): loops(0),result(0) {}
+
+    void execute() throw(n_u::Exception)
+    {
+        unsigned long long x = result + 1;
+        for (unsigned int i = 0; i < loops; i++)
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        result = x;
+    }
+
+    unsigned int loops;
+
+    unsigned long long result;
+};
+
+/**
+ * Run ntasks Tasks of loops iterations in batches on the pool,
+ * returning the elapsed seconds.
+ */
+double runTasks(n_u::ThreadPool& pool, Spin* tasks, unsigned int ntasks,
+    unsigned int nbatch, unsigned int loops, bool hinted)
+{
+    long long t0 = n_u::getSystemTime();
+    for (unsigned int b = 0; b < ntasks; b += nbatch) {
+        unsigned int n = std::min(nbatch, ntasks - b);
+        for (unsigned int i = 0; i < n; i++) {
+            tasks[i].loops = loops;
+            pool.submit(&tasks[i], hinted ? 0 : -1);
+        }
+        for (unsigned int i = 0; i < n; i++) tasks[i].wait();
+    }
+    return (n_u::getSystemTime() - t0) / (double)USECS_PER_SEC;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    long ncpu = ::sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 1) ncpu = 1;
+    unsigned int maxThreads = argc > 1 ? atoi(argv[1]) : ncpu;
+
+    const unsigned int NBATCH = 256;
+    Spin tasks[NBATCH];
+
+    cout << "threads  small_tasks/sec  usec/small_task"
+        "  spread_secs  speedup  hinted_secs  stolen" << endl;
+
+    double t1 = 0.0;
+    for (unsigned int nt = 1; ; nt = std::min(nt * 2, maxThreads)) {
+        n_u::ThreadPool pool("bench", nt);
+        pool.setCPUAffinity(true);
+        pool.start();
+
+        // overhead of empty tasks
+        const unsigned int NSMALL = 200000;
+        double ts = runTasks(pool, tasks, NSMALL, NBATCH, 0, false);
+
+        // CPU-bound tasks of about 1 msec
+        const unsigned int NBIG = 2048;
+        const unsigned int LOOPS = 1000000;
+        double tb = runTasks(pool, tasks, NBIG, NBATCH, LOOPS, false);
+        if (nt == 1) t1 = tb;
+
+        // all queued to the first thread
+        double th = runTasks(pool, tasks, NBIG, NBATCH, LOOPS, true);
+        pool.join();
+
+        cout << setw(7) << nt << ' ' <<
+            setw(16) << fixed << setprecision(0) << NSMALL / ts << ' ' <<
+            setw(16) << setprecision(3) << ts * USECS_PER_SEC / NSMALL << ' ' <<
+            setw(12) << tb << ' ' <<
+            setw(8) << setprecision(2) << t1 / tb << ' ' <<
+            setw(12) << setprecision(3) << th << ' ' <<
+            setw(7) << pool.getNumStolen() << endl;
+        if (nt >= maxThreads) break;
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+// -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*-
+// vim: set shiftwidth=4 softtabstop=4 expandtab:
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+
+
+/*
+ * Per-sample cost of the steps of Wind3D processing of u,v,w,tc:
+ * AdaptiveDespiker on each component, and WindTilter plus WindRotator,
+ * one sample at a time as Wind3D::process does them, compared with
+ * the same tilt and rotation arithmetic done over a block of samples,
+ * in arrays of u, v and w, which the compiler can vectorize.
+ */
+
+#include <nidas/dynld/isff/Wind3D.h>
+#include <nidas/core/AdaptiveDespiker.h>
+#include <nidas/util/UTime.h>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+using namespace nidas::core;
+using nidas::dynld::isff::WindTilter;
+using nidas::dynld::isff::WindRotator;
+namespace n_u = nidas::util;
+using namespace std;
+
+namespace {
+
+void tiltBlock(const double mat[3][3], float* u, float* v, float* w, int n)
+{
+    for (int k = 0; k < n; k++) {
+        float vin[3] = { u[k], v[k], w[k] };
+        double out[3];
+        for (int i = 0; i < 3; i++) {
+            out[i] = 0.0;
+            for (int j = 0; j < 3; j++) out[i] += mat[i][j] * vin[j];
+        }
+        u[k] = (float) out[0];
+        v[k] = (float) out[1];
+        w[k] = (float) out[2];
+    }
+}
+
+void rotateBlock(double cosa, double sina, float* u, float* v, int n)
+{
+    for (int k = 0; k < n; k++) {
+        float ur = (float)( u[k] * cosa + v[k] * sina);
+        float vr = (float)(-u[k] * sina + v[k] * cosa);
+        u[k] = ur;
+        v[k] = vr;
+    }
+}
+
+double usecs(long long t0, unsigned int n)
+{
+    return (n_u::getSystemTime() - t0) * 1000.0 / n;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int nsamp = argc > 1 ? atoi(argv[1]) : 1000000;
+    int blocklen = argc > 2 ? atoi(argv[2]) : 64;
+    nsamp -= nsamp % blocklen;
+
+    vector<float> data(nsamp * 4);
+    srand48(1);
+    for (unsigned int i = 0; i < data.size(); i++)
+        data[i] = 3.0 * drand48() - 1.5 + (i % 4 == 3 ? 20.0 : 0.0);
+
+    WindTilter tilter;
+    tilter.setLeanDegrees(3.1);
+    tilter.setLeanAzimuthDegrees(47.0);
+    WindRotator rotator;
+    rotator.setAngleDegrees(121.0);
+
+    AdaptiveDespiker despiker[4];
+    vector<float> uvwt(data);
+    long long t0 = n_u::getSystemTime();
+    for (unsigned int i = 0; i < nsamp; i++) {
+        float* dp = &uvwt[i * 4];
+        bool spike;
+        for (int j = 0; j < 4; j++) dp[j] = despiker[j].despike(dp[j], &spike);
+    }
+    double tdespike = usecs(t0, nsamp);
+
+    uvwt = data;
+    t0 = n_u::getSystemTime();
+    for (unsigned int i = 0; i < nsamp; i++) {
+        float* dp = &uvwt[i * 4];
+        tilter.rotate(dp, dp + 1, dp + 2);
+        rotator.rotate(dp, dp + 1);
+    }
+    double tsample = usecs(t0, nsamp);
+
+    // The tilt matrix, from the rotation of the unit vectors. It is
+    // rounded to float, so the results differ slightly from tilter's,
+    // but the arithmetic is the same.
+    double mat[3][3];
+    for (int j = 0; j < 3; j++) {
+        float e[3] = { 0.0, 0.0, 0.0 };
+        e[j] = 1.0;
+        tilter.rotate(e, e + 1, e + 2);
+        for (int i = 0; i < 3; i++) mat[i][j] = e[i];
+    }
+    double angle = rotator.getAngleDegrees() * M_PI / 180.0;
+
+    vector<float> u(nsamp), v(nsamp), w(nsamp);
+    for (unsigned int i = 0; i < nsamp; i++) {
+        u[i] = data[i * 4];
+        v[i] = data[i * 4 + 1];
+        w[i] = data[i * 4 + 2];
+    }
+    t0 = n_u::getSystemTime();
+    for (unsigned int i = 0; i < nsamp; i += blocklen) {
+        tiltBlock(mat, &u[i], &v[i], &w[i], blocklen);
+        rotateBlock(::cos(angle), ::sin(angle), &u[i], &v[i], blocklen);
+    }
+    double tblock = usecs(t0, nsamp);
+
+    cout << fixed << setprecision(1) <<
+        "nsec/sample, despike u,v,w,tc:           " << tdespike << endl <<
+        "nsec/sample, tilt and rotate per sample: " << tsample << endl <<
+        "nsec/sample, tilt and rotate in blocks of " << blocklen << ": " <<
+        tblock << endl;
+    return 0;
+}
@@ -198,6 +198,24 @@ BOOST_AUTO_TEST_CASE(test_match_implicit_include)
 }
 
 
+BOOST_AUTO_TEST_CASE(test_match_dsm)
+{
+  SampleMatcher sm;
+
+  BOOST_CHECK_EQUAL(sm.matchDSM(1), true);
+  // A DSM with some samples excluded can still match.
+  BOOST_REQUIRE(sm.addCriteria("^1,1"));
+  BOOST_REQUIRE(sm.addCriteria("^2,*"));
+  BOOST_CHECK_EQUAL(sm.matchDSM(1), true);
+  BOOST_CHECK_EQUAL(sm.matchDSM(2), false);
+  BOOST_CHECK_EQUAL(sm.matchDSM(3), true);
+  BOOST_REQUIRE(sm.addCriteria("3-4,10"));
+  BOOST_CHECK_EQUAL(sm.matchDSM(1), false);
+  BOOST_CHECK_EQUAL(sm.matchDSM(4), true);
+  BOOST_CHECK_EQUAL(sm.matchDSM(5), false);
+}
+
+
 BOOST_AUTO_TEST_CASE(test_log_level_parse)
 {
   // These tests assume the logging scheme is at its initial state and with
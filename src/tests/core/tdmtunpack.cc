@@ -0,0 +1,144 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/dynld/raf/SppSerial.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace nidas::dynld::raf;
+using namespace std;
+
+namespace {
+
+// Fill a buffer with random bytes, with some runs of 0xff
+// so that the high bits of the counts are set.
+void
+fillRandom(unsigned char* buf, int n)
+{
+  for (int i = 0; i < n; i++)
+    buf[i] = (i / 16) % 5 == 0 ? 0xff : (unsigned char)(drand48() * 256);
+}
+
+// Copies of UnpackDMT_ULong() and UnpackDMT_UShort() as they were
+// before the array functions were added, as the reference.
+unsigned long
+originalUnpackDMT_ULong(DMT_ULong dmtval)
+{
+  unsigned long val = dmtval[1] << 24 | dmtval[0] << 16 |
+      dmtval[3] << 8 | dmtval[2]; // DMT byte order is 2301
+  return val;
+}
+
+unsigned short
+originalUnpackDMT_UShort(DMT_UShort dmtval)
+{
+  unsigned short val = (dmtval[1] << 8) | dmtval[0];
+  return val;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_unpack_dmt_ulongs)
+{
+  srand48(34034);
+  const int MAXN = SppSerial::MAX_CHANNELS;
+  DMT_ULong counts[MAXN];
+
+  for (int itry = 0; itry < 10000; itry++) {
+    fillRandom(counts[0], sizeof(counts));
+    int n = 1 + itry % MAXN;
+
+    // The original function shifted a signed int, so on a host with
+    // a 64 bit long, counts of 2^31 and more were sign extended.
+    // Those are now unpacked as the unsigned 32 bit count.
+    vector<float> ref(n);
+    unsigned long long refsum = 0;
+    for (int i = 0; i < n; i++) {
+      unsigned long val = originalUnpackDMT_ULong(counts[i]) & 0xffffffffUL;
+      ref[i] = val;
+      refsum += val;
+      BOOST_CHECK_EQUAL(UnpackDMT_ULong(counts[i]), val);
+    }
+
+    vector<float> out(n);
+    unsigned long long sum = UnpackDMT_ULongs(counts, n, &out[0]);
+    BOOST_CHECK_EQUAL(sum, refsum);
+    BOOST_CHECK(::memcmp(&out[0], &ref[0], n * sizeof(float)) == 0);
+  }
+
+  // DMT byte order is 2301
+  DMT_ULong val = { 0x02, 0x01, 0x04, 0x03 };
+  float f;
+  BOOST_CHECK_EQUAL(UnpackDMT_ULongs(&val, 1, &f), 0x01020304ULL);
+  BOOST_CHECK_EQUAL(f, 16909060.0f);
+  BOOST_CHECK_EQUAL(UnpackDMT_ULong(val), 0x01020304UL);
+
+  // A count with the high bit set.
+  DMT_ULong hval = { 0xdc, 0xfe, 0x98, 0xba };
+  BOOST_CHECK_EQUAL(UnpackDMT_ULongs(&hval, 1, &f), 0xfedcba98ULL);
+  BOOST_CHECK_EQUAL(f, 4275878552.0f);
+  BOOST_CHECK_EQUAL(UnpackDMT_ULong(hval), 0xfedcba98UL);
+  PackDMT_ULong(val, 0xfedcba98);
+  BOOST_CHECK(::memcmp(val, hval, sizeof(val)) == 0);
+  // which the original function sign extended to a 64 bit long
+  if (sizeof(long) > 4)
+    BOOST_CHECK(originalUnpackDMT_ULong(hval) != 0xfedcba98UL);
+
+  // A histogram of known counts and their sum.
+  DMT_ULong hist[3] = {
+    { 0x00, 0x00, 0x01, 0x00 },     // 1
+    { 0x01, 0x00, 0x00, 0x00 },     // 65536
+    { 0x00, 0x80, 0x00, 0x00 }      // 2^31
+  };
+  float fhist[3];
+  BOOST_CHECK_EQUAL(UnpackDMT_ULongs(hist, 3, fhist),
+                    1ULL + 65536ULL + 2147483648ULL);
+  BOOST_CHECK_EQUAL(fhist[0], 1.0f);
+  BOOST_CHECK_EQUAL(fhist[1], 65536.0f);
+  BOOST_CHECK_EQUAL(fhist[2], 2147483648.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_unpack_dmt_ushorts)
+{
+  srand48(34035);
+  const int MAXN = 100;
+  DMT_UShort counts[MAXN];
+
+  for (int itry = 0; itry < 10000; itry++) {
+    fillRandom(counts[0], sizeof(counts));
+    int n = 1 + itry % MAXN;
+
+    vector<float> ref(n);
+    vector<float> rref(n);
+    unsigned long refsum = 0;
+    for (int i = 0; i < n; i++) {
+      ref[i] = originalUnpackDMT_UShort(counts[i]);
+      rref[n - 1 - i] = ref[i];
+      refsum += originalUnpackDMT_UShort(counts[i]);
+    }
+
+    vector<float> out(n);
+    unsigned long sum = UnpackDMT_UShorts(counts, n, &out[0]);
+    BOOST_CHECK_EQUAL(sum, refsum);
+    BOOST_CHECK(::memcmp(&out[0], &ref[0], n * sizeof(float)) == 0);
+
+    sum = UnpackDMT_UShortsReversed(counts, n, &out[0]);
+    BOOST_CHECK_EQUAL(sum, refsum);
+    BOOST_CHECK(::memcmp(&out[0], &rref[0], n * sizeof(float)) == 0);
+  }
+
+  // little endian
+  DMT_UShort hist[3] = { { 0x01, 0x00 }, { 0x00, 0x01 }, { 0xff, 0xff } };
+  float fhist[3];
+  BOOST_CHECK_EQUAL(UnpackDMT_UShorts(hist, 3, fhist), 1UL + 256UL + 65535UL);
+  BOOST_CHECK_EQUAL(fhist[0], 1.0f);
+  BOOST_CHECK_EQUAL(fhist[1], 256.0f);
+  BOOST_CHECK_EQUAL(fhist[2], 65535.0f);
+  UnpackDMT_UShortsReversed(hist, 3, fhist);
+  BOOST_CHECK_EQUAL(fhist[0], 65535.0f);
+  BOOST_CHECK_EQUAL(fhist[2], 1.0f);
+}
@@ -0,0 +1,131 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/core/FIRDecimator.h>
+
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+using nidas::core::FIRDecimator;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE(test_fir_decimator)
+{
+  const int nchan = 5;
+  const int decimation = 4;
+  vector<float> coefs;
+  for (int i = 0; i < 11; i++) coefs.push_back(1.0 + min(i, 10 - i));  // symmetric
+
+  FIRDecimator fir(nchan, coefs, decimation);
+
+  srand48(35035);
+  vector<vector<float> > inputs;
+  int nout = 0;
+  for (int n = 0; n < 200; n++) {
+    vector<float> scan(nchan);
+    for (int c = 0; c < nchan; c++) scan[c] = drand48() * 10.0 - 5.0;
+    inputs.push_back(scan);
+
+    bool due = fir.add(&scan[0]);
+    // first output when the window is full, then every decimation scans
+    int nin = n + 1;
+    bool expected = nin >= (int)coefs.size() &&
+        (nin - (int)coefs.size()) % decimation == 0;
+    BOOST_CHECK_EQUAL(due, expected);
+    if (!due) continue;
+
+    vector<float> out(nchan);
+    fir.output(&out[0]);
+    nout++;
+    for (int c = 0; c < nchan; c++) {
+      double sum = 0.0;
+      for (unsigned int k = 0; k < coefs.size(); k++)
+        sum += coefs[k] * inputs[n - k][c];
+      BOOST_CHECK_CLOSE(out[c], sum, 1.e-3);
+    }
+  }
+  BOOST_CHECK_EQUAL(nout, (200 - 11) / decimation + 1);
+  BOOST_CHECK_CLOSE(fir.getDelay(), 5.0, 1.e-6);
+}
+
+BOOST_AUTO_TEST_CASE(test_fir_decimator_nan)
+{
+  vector<float> coefs(3, 1.0 / 3);
+  FIRDecimator fir(2, coefs, 1);
+  float out[2];
+  float scan[2] = { 1.0, 2.0 };
+  fir.add(scan);
+  fir.add(scan);
+  scan[1] = nanf("");
+  BOOST_CHECK(fir.add(scan));
+  fir.output(out);
+  BOOST_CHECK_CLOSE(out[0], 1.0, 1.e-4);
+  BOOST_CHECK(isnan(out[1]));
+  scan[1] = 2.0;
+  fir.add(scan);
+  fir.add(scan);
+  BOOST_CHECK(fir.add(scan));
+  fir.output(out);
+  BOOST_CHECK_CLOSE(out[1], 2.0, 1.e-4);
+}
+
+BOOST_AUTO_TEST_CASE(test_fir_decimator_reset)
+{
+  // After a reset, as after a gap in the scans, no old values
+  // are mixed into the outputs.
+  vector<float> coefs(4, 0.25);
+  FIRDecimator fir(1, coefs, 2);
+  float out;
+  float scan = 1.0;
+  for (int i = 0; i < 5; i++) fir.add(&scan);
+
+  fir.reset();
+  scan = 3.0;
+  for (int i = 0; i < 3; i++) BOOST_CHECK(!fir.add(&scan));
+  BOOST_CHECK(fir.add(&scan));
+  fir.output(&out);
+  BOOST_CHECK_CLOSE(out, 3.0, 1.e-4);
+  BOOST_CHECK(!fir.add(&scan));
+  BOOST_CHECK(fir.add(&scan));
+}
+
+BOOST_AUTO_TEST_CASE(test_cic_coefficients)
+{
+  // order 1 is a boxcar
+  vector<float> coefs = FIRDecimator::cicCoefficients(4, 1);
+  BOOST_CHECK_EQUAL(coefs.size(), 4u);
+  for (unsigned int i = 0; i < coefs.size(); i++)
+    BOOST_CHECK_CLOSE(coefs[i], 0.25, 1.e-5);
+
+  // order 2 is a triangle
+  coefs = FIRDecimator::cicCoefficients(3, 2);
+  float tri[] = { 1, 2, 3, 2, 1 };
+  BOOST_CHECK_EQUAL(coefs.size(), 5u);
+  for (unsigned int i = 0; i < coefs.size(); i++)
+    BOOST_CHECK_CLOSE(coefs[i], tri[i] / 9.0, 1.e-5);
+
+  coefs = FIRDecimator::cicCoefficients(10, 3);
+  BOOST_CHECK_EQUAL(coefs.size(), 28u);
+  double sum = 0.0;
+  for (unsigned int i = 0; i < coefs.size(); i++) sum += coefs[i];
+  BOOST_CHECK_CLOSE(sum, 1.0, 1.e-4);
+
+  // a constant input gives a constant output
+  FIRDecimator cic(1, coefs, 10);
+  float val = 2.5;
+  int nout = 0;
+  for (int i = 0; i < 100; i++) {
+    if (cic.add(&val)) {
+      float out;
+      cic.output(&out);
+      BOOST_CHECK_CLOSE(out, 2.5, 1.e-4);
+      nout++;
+    }
+  }
+  BOOST_CHECK_EQUAL(nout, 8);
+  BOOST_CHECK_CLOSE(cic.getDelay(), 13.5, 1.e-4);
+}
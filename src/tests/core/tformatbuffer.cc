@@ -0,0 +1,141 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/util/FormatBuffer.h>
+#include <nidas/util/UTime.h>
+
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+using nidas::util::FormatBuffer;
+using nidas::util::UTime;
+using namespace std;
+
+namespace {
+
+string
+general(double val, int precision, int width)
+{
+  FormatBuffer buf;
+  buf.appendGeneral(val, precision, width);
+  return string(buf.data(), buf.size());
+}
+
+string
+ostreamGeneral(double val, int precision, int width)
+{
+  ostringstream ost;
+  ost << setprecision(precision) << setw(width) << val;
+  return ost.str();
+}
+
+// Number of significant digits of a %g formatted value.
+int
+significantDigits(const string& str)
+{
+  string::size_type e = str.find('e');
+  string mant = str.substr(0, e);
+  string digits;
+  for (unsigned int i = 0; i < mant.length(); ++i)
+    if (isdigit(mant[i])) digits += mant[i];
+  digits.erase(0, digits.find_first_not_of('0'));
+  digits.erase(digits.find_last_not_of('0') + 1);
+  return digits.length();
+}
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_format_general)
+{
+  const double vals[] = { 0.0, -0.0, 1.0, -1.0, 0.5, 0.125, 2.5, 100.0,
+                          99999.95, 123456789.0, 1.e-5, 9.9999e-5, 0.0001,
+                          1.e15, 1.e22, 1.e-300, 3.14159265358979, -273.15,
+                          0.1, 0.3, 1.e100, 65535.0 };
+  for (unsigned int i = 0; i < sizeof(vals)/sizeof(vals[0]); ++i)
+    for (int p = 0; p <= 17; ++p)
+      BOOST_CHECK_EQUAL(general(vals[i], p, 10),
+                        ostreamGeneral(vals[i], p, 10));
+
+  srand48(12345);
+  for (int i = 0; i < 200000; ++i) {
+    double v = (drand48() - 0.5) * pow(10.0, (int)(drand48() * 40) - 20);
+    // values which are exactly or nearly on a rounding boundary
+    if (i % 4 == 0) v = floor(v * 1000.0 + 0.5) / 1000.0 + 0.0005;
+    int p = 1 + i % 12;
+    BOOST_CHECK_EQUAL(general(v, p, 10), ostreamGeneral(v, p, 10));
+    float f = v;
+    BOOST_CHECK_EQUAL(general(f, 5, 10), ostreamGeneral(f, 5, 10));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_format_shortest)
+{
+  srand48(54321);
+  for (int i = 0; i < 200000; ++i) {
+    union { unsigned int u; float f; } x;
+    x.u = (unsigned int)(drand48() * 4294967296.0);
+    if (i % 2) x.f = (drand48() - 0.5) * pow(10.0, (int)(drand48() * 20) - 10);
+    if (!isfinite(x.f)) continue;
+
+    FormatBuffer buf;
+    buf.appendShortest(x.f);
+    string str(buf.data(), buf.size());
+    BOOST_CHECK_EQUAL(strtof(str.c_str(), 0), x.f);
+
+    int pmin = 6;
+    for ( ; pmin < 9; ++pmin) {
+      char tmp[32];
+      snprintf(tmp, sizeof(tmp), "%.*g", pmin, x.f);
+      if (strtof(tmp, 0) == x.f) break;
+    }
+    char ref[32];
+    snprintf(ref, sizeof(ref), "%.*g", pmin, x.f);
+    BOOST_CHECK_EQUAL(str, string(ref));
+    BOOST_CHECK(significantDigits(str) <= pmin);
+  }
+
+  FormatBuffer buf;
+  buf.appendShortest(0.1f, 8);
+  buf.appendShortest(0.1);
+  buf.appendShortest(100.0f);
+  BOOST_CHECK_EQUAL(string(buf.data(), buf.size()), "     0.10.1100");
+}
+
+BOOST_AUTO_TEST_CASE(test_format_ints)
+{
+  FormatBuffer buf;
+  buf.appendInt(-42, 6);
+  buf.append(' ');
+  buf.appendInt(1234567, 3);
+  buf.append(' ');
+  buf.appendHex(0xa, 2);
+  buf.appendHex(0x1f3, 2);
+  BOOST_CHECK_EQUAL(string(buf.data(), buf.size()), "   -42 1234567 0a1f3");
+}
+
+BOOST_AUTO_TEST_CASE(test_format_time)
+{
+  const char* fmts[] = { "%Y %m %d %H:%M:%S.%4f", "%H:%M:%S.%f ",
+                         "%Y %m %d %H:%M:%S.%6f", "%Y %j %H:%M:%S" };
+  long long t0 = UTime(true, 2024, 12, 31, 23, 59, 58.0).toUsecs();
+
+  for (unsigned int i = 0; i < sizeof(fmts)/sizeof(fmts[0]); ++i) {
+    FormatBuffer buf;
+    buf.setTimeFormat(fmts[i]);
+    for (long long t = t0; t < t0 + 3000000; t += 12345) {
+      // UTime::format() rounds up to one full second when the
+      // rounding carries, skip those.
+      if ((t + 50) % 1000000 < 100) continue;
+      buf.clear();
+      buf.appendTime(t);
+      BOOST_CHECK_EQUAL(string(buf.data(), buf.size()),
+                        UTime(t).format(true, fmts[i]));
+    }
+  }
+}
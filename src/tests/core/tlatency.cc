@@ -0,0 +1,65 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/core/LatencyHistogram.h>
+
+#include <sstream>
+
+using namespace nidas::core;
+
+
+BOOST_AUTO_TEST_CASE(test_latency_bins)
+{
+  // bins are monotonic and each value is within its bin
+  unsigned int last = 0;
+  for (unsigned int v = 0; v < 1000000; v += 7) {
+    unsigned int i = LatencyHistogram::binIndex(v);
+    BOOST_CHECK(i >= last);
+    BOOST_CHECK(i < LatencyHistogram::NBINS);
+    BOOST_CHECK(v <= LatencyHistogram::binUpperBound(i));
+    if (i > 0)
+      BOOST_CHECK(v > LatencyHistogram::binUpperBound(i - 1));
+    last = i;
+  }
+  BOOST_CHECK_EQUAL(LatencyHistogram::binIndex(LatencyHistogram::MAX_VALUE),
+                    LatencyHistogram::NBINS - 1);
+  BOOST_CHECK_EQUAL(LatencyHistogram::binUpperBound(LatencyHistogram::NBINS - 1),
+                    LatencyHistogram::MAX_VALUE);
+}
+
+BOOST_AUTO_TEST_CASE(test_latency_percentiles)
+{
+  LatencyHistogram hist;
+  BOOST_CHECK_EQUAL(hist.getPercentile(50.0), 0u);
+
+  for (int i = 1; i <= 1000; i++) hist.record(i);
+  hist.record(-5);
+
+  BOOST_CHECK_EQUAL(hist.getCount(), 1001u);
+  BOOST_CHECK_EQUAL(hist.getMax(), 1000u);
+
+  // within the 1/16 resolution of the bins
+  unsigned int p50 = hist.getPercentile(50.0);
+  BOOST_CHECK(p50 >= 500 && p50 <= 500 + 500 / 16);
+  unsigned int p99 = hist.getPercentile(99.0);
+  BOOST_CHECK(p99 >= 990 && p99 <= 1000);
+  BOOST_CHECK_EQUAL(hist.getPercentile(100.0), 1000u);
+
+  hist.reset();
+  BOOST_CHECK_EQUAL(hist.getCount(), 0u);
+  BOOST_CHECK_EQUAL(hist.getMax(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_pipeline_latency_print)
+{
+  PipelineLatency lat;
+  lat[PipelineLatency::PROCESS].record(20);
+
+  std::ostringstream ost;
+  lat.printAndReset(ost, "sensor");
+  BOOST_CHECK_EQUAL(ost.str(),
+                    "sensor process n=1 p50=20 p90=20 p99=20 max=20\n");
+  BOOST_CHECK_EQUAL(lat[PipelineLatency::PROCESS].getCount(), 0u);
+}
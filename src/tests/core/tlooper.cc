@@ -0,0 +1,130 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/core/Looper.h>
+#include <nidas/util/UTime.h>
+
+#include <sstream>
+#include <unistd.h>
+
+using namespace nidas::core;
+namespace n_u = nidas::util;
+
+namespace {
+
+class Counter: public LooperClient
+{
+public:
+  Counter(): count(0), lastTime(0), badPhase(0), periodMsec(0), offsetMsec(0)
+  {
+  }
+
+  void looperNotify() throw()
+  {
+    dsm_time_t tnow = n_u::getSystemTime();
+    // the call should be shortly after the offset into the period
+    dsm_time_t phase = (tnow / USECS_PER_MSEC - offsetMsec) % periodMsec;
+    if (phase > periodMsec / 2) badPhase++;
+    lastTime = tnow;
+    count++;
+  }
+
+  int count;
+  dsm_time_t lastTime;
+  int badPhase;
+  int periodMsec;
+  int offsetMsec;
+};
+
+// A client whose looperNotify() takes a while.
+class Slow: public LooperClient
+{
+public:
+  Slow(): started(0), finished(0) {}
+
+  void looperNotify() throw()
+  {
+    __atomic_store_n(&started, 1, __ATOMIC_SEQ_CST);
+    usleep(200000);
+    __atomic_store_n(&finished, 1, __ATOMIC_SEQ_CST);
+  }
+
+  int started;
+  int finished;
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(test_looper_periods)
+{
+  Looper looper;
+  Counter fast, slow, gone;
+  fast.periodMsec = 20;
+  slow.periodMsec = 70;
+  slow.offsetMsec = 13;
+  gone.periodMsec = 10;
+
+  looper.addClient(&fast, fast.periodMsec, fast.offsetMsec);
+  looper.addClient(&slow, slow.periodMsec, slow.offsetMsec);
+  looper.addClient(&gone, gone.periodMsec, gone.offsetMsec);
+  usleep(100000);
+  looper.removeClient(&gone);
+  int ngone = gone.count;
+  usleep(600000);
+
+  // exact periods, not rounded to a common tick. Allow for
+  // a loaded test machine.
+  BOOST_CHECK(fast.count >= 25 && fast.count <= 36);
+  BOOST_CHECK(slow.count >= 7 && slow.count <= 11);
+  BOOST_CHECK_EQUAL(gone.count, ngone);
+  BOOST_CHECK(ngone > 0);
+  BOOST_CHECK(fast.badPhase <= 2);
+  BOOST_CHECK(slow.badPhase <= 2);
+
+  std::ostringstream ost;
+  looper.printJitter(ost, &fast, "fast");
+  BOOST_CHECK(ost.str().find("fast looper n=") == 0);
+  ost.str("");
+  looper.printJitter(ost, &gone, "gone");
+  BOOST_CHECK(ost.str().empty());
+
+  looper.removeClient(&slow);
+  looper.removeClient(&fast);
+  BOOST_CHECK(!looper.isRunning());
+}
+
+BOOST_AUTO_TEST_CASE(test_looper_remove_running)
+{
+  // Another client, so that the Looper is not stopped and joined
+  // when the slow one is removed.
+  Looper looper;
+  Counter other;
+  other.periodMsec = 1000;
+  Slow slow;
+  looper.addClient(&other, other.periodMsec, 0);
+  looper.addClient(&slow, 10, 0);
+
+  for (int i = 0; i < 500 && !__atomic_load_n(&slow.started, __ATOMIC_SEQ_CST);
+       i++)
+    usleep(10000);
+  BOOST_REQUIRE(__atomic_load_n(&slow.started, __ATOMIC_SEQ_CST));
+
+  // removeClient() returns after the running looperNotify(),
+  // so that the client can be deleted.
+  looper.removeClient(&slow);
+  BOOST_CHECK(__atomic_load_n(&slow.finished, __ATOMIC_SEQ_CST));
+  BOOST_CHECK(looper.isRunning());
+
+  looper.removeClient(&other);
+  BOOST_CHECK(!looper.isRunning());
+}
+
+BOOST_AUTO_TEST_CASE(test_looper_bad_period)
+{
+  Looper looper;
+  Counter c;
+  BOOST_CHECK_THROW(looper.addClient(&c, 2, 0),
+                    n_u::InvalidParameterException);
+}
@@ -0,0 +1,103 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/dynld/isff/Packets.h>
+
+#include <cmath>
+
+using namespace nidas::dynld::isff;
+using nidas::util::UTime;
+using nidas::util::ParseException;
+
+namespace {
+
+// First message of tests/goes_dcp/data/messages.010410.txt.
+const char* nesdisPacket =
+    "3640C55010004151531G48+0HF200WFF00061 @@yLEQ@@|_@@|_@@|_@@|_@@|_"
+    "@@|_@@|_@@|_@@|_@@|_@@|_@@|_@@|_T \r\n";
+
+}
+
+BOOST_AUTO_TEST_CASE(test_packet_parser_nesdis)
+{
+  PacketParser parser;
+
+  BOOST_CHECK_EQUAL(parser.parse(nesdisPacket), PacketParser::NESDIS_PT);
+
+  // station id, followed by year 10, day 004, 15:15:31
+  BOOST_CHECK_EQUAL(parser.getStationId(), 0x3640C550);
+  BOOST_CHECK_EQUAL(parser.getPacketTime().toUsecs(),
+                    UTime(true, 2010, 1, 4, 15, 15, 31).toUsecs());
+
+  // info fields: G48+0HF200WFF00061
+  const PacketInfo* info = parser.getPacketInfo();
+  BOOST_REQUIRE(info);
+  BOOST_CHECK_EQUAL(info->getSignalStrength(), 48.0);
+  BOOST_CHECK_EQUAL(info->getFreqOffset(), 0.0);
+  BOOST_CHECK_EQUAL(info->getChannel(), -200);
+  BOOST_CHECK_EQUAL(info->getLength(), 61);
+  // good message, high modulation index (2 << 4), fair quality (1 << 6)
+  BOOST_CHECK_EQUAL(info->getStatusInt(), 96);
+
+  // the first two data characters are the config and sample ids
+  BOOST_CHECK_EQUAL(parser.getConfigId(), 0);
+  BOOST_CHECK_EQUAL(parser.getSampleId(), 0);
+
+  // 61 bytes, less the two ids, is 14 values of 4 characters.
+  // The first is the value in tests/goes_dcp/data/results.txt,
+  // the next 13 are the missing value code "@@|_", and values
+  // past the end of the packet are also NaN.
+  float data[16];
+  parser.parseData(data, 16);
+  BOOST_CHECK_CLOSE(data[0], 844.8906, 1.e-4);
+  for (int i = 1; i < 16; i++)
+    BOOST_CHECK(std::isnan(data[i]));
+}
+
+BOOST_AUTO_TEST_CASE(test_packet_parser_sutron)
+{
+  PacketParser parser;
+
+  const char* packet = "3640C55010004151531"
+    "1 -48.5 12 3 9.5 @@yLEQ\n";
+  BOOST_CHECK_EQUAL(parser.parse(packet), PacketParser::NESDIS_PT);
+  BOOST_CHECK_EQUAL(parser.getStationId(), 0x3640C550);
+  const PacketInfo* info = parser.getPacketInfo();
+  BOOST_REQUIRE(info);
+  BOOST_CHECK_EQUAL(info->getSignalStrength(), -48.5);
+  BOOST_CHECK_EQUAL(info->getFreqOffset(), 12.0);
+  BOOST_CHECK_EQUAL(info->getChannel(), -99999);
+}
+
+BOOST_AUTO_TEST_CASE(test_packet_parser_bad)
+{
+  PacketParser parser;
+
+  // lower case hex digit in the station id
+  BOOST_CHECK_THROW(
+    parser.parse("3640c55010004151531G48+0HF200WFF00061 @@yLEQ\n"),
+    ParseException);
+  // day of year starting with 4
+  BOOST_CHECK_THROW(
+    parser.parse("3640C55010404151531G48+0HF200WFF00061 @@yLEQ\n"),
+    ParseException);
+  // minute of 65
+  BOOST_CHECK_THROW(
+    parser.parse("3640C55010004156531G48+0HF200WFF00061 @@yLEQ\n"),
+    ParseException);
+  // header truncated
+  BOOST_CHECK_THROW(parser.parse("3640C550100041515"), ParseException);
+  // unknown modulation index in the NESDIS info, which then
+  // does not match the Sutron info either
+  BOOST_CHECK_THROW(
+    parser.parse("3640C55010004151531G48+0XF200WFF00061 @@yLEQ\n"),
+    ParseException);
+  // info truncated before the length
+  BOOST_CHECK_THROW(parser.parse("3640C55010004151531G48+0HF200WFF"),
+                    ParseException);
+
+  // A good packet parses after the bad ones.
+  BOOST_CHECK_NO_THROW(parser.parse(nesdisPacket));
+  BOOST_CHECK_EQUAL(parser.getPacketInfo()->getLength(), 61);
+}
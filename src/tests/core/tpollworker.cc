@@ -0,0 +1,161 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/dynld/RawSampleService.h>
+#include <nidas/dynld/RawSampleInputStream.h>
+#include <nidas/core/IOStream.h>
+#include <nidas/core/SampleInputHeader.h>
+#include <nidas/core/SampleClient.h>
+#include <nidas/core/UnixIOChannel.h>
+#include <nidas/util/Thread.h>
+
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+
+using namespace nidas::core;
+using namespace nidas::dynld;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+namespace {
+
+class IdCollector: public SampleClient
+{
+public:
+  IdCollector(): ids(), mutex() {}
+
+  bool receive(const Sample* s) throw()
+  {
+    n_u::Autolock alock(mutex);
+    ids.push_back(s->getId());
+    return true;
+  }
+
+  void flush() throw() {}
+
+  size_t size()
+  {
+    n_u::Autolock alock(mutex);
+    return ids.size();
+  }
+
+  vector<dsm_sample_id_t> ids;
+
+  n_u::Mutex mutex;
+};
+
+// Input reading the read end of a pipe, which counts the requests
+// for a new connection, rather than connecting.
+class PipeInput: public RawSampleInputStream
+{
+public:
+  PipeInput(int fd):
+    RawSampleInputStream(new UnixIOChannel("pipe", fd)), nrequests(0)
+  {}
+
+  void requestConnection(DSMService*) throw(n_u::IOException)
+  {
+    nrequests++;
+  }
+
+  int nrequests;
+};
+
+// Raw samples with a little-endian SampleHeader, as written by a DSM.
+string rawSamples(int first, int n)
+{
+  string buf;
+  for (int i = first; i < first + n; i++) {
+    char data[10];
+    ::memset(data, i, sizeof(data));
+    SampleHeader header(CHAR_ST);
+    header.setTimeTag((dsm_time_t)i * USECS_PER_SEC);
+    header.setDataByteLength(sizeof(data));
+    header.setId(i);
+    buf.append((const char*)&header, SampleHeader::getSizeOf());
+    buf.append(data, sizeof(data));
+  }
+  return buf;
+}
+
+// Wait up to 5 seconds for a condition.
+template<class T>
+bool waitFor(T& obj, bool (*cond)(T&))
+{
+  for (int i = 0; i < 500 && !cond(obj); i++) ::usleep(10000);
+  return cond(obj);
+}
+
+bool gotTwenty(IdCollector& c) { return c.size() == 20; }
+
+bool noInputs(RawSampleService::PollWorker& w) { return w.getNumInputs() == 0; }
+
+}
+
+BOOST_AUTO_TEST_CASE(test_poll_worker)
+{
+  int fds[2];
+  BOOST_REQUIRE(::pipe(fds) == 0);
+
+  PipeInput input(fds[0]);
+  IdCollector collector;
+  input.addSampleClient(&collector);
+
+  RawSampleService svc;
+  RawSampleService::PollWorker worker(&svc);
+  worker.start();
+  worker.add(&input);
+  BOOST_CHECK_EQUAL(worker.getNumInputs(), 1);
+
+  // The input header and a sample are split across writes, and so
+  // across reads, which must be parsed incrementally.
+  UnixIOChannel wchan("pipe", fds[1]);
+  IOStream wios(wchan);
+  SampleInputHeader header;
+  header.setArchiveVersion("1");
+  header.setProjectName("tpollworker");
+  header.write(&wios);
+  wios.flush();
+  ::usleep(100000);
+
+  string samps = rawSamples(1, 20);
+  size_t split = samps.length() / 2 + 3;
+  BOOST_REQUIRE(::write(fds[1], samps.c_str(), split) == (ssize_t)split);
+  ::usleep(100000);
+  BOOST_REQUIRE(::write(fds[1], samps.c_str() + split,
+                        samps.length() - split) ==
+                (ssize_t)(samps.length() - split));
+
+  BOOST_CHECK(waitFor(collector, gotTwenty));
+  for (unsigned int i = 0; i < collector.ids.size(); i++)
+    BOOST_CHECK_EQUAL(collector.ids[i], i + 1);
+  BOOST_CHECK_EQUAL(input.getInputHeader().getProjectName(), "tpollworker");
+
+  // A hangup of the writer closes the input and requests
+  // a new connection.
+  ::close(fds[1]);
+  BOOST_CHECK(waitFor(worker, noInputs));
+  BOOST_CHECK_EQUAL(input.nrequests, 1);
+
+  // Inputs left when the worker is interrupted are closed,
+  // but not reconnected.
+  BOOST_REQUIRE(::pipe(fds) == 0);
+  PipeInput input2(fds[0]);
+  worker.add(&input2);
+  BOOST_CHECK_EQUAL(worker.getNumInputs(), 1);
+  worker.interrupt();
+  worker.join();
+  BOOST_CHECK_EQUAL(worker.getNumInputs(), 0);
+  BOOST_CHECK_EQUAL(input2.nrequests, 0);
+  ::close(fds[1]);
+
+  // A worker which has stopped polling refuses new inputs.
+  BOOST_REQUIRE(::pipe(fds) == 0);
+  PipeInput input3(fds[0]);
+  BOOST_CHECK_THROW(worker.add(&input3), n_u::IOException);
+  input3.close();
+  ::close(fds[1]);
+}
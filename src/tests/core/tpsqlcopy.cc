@@ -0,0 +1,109 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/dynld/psql/PSQLCopyFormat.h>
+#include <nidas/core/SampleTag.h>
+#include <nidas/core/Variable.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace nidas::core;
+using nidas::dynld::psql::PSQLCopyFormat;
+using namespace std;
+
+namespace {
+
+// The big-endian bytes of a value.
+vector<unsigned char> be(unsigned long long val, int n)
+{
+  vector<unsigned char> bytes(n);
+  for (int i = n - 1; i >= 0; i--, val >>= 8) bytes[i] = val & 0xff;
+  return bytes;
+}
+
+vector<unsigned char> be(double val)
+{
+  unsigned long long bits;
+  ::memcpy(&bits, &val, sizeof(bits));
+  return be(bits, 8);
+}
+
+void appendField(vector<unsigned char>& out, const vector<unsigned char>& val)
+{
+  vector<unsigned char> len = be(val.size(), 4);
+  out.insert(out.end(), len.begin(), len.end());
+  out.insert(out.end(), val.begin(), val.end());
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_psql_copy_header)
+{
+  vector<char> buf;
+  PSQLCopyFormat::appendHeader(buf);
+  const unsigned char header[] = {
+    'P', 'G', 'C', 'O', 'P', 'Y', '\n', 0xff, '\r', '\n', 0,
+    0, 0, 0, 0,     // flags
+    0, 0, 0, 0      // header extension length
+  };
+  BOOST_REQUIRE_EQUAL(buf.size(), sizeof(header));
+  BOOST_CHECK(::memcmp(&buf[0], header, sizeof(header)) == 0);
+
+  buf.clear();
+  PSQLCopyFormat::appendTrailer(buf);
+  BOOST_REQUIRE_EQUAL(buf.size(), PSQLCopyFormat::TRAILER_LENGTH);
+  BOOST_CHECK_EQUAL((unsigned char)buf[0], 0xff);
+  BOOST_CHECK_EQUAL((unsigned char)buf[1], 0xff);
+}
+
+BOOST_AUTO_TEST_CASE(test_psql_copy_row)
+{
+  SampleTag tag;
+  const char* names[] = { "T", "Clock", "RH", "P" };
+  for (int i = 0; i < 4; i++) {
+    Variable* var = new Variable();
+    var->setName(names[i]);
+    tag.addVariable(var);
+  }
+  const SampleTag& ctag = tag;
+
+  // 2000-01-01 00:00:01.5, one second and a half after the PostgreSQL
+  // epoch. RH is NaN, and P is not in the sample.
+  SampleT<float>* samp = getSample<float>(3);
+  samp->setTimeTag(946684801500000LL);
+  float* fp = samp->getDataPtr();
+  fp[0] = 12.5;
+  fp[1] = 99.0;
+  fp[2] = floatNAN;
+
+  const double missing = 1.e37;
+  vector<char> buf;
+  buf.push_back('x');     // rows are appended
+  PSQLCopyFormat::appendRow(buf, samp, ctag.getVariables(), missing);
+  samp->freeReference();
+
+  // field count: time, T, RH and P, but not Clock
+  vector<unsigned char> expected(1, 'x');
+  vector<unsigned char> nfields = be(4, 2);
+  expected.insert(expected.end(), nfields.begin(), nfields.end());
+  appendField(expected, be(1500000ULL, 8));
+  appendField(expected, be(12.5));
+  appendField(expected, be(missing));
+  appendField(expected, be(missing));
+
+  BOOST_REQUIRE_EQUAL(buf.size(), expected.size());
+  BOOST_CHECK(::memcmp(&buf[0], &expected[0], buf.size()) == 0);
+
+  // A time before the epoch is negative.
+  samp = getSample<float>(0);
+  samp->setTimeTag(946684800000000LL - 1);
+  buf.clear();
+  PSQLCopyFormat::appendRow(buf, samp, ctag.getVariables(), missing);
+  samp->freeReference();
+  BOOST_REQUIRE(buf.size() > 14);
+  vector<unsigned char> minus1 = be(~0ULL, 8);
+  BOOST_CHECK(::memcmp(&buf[6], &minus1[0], 8) == 0);
+}
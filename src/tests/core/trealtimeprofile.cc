@@ -0,0 +1,123 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/core/RealTimeProfile.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/resource.h>
+
+using nidas::core::RealTimeProfile;
+namespace n_u = nidas::util;
+
+namespace {
+
+// Minor page faults of the calling thread.
+long threadFaults()
+{
+  struct rusage ru;
+  ::getrusage(RUSAGE_THREAD, &ru);
+  return ru.ru_minflt;
+}
+
+// Allocates and writes to 2 MB in small blocks, like the samples and
+// set nodes of a sorter, and counts the page faults of doing so.
+class AllocThread: public n_u::Thread
+{
+public:
+  AllocThread(const RealTimeProfile& rt, bool prefault):
+    n_u::Thread("alloc"), faults(0), _rt(rt), _prefault(prefault) {}
+
+  int run() throw(n_u::Exception)
+  {
+    if (_prefault) _rt.prefaultThread();
+    std::vector<char*> blocks;
+    long f0 = threadFaults();
+    for (int i = 0; i < 2000; i++) {
+      char* p = (char*)::malloc(1000);
+      ::memset(p, 1, 1000);
+      blocks.push_back(p);
+    }
+    faults = threadFaults() - f0;
+    for (unsigned int i = 0; i < blocks.size(); i++) ::free(blocks[i]);
+    return RUN_OK;
+  }
+
+  long faults;
+
+private:
+  const RealTimeProfile& _rt;
+  bool _prefault;
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(test_realtime_parse)
+{
+  RealTimeProfile rt;
+  rt.parse("sensors=RT_FIFO:60@1-2,4;looper=@0;status=RT_RR:5;prefault=16;lock");
+  BOOST_CHECK_EQUAL(rt.getPrefaultMBytes(), 16u);
+  BOOST_CHECK(rt.getLockMemory());
+
+  BOOST_CHECK_EQUAL(RealTimeProfile::getRole("rawsorter"),
+                    RealTimeProfile::RAW_SORTER);
+  BOOST_CHECK_THROW(RealTimeProfile::getRole("nosuch"),
+                    n_u::InvalidParameterException);
+  BOOST_CHECK_THROW(rt.parse("sensors=RT_XX:60"),
+                    n_u::InvalidParameterException);
+  BOOST_CHECK_THROW(rt.parse("sensors=@1-x"),
+                    n_u::InvalidParameterException);
+  BOOST_CHECK_THROW(rt.parse("prefault"),
+                    n_u::InvalidParameterException);
+}
+
+BOOST_AUTO_TEST_CASE(test_realtime_update)
+{
+  RealTimeProfile base;
+  RealTimeProfile xml;
+  xml.setPrefaultMBytes(8);
+  base.update(xml);
+  BOOST_CHECK_EQUAL(base.getPrefaultMBytes(), 8u);
+  BOOST_CHECK(!base.getLockMemory());
+
+  // settings which are not made in the other profile are kept
+  RealTimeProfile cli;
+  cli.setLockMemory(true);
+  base.update(cli);
+  BOOST_CHECK_EQUAL(base.getPrefaultMBytes(), 8u);
+  BOOST_CHECK(base.getLockMemory());
+}
+
+BOOST_AUTO_TEST_CASE(test_realtime_apply)
+{
+  RealTimeProfile rt;
+  rt.parse("status=NONRT@0");
+
+  // NONRT does not need privileges, the affinity is set on start
+  n_u::ThreadRunnable thread("rt", 0);
+  rt.apply(RealTimeProfile::STATUS, &thread);
+  thread.start();
+  thread.join();
+}
+
+BOOST_AUTO_TEST_CASE(test_realtime_prefault_thread)
+{
+  RealTimeProfile rt;
+  rt.setPrefaultMBytes(16);
+
+  // A thread allocates from its own malloc arena. After
+  // prefaultThread() the allocations of its data path do not fault.
+  AllocThread cold(rt, false);
+  cold.start();
+  cold.join();
+  AllocThread warm(rt, true);
+  warm.start();
+  warm.join();
+  BOOST_TEST_MESSAGE("page faults of 2 MB of allocations: " <<
+                     cold.faults << " without prefaultThread(), " <<
+                     warm.faults << " with");
+  BOOST_CHECK_LT(warm.faults, 20);
+}
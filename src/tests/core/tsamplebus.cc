@@ -0,0 +1,290 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/core/SampleBus.h>
+#include <nidas/core/SampleBusChannel.h>
+#include <nidas/core/Sample.h>
+#include <nidas/core/Project.h>
+#include <nidas/util/EOFException.h>
+#include <nidas/util/UTime.h>
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+using namespace nidas::core;
+namespace n_u = nidas::util;
+
+namespace {
+
+std::string busName()
+{
+  std::ostringstream ost;
+  ost << "tsamplebus_" << ::getpid();
+  return ost.str();
+}
+
+void publish(SampleBusWriter& bus, unsigned int id, unsigned int len)
+{
+  SampleT<char>* samp = getSample<char>(len);
+  samp->setTimeTag(id * 1000);
+  samp->setId(id);
+  ::memset(samp->getDataPtr(), id % 256, len);
+  bus.receive(samp);
+  samp->freeReference();
+}
+
+// The bus and read buffer of test_samplebus_channel_overwrite.
+SampleBusWriter* lapBus = 0;
+char* lapBuf = 0;
+long pageSize = 0;
+int nlapped = 0;
+
+/*
+ * Handler of the fault of a copy into the protected read buffer.
+ * It laps the reader, overwriting the record being copied, and then
+ * allows the copy to finish. Not async-signal-safe, but the
+ * interrupted code is a memcpy, which holds no locks.
+ */
+void lapReader(int, siginfo_t* info, void*)
+{
+  char* addr = (char*) info->si_addr;
+  if (addr < lapBuf || addr >= lapBuf + pageSize) ::abort();
+  for (int i = 0; i < 2000; i++, nlapped++) publish(*lapBus, 1000 + i, 1000);
+  ::mprotect(lapBuf, pageSize, PROT_READ | PROT_WRITE);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_samplebus_read)
+{
+  SampleBusWriter bus(busName(), 1);
+  publish(bus, 1, 10);
+
+  // a reader starts at the newest sample
+  SampleBusReader reader(busName());
+  BOOST_CHECK(reader.writerAlive());
+
+  size_t len;
+  BOOST_CHECK(reader.next(len) == 0);
+
+  for (unsigned int i = 2; i < 1000; i++) publish(bus, i, i % 100 + 1);
+  BOOST_CHECK_EQUAL(bus.getNumPublished(), 999u);
+
+  for (unsigned int i = 2; i < 1000; i++) {
+    const char* rec = reader.next(len);
+    BOOST_REQUIRE(rec != 0);
+    BOOST_REQUIRE(reader.valid());
+    BOOST_CHECK_EQUAL(len, SampleHeader::getSizeOf() + i % 100 + 1);
+    SampleHeader header;
+    ::memcpy(&header, rec, SampleHeader::getSizeOf());
+    BOOST_CHECK_EQUAL(header.getId(), i);
+    BOOST_CHECK_EQUAL(header.getTimeTag(), (dsm_time_t)i * 1000);
+    BOOST_CHECK_EQUAL(rec[len - 1], (char)(i % 256));
+  }
+  BOOST_CHECK(reader.next(len) == 0);
+  BOOST_CHECK_EQUAL(reader.getNumDropped(), 0u);
+  BOOST_CHECK_EQUAL(reader.getNumOverruns(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_samplebus_overrun)
+{
+  SampleBusWriter bus(busName(), 1);
+  SampleBusReader reader(busName());
+
+  size_t len;
+  publish(bus, 1, 1000);
+  const char* rec = reader.next(len);
+  BOOST_REQUIRE(rec != 0);
+  BOOST_CHECK(reader.valid());
+
+  // lap the reader, which invalidates the record it holds
+  const unsigned int N = 3000;
+  for (unsigned int i = 2; i <= N; i++) publish(bus, i, 1000);
+  BOOST_CHECK(!reader.valid());
+
+  // the reader skips to the head, and counts the samples it missed
+  // when it reads the next one
+  BOOST_CHECK(reader.next(len) == 0);
+  BOOST_CHECK_EQUAL(reader.getNumOverruns(), 1u);
+
+  publish(bus, N + 1, 1000);
+  rec = reader.next(len);
+  BOOST_REQUIRE(rec != 0);
+  SampleHeader header;
+  ::memcpy(&header, rec, SampleHeader::getSizeOf());
+  BOOST_CHECK_EQUAL(header.getId(), N + 1);
+  BOOST_CHECK_EQUAL(reader.getNumDropped(), N - 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_samplebus_spec)
+{
+  std::string name;
+  unsigned int mbytes;
+  SampleBusWriter::parseSpec("dsm", name, mbytes);
+  BOOST_CHECK_EQUAL(name, "dsm");
+  BOOST_CHECK_EQUAL(mbytes, 16u);
+  SampleBusWriter::parseSpec("dsm:64", name, mbytes);
+  BOOST_CHECK_EQUAL(mbytes, 64u);
+  BOOST_CHECK_THROW(SampleBusWriter::parseSpec("a/b", name, mbytes),
+                    n_u::InvalidParameterException);
+  BOOST_CHECK_THROW(SampleBusWriter::parseSpec("dsm:0", name, mbytes),
+                    n_u::InvalidParameterException);
+  BOOST_CHECK_THROW(SampleBusReader("tsamplebus_nosuch"), n_u::IOException);
+}
+
+BOOST_AUTO_TEST_CASE(test_samplebus_channel)
+{
+  Project::getInstance()->setName("tsamplebus");
+  SampleBusWriter bus(busName(), 1);
+  bus.setHeader();
+  std::string header = SampleBusReader(busName()).getHeader();
+  BOOST_REQUIRE(header.find("tsamplebus") != std::string::npos);
+
+  SampleBusChannel chan(busName());
+  BOOST_CHECK_EQUAL(chan.getName(), "shm:" + busName());
+  BOOST_CHECK(chan.isNewInput());
+
+  // the header, in reads smaller than it
+  std::string got;
+  char buf[256];
+  while (got.length() < header.length()) {
+    size_t l = chan.read(buf, 16);
+    BOOST_REQUIRE(l > 0 && l <= 16);
+    got.append(buf, l);
+  }
+  BOOST_CHECK_EQUAL(got, header);
+  BOOST_CHECK(chan.isNewInput());
+
+  // Three samples of 10 bytes fit in a read of 100 bytes, the
+  // fourth, of 200, doesn't, and is returned by the next reads.
+  const size_t hlen = SampleHeader::getSizeOf();
+  for (unsigned int i = 1; i <= 3; i++) publish(bus, i, 10);
+  publish(bus, 4, 200);
+
+  size_t l = chan.read(buf, 100);
+  BOOST_CHECK(!chan.isNewInput());
+  BOOST_REQUIRE_EQUAL(l, 3 * (hlen + 10));
+  for (unsigned int i = 0; i < 3; i++) {
+    SampleHeader sh;
+    ::memcpy(&sh, buf + i * (hlen + 10), hlen);
+    BOOST_CHECK_EQUAL(sh.getId(), i + 1);
+    BOOST_CHECK_EQUAL(sh.getDataByteLength(), 10u);
+  }
+
+  got.clear();
+  while (got.length() < hlen + 200) {
+    l = chan.read(buf, 100);
+    BOOST_REQUIRE(l > 0 && l <= 100);
+    got.append(buf, l);
+  }
+  BOOST_REQUIRE_EQUAL(got.length(), hlen + 200);
+  SampleHeader sh;
+  ::memcpy(&sh, got.c_str(), hlen);
+  BOOST_CHECK_EQUAL(sh.getId(), 4u);
+  BOOST_CHECK_EQUAL(sh.getDataByteLength(), 200u);
+  BOOST_CHECK_EQUAL(got.find_first_not_of('\x04', hlen), std::string::npos);
+  BOOST_CHECK_EQUAL(chan.getNumDropped(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_samplebus_channel_overwrite)
+{
+  // A record which is overwritten while it is copied into
+  // the buffer of a read is discarded.
+  SampleBusWriter bus(busName(), 1);
+  SampleBusChannel chan(busName());
+  publish(bus, 1, 10);
+
+  pageSize = ::sysconf(_SC_PAGESIZE);
+  void* addr = ::mmap(0, pageSize, PROT_READ,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  BOOST_REQUIRE(addr != MAP_FAILED);
+  lapBus = &bus;
+  lapBuf = (char*) addr;
+  nlapped = 0;
+
+  struct sigaction act, oldact;
+  ::memset(&act, 0, sizeof(act));
+  act.sa_sigaction = lapReader;
+  act.sa_flags = SA_SIGINFO;
+  BOOST_REQUIRE(::sigaction(SIGSEGV, &act, &oldact) == 0);
+  size_t l = chan.read(lapBuf, 100);
+  ::sigaction(SIGSEGV, &oldact, 0);
+
+  // 2000 records of 1000 bytes are more than a ring of 1 MB
+  BOOST_CHECK_EQUAL(nlapped, 2000);
+  BOOST_CHECK_EQUAL(l, 0u);
+
+  // the next sample is read, and the discarded one and those
+  // which were overwritten are counted as dropped
+  publish(bus, 2, 10);
+  l = chan.read(lapBuf, 100);
+  BOOST_REQUIRE_EQUAL(l, SampleHeader::getSizeOf() + 10);
+  SampleHeader header;
+  ::memcpy(&header, lapBuf, SampleHeader::getSizeOf());
+  BOOST_CHECK_EQUAL(header.getId(), 2u);
+  BOOST_CHECK_EQUAL(chan.getNumDropped(), 2001u);
+
+  ::munmap(addr, pageSize);
+}
+
+BOOST_AUTO_TEST_CASE(test_samplebus_channel_eof)
+{
+  // A writer in another process, which exits without removing the bus.
+  const std::string name = busName() + "_eof";
+  int topipe[2], frompipe[2];
+  BOOST_REQUIRE(::pipe(topipe) == 0 && ::pipe(frompipe) == 0);
+  pid_t pid = ::fork();
+  BOOST_REQUIRE(pid >= 0);
+  if (pid == 0) {
+    ::close(topipe[1]);
+    ::close(frompipe[0]);
+    SampleBusWriter* bus = new SampleBusWriter(name, 1);
+    char c = 0;
+    if (::write(frompipe[1], &c, 1) != 1) ::_exit(1);
+    if (::read(topipe[0], &c, 1) != 1) ::_exit(1);
+    publish(*bus, 1, 10);
+    if (::write(frompipe[1], &c, 1) != 1) ::_exit(1);
+    if (::read(topipe[0], &c, 1) != 1) ::_exit(1);
+    ::_exit(0);
+  }
+  ::close(topipe[0]);
+  ::close(frompipe[1]);
+  char c = 0;
+  BOOST_REQUIRE(::read(frompipe[0], &c, 1) == 1);
+
+  SampleBusChannel chan(name);
+  BOOST_REQUIRE(::write(topipe[1], &c, 1) == 1);
+  BOOST_REQUIRE(::read(frompipe[0], &c, 1) == 1);
+
+  char buf[100];
+  BOOST_CHECK_EQUAL(chan.read(buf, sizeof(buf)),
+                    SampleHeader::getSizeOf() + 10);
+
+  // Without samples for a second, a read returns 0 while
+  // the writer is running, and throws EOFException after it exits.
+  n_u::UTime t0;
+  BOOST_CHECK_EQUAL(chan.read(buf, sizeof(buf)), 0u);
+  double dt = (n_u::UTime() - t0) / (double)USECS_PER_SEC;
+  BOOST_CHECK(dt >= 0.9 && dt < 5.0);
+
+  BOOST_REQUIRE(::write(topipe[1], &c, 1) == 1);
+  int status;
+  BOOST_REQUIRE(::waitpid(pid, &status, 0) == pid);
+  BOOST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  t0 = n_u::UTime();
+  BOOST_CHECK_THROW(chan.read(buf, sizeof(buf)), n_u::EOFException);
+  dt = (n_u::UTime() - t0) / (double)USECS_PER_SEC;
+  BOOST_CHECK(dt >= 0.9 && dt < 5.0);
+
+  ::shm_unlink(("/" + name).c_str());
+  ::close(topipe[1]);
+  ::close(frompipe[0]);
+}
@@ -0,0 +1,310 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/core/CompactSampleHeader.h>
+#include <nidas/core/HeaderSource.h>
+#include <nidas/core/SampleInputHeader.h>
+#include <nidas/core/UnixIOChannel.h>
+#include <nidas/core/SampleClient.h>
+#include <nidas/dynld/SampleOutputStream.h>
+#include <nidas/dynld/SampleInputStream.h>
+
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+
+using namespace nidas::core;
+using nidas::dynld::SampleOutputStream;
+using nidas::dynld::SampleInputStream;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+namespace {
+
+struct Expected
+{
+  dsm_time_t tt;
+  dsm_sample_id_t rawId;
+  vector<char> data;
+};
+
+class Header: public HeaderSource
+{
+public:
+  void sendHeader(dsm_time_t, SampleOutput* output)
+    throw(n_u::IOException)
+  {
+    SampleInputHeader header;
+    header.setArchiveVersion("1");
+    header.setProjectName("test");
+    header.write(output);
+  }
+};
+
+class Collector: public SampleClient
+{
+public:
+  Collector(): samples() {}
+
+  bool receive(const Sample* s) throw()
+  {
+    Expected e;
+    e.tt = s->getTimeTag();
+    e.rawId = s->getRawId();
+    const char* cp = (const char*) s->getConstVoidDataPtr();
+    e.data.assign(cp, cp + s->getDataByteLength());
+    samples.push_back(e);
+    return true;
+  }
+
+  void flush() throw() {}
+
+  vector<Expected> samples;
+};
+
+/**
+ * Samples of a few ids at different rates, with time tags a little
+ * out of order, as in an unsorted raw stream, of lengths from 0 to
+ * larger than the IOStream buffer, so that headers and data are split
+ * across reads.
+ */
+vector<Expected> makeSamples(unsigned int n)
+{
+  vector<Expected> samples;
+  dsm_time_t t0 = 1300000000LL * USECS_PER_SEC;
+  for (unsigned int i = 0; i < n; i++) {
+    Expected e;
+    unsigned int id = i % 7;
+    e.tt = t0 + i * 10000 - (i % 5) * 3000;
+    e.rawId = SET_DSM_ID(id + 1, 1) | (id * 10 + 1);
+    e.rawId = SET_SAMPLE_TYPE(e.rawId, id == 6 ? FLOAT_ST : CHAR_ST);
+    unsigned int len = (i * 37) % 100;
+    if (id == 6) len = 4;
+    if (i % 500 == 250) len = 20000;
+    e.data.resize(len);
+    for (unsigned int j = 0; j < len; j++) e.data[j] = (char)(i + j);
+    samples.push_back(e);
+  }
+  return samples;
+}
+
+string writeSamples(const vector<Expected>& samples, const string& encoding)
+{
+  char name[] = "/tmp/tsampleencodingXXXXXX";
+  int fd = ::mkstemp(name);
+  BOOST_REQUIRE(fd >= 0);
+
+  Header header;
+  SampleOutputStream out(new UnixIOChannel(name, fd));
+  out.setSampleEncoding(encoding);
+  out.setHeaderSource(&header);
+  for (unsigned int i = 0; i < samples.size(); i++) {
+    const Expected& e = samples[i];
+    Sample* samp = getSample((sampleType)GET_SAMPLE_TYPE(e.rawId),
+                             e.data.size());
+    samp->setTimeTag(e.tt);
+    samp->setRawId(e.rawId);
+    if (e.data.size())
+      ::memcpy(samp->getVoidDataPtr(), &e.data[0], e.data.size());
+    out.receive(samp);
+    samp->freeReference();
+  }
+  out.flush();
+  out.close();
+  return name;
+}
+
+vector<Expected> readSamples(const string& name, string& encoding)
+{
+  int fd = ::open(name.c_str(), O_RDONLY);
+  BOOST_REQUIRE(fd >= 0);
+  SampleInputStream input(new UnixIOChannel(name, fd));
+  Collector collector;
+  input.addSampleClient(&collector);
+  while (input.readSamples());
+  encoding = input.getInputHeader().getSampleEncoding();
+  input.removeSampleClient(&collector);
+  input.close();
+  return collector.samples;
+}
+
+// Reads a byte at a time, so that each compact header
+// is assembled by SampleInputStream::nextCompactSample().
+class ByteChannel: public UnixIOChannel
+{
+public:
+  ByteChannel(const string& name, int fd): UnixIOChannel(name, fd) {}
+
+  size_t read(void* buf, size_t) throw(n_u::IOException)
+  {
+    return UnixIOChannel::read(buf, 1);
+  }
+};
+
+void checkSamples(const vector<Expected>& in, const vector<Expected>& out)
+{
+  BOOST_REQUIRE_EQUAL(in.size(), out.size());
+  for (unsigned int i = 0; i < in.size(); i++) {
+    BOOST_REQUIRE_EQUAL(in[i].tt, out[i].tt);
+    BOOST_REQUIRE_EQUAL(in[i].rawId, out[i].rawId);
+    BOOST_REQUIRE(in[i].data == out[i].data);
+  }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_codec)
+{
+  CompactHeaderEncoder encoder;
+  CompactHeaderDecoder decoder;
+  char buf[CompactHeaderEncoder::MAX_LENGTH];
+  SampleHeader header;
+
+  dsm_sample_id_t id = SET_DSM_ID(SET_SAMPLE_TYPE(0, CHAR_ST), 5) | 11;
+  dsm_time_t tts[] = { 1300000000000000LL, 1300000000010000LL,
+                       1300000000005000LL, 0, -1, LONG_LONG_MAX,
+                       LONG_LONG_MIN, 1300000000020000LL };
+  for (unsigned int i = 0; i < sizeof(tts) / sizeof(tts[0]); i++) {
+    size_t len = encoder.encode(tts[i], id, i * 1000, buf);
+    BOOST_CHECK(len <= (size_t)CompactHeaderEncoder::MAX_LENGTH);
+    encoder.accept();
+
+    // incomplete until the last byte
+    for (size_t l = 0; l < len; l++)
+      BOOST_CHECK_EQUAL(decoder.decode(buf, l, header), 0u);
+    BOOST_REQUIRE_EQUAL(decoder.decode(buf, len, header), len);
+    decoder.accept();
+    BOOST_CHECK_EQUAL(header.getTimeTag(), tts[i]);
+    BOOST_CHECK_EQUAL(header.getRawId(), id);
+    BOOST_CHECK_EQUAL(header.getDataByteLength(), i * 1000);
+  }
+
+  // a sample 10 msec after the previous of its id is 5 bytes
+  BOOST_CHECK_EQUAL(encoder.encode(1300000000030000LL, id, 20, buf), 5u);
+
+  // a type change of an id is sent as a new id
+  dsm_sample_id_t fid = SET_SAMPLE_TYPE(id, FLOAT_ST);
+  size_t len = encoder.encode(1300000000030000LL, fid, 8, buf);
+  encoder.accept();
+  BOOST_REQUIRE_EQUAL(decoder.decode(buf, len, header), len);
+  decoder.accept();
+  BOOST_CHECK_EQUAL(header.getRawId(), fid);
+  BOOST_CHECK_EQUAL(header.getType(), FLOAT_ST);
+
+  // an unknown dictionary code
+  buf[0] = 9;
+  buf[1] = 0;
+  buf[2] = 0;
+  BOOST_CHECK_THROW(decoder.decode(buf, 3, header), n_u::ParseException);
+  // a varint which is too long
+  ::memset(buf, 0xff, sizeof(buf));
+  BOOST_CHECK_THROW(decoder.decode(buf, sizeof(buf), header),
+                    n_u::ParseException);
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_roundtrip)
+{
+  vector<Expected> samples = makeSamples(5000);
+
+  string encoding;
+  string full = writeSamples(samples, "");
+  checkSamples(samples, readSamples(full, encoding));
+  BOOST_CHECK_EQUAL(encoding, "");
+
+  string compact = writeSamples(samples, "compact");
+  checkSamples(samples, readSamples(compact, encoding));
+  BOOST_CHECK_EQUAL(encoding, "compact");
+
+  // the same header, and smaller samples
+  off_t fsize, csize;
+  FILE* fp = ::fopen(full.c_str(), "r");
+  ::fseeko(fp, 0, SEEK_END);
+  fsize = ::ftello(fp);
+  ::fclose(fp);
+  fp = ::fopen(compact.c_str(), "r");
+  ::fseeko(fp, 0, SEEK_END);
+  csize = ::ftello(fp);
+  ::fclose(fp);
+  BOOST_CHECK(fsize - csize > (off_t)samples.size() * 10);
+
+  // readSample() assembles each sample, rather than readSamples()
+  int fd = ::open(compact.c_str(), O_RDONLY);
+  SampleInputStream input(new UnixIOChannel(compact, fd));
+  input.readInputHeader();
+  Collector collector;
+  for (unsigned int i = 0; i < samples.size(); i++) {
+    Sample* samp = input.readSample();
+    collector.receive(samp);
+    samp->freeReference();
+  }
+  input.close();
+  checkSamples(samples, collector.samples);
+
+  ::unlink(full.c_str());
+  ::unlink(compact.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_header_too_long)
+{
+  vector<Expected> samples = makeSamples(10);
+  string name = writeSamples(samples, "compact");
+
+  // A header of a new id whose varints are not of the shortest
+  // length, 22 bytes, longer than a valid one: a code of 0 in 3
+  // bytes, an id of 1 in 5, a time of 0 in 10 and a length of 0 in
+  // 4. The input is corrupt after it, and the valid header and
+  // data which follow are discarded.
+  const unsigned char bad[] = {
+    0x80, 0x80, 0x00,
+    0x81, 0x80, 0x80, 0x80, 0x00,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00,
+    0x80, 0x80, 0x80, 0x00
+  };
+  BOOST_REQUIRE(sizeof(bad) > (size_t)CompactHeaderEncoder::MAX_LENGTH);
+  CompactHeaderEncoder encoder;
+  char good[CompactHeaderEncoder::MAX_LENGTH + 4];
+  size_t hlen = encoder.encode(samples[0].tt, samples[0].rawId, 4, good);
+  ::memset(good + hlen, 0, 4);
+
+  FILE* fp = ::fopen(name.c_str(), "a");
+  BOOST_REQUIRE(fp);
+  ::fwrite(bad, 1, sizeof(bad), fp);
+  ::fwrite(good, 1, hlen + 4, fp);
+  ::fclose(fp);
+
+  int fd = ::open(name.c_str(), O_RDONLY);
+  BOOST_REQUIRE(fd >= 0);
+  SampleInputStream input(new ByteChannel(name, fd));
+  Collector collector;
+  input.addSampleClient(&collector);
+  while (input.readSamples());
+  input.removeSampleClient(&collector);
+  input.close();
+
+  checkSamples(samples, collector.samples);
+  ::unlink(name.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_encoding_name)
+{
+  SampleOutputStream out;
+  out.setSampleEncoding("compact");
+  BOOST_CHECK_EQUAL(out.getSampleEncoding(), "compact");
+  out.setSampleEncoding("full");
+  BOOST_CHECK_EQUAL(out.getSampleEncoding(), "");
+  BOOST_CHECK_THROW(out.setSampleEncoding("zip"),
+                    n_u::InvalidParameterException);
+
+  // the sample encoding is only in the headers of compact archives
+  SampleInputHeader header;
+  BOOST_CHECK(header.toString().find("sample encoding") == string::npos);
+  header.setSampleEncoding("compact");
+  BOOST_CHECK(header.toString().find("sample encoding: compact\n") !=
+              string::npos);
+}
@@ -0,0 +1,62 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/core/SampleIdMap.h>
+
+#include <map>
+
+using namespace nidas::core;
+
+
+BOOST_AUTO_TEST_CASE(test_sampleidmap_find)
+{
+  SampleIdMap<int> idmap;
+  BOOST_CHECK(idmap.empty());
+  BOOST_CHECK(idmap.find(0) == idmap.end());
+
+  // ids on several DSMs, added out of order, with gaps
+  std::map<dsm_sample_id_t, int> ref;
+  unsigned int dsms[] = { 5, 1, 1023, 0 };
+  unsigned int spsids[] = { 200, 11, 65535, 0, 1000, 101, 0x8001 };
+  int n = 0;
+  for (unsigned int i = 0; i < sizeof(dsms)/sizeof(dsms[0]); i++) {
+    for (unsigned int j = 0; j < sizeof(spsids)/sizeof(spsids[0]); j++) {
+      dsm_sample_id_t id = 0;
+      id = SET_DSM_ID(id, dsms[i]);
+      id = SET_SPS_ID(id, spsids[j]);
+      idmap[id] = n;
+      ref[id] = n++;
+    }
+  }
+  BOOST_CHECK_EQUAL(idmap.size(), ref.size());
+
+  std::map<dsm_sample_id_t, int>::const_iterator ri = ref.begin();
+  for ( ; ri != ref.end(); ++ri) {
+    SampleIdMap<int>::const_iterator mi = idmap.find(ri->first);
+    BOOST_REQUIRE(mi != idmap.end());
+    BOOST_CHECK_EQUAL(mi->first, ri->first);
+    BOOST_CHECK_EQUAL(mi->second, ri->second);
+
+    // the sample type is not part of the key
+    dsm_sample_id_t typed = SET_SAMPLE_TYPE(ri->first, 3);
+    BOOST_CHECK(idmap.find(typed) == mi);
+
+    // neighbors which were not added
+    dsm_sample_id_t spsid = GET_SPS_ID(ri->first);
+    if (spsid < 65535 && ref.find(ri->first + 1) == ref.end())
+      BOOST_CHECK(idmap.find(ri->first + 1) == idmap.end());
+  }
+  BOOST_CHECK(idmap.find(SET_DSM_ID(0, 2)) == idmap.end());
+
+  // iteration is in order of insertion
+  n = 0;
+  SampleIdMap<int>::iterator mi = idmap.begin();
+  for ( ; mi != idmap.end(); ++mi)
+    BOOST_CHECK_EQUAL(mi->second, n++);
+
+  idmap.clear();
+  BOOST_CHECK_EQUAL(idmap.size(), 0u);
+  BOOST_CHECK(idmap.find(ref.begin()->first) == idmap.end());
+}
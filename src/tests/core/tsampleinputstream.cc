@@ -0,0 +1,239 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/dynld/SampleInputStream.h>
+#include <nidas/core/SampleClient.h>
+#include <nidas/core/UnixIOChannel.h>
+#include <nidas/util/EOFException.h>
+#include <nidas/util/UTime.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace nidas::core;
+using namespace nidas::dynld;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+namespace {
+
+// Reads a file, throwing EOFException at the end, as FileSet does.
+class FileChannel: public UnixIOChannel
+{
+public:
+  FileChannel(int fd, size_t bufsize):
+    UnixIOChannel("archive", fd), _bufsize(bufsize) {}
+
+  FileChannel* clone() const { return new FileChannel(*this); }
+
+  size_t getBufferSize() const throw() { return _bufsize; }
+
+  size_t read(void* buf, size_t len) throw(n_u::IOException)
+  {
+    size_t l = UnixIOChannel::read(buf, len);
+    if (l == 0) throw n_u::EOFException(getName(), "read");
+    return l;
+  }
+
+private:
+  size_t _bufsize;
+};
+
+// Keeps the id, time and a checksum of the data of each sample.
+class Collector: public SampleClient
+{
+public:
+  Collector(): ids(), times(), sums() {}
+
+  bool receive(const Sample* s) throw()
+  {
+    ids.push_back(s->getId());
+    times.push_back(s->getTimeTag());
+    const unsigned char* dp = (const unsigned char*)s->getConstVoidDataPtr();
+    unsigned int sum = 0;
+    for (unsigned int i = 0; i < s->getDataByteLength(); i++)
+      sum = sum * 31 + dp[i];
+    sums.push_back(sum);
+    return true;
+  }
+
+  void flush() throw() {}
+
+  vector<dsm_sample_id_t> ids;
+  vector<dsm_time_t> times;
+  vector<unsigned int> sums;
+};
+
+const dsm_time_t T0 = n_u::UTime(true, 2026, 1, 1, 0, 0, 0).toUsecs();
+
+void
+appendSample(string& buf, int i, Collector& expected)
+{
+  // lengths from 1 to 97 bytes, so that samples are split
+  // at all positions across the 8192 byte reads
+  size_t len = (i * 37) % 97 + 1;
+  vector<char> data(len);
+  for (size_t j = 0; j < len; j++) data[j] = (char)(i + j);
+
+  SampleHeader header(CHAR_ST);
+  header.setTimeTag(T0 + (dsm_time_t)i * 1000);
+  header.setDataByteLength(len);
+  header.setDSMId(i % 8 + 1);
+  header.setSpSId(i % 1000);
+  buf.append((const char*)&header, SampleHeader::getSizeOf());
+  buf.append(&data[0], len);
+
+  SampleT<char>* samp = getSample<char>(len);
+  samp->setTimeTag(header.getTimeTag());
+  samp->setId(header.getId());
+  ::memcpy(samp->getDataPtr(), &data[0], len);
+  expected.receive(samp);
+  samp->freeReference();
+}
+
+/**
+ * Write an archive of nsamp samples, without an input header,
+ * with garbage after some of the samples. Return the number of
+ * bad bytes.
+ */
+size_t
+writeArchive(const string& path, int nsamp, Collector& expected)
+{
+  string buf;
+  size_t nbad = 0;
+  for (int i = 0; i < nsamp; i++) {
+    appendSample(buf, i, expected);
+    if (i % 50 == 7) {
+      // runs of 1 to 20 bytes of 0xff
+      size_t n = (i / 50) % 20 + 1;
+      buf.append(n, '\xff');
+      nbad += n;
+    }
+    if (i % 200 == 99) {
+      // a header with a length which is too large,
+      // followed by its data
+      SampleHeader header(CHAR_ST);
+      header.setTimeTag(T0 + (dsm_time_t)i * 1000);
+      header.setDataByteLength(50000);
+      header.setDSMId(1);
+      header.setSpSId(1);
+      buf.append((const char*)&header, SampleHeader::getSizeOf());
+      buf.append(20, '\x05');
+      nbad += SampleHeader::getSizeOf() + 20;
+    }
+  }
+  FILE* fp = ::fopen(path.c_str(), "w");
+  BOOST_REQUIRE(fp);
+  BOOST_REQUIRE_EQUAL(::fwrite(buf.c_str(), 1, buf.length(), fp),
+                      buf.length());
+  ::fclose(fp);
+  return nbad;
+}
+
+SampleInputStream*
+openArchive(const string& path, size_t bufsize)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  BOOST_REQUIRE(fd >= 0);
+  SampleInputStream* input =
+    new SampleInputStream(new FileChannel(fd, bufsize), true);
+  input->setExpectHeader(false);
+  input->setMaxDsmId(10);
+  input->setMaxSampleLength(1000);
+  input->setMinSampleTime(n_u::UTime(T0));
+  input->setMaxSampleTime(n_u::UTime(T0 + USECS_PER_DAY));
+  return input;
+}
+
+void
+checkSamples(const Collector& got, const Collector& expected)
+{
+  BOOST_REQUIRE_EQUAL(got.ids.size(), expected.ids.size());
+  for (unsigned int i = 0; i < got.ids.size(); i++) {
+    BOOST_CHECK_EQUAL(got.ids[i], expected.ids[i]);
+    BOOST_CHECK_EQUAL(got.times[i], expected.times[i]);
+    BOOST_CHECK_EQUAL(got.sums[i], expected.sums[i]);
+  }
+}
+
+/**
+ * Read an archive with readSamples(), which parses the whole samples
+ * of each read in place with distributeBlock(), and a sample split
+ * across reads with nextSample().
+ * @return number of bad samples
+ */
+size_t
+readBlocks(const string& path, size_t bufsize, Collector& got, int& nreads)
+{
+  SampleInputStream* input = openArchive(path, bufsize);
+  input->addSampleClient(&got);
+  nreads = 0;
+  try {
+    for (;;) {
+      input->readSamples();
+      nreads++;
+    }
+  }
+  catch (const n_u::EOFException& e) {}
+  input->removeSampleClient(&got);
+  size_t nbad = input->getBadSamples();
+  input->close();
+  delete input;
+  return nbad;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_corrupt_archive)
+{
+  char tmpl[] = "/tmp/tsampleinputstream_XXXXXX";
+  int tfd = ::mkstemp(tmpl);
+  BOOST_REQUIRE(tfd >= 0);
+  ::close(tfd);
+  string path(tmpl);
+
+  const int nsamp = 5000;
+  Collector expected;
+  size_t nbad = writeArchive(path, nsamp, expected);
+
+  // Reads of 16 KB, and of 122 bytes, smaller than the largest
+  // sample, so that the bad bytes and samples are split across
+  // reads at many positions.
+  size_t bufsizes[] = { 8192, 61 };
+  for (int i = 0; i < 2; i++) {
+    Collector block;
+    int nreads;
+    size_t blockBad = readBlocks(path, bufsizes[i], block, nreads);
+    BOOST_CHECK_GT(nreads, 10);
+    checkSamples(block, expected);
+    // Each byte skipped while searching for a good header is
+    // counted as a bad sample.
+    BOOST_CHECK_EQUAL(blockBad, nbad);
+  }
+
+  // The same with readSample(), a sample at a time.
+  SampleInputStream* input = openArchive(path, 8192);
+  Collector single;
+  try {
+    for (;;) {
+      Sample* samp = input->readSample();
+      single.receive(samp);
+      samp->freeReference();
+    }
+  }
+  catch (const n_u::EOFException& e) {}
+  BOOST_CHECK_EQUAL(input->getBadSamples(), nbad);
+  input->close();
+  delete input;
+
+  checkSamples(single, expected);
+
+  ::unlink(path.c_str());
+}
@@ -0,0 +1,222 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/core/SampleSorter.h>
+#include <nidas/core/SampleClient.h>
+#include <nidas/util/Thread.h>
+#include <nidas/util/UTime.h>
+
+#include <vector>
+#include <unistd.h>
+
+using namespace nidas::core;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+namespace {
+
+class TimeCollector: public SampleClient
+{
+public:
+  TimeCollector(): times(), mutex() {}
+
+  bool receive(const Sample* s) throw()
+  {
+    n_u::Autolock alock(mutex);
+    times.push_back(s->getTimeTag());
+    return true;
+  }
+
+  void flush() throw() {}
+
+  vector<dsm_time_t> times;
+
+  n_u::Mutex mutex;
+};
+
+// Send nsamp samples, one every dt usecs, with time tags
+// jittered by up to 0.1 seconds.
+class Producer: public n_u::Thread
+{
+public:
+  Producer(SampleSorter& sorter, int id, int nsamp):
+    n_u::Thread("Producer"), _sorter(sorter), _id(id), _nsamp(nsamp)
+  {}
+
+  int run() throw(n_u::Exception)
+  {
+    dsm_time_t t0 = 1000000000LL * USECS_PER_SEC;
+    for (int i = 0; i < _nsamp; i++) {
+      SampleT<float>* samp = getSample<float>(1);
+      dsm_time_t tt = t0 + (i * 1000) + _id * 10 + ((i * 7919) % 100) * 1000;
+      samp->setTimeTag(tt);
+      samp->setId(_id);
+      samp->getDataPtr()[0] = i;
+      _sorter.receive(samp);
+      samp->freeReference();
+    }
+    return RUN_OK;
+  }
+
+private:
+  SampleSorter& _sorter;
+  int _id;
+  int _nsamp;
+
+  Producer(const Producer&);
+  Producer& operator=(const Producer&);
+};
+
+void
+sortSamples(unsigned int nshards, bool heapBlock)
+{
+  const int nprod = 4;
+  const int nsamp = 20000;
+
+  SampleSorter sorter("TestSorter", true);
+  // longer than the data, so that the producers needn't keep in step
+  sorter.setLengthSecs(100.0);
+  sorter.setHeapBlock(heapBlock);
+  // Without blocking, the heap must hold all the samples.
+  if (!heapBlock) sorter.setHeapMax(100000000);
+  sorter.setNumShards(nshards);
+  BOOST_CHECK_EQUAL(sorter.getNumShards(), std::max(1u, nshards));
+
+  TimeCollector collector;
+  sorter.addSampleClient(&collector);
+  sorter.start();
+
+  vector<Producer*> producers;
+  for (int i = 0; i < nprod; i++) {
+    producers.push_back(new Producer(sorter, i, nsamp));
+    producers.back()->start();
+  }
+  for (int i = 0; i < nprod; i++) {
+    producers[i]->join();
+    delete producers[i];
+  }
+  sorter.flush();
+  sorter.interrupt();
+  sorter.join();
+  sorter.removeSampleClient(&collector);
+
+  BOOST_CHECK_EQUAL(collector.times.size(), (size_t)(nprod * nsamp));
+  bool sorted = true;
+  for (unsigned int i = 1; i < collector.times.size(); i++)
+    if (collector.times[i] < collector.times[i-1]) sorted = false;
+  BOOST_CHECK(sorted);
+  BOOST_CHECK_EQUAL(sorter.getNumDiscardedSamples(), 0u);
+  BOOST_CHECK_EQUAL(sorter.getHeapSize(), 0u);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_sorter)
+{
+  sortSamples(1, true);
+}
+
+BOOST_AUTO_TEST_CASE(test_sharded_sorter)
+{
+  sortSamples(4, true);
+}
+
+BOOST_AUTO_TEST_CASE(test_sharded_nonblocking_sorter)
+{
+  sortSamples(4, false);
+}
+
+BOOST_AUTO_TEST_CASE(test_sharded_sorter_discard)
+{
+  const int nprod = 4;
+  const int nsamp = 5000;
+  const int nkeep = 100;
+
+  SampleT<float>* samp = getSample<float>(1);
+  size_t slen = samp->getDataByteLength() + samp->getHeaderLength();
+  samp->freeReference();
+
+  SampleSorter sorter("TestSorter", true);
+  sorter.setLengthSecs(100.0);
+  sorter.setHeapBlock(false);
+  sorter.setHeapMax(nkeep * slen);
+  sorter.setNumShards(4);
+
+  TimeCollector collector;
+  sorter.addSampleClient(&collector);
+
+  // The sorting thread is not running, so the heap fills up
+  // and the producers then discard samples, without blocking.
+  vector<Producer*> producers;
+  for (int i = 0; i < nprod; i++) {
+    producers.push_back(new Producer(sorter, i, nsamp));
+    producers.back()->start();
+  }
+  for (int i = 0; i < nprod; i++) {
+    producers[i]->join();
+    delete producers[i];
+  }
+  BOOST_CHECK_EQUAL(sorter.getHeapSize(), nkeep * slen);
+  BOOST_CHECK_EQUAL(sorter.getNumDiscardedSamples(),
+                    (size_t)(nprod * nsamp - nkeep));
+
+  sorter.start();
+  sorter.flush();
+  sorter.interrupt();
+  sorter.join();
+  sorter.removeSampleClient(&collector);
+
+  BOOST_CHECK_EQUAL(collector.times.size(), (size_t)nkeep);
+  bool sorted = true;
+  for (unsigned int i = 1; i < collector.times.size(); i++)
+    if (collector.times[i] < collector.times[i-1]) sorted = false;
+  BOOST_CHECK(sorted);
+  BOOST_CHECK_EQUAL(sorter.getHeapSize(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_adaptive_sorter)
+{
+  SampleSorter sorter("TestSorter", true);
+  sorter.setLengthSecs(2.0);
+  sorter.setHeapMax(50000000);
+  sorter.setAdaptive(true);
+  sorter.setLengthBounds(0.05, 5.0);
+  sorter.setHeapMaxBounds(10000, 50000000);
+  sorter.setAdaptPeriodSecs(0.1);
+
+  TimeCollector collector;
+  sorter.addSampleClient(&collector);
+  sorter.start();
+
+  // A sample every msec of system time, with time tags
+  // jittered by up to 0.1 seconds.
+  dsm_time_t t0 = n_u::getSystemTime();
+  int i;
+  for (i = 0; n_u::getSystemTime() < t0 + 2 * USECS_PER_SEC; i++) {
+    SampleT<float>* samp = getSample<float>(1);
+    samp->setTimeTag(t0 + (i * 1000) + ((i * 7919) % 100) * 1000);
+    samp->setId(1);
+    samp->getDataPtr()[0] = i;
+    sorter.receive(samp);
+    samp->freeReference();
+    usleep(1000);
+  }
+  sorter.flush();
+  sorter.interrupt();
+  sorter.join();
+  sorter.removeSampleClient(&collector);
+
+  BOOST_CHECK_EQUAL(collector.times.size(), (size_t)i);
+
+  // the disorder is about 0.1 seconds
+  BOOST_CHECK_GT(sorter.getLengthSecs(), 0.09);
+  BOOST_CHECK_LT(sorter.getLengthSecs(), 0.3);
+
+  // at most a few thousand samples of 20 bytes per second
+  BOOST_CHECK_GE(sorter.getHeapMax(), 10000u);
+  BOOST_CHECK_LT(sorter.getHeapMax(), 5000000u);
+  BOOST_CHECK_EQUAL(sorter.getNumEarlySamples(), 0u);
+}
@@ -0,0 +1,152 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/core/CharacterSensor.h>
+#include <nidas/core/Project.h>
+#include <nidas/core/SampleMatcher.h>
+#include <nidas/core/SensorCatalog.h>
+#include <nidas/core/XMLParser.h>
+#include <nidas/core/XDOM.h>
+
+#include <xercesc/framework/MemBufInputSource.hpp>
+
+#include <cstring>
+#include <list>
+#include <map>
+#include <string>
+
+using namespace nidas::core;
+using namespace std;
+
+namespace {
+
+// A catalog entry with a sample, and sensors of dsm 1 with ids in
+// the element, in the catalog entry, in hex, and which can't be read,
+// and an override by devicename of a sensor from a dsmcatalog entry.
+const char* xml =
+  "<project>"
+  "<sensorcatalog>"
+  "<sensor ID=\"cat\"><sample id=\"2\"/></sensor>"
+  "<sensor ID=\"noid\"><sample id=\"3\"/></sensor>"
+  "</sensorcatalog>"
+  "<dsm id=\"1\">"
+  "<sensor ID=\"plain\" id=\"100\"/>"
+  "<sensor ID=\"sample\" id=\"200\"><sample id=\"1\"/></sensor>"
+  "<sensor ID=\"catalog\" IDREF=\"cat\" id=\"300\"/>"
+  "<sensor ID=\"hex\" id=\"0x1f4\"/>"
+  "<sensor ID=\"unparseable\" id=\"$SENSOR_ID\"/>"
+  "<sensor ID=\"catalognoid\" IDREF=\"noid\"/>"
+  "<sensor ID=\"override\" devicename=\"/dev/ttyS1\"/>"
+  "</dsm>"
+  "</project>";
+
+const xercesc::DOMElement*
+findChild(const xercesc::DOMElement* node, const string& name)
+{
+  for (xercesc::DOMNode* child = node->getFirstChild(); child != 0;
+       child = child->getNextSibling()) {
+    if (child->getNodeType() != xercesc::DOMNode::ELEMENT_NODE) continue;
+    XDOMElement xchild((xercesc::DOMElement*) child);
+    if (xchild.getNodeName() == name) return (xercesc::DOMElement*) child;
+  }
+  return 0;
+}
+
+// Which of the sensors of dsm 1 are selected, by their ID attribute,
+// given the sensors which have been created.
+map<string, bool>
+selected(const Project& project, const xercesc::DOMElement* dsm,
+         const list<DSMSensor*>& sensors = list<DSMSensor*>())
+{
+  map<string, bool> sel;
+  for (xercesc::DOMNode* child = dsm->getFirstChild(); child != 0;
+       child = child->getNextSibling()) {
+    if (child->getNodeType() != xercesc::DOMNode::ELEMENT_NODE) continue;
+    XDOMElement xchild((xercesc::DOMElement*) child);
+    sel[xchild.getAttributeValue("ID")] =
+      project.selectSensor(1, (xercesc::DOMElement*) child, sensors);
+  }
+  return sel;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_select_sensor)
+{
+  XMLParser* parser = new XMLParser();
+  parser->setXercesUserAdoptsDOMDocument(true);
+  xercesc::MemBufInputSource source((const XMLByte*) xml, strlen(xml),
+                                    "tselectsensor", false);
+  xercesc::DOMDocument* doc = parser->parse(source);
+  delete parser;
+
+  const xercesc::DOMElement* root = doc->getDocumentElement();
+  const xercesc::DOMElement* dsm = findChild(root, "dsm");
+  BOOST_REQUIRE(dsm);
+
+  Project project;
+  SensorCatalog* catalog = new SensorCatalog();
+  catalog->fromDOMElement(findChild(root, "sensorcatalog"));
+  project.setSensorCatalog(catalog);
+
+  // Without a SampleMatcher, all are selected.
+  map<string, bool> sel = selected(project, dsm);
+  BOOST_CHECK_EQUAL(sel.size(), 7);
+  for (map<string, bool>::const_iterator si = sel.begin();
+       si != sel.end(); ++si)
+    BOOST_CHECK_MESSAGE(si->second, si->first);
+
+  // A sensor id, a <sample> id, a sample id of a catalog entry
+  // and a hex sensor id. The sensors whose ids aren't known
+  // until they are created are always selected, but not the
+  // override of a sensor which wasn't created.
+  const char* criteria[] = { "1,100", "1,201", "1,302", "1,500" };
+  const char* expected[] = { "plain", "sample", "catalog", "hex" };
+  for (int i = 0; i < 4; i++) {
+    SampleMatcher matcher;
+    BOOST_REQUIRE(matcher.addCriteria(criteria[i]));
+    project.setSampleMatcher(&matcher);
+    sel = selected(project, dsm);
+    for (map<string, bool>::const_iterator si = sel.begin();
+         si != sel.end(); ++si) {
+      bool expect = si->first == expected[i] ||
+        si->first == "unparseable" || si->first == "catalognoid";
+      BOOST_CHECK_MESSAGE(si->second == expect,
+                          criteria[i] << ": " << si->first << "=" <<
+                          si->second);
+    }
+  }
+
+  // 301 is no sensor id, nor a sensor id plus one of its sample ids.
+  SampleMatcher matcher;
+  BOOST_REQUIRE(matcher.addCriteria("1,301"));
+  project.setSampleMatcher(&matcher);
+  sel = selected(project, dsm);
+  BOOST_CHECK(!sel["catalog"]);
+  BOOST_CHECK(sel["unparseable"]);
+  BOOST_CHECK(!sel["override"]);
+
+  // The override is selected if the sensor it overrides was created.
+  CharacterSensor serial;
+  serial.setDeviceName("/dev/ttyS1");
+  list<DSMSensor*> sensors;
+  sensors.push_back(&serial);
+  sel = selected(project, dsm, sensors);
+  BOOST_CHECK(sel["override"]);
+  BOOST_CHECK(!sel["catalog"]);
+
+  // No sensors of a DSM which can't match, not even those with
+  // an unknown id.
+  SampleMatcher other;
+  BOOST_REQUIRE(other.addCriteria("2,100"));
+  project.setSampleMatcher(&other);
+  sel = selected(project, dsm);
+  for (map<string, bool>::const_iterator si = sel.begin();
+       si != sel.end(); ++si)
+    BOOST_CHECK_MESSAGE(!si->second, si->first);
+
+  project.setSampleMatcher(0);
+  doc->release();
+  XMLImplementation::terminate();
+}
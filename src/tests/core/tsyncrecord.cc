@@ -0,0 +1,207 @@
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/dynld/raf/SyncRecordSource.h>
+#include <nidas/core/SampleClient.h>
+#include <nidas/core/SortedSampleSet.h>
+#include <nidas/core/Variable.h>
+#include <nidas/util/UTime.h>
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <vector>
+
+using namespace nidas::core;
+using namespace nidas::dynld::raf;
+using namespace std;
+
+namespace n_u = nidas::util;
+
+namespace {
+
+// Keeps a copy of the data of each sync record.
+class RecordCollector: public SampleClient
+{
+public:
+  RecordCollector(): times(), records() {}
+
+  bool receive(const Sample* s) throw()
+  {
+    if (s->getId() != SYNC_RECORD_ID) return false;
+    const double* dp = (const double*)s->getConstVoidDataPtr();
+    times.push_back(s->getTimeTag());
+    records.push_back(vector<double>(dp, dp + s->getDataLength()));
+    return true;
+  }
+
+  void flush() throw() {}
+
+  vector<dsm_time_t> times;
+  vector<vector<double> > records;
+};
+
+/**
+ * The per-variable copy of a sample into a sync record which
+ * SyncRecordSource did before it used scatter tables. varOffset
+ * are the offsets of the variables into the whole record.
+ */
+template <typename ST>
+void
+copy_variables_to_record(const Sample* samp, double* dataPtr,
+                         const int* varOffset, const size_t* varLen,
+                         size_t numVar, int timeIndex)
+{
+  const ST* fp = (const ST*)samp->getConstVoidDataPtr();
+  const ST* ep = fp + samp->getDataLength();
+
+  for (size_t i = 0; i < numVar && fp < ep; i++) {
+    size_t outlen = varLen[i];
+    size_t inlen = std::min((size_t)(ep - fp), outlen);
+    if (varOffset[i] >= 0) {
+      double* dp = dataPtr + varOffset[i] + 1 + outlen * timeIndex;
+      for (size_t j = 0; j < inlen; j++) dp[j] = fp[j];
+    }
+    fp += inlen;
+  }
+}
+
+struct TestSample
+{
+  sampleType type;
+  float rate;
+  // lengths of the variables, of which the first nselected are
+  // continuous, and the rest are not put in the sync record.
+  size_t lens[4];
+  size_t nvars;
+  size_t nselected;
+  // number of values in each sample
+  size_t nvals;
+};
+
+const TestSample testSamples[] = {
+  // 10 Hz floats, a scalar and a vector
+  { FLOAT_ST, 10.0, { 1, 3 }, 2, 2, 4 },
+  // 1 Hz doubles, short by one value
+  { DOUBLE_ST, 1.0, { 1, 1, 2 }, 3, 3, 3 },
+  // 12.5 Hz, whose row has 13 samples, with an extra value
+  { UINT32_ST, 12.5, { 2 }, 1, 1, 3 },
+  // 5 Hz, with a trailing variable which is not selected
+  { FLOAT_ST, 5.0, { 2, 1, 1, 3 }, 4, 3, 7 },
+};
+const int NTAGS = sizeof(testSamples) / sizeof(testSamples[0]);
+
+Sample*
+makeSample(const TestSample& ts, dsm_sample_id_t id, dsm_time_t tt, int n)
+{
+  Sample* samp;
+  switch (ts.type) {
+  case FLOAT_ST: samp = getSample<float>(ts.nvals); break;
+  case DOUBLE_ST: samp = getSample<double>(ts.nvals); break;
+  default: samp = getSample<uint32_t>(ts.nvals); break;
+  }
+  samp->setId(id);
+  samp->setTimeTag(tt);
+  for (size_t j = 0; j < ts.nvals; j++)
+    samp->setDataValue(j, (float)(n * 100 + j + 1));
+  return samp;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_sync_record_scatter)
+{
+  const dsm_time_t T0 = n_u::UTime(true, 2026, 1, 1, 0, 0, 0).toUsecs();
+
+  SampleTag tags[NTAGS];
+  list<const Variable*> variables;
+  for (int t = 0; t < NTAGS; t++) {
+    const TestSample& ts = testSamples[t];
+    tags[t].setDSMId(1);
+    tags[t].setSensorId(100);
+    tags[t].setSampleId(t + 1);
+    tags[t].setRate(ts.rate);
+    for (size_t i = 0; i < ts.nvars; i++) {
+      Variable* var = new Variable();
+      var->setName(string("v") + (char)('a' + t) + (char)('0' + i));
+      var->setLength(ts.lens[i]);
+      if (i >= ts.nselected) var->setType(Variable::OTHER);
+      tags[t].addVariable(var);
+      if (i < ts.nselected) variables.push_back(var);
+    }
+  }
+
+  SyncRecordSource syncer;
+  syncer.setVariables(variables);
+  RecordCollector collector;
+  syncer.addSampleClient(&collector);
+
+  // The expected record, from the documented layout of each row:
+  // toffset, then var[time][element] for each selected variable.
+  vector<vector<int> > varOffsets(NTAGS);
+  vector<vector<size_t> > varLens(NTAGS);
+  int recSize = 0;
+  for (int t = 0; t < NTAGS; t++) {
+    const TestSample& ts = testSamples[t];
+    int nsamp = (int)ceil(ts.rate);
+    int offset = recSize;
+    for (size_t i = 0; i < ts.nselected; i++) {
+      varOffsets[t].push_back(offset);
+      varLens[t].push_back(ts.lens[i]);
+      offset += ts.lens[i] * nsamp;
+    }
+    recSize = offset + 1;
+  }
+  vector<double> expected(recSize, doubleNAN);
+
+  // Samples of each tag, evenly spaced from the start of the second,
+  // fed in time order.
+  vector<Sample*> samples;
+  int rowOffset = 0;
+  for (int t = 0; t < NTAGS; t++) {
+    const TestSample& ts = testSamples[t];
+    int nsamp = (int)ceil(ts.rate);
+    int usecs = (int)rint(USECS_PER_SEC / ts.rate);
+    expected[rowOffset] = 0.0;    // toffset
+    for (int n = 0; n < nsamp; n++) {
+      Sample* samp = makeSample(ts, tags[t].getId(),
+                                T0 + (dsm_time_t)n * usecs, n);
+      samples.push_back(samp);
+      switch (ts.type) {
+      case FLOAT_ST:
+        copy_variables_to_record<float>(samp, &expected[0],
+          &varOffsets[t][0], &varLens[t][0], ts.nselected, n);
+        break;
+      case DOUBLE_ST:
+        copy_variables_to_record<double>(samp, &expected[0],
+          &varOffsets[t][0], &varLens[t][0], ts.nselected, n);
+        break;
+      default:
+        copy_variables_to_record<uint32_t>(samp, &expected[0],
+          &varOffsets[t][0], &varLens[t][0], ts.nselected, n);
+        break;
+      }
+    }
+    rowOffset = varOffsets[t].back() + varLens[t].back() * nsamp + 1;
+  }
+
+  stable_sort(samples.begin(), samples.end(), SampleTimetagComparator());
+  for (unsigned int i = 0; i < samples.size(); i++) {
+    BOOST_CHECK(syncer.receive(samples[i]));
+    samples[i]->freeReference();
+  }
+  syncer.flush();
+
+  BOOST_REQUIRE_EQUAL(collector.records.size(), 1);
+  BOOST_CHECK_EQUAL(collector.times[0], T0);
+  const vector<double>& rec = collector.records[0];
+  BOOST_REQUIRE_EQUAL(rec.size(), expected.size());
+  for (unsigned int i = 0; i < rec.size(); i++) {
+    if (std::isnan(expected[i]))
+      BOOST_CHECK_MESSAGE(std::isnan(rec[i]), "rec[" << i << "]=" << rec[i]);
+    else
+      BOOST_CHECK_MESSAGE(rec[i] == expected[i], "rec[" << i << "]=" <<
+                          rec[i] << ", expected " << expected[i]);
+  }
+}
@@ -0,0 +1,123 @@
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/auto_unit_test.hpp>
+using boost::unit_test_framework::test_suite;
+
+#include <nidas/util/ThreadPool.h>
+#include <nidas/util/IOException.h>
+#include <nidas/util/ThreadSupport.h>
+
+#include <unistd.h>
+
+namespace n_u = nidas::util;
+
+namespace {
+
+class Sum: public n_u::Callable<long long>
+{
+public:
+  Sum(): n(0), usec(0), started(false), cond() {}
+
+  long long call() throw(n_u::Exception)
+  {
+    {
+      n_u::Synchronized sync(cond);
+      started = true;
+      cond.broadcast();
+    }
+    if (usec) usleep(usec);
+    long long sum = 0;
+    for (int i = 1; i <= n; i++) sum += i;
+    return sum;
+  }
+
+  void waitStarted()
+  {
+    n_u::Synchronized sync(cond);
+    while (!started) cond.wait();
+  }
+
+  int n;
+  int usec;
+
+private:
+  bool started;
+  n_u::Cond cond;
+};
+
+class Thrower: public n_u::Task
+{
+public:
+  void execute() throw(n_u::Exception)
+  {
+    throw n_u::IOException("thrower", "read", EIO);
+  }
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(test_threadpool_futures)
+{
+  n_u::ThreadPool pool("tpool", 4);
+  BOOST_CHECK_EQUAL(pool.getNumThreads(), 4u);
+  pool.start();
+
+  Sum sums[100];
+  for (unsigned int i = 0; i < sizeof(sums) / sizeof(sums[0]); i++) {
+    sums[i].n = i;
+    pool.submit(&sums[i]);
+  }
+  for (unsigned int i = 0; i < sizeof(sums) / sizeof(sums[0]); i++) {
+    BOOST_CHECK_EQUAL(sums[i].get(), (long long)i * (i + 1) / 2);
+    BOOST_CHECK(sums[i].isDone());
+  }
+
+  // a Task can be submitted again when it is done
+  sums[0].n = 10;
+  pool.submit(&sums[0]);
+  BOOST_CHECK_EQUAL(sums[0].get(), 55);
+
+  Thrower thrower;
+  pool.submit(&thrower);
+  BOOST_CHECK_THROW(thrower.wait(), n_u::Exception);
+  pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(test_threadpool_stealing)
+{
+  n_u::ThreadPool pool("tpool", 4);
+  pool.start();
+
+  // all queued to one thread, the others steal them
+  Sum sums[40];
+  for (unsigned int i = 0; i < sizeof(sums) / sizeof(sums[0]); i++) {
+    sums[i].n = i;
+    sums[i].usec = 2000;
+    pool.submit(&sums[i], 0);
+  }
+  pool.join();
+  for (unsigned int i = 0; i < sizeof(sums) / sizeof(sums[0]); i++) {
+    BOOST_CHECK(sums[i].isDone());
+    BOOST_CHECK_EQUAL(sums[i].get(), (long long)i * (i + 1) / 2);
+  }
+  BOOST_CHECK(pool.getNumStolen() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_threadpool_interrupt)
+{
+  n_u::ThreadPool pool("tpool", 1);
+  Sum sums[5];
+  for (unsigned int i = 0; i < sizeof(sums) / sizeof(sums[0]); i++) {
+    sums[i].usec = 20000;
+    pool.submit(&sums[i]);
+  }
+  pool.start();
+  sums[0].waitStarted();
+  pool.interrupt();
+
+  // the first is run, queued ones are finished with an exception
+  BOOST_CHECK_EQUAL(sums[0].get(), 0);
+  BOOST_CHECK_THROW(sums[4].wait(), n_u::Exception);
+  for (unsigned int i = 0; i < sizeof(sums) / sizeof(sums[0]); i++)
+    BOOST_CHECK(sums[i].isDone());
+}
@@ -0,0 +1,86 @@
+#! /bin/sh
+
+# Check the digest verification of merge_verify -d, with the TREX
+# archives as the merge, and inputs split from them by dsm with
+# sensor_extract.
+
+installed=false
+[ $# -gt 0 -a "$1" = "-i" ] && installed=true
+
+if ! $installed; then
+
+    echo $PATH | fgrep -q build/apps || PATH=../../build/apps:$PATH
+
+    llp=../../build/util:../../build/core:../../build/dynld
+    echo $LD_LIBRARY_PATH | fgrep -q build || \
+        export LD_LIBRARY_PATH=$llp${LD_LIBRARY_PATH:+":$LD_LIBRARY_PATH"}
+
+    if ! which merge_verify | fgrep -q build/; then
+        echo "merge_verify program not found on build directory. PATH=$PATH"
+        exit 1
+    fi
+fi
+
+echo "merge_verify executable: `which merge_verify`"
+
+datadir=../prep/data/projects/TREX/merge
+merge="$datadir/isff_20060331_000000.dat $datadir/isff_20060401_000000.dat $datadir/isff_20060402_160000.dat"
+
+rm -rf outputs
+mkdir outputs
+
+run() # output command ...
+{
+    out=$1
+    shift
+    (set -x; "$@" > $out 2> $out.stderr)
+    if [ $? -ne 0 ]; then
+        echo "*** Non-zero exit status: $*"
+        cat $out.stderr
+        exit 1
+    fi
+}
+
+# inputs with the samples of dsm 2, and of the other dsms
+run outputs/extract2.out sensor_extract -s 2 outputs/dsm2.dat $merge
+run outputs/extract3.out sensor_extract -x 2 outputs/dsm3.dat $merge
+
+# A good merge: the samples of each interval, one per day, match.
+run outputs/good.out merge_verify -d 1 -i outputs/dsm2.dat \
+    -i outputs/dsm3.dat -m $merge
+cat outputs/good.out
+if ! fgrep -q "mismatched intervals and ids=0" outputs/good.out; then
+    echo "*** merge_verify -d reported mismatches in a good merge"
+    cat outputs/good.out.stderr
+    exit 1
+fi
+if [ `fgrep -c "mismatched ids=0" outputs/good.out` -ne 3 ]; then
+    echo "*** merge_verify -d did not verify 3 intervals"
+    exit 1
+fi
+if ! egrep -q "^merge samps=([1-9][0-9]*), input samps=\1," outputs/good.out; then
+    echo "*** merge_verify -d read different numbers of samples"
+    exit 1
+fi
+
+# A merge missing the samples of sensor 2,100.
+run outputs/badmerge.out sensor_extract -x 2,100 outputs/badmerge.dat $merge
+run outputs/bad.out merge_verify -d 1 -i outputs/dsm2.dat \
+    -i outputs/dsm3.dat -m outputs/badmerge.dat
+cat outputs/bad.out
+if fgrep -q "mismatched intervals and ids=0" outputs/bad.out; then
+    echo "*** merge_verify -d found no mismatches in a bad merge"
+    exit 1
+fi
+if [ `fgrep -c "id=2,100, merge samps=0," outputs/bad.out.stderr` -ne 3 ]; then
+    echo "*** merge_verify -d did not report the missing samples of 2,100"
+    cat outputs/bad.out.stderr
+    exit 1
+fi
+if fgrep "Mismatch" outputs/bad.out.stderr | fgrep -qv "id=2,100,"; then
+    echo "*** merge_verify -d reported mismatches of other ids"
+    cat outputs/bad.out.stderr
+    exit 1
+fi
+
+echo "merge_verify tests passed"
@@ -0,0 +1,95 @@
+#! /bin/sh
+
+# Check that sensor_extract -r, which copies samples without decoding
+# them, writes the same archives as sensor_extract without -r, and
+# that rehead copies the data after the header unchanged.
+
+installed=false
+[ $# -gt 0 -a "$1" = "-i" ] && installed=true
+
+if ! $installed; then
+
+    echo $PATH | fgrep -q build/apps || PATH=../../build/apps:$PATH
+
+    llp=../../build/util:../../build/core:../../build/dynld
+    echo $LD_LIBRARY_PATH | fgrep -q build || \
+        export LD_LIBRARY_PATH=$llp${LD_LIBRARY_PATH:+":$LD_LIBRARY_PATH"}
+
+    if ! which sensor_extract | fgrep -q build/; then
+        echo "sensor_extract program not found on build directory. PATH=$PATH"
+        exit 1
+    fi
+fi
+
+echo "sensor_extract executable: `which sensor_extract`"
+
+datadir=../prep/data/projects/TREX/merge
+inputs="$datadir/isff_20060331_000000.dat $datadir/isff_20060401_000000.dat $datadir/isff_20060402_160000.dat"
+
+test -d outputs || mkdir outputs
+
+extract() # name option ...
+{
+    name=$1
+    shift
+    for mode in decode raw; do
+        dir=outputs/$name/$mode
+        rm -rf $dir
+        mkdir -p $dir
+        flag=
+        [ $mode = raw ] && flag=-r
+        (set -x; sensor_extract $flag "$@" $dir/se_%Y%m%d_%H%M%S.dat \
+            $inputs > $dir.stderr 2>&1)
+        if [ $? -ne 0 ]; then
+            echo "*** Non-zero exit status: sensor_extract $flag $*"
+            cat $dir.stderr
+            exit 1
+        fi
+    done
+    if [ -z "`ls outputs/$name/raw`" ]; then
+        echo "*** No output files: sensor_extract $*"
+        exit 1
+    fi
+    if ! diff -r outputs/$name/decode outputs/$name/raw; then
+        echo "*** sensor_extract -r output differs: $*"
+        exit 1
+    fi
+}
+
+# all samples, split into daily files
+extract all -l 86400
+
+# selected sensors, changing the id of one
+extract sensors -l 86400 -s 2,100 -s 3,150,5,151
+
+# all sensors of a dsm, changing the dsm id
+extract dsm -s 3,-1,7
+
+# excluded sensors
+extract exclude -x 2,100 -x 3
+
+# rehead only rewrites the header, and must copy the samples
+# after it unchanged.
+input=$datadir/isff_20060402_160000.dat
+output=outputs/rehead.dat
+rm -f $output
+if ! ./rehead $input $output > outputs/rehead.stderr 2>&1; then
+    echo "*** Non-zero exit status: rehead $input $output"
+    cat outputs/rehead.stderr
+    exit 1
+fi
+
+# byte offset of the data after the "end header" line
+dataoffset() # file
+{
+    echo $((`grep -abo -m 1 "end header" $1 | cut -d: -f1` + 11))
+}
+
+tail -c +$((`dataoffset $input` + 1)) $input > outputs/rehead.in
+tail -c +$((`dataoffset $output` + 1)) $output > outputs/rehead.out
+if ! cmp outputs/rehead.in outputs/rehead.out; then
+    echo "*** rehead did not copy the data unchanged"
+    exit 1
+fi
+
+echo "sensor_extract and rehead tests passed"